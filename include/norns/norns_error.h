@@ -80,6 +80,10 @@ extern "C" {
 #define NORNS_ENOSUCHTASK        -41
 #define NORNS_ETOOMANYTASKS      -42
 #define NORNS_ETASKSPENDING      -43
+#define NORNS_ETASKCANCELLED     -44
+#define NORNS_EDEPFAILED         -45
+#define NORNS_ETASKFINISHED      -46
+#define NORNS_ENOTTASKOWNER      -47
 
 /* task status */
 #define NORNS_EUNDEFINED        -100
@@ -39,6 +39,7 @@
 #define __NORNS_TYPES_H__ 1
 
 #include <sys/types.h>
+#include <time.h>       /* For struct timespec */
 
 #ifdef __cplusplus
 extern "C" {
@@ -133,6 +134,23 @@ typedef enum {
     NORNS_IOTASK_REMOVE = 0x3
 } norns_op_t;
 
+/* Task priorities */
+typedef enum {
+    NORNS_PRIORITY_DEFAULT = 0x0,   /* same as NORNS_PRIORITY_NORMAL */
+    NORNS_PRIORITY_LOW     = 0x1,
+    NORNS_PRIORITY_NORMAL  = 0x2,
+    NORNS_PRIORITY_HIGH    = 0x3,
+    NORNS_PRIORITY_URGENT  = 0x4
+} norns_priority_t;
+
+/* Mechanisms used by a task to copy data between local paths */
+#define NORNS_COPY_REFLINK      0x1 /* data blocks shared with the source */
+#define NORNS_COPY_FILE_RANGE   0x2 /* in-kernel or server-side copy */
+#define NORNS_COPY_SENDFILE     0x4 /* data streamed through the kernel */
+#define NORNS_COPY_READ_WRITE   0x8 /* data copied through a user buffer */
+#define NORNS_COPY_IO_URING     0x10 /* small files batched with io_uring */
+#define NORNS_COPY_DIRECT       0x20 /* data copied bypassing the page cache */
+
 /* I/O task status descriptor */
 typedef struct {
     norns_status_t st_status;     /* task current status */
@@ -140,6 +158,7 @@ typedef struct {
     int            st_sys_errno;  /* errno returned if st_task_error == NORNS_ESYSTEM_ERROR */
     size_t         st_pending;    /* bytes pending in task */
     size_t         st_total;      /* total bytes in task */
+    norns_flags_t  st_copy_engines; /* NORNS_COPY_* mechanisms used so far */
 } norns_stat_t;
 
 /* Descriptor for an I/O task */
@@ -148,6 +167,12 @@ typedef struct {
     norns_op_t          t_op;   /* operation to be performed */
     norns_resource_t    t_src;  /* source resource */
     norns_resource_t    t_dst;  /* destination resource */
+    norns_priority_t    t_priority; /* scheduling priority */
+    struct timespec     t_deadline; /* absolute deadline (CLOCK_REALTIME), 
+                                       or {0, 0} if the task has none */
+    const norns_tid_t*  t_parents;  /* tasks that must complete successfully 
+                                       before this one can start, or NULL */
+    size_t              t_nparents; /* number of entries in t_parents */
 
     /* Internal members */
     norns_stat_t        __t_status; /* cached task status */
@@ -167,6 +192,10 @@ typedef enum {
     NORNSCTL_CMD_PAUSE_LISTEN,
     NORNSCTL_CMD_RESUME_LISTEN,
     NORNSCTL_CMD_SHUTDOWN,
+    NORNSCTL_CMD_DUMP_TRACE,    /* args: (const char*) path of the file 
+                                   where the service writes its recent 
+                                   task lifecycle events, in the Chrome 
+                                   trace format */
 } nornsctl_command_t;
 
 #ifdef __cplusplus
@@ -85,6 +85,9 @@ typedef struct {
     size_t                 j_nlimits;  /* entries in limits list */
 } nornsctl_job_t;
 
+/* Maximum number of task ids reported in nornsctl_stat_t.st_at_risk */
+#define NORNSCTL_MAX_AT_RISK_TASKS 32
+
 /* Global task status descriptor */
 typedef struct {
     /* Number of running tasks */
@@ -99,8 +102,112 @@ typedef struct {
      * This value is computed as the max of alls ETAs for all currently 
      * running tasks */
     double st_eta;
+
+    /* Number of pending or running tasks whose deadline is not expected
+     * to be met given the current bandwidth estimations */
+    size_t st_deadlines_at_risk;
+
+    /* Identifiers of (at most NORNSCTL_MAX_AT_RISK_TASKS of) those tasks, 
+     * in scheduling order */
+    norns_tid_t st_at_risk[NORNSCTL_MAX_AT_RISK_TASKS];
 } nornsctl_stat_t;
 
+/* Estimated cost of a transfer between two namespaces, based on the 
+ * transfers completed between them so far. Values that can't be estimated 
+ * yet are set to NAN */
+typedef struct {
+    /* Expected bandwidth (in MiB/s) for files of the requested size */
+    double e_bandwidth;
+
+    /* Expected fixed cost (in seconds) of transferring each file */
+    double e_overhead;
+
+    /* Expected duration (in seconds) of the transfer, once started */
+    double e_duration;
+
+    /* Expected time (in seconds) until the tasks already pending or 
+     * running between both namespaces complete */
+    double e_backlog;
+
+    /* Number of completed transfers of similar size that the estimation 
+     * is based on (if 0, transfers of other sizes were used) */
+    uint32_t e_samples;
+} nornsctl_estimate_t;
+
+/* What the latencies in a nornsctl_latency_t refer to */
+typedef enum {
+    NORNSCTL_LATENCY_TASK_TYPE = 0, /* tasks of a type (e.g. "DATA_COPY") */
+    NORNSCTL_LATENCY_NS_PAIR,       /* tasks between two namespaces 
+                                       ("src_nsid => dst_nsid") */
+    NORNSCTL_LATENCY_REQUEST        /* API requests of a type 
+                                       (e.g. "IOTASK_SUBMIT") */
+} nornsctl_latency_scope_t;
+
+/* Phases whose latency is tracked */
+typedef enum {
+    NORNSCTL_PHASE_QUEUED = 0,  /* from submission until a worker picks the 
+                                   task (including waiting for its parents) */
+    NORNSCTL_PHASE_RESOLVE,     /* resolution of the task's resources */
+    NORNSCTL_PHASE_SETUP,       /* preparation of the transfer (e.g. 
+                                   packing an archive for a remote peer) */
+    NORNSCTL_PHASE_TRANSFER,    /* data transfer until completion */
+    NORNSCTL_PHASE_TOTAL,       /* from submission until completion */
+    NORNSCTL_PHASE_HANDLER      /* handling of an API request by the 
+                                   service (NORNSCTL_LATENCY_REQUEST only) */
+} nornsctl_latency_phase_t;
+
+/* Maximum length of nornsctl_latency_t.l_name (including the final '\0') */
+#define NORNSCTL_MAX_LATENCY_NAME 128
+
+/* Distribution of the latencies observed for a phase. All values are in 
+ * seconds, and percentiles have a relative error below 1/16 */
+typedef struct {
+    nornsctl_latency_scope_t l_scope;
+    nornsctl_latency_phase_t l_phase;
+    char     l_name[NORNSCTL_MAX_LATENCY_NAME];
+    uint64_t l_count;   /* number of samples */
+    double   l_mean;
+    double   l_p50;
+    double   l_p90;
+    double   l_p99;
+    double   l_max;
+} nornsctl_latency_t;
+
+/* Maximum length of nornsctl_lock_stat_t.lk_name (including the final '\0') */
+#define NORNSCTL_MAX_LOCK_NAME 64
+
+/* Contention observed on a class of locks of the service (e.g. "urd.jobs"
+ * or "task_info", which accounts for the locks of all tasks). Times are 
+ * in seconds */
+typedef struct {
+    char     lk_name[NORNSCTL_MAX_LOCK_NAME];
+    uint64_t lk_acquisitions;        /* exclusive acquisitions */
+    uint64_t lk_shared_acquisitions; /* shared acquisitions */
+    uint64_t lk_contended;           /* acquisitions that had to wait */
+    double   lk_wait;                /* total time spent waiting */
+    double   lk_max_wait;
+    double   lk_hold;                /* total time held exclusively */
+    double   lk_max_hold;
+} nornsctl_lock_stat_t;
+
+/* Why a running task has been flagged by the service's watchdog */
+typedef enum {
+    NORNSCTL_TASK_SLOW = 0, /* progressing below the expected rate */
+    NORNSCTL_TASK_STALLED   /* no progress for 'stall_timeout' seconds */
+} nornsctl_slow_reason_t;
+
+/* A running task flagged by the watchdog. Rates are in MiB/s */
+typedef struct {
+    norns_tid_t sl_tid;
+    nornsctl_slow_reason_t sl_reason;
+    size_t   sl_sent_bytes;
+    size_t   sl_total_bytes;
+    double   sl_rate;          /* observed since the transfer started */
+    double   sl_expected_rate; /* expected from previous transfers between 
+                                  the same namespaces (NaN if unknown) */
+    double   sl_idle;          /* seconds since the task last made progress */
+} nornsctl_slow_task_t;
+
 nornsctl_backend_t 
 NORNSCTL_BACKEND(nornsctl_backend_flags_t flags, 
                  bool track,
@@ -136,7 +243,8 @@ nornsctl_job_init(nornsctl_job_t* job,
                   nornsctl_job_limit_t** limits, 
                   size_t nlimits) __THROW;
 
-/* Send a command to the service daemon */
+/* Send a command to the service daemon. 'args' must be NULL unless 
+ * otherwise stated in the description of the command */
 norns_error_t
 nornsctl_send_command(nornsctl_command_t command, 
                       void* args) __THROW;
@@ -144,6 +252,38 @@ nornsctl_send_command(nornsctl_command_t command,
 norns_error_t
 nornsctl_status(nornsctl_stat_t* stats) __THROW;
 
+/* Estimate the cost of transferring 'size' bytes distributed over 'nfiles' 
+ * files from namespace 'src_nsid' to namespace 'dst_nsid' */
+norns_error_t
+nornsctl_estimate_transfer(const char* src_nsid, 
+                           const char* dst_nsid, 
+                           size_t size, 
+                           size_t nfiles,
+                           nornsctl_estimate_t* estimate) __THROW;
+
+/* Retrieve the latency distributions of task phases (per task type and 
+ * namespace pair) and API requests observed by the service. On input, 
+ * '*nentries' is the number of entries available in 'entries'; on output, 
+ * it is set to the number of distributions available, which may be larger
+ * (only the first '*nentries' are filled in) */
+norns_error_t
+nornsctl_latency_stats(nornsctl_latency_t* entries, 
+                       size_t* nentries) __THROW;
+
+/* Retrieve the contention statistics of the locks of the service (only 
+ * available if it runs with 'lock_profiling' enabled). '*nentries' works 
+ * as in nornsctl_latency_stats() */
+norns_error_t
+nornsctl_lock_stats(nornsctl_lock_stat_t* entries, 
+                    size_t* nentries) __THROW;
+
+/* Retrieve the running tasks that the service's watchdog found to be slow 
+ * or stalled in its last check (only available if it runs with a non-zero 
+ * 'watchdog_interval'). '*nentries' works as in nornsctl_latency_stats() */
+norns_error_t
+nornsctl_slow_tasks(nornsctl_slow_task_t* entries, 
+                    size_t* nentries) __THROW;
+
 /* Register a batch job into the system */
 norns_error_t 
 nornsctl_register_job(uint32_t jobid, 
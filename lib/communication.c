@@ -43,6 +43,7 @@
 #include <unistd.h>
 #include <errno.h>
 #include <stdarg.h>
+#include <string.h>
 
 #include "norns.h"
 #include "nornsctl.h"
@@ -134,6 +135,31 @@ send_status_request(norns_iotask_t* task, norns_stat_t* stats) {
     stats->st_status = resp.r_status;
     stats->st_task_error = resp.r_task_error;
     stats->st_sys_errno = resp.r_errno;
+    stats->st_pending = resp.r_pending_bytes;
+    stats->st_total = resp.r_total_bytes;
+    stats->st_copy_engines = resp.r_copy_engines;
+
+    return resp.r_error_code;
+}
+
+norns_error_t
+send_cancel_request(norns_iotask_t* task) {
+
+    int res;
+    norns_response_t resp;
+
+    if(task->t_id == 0) {
+        return NORNS_EBADARGS;
+    }
+
+    if((res = send_request(NORNS_IOTASK_CANCEL, &resp, task)) 
+            != NORNS_SUCCESS) {
+        return res;
+    }
+
+    if(resp.r_type != NORNS_IOTASK_CANCEL) {
+        return NORNS_ESNAFU;
+    }
 
     return resp.r_error_code;
 }
@@ -156,6 +182,122 @@ send_control_status_request(nornsctl_stat_t* stats) {
     stats->st_running_tasks = resp.r_running_tasks;
     stats->st_pending_tasks = resp.r_pending_tasks;
     stats->st_eta = resp.r_eta;
+    stats->st_deadlines_at_risk = resp.r_deadlines_at_risk;
+
+    memset(stats->st_at_risk, 0, sizeof(stats->st_at_risk));
+
+    for(size_t i = 0; i < resp.r_nat_risk; ++i) {
+        stats->st_at_risk[i] = resp.r_at_risk[i];
+    }
+
+    return resp.r_error_code;
+}
+
+norns_error_t
+send_transfer_estimate_request(const char* src_nsid, const char* dst_nsid,
+                               size_t size, size_t nfiles,
+                               nornsctl_estimate_t* estimate) {
+
+    int res;
+    norns_response_t resp;
+
+    if((res = send_request(NORNSCTL_TRANSFER_ESTIMATE, &resp, 
+                           src_nsid, dst_nsid, size, nfiles)) 
+            != NORNS_SUCCESS) {
+        return res;
+    }
+
+    if(resp.r_type != NORNSCTL_TRANSFER_ESTIMATE) {
+        return NORNS_ESNAFU;
+    }
+
+    estimate->e_bandwidth = resp.r_bandwidth;
+    estimate->e_overhead = resp.r_overhead;
+    estimate->e_duration = resp.r_duration;
+    estimate->e_backlog = resp.r_backlog;
+    estimate->e_samples = resp.r_samples;
+
+    return resp.r_error_code;
+}
+
+norns_error_t
+send_latency_stats_request(nornsctl_latency_t* entries, size_t* nentries) {
+
+    int res;
+    norns_response_t resp;
+
+    if((res = send_request(NORNSCTL_LATENCY_STATS, &resp)) 
+            != NORNS_SUCCESS) {
+        return res;
+    }
+
+    if(resp.r_type != NORNSCTL_LATENCY_STATS) {
+        return NORNS_ESNAFU;
+    }
+
+    for(size_t i = 0; i < resp.r_nlatencies && i < *nentries; ++i) {
+        entries[i] = resp.r_latencies[i];
+    }
+
+    *nentries = resp.r_nlatencies;
+
+    if(resp.r_latencies != NULL) {
+        xfree(resp.r_latencies);
+    }
+
+    return resp.r_error_code;
+}
+
+norns_error_t
+send_lock_stats_request(nornsctl_lock_stat_t* entries, size_t* nentries) {
+
+    int res;
+    norns_response_t resp;
+
+    if((res = send_request(NORNSCTL_LOCK_STATS, &resp)) != NORNS_SUCCESS) {
+        return res;
+    }
+
+    if(resp.r_type != NORNSCTL_LOCK_STATS) {
+        return NORNS_ESNAFU;
+    }
+
+    for(size_t i = 0; i < resp.r_nlocks && i < *nentries; ++i) {
+        entries[i] = resp.r_locks[i];
+    }
+
+    *nentries = resp.r_nlocks;
+
+    if(resp.r_locks != NULL) {
+        xfree(resp.r_locks);
+    }
+
+    return resp.r_error_code;
+}
+
+norns_error_t
+send_slow_tasks_request(nornsctl_slow_task_t* entries, size_t* nentries) {
+
+    int res;
+    norns_response_t resp;
+
+    if((res = send_request(NORNSCTL_SLOW_TASKS, &resp)) != NORNS_SUCCESS) {
+        return res;
+    }
+
+    if(resp.r_type != NORNSCTL_SLOW_TASKS) {
+        return NORNS_ESNAFU;
+    }
+
+    for(size_t i = 0; i < resp.r_nslow_tasks && i < *nentries; ++i) {
+        entries[i] = resp.r_slow_tasks[i];
+    }
+
+    *nentries = resp.r_nslow_tasks;
+
+    if(resp.r_slow_tasks != NULL) {
+        xfree(resp.r_slow_tasks);
+    }
 
     return resp.r_error_code;
 }
@@ -247,6 +389,7 @@ send_request(norns_msgtype_t type, norns_response_t* resp, ...) {
     switch(type) {
         case NORNS_IOTASK_SUBMIT:
         case NORNS_IOTASK_STATUS:
+        case NORNS_IOTASK_CANCEL:
         {
             const norns_iotask_t* task =
                 va_arg(ap, const norns_iotask_t*);
@@ -272,6 +415,9 @@ send_request(norns_msgtype_t type, norns_response_t* resp, ...) {
         }
 
         case NORNSCTL_GLOBAL_STATUS:
+        case NORNSCTL_LATENCY_STATS:
+        case NORNSCTL_LOCK_STATS:
+        case NORNSCTL_SLOW_TASKS:
         case NORNS_PING:
         {
             if((res = pack_to_buffer(type, &req_buf)) != NORNS_SUCCESS) {
@@ -281,6 +427,21 @@ send_request(norns_msgtype_t type, norns_response_t* resp, ...) {
             break;
         }
 
+        case NORNSCTL_TRANSFER_ESTIMATE:
+        {
+            const char* const src_nsid = va_arg(ap, const char* const);
+            const char* const dst_nsid = va_arg(ap, const char* const);
+            const size_t size = va_arg(ap, size_t);
+            const size_t nfiles = va_arg(ap, size_t);
+
+            if((res = pack_to_buffer(type, &req_buf, src_nsid, dst_nsid, 
+                                     size, nfiles)) != NORNS_SUCCESS) {
+                return res;
+            }
+
+            break;
+        }
+
         case NORNS_JOB_REGISTER:
         case NORNS_JOB_UPDATE:
         case NORNS_JOB_UNREGISTER:
@@ -45,6 +45,7 @@
 norns_error_t send_submit_request(norns_iotask_t* task);
 norns_error_t send_control_command_request(nornsctl_command_t cmd, void* args);
 norns_error_t send_status_request(norns_iotask_t* task, norns_stat_t* stats);
+norns_error_t send_cancel_request(norns_iotask_t* task);
 norns_error_t send_job_request(norns_msgtype_t type, uint32_t jobid, 
                                nornsctl_job_t* job);
 norns_error_t send_process_request(norns_msgtype_t type, uint32_t jobid, 
@@ -52,6 +53,16 @@ norns_error_t send_process_request(norns_msgtype_t type, uint32_t jobid,
 norns_error_t send_namespace_request(norns_msgtype_t type, const char* nsid, 
                                      nornsctl_backend_t* backend);
 norns_error_t send_control_status_request(nornsctl_stat_t* stats);
+norns_error_t send_transfer_estimate_request(const char* src_nsid, 
+                                             const char* dst_nsid,
+                                             size_t size, size_t nfiles,
+                                             nornsctl_estimate_t* estimate);
+norns_error_t send_latency_stats_request(nornsctl_latency_t* entries, 
+                                         size_t* nentries);
+norns_error_t send_lock_stats_request(nornsctl_lock_stat_t* entries, 
+                                      size_t* nentries);
+norns_error_t send_slow_tasks_request(nornsctl_slow_task_t* entries, 
+                                      size_t* nentries);
 
 #pragma GCC visibility pop
 
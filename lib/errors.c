@@ -71,6 +71,10 @@ const char* const norns_errlist[NORNS_ERRMAX + 1] = {
     [ERR_REMAP(NORNS_ENOSUCHTASK)] = "Task does not exist",
     [ERR_REMAP(NORNS_ETOOMANYTASKS)] = "Too many pending tasks",
     [ERR_REMAP(NORNS_ETASKSPENDING)] = "There are still pending tasks",
+    [ERR_REMAP(NORNS_ETASKCANCELLED)] = "Task was cancelled",
+    [ERR_REMAP(NORNS_EDEPFAILED)] = "A task dependency did not complete successfully",
+    [ERR_REMAP(NORNS_ETASKFINISHED)] = "Task has already finished",
+    [ERR_REMAP(NORNS_ENOTTASKOWNER)] = "Task belongs to another user",
 
     /* resource errors */
     [ERR_REMAP(NORNS_ERESOURCEEXISTS)] = "Resource already exists",
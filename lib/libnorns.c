@@ -215,9 +215,29 @@ norns_submit(norns_iotask_t* task) {
         return NORNS_EBADARGS;
     }
 
+    if(task->t_priority > NORNS_PRIORITY_URGENT ||
+       task->t_deadline.tv_sec < 0 ||
+       task->t_deadline.tv_nsec < 0 || task->t_deadline.tv_nsec >= 1000000000L) {
+        return NORNS_EBADARGS;
+    }
+
+    if(task->t_nparents != 0 && task->t_parents == NULL) {
+        return NORNS_EBADARGS;
+    }
+
     return send_submit_request(task);
 }
 
+norns_error_t
+norns_cancel(norns_iotask_t* task) {
+
+    if(task == NULL) {
+        return NORNS_EBADARGS;
+    }
+
+    return send_cancel_request(task);
+}
+
 norns_error_t
 norns_error(norns_iotask_t* task, norns_stat_t* stats) {
 
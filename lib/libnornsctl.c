@@ -168,8 +168,8 @@ norns_error_t
 nornsctl_send_command(nornsctl_command_t command, 
                       void* args) {
 
-    // we don't have any commands right now that support arguments
-    if(args != NULL) {
+    // only NORNSCTL_CMD_DUMP_TRACE requires arguments (a path)
+    if((command == NORNSCTL_CMD_DUMP_TRACE) != (args != NULL)) {
         ERR("invalid arguments");
         return NORNS_EBADARGS;
     }
@@ -188,6 +188,54 @@ nornsctl_status(nornsctl_stat_t* stats) {
     return send_control_status_request(stats);
 }
 
+norns_error_t
+nornsctl_estimate_transfer(const char* src_nsid, const char* dst_nsid, 
+                           size_t size, size_t nfiles,
+                           nornsctl_estimate_t* estimate) {
+
+    if(src_nsid == NULL || dst_nsid == NULL || nfiles == 0 || 
+       estimate == NULL) {
+        ERR("invalid arguments");
+        return NORNS_EBADARGS;
+    }
+
+    return send_transfer_estimate_request(src_nsid, dst_nsid, size, 
+                                          nfiles, estimate);
+}
+
+norns_error_t
+nornsctl_latency_stats(nornsctl_latency_t* entries, size_t* nentries) {
+
+    if(nentries == NULL || (entries == NULL && *nentries != 0)) {
+        ERR("invalid arguments");
+        return NORNS_EBADARGS;
+    }
+
+    return send_latency_stats_request(entries, nentries);
+}
+
+norns_error_t
+nornsctl_lock_stats(nornsctl_lock_stat_t* entries, size_t* nentries) {
+
+    if(nentries == NULL || (entries == NULL && *nentries != 0)) {
+        ERR("invalid arguments");
+        return NORNS_EBADARGS;
+    }
+
+    return send_lock_stats_request(entries, nentries);
+}
+
+norns_error_t
+nornsctl_slow_tasks(nornsctl_slow_task_t* entries, size_t* nentries) {
+
+    if(nentries == NULL || (entries == NULL && *nentries != 0)) {
+        ERR("invalid arguments");
+        return NORNS_EBADARGS;
+    }
+
+    return send_slow_tasks_request(entries, nentries);
+}
+
 /* Register and describe a batch job */
 norns_error_t 
 nornsctl_register_job(uint32_t jobid, nornsctl_job_t* job) {
@@ -401,9 +449,29 @@ nornsctl_submit(norns_iotask_t* task) {
         return NORNS_EBADARGS;
     }
 
+    if(task->t_priority > NORNS_PRIORITY_URGENT ||
+       task->t_deadline.tv_sec < 0 ||
+       task->t_deadline.tv_nsec < 0 || task->t_deadline.tv_nsec >= 1000000000L) {
+        return NORNS_EBADARGS;
+    }
+
+    if(task->t_nparents != 0 && task->t_parents == NULL) {
+        return NORNS_EBADARGS;
+    }
+
     return send_submit_request(task);
 }
 
+norns_error_t
+nornsctl_cancel(norns_iotask_t* task) {
+
+    if(task == NULL) {
+        return NORNS_EBADARGS;
+    }
+
+    return send_cancel_request(task);
+}
+
 norns_error_t
 nornsctl_error(norns_iotask_t* task, 
                norns_stat_t* stats) {
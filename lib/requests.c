@@ -36,6 +36,7 @@
  *************************************************************************/
 
 #include <stdarg.h>
+#include <string.h>
 
 #include "norns.h"
 #include "nornsctl.h"
@@ -89,6 +90,9 @@ free_path_msg(Norns__Rpc__Request__Task__PosixPath* msg);
 
 static Norns__Rpc__Request__Command* 
 build_command_msg(const nornsctl_command_t cmd, const void* args);
+static Norns__Rpc__Request__Estimate* 
+build_estimate_msg(const char* src_nsid, const char* dst_nsid, 
+                   size_t size, size_t nfiles);
 static void
 free_command_msg(Norns__Rpc__Request__Command* msg) __attribute__((unused));
 
@@ -104,6 +108,8 @@ encode_request_type(norns_msgtype_t type) {
             return NORNS__RPC__REQUEST__TYPE__IOTASK_SUBMIT;
         case NORNS_IOTASK_STATUS:
             return NORNS__RPC__REQUEST__TYPE__IOTASK_STATUS;
+        case NORNS_IOTASK_CANCEL:
+            return NORNS__RPC__REQUEST__TYPE__IOTASK_CANCEL;
         case NORNS_PING:
             return NORNS__RPC__REQUEST__TYPE__PING;
         case NORNS_JOB_REGISTER:
@@ -124,6 +130,14 @@ encode_request_type(norns_msgtype_t type) {
             return NORNS__RPC__REQUEST__TYPE__NAMESPACE_UNREGISTER;
         case NORNSCTL_GLOBAL_STATUS:
             return NORNS__RPC__REQUEST__TYPE__GLOBAL_STATUS;
+        case NORNSCTL_TRANSFER_ESTIMATE:
+            return NORNS__RPC__REQUEST__TYPE__TRANSFER_ESTIMATE;
+        case NORNSCTL_LATENCY_STATS:
+            return NORNS__RPC__REQUEST__TYPE__LATENCY_STATS;
+        case NORNSCTL_LOCK_STATS:
+            return NORNS__RPC__REQUEST__TYPE__LOCK_STATS;
+        case NORNSCTL_SLOW_TASKS:
+            return NORNS__RPC__REQUEST__TYPE__SLOW_TASKS;
         case NORNSCTL_COMMAND:
             return NORNS__RPC__REQUEST__TYPE__CTL_COMMAND;
         default:
@@ -138,6 +152,8 @@ decode_response_type(int norns_rpc_type) {
             return NORNS_IOTASK_SUBMIT;
         case NORNS__RPC__RESPONSE__TYPE__IOTASK_STATUS:
             return NORNS_IOTASK_STATUS;
+        case NORNS__RPC__RESPONSE__TYPE__IOTASK_CANCEL:
+            return NORNS_IOTASK_CANCEL;
         case NORNS__RPC__RESPONSE__TYPE__PING:
             return NORNS_PING;
         case NORNS__RPC__RESPONSE__TYPE__JOB_REGISTER:
@@ -158,6 +174,14 @@ decode_response_type(int norns_rpc_type) {
             return NORNS_NAMESPACE_UNREGISTER;
         case NORNS__RPC__RESPONSE__TYPE__GLOBAL_STATUS:
             return NORNSCTL_GLOBAL_STATUS;
+        case NORNS__RPC__RESPONSE__TYPE__TRANSFER_ESTIMATE:
+            return NORNSCTL_TRANSFER_ESTIMATE;
+        case NORNS__RPC__RESPONSE__TYPE__LATENCY_STATS:
+            return NORNSCTL_LATENCY_STATS;
+        case NORNS__RPC__RESPONSE__TYPE__LOCK_STATS:
+            return NORNSCTL_LOCK_STATS;
+        case NORNS__RPC__RESPONSE__TYPE__SLOW_TASKS:
+            return NORNSCTL_SLOW_TASKS;
         case NORNS__RPC__REQUEST__TYPE__CTL_COMMAND:
             return NORNSCTL_COMMAND;
         case NORNS__RPC__RESPONSE__TYPE__BAD_REQUEST:
@@ -199,6 +223,7 @@ build_request_msg(norns_msgtype_t type, va_list ap) {
 
         case NORNS_IOTASK_SUBMIT:
         case NORNS_IOTASK_STATUS:
+        case NORNS_IOTASK_CANCEL:
         {
             const norns_iotask_t* task = va_arg(ap, norns_iotask_t*);
 
@@ -210,11 +235,30 @@ build_request_msg(norns_msgtype_t type, va_list ap) {
         }
 
         case NORNSCTL_GLOBAL_STATUS:
+        case NORNSCTL_LATENCY_STATS:
+        case NORNSCTL_LOCK_STATS:
+        case NORNSCTL_SLOW_TASKS:
         case NORNS_PING:
         {
             break;
         }
 
+        case NORNSCTL_TRANSFER_ESTIMATE:
+        {
+            const char* const src_nsid = va_arg(ap, const char* const);
+            const char* const dst_nsid = va_arg(ap, const char* const);
+            const size_t size = va_arg(ap, size_t);
+            const size_t nfiles = va_arg(ap, size_t);
+
+            if((req_msg->estimate = 
+                    build_estimate_msg(src_nsid, dst_nsid, 
+                                       size, nfiles)) == NULL) {
+                goto cleanup_on_error;
+            }
+
+            break;
+        }
+
         case NORNS_JOB_REGISTER:
         case NORNS_JOB_UPDATE:
         case NORNS_JOB_UNREGISTER:
@@ -384,6 +428,50 @@ free_namespace_message(Norns__Rpc__Request__Namespace* msg) {
     (void) msg;
 }
 
+static Norns__Rpc__Request__Estimate* 
+build_estimate_msg(const char* src_nsid, const char* dst_nsid, 
+                   size_t size, size_t nfiles) {
+
+    assert(src_nsid != NULL);
+    assert(dst_nsid != NULL);
+
+    Norns__Rpc__Request__Estimate* estmsg =
+        (Norns__Rpc__Request__Estimate*) xmalloc(sizeof(*estmsg));
+
+    if(estmsg == NULL) {
+        ERR("!xmalloc");
+        return NULL;
+    }
+
+    norns__rpc__request__estimate__init(estmsg);
+
+    estmsg->src_nsid = xstrdup(src_nsid);
+    estmsg->dst_nsid = xstrdup(dst_nsid);
+
+    if(estmsg->src_nsid == NULL || estmsg->dst_nsid == NULL) {
+        ERR("!xstrdup");
+        goto error_cleanup;
+    }
+
+    estmsg->size = size;
+    estmsg->nfiles = nfiles;
+
+    return estmsg;
+
+error_cleanup:
+    if(estmsg->src_nsid != NULL) {
+        xfree(estmsg->src_nsid);
+    }
+
+    if(estmsg->dst_nsid != NULL) {
+        xfree(estmsg->dst_nsid);
+    }
+
+    xfree(estmsg);
+
+    return NULL;
+}
+
 static Norns__Rpc__Request__Namespace__Backend*
 build_backend_message(const nornsctl_backend_t* backend) {
 
@@ -685,6 +773,33 @@ build_task_msg(const norns_iotask_t* task) {
     taskmsg->taskid = task->t_id;
     taskmsg->optype = task->t_op;
 
+    if(task->t_priority != NORNS_PRIORITY_DEFAULT) {
+        taskmsg->has_priority = true;
+        taskmsg->priority = task->t_priority;
+    }
+
+    if(task->t_deadline.tv_sec != 0 || task->t_deadline.tv_nsec != 0) {
+        taskmsg->has_deadline = true;
+        taskmsg->deadline = 
+            (uint64_t) task->t_deadline.tv_sec * 1000000 + 
+            (uint64_t) task->t_deadline.tv_nsec / 1000;
+    }
+
+    if(task->t_nparents != 0) {
+        taskmsg->parents = 
+            (uint32_t*) xmalloc(task->t_nparents * sizeof(uint32_t));
+
+        if(taskmsg->parents == NULL) {
+            goto cleanup_on_error;
+        }
+
+        taskmsg->n_parents = task->t_nparents;
+
+        for(size_t i = 0; i < task->t_nparents; ++i) {
+            taskmsg->parents[i] = task->t_parents[i];
+        }
+    }
+
     // construct source
     taskmsg->source = build_resource_msg(&task->t_src);
 
@@ -714,6 +829,10 @@ free_task_msg(Norns__Rpc__Request__Task* msg) {
 
     assert(msg != NULL);
 
+    if(msg->parents != NULL) {
+        xfree(msg->parents);
+    }
+
     if(msg->source != NULL) {
         if(msg->source->buffer != NULL) {
             xfree(msg->source->buffer);
@@ -744,8 +863,6 @@ free_task_msg(Norns__Rpc__Request__Task* msg) {
 Norns__Rpc__Request__Command* 
 build_command_msg(const nornsctl_command_t cmd, const void* args) {
 
-    (void) args;
-
     Norns__Rpc__Request__Command* msg = xmalloc(sizeof(*msg)); 
 
     if(msg == NULL) {
@@ -755,6 +872,16 @@ build_command_msg(const nornsctl_command_t cmd, const void* args) {
     norns__rpc__request__command__init(msg);
     msg->id = cmd;
 
+    if(cmd == NORNSCTL_CMD_DUMP_TRACE) {
+        assert(args != NULL);
+
+        if((msg->path = xstrdup((const char*) args)) == NULL) {
+            ERR("!xstrdup");
+            xfree(msg);
+            return NULL;
+        }
+    }
+
     return msg;
 }
 
@@ -838,6 +965,15 @@ unpack_from_buffer(norns_msgbuffer_t* buf, norns_response_t* response) {
             response->r_status = rpc_resp->stats->status;
             response->r_task_error = rpc_resp->stats->task_error;
             response->r_errno = rpc_resp->stats->sys_errnum;
+            response->r_pending_bytes = 
+                rpc_resp->stats->has_pending_bytes ? 
+                    rpc_resp->stats->pending_bytes : 0;
+            response->r_total_bytes = 
+                rpc_resp->stats->has_total_bytes ? 
+                    rpc_resp->stats->total_bytes : 0;
+            response->r_copy_engines = 
+                rpc_resp->stats->has_copy_engines ? 
+                    rpc_resp->stats->copy_engines : 0;
             break;
 
         case NORNSCTL_GLOBAL_STATUS:
@@ -847,6 +983,125 @@ unpack_from_buffer(norns_msgbuffer_t* buf, norns_response_t* response) {
             response->r_running_tasks = rpc_resp->gstats->running_tasks;
             response->r_pending_tasks = rpc_resp->gstats->pending_tasks;
             response->r_eta = rpc_resp->gstats->eta;
+            response->r_deadlines_at_risk = 
+                rpc_resp->gstats->has_deadlines_at_risk ?
+                    rpc_resp->gstats->deadlines_at_risk : 0;
+            response->r_nat_risk = 0;
+
+            for(size_t i = 0; i < rpc_resp->gstats->n_at_risk_tasks && 
+                              i < NORNSCTL_MAX_AT_RISK_TASKS; ++i) {
+                response->r_at_risk[i] = rpc_resp->gstats->at_risk_tasks[i];
+                ++response->r_nat_risk;
+            }
+            break;
+
+        case NORNSCTL_TRANSFER_ESTIMATE:
+            if(rpc_resp->estimate == NULL) {
+                return NORNS_ERPCRECVFAILED;
+            }
+            response->r_bandwidth = rpc_resp->estimate->bandwidth;
+            response->r_overhead = rpc_resp->estimate->overhead;
+            response->r_duration = rpc_resp->estimate->duration;
+            response->r_backlog = rpc_resp->estimate->backlog;
+            response->r_samples = rpc_resp->estimate->samples;
+            break;
+
+        case NORNSCTL_LATENCY_STATS:
+            response->r_latencies = NULL;
+            response->r_nlatencies = rpc_resp->n_latencies;
+
+            if(response->r_nlatencies == 0) {
+                break;
+            }
+
+            response->r_latencies = (nornsctl_latency_t*) 
+                xmalloc(response->r_nlatencies * sizeof(nornsctl_latency_t));
+
+            if(response->r_latencies == NULL) {
+                ERR("!xmalloc");
+                return NORNS_ENOMEM;
+            }
+
+            for(size_t i = 0; i < rpc_resp->n_latencies; ++i) {
+                const Norns__Rpc__Response__Latency* lat = 
+                    rpc_resp->latencies[i];
+                nornsctl_latency_t* entry = &response->r_latencies[i];
+
+                entry->l_scope = (nornsctl_latency_scope_t) lat->scope;
+                entry->l_phase = (nornsctl_latency_phase_t) lat->phase;
+                strncpy(entry->l_name, lat->name, sizeof(entry->l_name) - 1);
+                entry->l_name[sizeof(entry->l_name) - 1] = '\0';
+                entry->l_count = lat->count;
+                entry->l_mean = lat->mean;
+                entry->l_p50 = lat->p50;
+                entry->l_p90 = lat->p90;
+                entry->l_p99 = lat->p99;
+                entry->l_max = lat->max;
+            }
+            break;
+
+        case NORNSCTL_LOCK_STATS:
+            response->r_locks = NULL;
+            response->r_nlocks = rpc_resp->n_locks;
+
+            if(response->r_nlocks == 0) {
+                break;
+            }
+
+            response->r_locks = (nornsctl_lock_stat_t*) 
+                xmalloc(response->r_nlocks * sizeof(nornsctl_lock_stat_t));
+
+            if(response->r_locks == NULL) {
+                ERR("!xmalloc");
+                return NORNS_ENOMEM;
+            }
+
+            for(size_t i = 0; i < rpc_resp->n_locks; ++i) {
+                const Norns__Rpc__Response__LockStat* lk = rpc_resp->locks[i];
+                nornsctl_lock_stat_t* entry = &response->r_locks[i];
+
+                strncpy(entry->lk_name, lk->name, sizeof(entry->lk_name) - 1);
+                entry->lk_name[sizeof(entry->lk_name) - 1] = '\0';
+                entry->lk_acquisitions = lk->acquisitions;
+                entry->lk_shared_acquisitions = lk->shared_acquisitions;
+                entry->lk_contended = lk->contended;
+                entry->lk_wait = lk->wait;
+                entry->lk_max_wait = lk->max_wait;
+                entry->lk_hold = lk->hold;
+                entry->lk_max_hold = lk->max_hold;
+            }
+            break;
+
+        case NORNSCTL_SLOW_TASKS:
+            response->r_slow_tasks = NULL;
+            response->r_nslow_tasks = rpc_resp->n_slow_tasks;
+
+            if(response->r_nslow_tasks == 0) {
+                break;
+            }
+
+            response->r_slow_tasks = (nornsctl_slow_task_t*) 
+                xmalloc(response->r_nslow_tasks * 
+                        sizeof(nornsctl_slow_task_t));
+
+            if(response->r_slow_tasks == NULL) {
+                ERR("!xmalloc");
+                return NORNS_ENOMEM;
+            }
+
+            for(size_t i = 0; i < rpc_resp->n_slow_tasks; ++i) {
+                const Norns__Rpc__Response__SlowTask* st = 
+                    rpc_resp->slow_tasks[i];
+                nornsctl_slow_task_t* entry = &response->r_slow_tasks[i];
+
+                entry->sl_tid = st->taskid;
+                entry->sl_reason = (nornsctl_slow_reason_t) st->reason;
+                entry->sl_sent_bytes = st->sent_bytes;
+                entry->sl_total_bytes = st->total_bytes;
+                entry->sl_rate = st->rate;
+                entry->sl_expected_rate = st->expected_rate;
+                entry->sl_idle = st->idle;
+            }
             break;
 
         default:
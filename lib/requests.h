@@ -42,13 +42,19 @@
 
 #include "messages.pb-c.h"
 #include "norns.h"
+#include "nornsctl.h"
 
 typedef enum {
     /* iotasks */
     NORNS_IOTASK_SUBMIT,
     NORNS_IOTASK_STATUS,
+    NORNS_IOTASK_CANCEL,
 
     NORNSCTL_GLOBAL_STATUS,
+    NORNSCTL_TRANSFER_ESTIMATE,
+    NORNSCTL_LATENCY_STATS,
+    NORNSCTL_LOCK_STATS,
+    NORNSCTL_SLOW_TASKS,
 
     /* control commands */
     NORNSCTL_COMMAND,
@@ -89,11 +95,42 @@ typedef struct {
             norns_status_t r_status;
             norns_error_t r_task_error;
             int r_errno;
+            size_t r_pending_bytes;
+            size_t r_total_bytes;
+            uint32_t r_copy_engines;
         };
         struct {
             uint32_t r_running_tasks;
             uint32_t r_pending_tasks;
             double r_eta;
+            uint32_t r_deadlines_at_risk;
+            size_t r_nat_risk;
+            norns_tid_t r_at_risk[NORNSCTL_MAX_AT_RISK_TASKS];
+        };
+        struct {
+            double r_bandwidth;
+            double r_overhead;
+            double r_duration;
+            double r_backlog;
+            uint32_t r_samples;
+        };
+        struct {
+            /* allocated by unpack_from_buffer(), must be freed by the
+             * caller with xfree() */
+            nornsctl_latency_t* r_latencies;
+            size_t r_nlatencies;
+        };
+        struct {
+            /* allocated by unpack_from_buffer(), must be freed by the
+             * caller with xfree() */
+            nornsctl_lock_stat_t* r_locks;
+            size_t r_nlocks;
+        };
+        struct {
+            /* allocated by unpack_from_buffer(), must be freed by the
+             * caller with xfree() */
+            nornsctl_slow_task_t* r_slow_tasks;
+            size_t r_nslow_tasks;
         };
     };
 } norns_response_t;
@@ -35,7 +35,9 @@
  * SOFTWARE.                                                             *
  *************************************************************************/
 
+#include <algorithm>
 #include <sstream>
+#include <ctime>
 #include <boost/algorithm/string/join.hpp>
 
 #include "common.hpp"
@@ -63,6 +65,56 @@ norns::iotask_type decode_iotask_type(::google::protobuf::uint32 type) {
     }
 }
 
+boost::optional<norns::iotask_priority> 
+decode_iotask_priority(const norns::rpc::Request_Task& task) {
+
+    using norns::iotask_priority;
+
+    if(!task.has_priority()) {
+        return iotask_priority::normal;
+    }
+
+    switch(task.priority()) {
+        case NORNS_PRIORITY_DEFAULT:
+        case NORNS_PRIORITY_NORMAL:
+            return iotask_priority::normal;
+        case NORNS_PRIORITY_LOW:
+            return iotask_priority::low;
+        case NORNS_PRIORITY_HIGH:
+            return iotask_priority::high;
+        case NORNS_PRIORITY_URGENT:
+            return iotask_priority::urgent;
+        default:
+            return boost::none;
+    }
+}
+
+boost::optional<norns::iotask_deadline> 
+decode_iotask_deadline(const norns::rpc::Request_Task& task) {
+
+    if(!task.has_deadline() || task.deadline() == 0) {
+        return boost::none;
+    }
+
+    return norns::iotask_deadline(
+            std::chrono::duration_cast<norns::iotask_deadline::duration>(
+                std::chrono::microseconds(task.deadline())));
+}
+
+std::vector<norns::iotask_id>
+decode_iotask_parents(const norns::rpc::Request_Task& task) {
+
+    std::vector<norns::iotask_id> parents(task.parents().begin(), 
+                                          task.parents().end());
+
+    // duplicates are harmless but useless
+    std::sort(parents.begin(), parents.end());
+    parents.erase(std::unique(parents.begin(), parents.end()), 
+                  parents.end());
+
+    return parents;
+}
+
 norns::backend_type decode_backend_type(::google::protobuf::uint32 type) {
 
     using norns::backend_type;
@@ -97,6 +149,8 @@ norns::command_type decode_command(::google::protobuf::uint32 type) {
             return command_type::resume_listen;
         case NORNSCTL_CMD_SHUTDOWN:
             return command_type::shutdown;
+        case NORNSCTL_CMD_DUMP_TRACE:
+            return command_type::dump_trace;
         default:
             return command_type::unknown;
     }
@@ -247,16 +301,19 @@ request_ptr request::create_from_buffer(const std::vector<uint8_t>& buffer, int
 
                     auto task = rpc_req.task();
                     iotask_type optype = ::decode_iotask_type(task.optype());
+                    const auto priority = ::decode_iotask_priority(task);
+                    const auto deadline = ::decode_iotask_deadline(task);
+                    const auto parents = ::decode_iotask_parents(task);
 
-                    if(::is_valid(task)) {
+                    if(::is_valid(task) && priority) {
                         const auto src_res = ::create_from(task.source());
                         const auto dst_res = ::create_from(task.destination());
 
                         if(dst_res) {
-                            return std::make_unique<iotask_create_request>(optype, std::move(src_res), dst_res);
+                            return std::make_unique<iotask_create_request>(optype, std::move(src_res), dst_res, *priority, deadline, parents);
                         }
 
-                        return std::make_unique<iotask_create_request>(optype, std::move(src_res), boost::none);
+                        return std::make_unique<iotask_create_request>(optype, std::move(src_res), boost::none, *priority, deadline, parents);
                     }
 
                     return std::make_unique<bad_request>();
@@ -274,17 +331,55 @@ request_ptr request::create_from_buffer(const std::vector<uint8_t>& buffer, int
                 }
             break;
 
+            case norns::rpc::Request::IOTASK_CANCEL:
+                if(rpc_req.has_task()) {
+
+                    auto task = rpc_req.task();
+
+                    if(task.has_taskid()) {
+                        return std::make_unique<iotask_cancel_request>(task.taskid());
+                    }
+                }
+            break;
+
             case norns::rpc::Request::PING:
                 return std::make_unique<ping_request>();
 
             case norns::rpc::Request::GLOBAL_STATUS:
                 return std::make_unique<global_status_request>();
 
+            case norns::rpc::Request::TRANSFER_ESTIMATE:
+
+                if(rpc_req.has_estimate()) {
+                    const auto& est = rpc_req.estimate();
+                    return std::make_unique<transfer_estimate_request>(
+                            est.src_nsid(), est.dst_nsid(), 
+                            est.size(), est.nfiles());
+                }
+                break;
+
+            case norns::rpc::Request::LATENCY_STATS:
+                return std::make_unique<latency_stats_request>();
+
+            case norns::rpc::Request::LOCK_STATS:
+                return std::make_unique<lock_stats_request>();
+
+            case norns::rpc::Request::SLOW_TASKS:
+                return std::make_unique<slow_tasks_request>();
+
             case norns::rpc::Request::CTL_COMMAND:
 
                 if(rpc_req.has_command()) {
                     command_type cmd = ::decode_command(rpc_req.command().id());
-                    return std::make_unique<command_request>(cmd);
+
+                    // dump_trace is the only command with an argument
+                    if(cmd == command_type::dump_trace && 
+                       !rpc_req.command().has_path()) {
+                        break;
+                    }
+
+                    return std::make_unique<command_request>(
+                            cmd, rpc_req.command().path());
                 }
                 break;
 
@@ -412,6 +507,9 @@ std::string iotask_create_request::to_string() const {
     const auto op = this->get<0>();
     const auto src = this->get<1>();
     const auto dst = this->get<2>();
+    const auto priority = this->get<3>();
+    const auto deadline = this->get<4>();
+    const auto parents = this->get<5>();
 
     auto str = utils::to_string(op);
 
@@ -423,6 +521,23 @@ std::string iotask_create_request::to_string() const {
         str += std::string(" => ") + (*dst)->to_string();
     }
 
+    str += std::string(", priority: ") + utils::to_string(priority);
+
+    if(deadline) {
+        const std::time_t t = std::chrono::system_clock::to_time_t(*deadline);
+        str += std::string(", deadline: ") + std::to_string(t);
+    }
+
+    if(!parents.empty()) {
+        str += std::string(", parents: [");
+
+        for(std::size_t i = 0; i < parents.size(); ++i) {
+            str += (i == 0 ? "" : ", ") + std::to_string(parents[i]);
+        }
+
+        str += "]";
+    }
+
     return str;
 }
 
@@ -434,11 +549,41 @@ std::string iotask_status_request::to_string() const {
     return std::to_string(tid);
 }
 
+template<>
+std::string iotask_cancel_request::to_string() const {
+
+    const auto tid = this->get<0>();
+
+    return std::to_string(tid);
+}
+
 template<>
 std::string global_status_request::to_string() const {
     return "GLOBAL_STATUS";
 }
 
+template<>
+std::string transfer_estimate_request::to_string() const {
+    return this->get<0>() + " => " + this->get<1>() + 
+           ", size: " + std::to_string(this->get<2>()) + 
+           ", files: " + std::to_string(this->get<3>());
+}
+
+template<>
+std::string latency_stats_request::to_string() const {
+    return "LATENCY_STATS";
+}
+
+template<>
+std::string lock_stats_request::to_string() const {
+    return "LOCK_STATS";
+}
+
+template<>
+std::string slow_tasks_request::to_string() const {
+    return "SLOW_TASKS";
+}
+
 template<>
 std::string command_request::to_string() const {
     switch(this->get<0>()) {
@@ -450,6 +595,8 @@ std::string command_request::to_string() const {
             return "RESUME_LISTEN";
         case command_type::shutdown:
             return "SHUTDOWN";
+        case command_type::dump_trace:
+            return "DUMP_TRACE, path: " + this->get<1>();
         default:
             return "UNKNOWN";
     }
@@ -593,6 +740,58 @@ std::string bad_request::to_string() const {
 
 
 } // namespace api
+
+namespace utils {
+
+std::string to_string(api::request_type type) {
+
+    using api::request_type;
+
+    switch(type) {
+        case request_type::iotask_create:
+            return "IOTASK_CREATE";
+        case request_type::iotask_status:
+            return "IOTASK_STATUS";
+        case request_type::iotask_cancel:
+            return "IOTASK_CANCEL";
+        case request_type::global_status:
+            return "GLOBAL_STATUS";
+        case request_type::transfer_estimate:
+            return "TRANSFER_ESTIMATE";
+        case request_type::latency_stats:
+            return "LATENCY_STATS";
+        case request_type::lock_stats:
+            return "LOCK_STATS";
+        case request_type::slow_tasks:
+            return "SLOW_TASKS";
+        case request_type::command:
+            return "COMMAND";
+        case request_type::ping:
+            return "PING_REQUEST";
+        case request_type::job_register:
+            return "REGISTER_JOB";
+        case request_type::job_update:
+            return "UPDATE_JOB";
+        case request_type::job_unregister:
+            return "UNREGISTER_JOB";
+        case request_type::process_register:
+            return "ADD_PROCESS";
+        case request_type::process_unregister:
+            return "REMOVE_PROCESS";
+        case request_type::backend_register:
+            return "REGISTER_NAMESPACE";
+        case request_type::backend_update:
+            return "UPDATE_NAMESPACE";
+        case request_type::backend_unregister:
+            return "UNREGISTER_NAMESPACE";
+        case request_type::bad_request:
+            return "UNKNOWN_REQUEST";
+        default:
+            return "UNKNOWN!";
+    }
+}
+
+} // namespace utils
 } // namespace norns
 
 
@@ -87,7 +87,12 @@ namespace api {
 enum class request_type { 
     iotask_create,
     iotask_status,
+    iotask_cancel,
     global_status,
+    transfer_estimate,
+    latency_stats,
+    lock_stats,
+    slow_tasks,
     command,
     ping,
     job_register, 
@@ -198,7 +203,10 @@ using iotask_create_request = detail::request_impl<
     request_type::iotask_create,
     iotask_type,
     std::shared_ptr<data::resource_info>,
-    boost::optional<std::shared_ptr<data::resource_info>>
+    boost::optional<std::shared_ptr<data::resource_info>>,
+    iotask_priority,
+    boost::optional<iotask_deadline>,
+    std::vector<iotask_id>
 >;
 
 using iotask_status_request = detail::request_impl<
@@ -206,6 +214,11 @@ using iotask_status_request = detail::request_impl<
     iotask_id
 >;
 
+using iotask_cancel_request = detail::request_impl<
+    request_type::iotask_cancel,
+    iotask_id
+>;
+
 using ping_request = detail::request_impl<
     request_type::ping
 >;
@@ -272,12 +285,40 @@ using global_status_request = detail::request_impl<
     request_type::global_status
 >;
 
+using transfer_estimate_request = detail::request_impl<
+    request_type::transfer_estimate,
+    std::string, // source nsid
+    std::string, // destination nsid
+    uint64_t, // size
+    uint64_t // number of files
+>;
+
+using latency_stats_request = detail::request_impl<
+    request_type::latency_stats
+>;
+
+using lock_stats_request = detail::request_impl<
+    request_type::lock_stats
+>;
+
+using slow_tasks_request = detail::request_impl<
+    request_type::slow_tasks
+>;
+
 using command_request = detail::request_impl<
     request_type::command,
-    command_type
+    command_type,
+    std::string // path argument (dump_trace only)
 >;
 
 } // namespace api
+
+namespace utils {
+
+/*! Name of a type of request (as used in log messages) */
+std::string to_string(api::request_type type);
+
+} // namespace utils
 } // namespace norns
 
 #endif /* __API_REQUESTS_H__ */
@@ -37,6 +37,7 @@
 
 #include "messages.pb.h"
 #include "io/task-stats.hpp"
+#include "utils/profiled-mutex.hpp"
 #include "response.hpp"
 #include "logger.hpp"
 
@@ -51,6 +52,8 @@ norns::rpc::Response_Type encode(norns::api::response_type type) {
             return norns::rpc::Response::IOTASK_SUBMIT;
         case response_type::iotask_status:
             return norns::rpc::Response::IOTASK_STATUS;
+        case response_type::iotask_cancel:
+            return norns::rpc::Response::IOTASK_CANCEL;
         case response_type::ping:
             return norns::rpc::Response::PING;
         case response_type::job_register: 
@@ -71,6 +74,14 @@ norns::rpc::Response_Type encode(norns::api::response_type type) {
             return norns::rpc::Response::NAMESPACE_UNREGISTER;
         case response_type::global_status:
             return norns::rpc::Response::GLOBAL_STATUS;
+        case response_type::transfer_estimate:
+            return norns::rpc::Response::TRANSFER_ESTIMATE;
+        case response_type::latency_stats:
+            return norns::rpc::Response::LATENCY_STATS;
+        case response_type::lock_stats:
+            return norns::rpc::Response::LOCK_STATS;
+        case response_type::slow_tasks:
+            return norns::rpc::Response::SLOW_TASKS;
         case response_type::command:
             return norns::rpc::Response::CTL_COMMAND;
         case response_type::bad_request:
@@ -158,6 +169,9 @@ void iotask_status_response::pack_extra_info(norns::rpc::Response& r) const {
     stats_msg->set_status(encode(stats.status()));
     stats_msg->set_task_error(encode(stats.error()));
     stats_msg->set_sys_errnum(stats.sys_error().value());
+    stats_msg->set_pending_bytes(stats.pending_bytes());
+    stats_msg->set_total_bytes(stats.total_bytes());
+    stats_msg->set_copy_engines(stats.copy_engines());
     r.set_allocated_stats(stats_msg);
 
     // we don't need to free stats_msg because 
@@ -182,6 +196,14 @@ void global_status_response::pack_extra_info(norns::rpc::Response& r) const {
     gstats_msg->set_running_tasks(gstats.running_tasks());
     gstats_msg->set_pending_tasks(gstats.pending_tasks());
     gstats_msg->set_eta(gstats.eta());
+
+    const auto at_risk = gstats.deadlines_at_risk();
+    gstats_msg->set_deadlines_at_risk(at_risk.size());
+
+    for(std::size_t i = 0; 
+        i < at_risk.size() && i < NORNSCTL_MAX_AT_RISK_TASKS; ++i) {
+        gstats_msg->add_at_risk_tasks(at_risk[i]);
+    }
     r.set_allocated_gstats(gstats_msg);
 
     // we don't need to free gstats_msg because 
@@ -194,6 +216,109 @@ std::string global_status_response::to_string() const {
     return utils::to_string(gstats) + " " + utils::to_string(this->error_code());
 }
 
+/////////////////////////////////////////////////////////////////////////////////
+//   specializations for transfer_estimate_response 
+/////////////////////////////////////////////////////////////////////////////////
+template<>
+void transfer_estimate_response::pack_extra_info(norns::rpc::Response& r) const {
+    const auto& est = this->get<0>();
+
+    auto est_msg = new norns::rpc::Response_Estimate();
+
+    est_msg->set_bandwidth(est.bandwidth());
+    est_msg->set_overhead(est.overhead());
+    est_msg->set_duration(est.duration());
+    est_msg->set_backlog(est.backlog());
+    est_msg->set_samples(est.samples());
+
+    // set_allocated_estimate() takes ownership of est_msg
+    r.set_allocated_estimate(est_msg);
+}
+
+template<>
+std::string transfer_estimate_response::to_string() const {
+    const auto& est = this->get<0>();
+    return utils::to_string(est) + " " + utils::to_string(this->error_code());
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+//   specializations for latency_stats_response 
+/////////////////////////////////////////////////////////////////////////////////
+template<>
+void latency_stats_response::pack_extra_info(norns::rpc::Response& r) const {
+
+    for(const auto& lst : this->get<0>()) {
+        auto lat_msg = r.add_latencies();
+
+        lat_msg->set_scope(static_cast<uint32_t>(lst.get_scope()));
+        lat_msg->set_name(lst.name());
+        lat_msg->set_phase(static_cast<uint32_t>(lst.phase()));
+        lat_msg->set_count(lst.count());
+        lat_msg->set_mean(lst.mean());
+        lat_msg->set_p50(lst.p50());
+        lat_msg->set_p90(lst.p90());
+        lat_msg->set_p99(lst.p99());
+        lat_msg->set_max(lst.max());
+    }
+}
+
+template<>
+std::string latency_stats_response::to_string() const {
+    return std::to_string(this->get<0>().size()) + " distributions " + 
+           utils::to_string(this->error_code());
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+//   specializations for lock_stats_response 
+/////////////////////////////////////////////////////////////////////////////////
+template<>
+void lock_stats_response::pack_extra_info(norns::rpc::Response& r) const {
+
+    for(const auto& lst : this->get<0>()) {
+        auto lock_msg = r.add_locks();
+
+        lock_msg->set_name(lst.m_name);
+        lock_msg->set_acquisitions(lst.m_acquisitions);
+        lock_msg->set_shared_acquisitions(lst.m_shared_acquisitions);
+        lock_msg->set_contended(lst.m_contended);
+        lock_msg->set_wait(lst.m_wait_ns / 1e9);
+        lock_msg->set_max_wait(lst.m_max_wait_ns / 1e9);
+        lock_msg->set_hold(lst.m_hold_ns / 1e9);
+        lock_msg->set_max_hold(lst.m_max_hold_ns / 1e9);
+    }
+}
+
+template<>
+std::string lock_stats_response::to_string() const {
+    return std::to_string(this->get<0>().size()) + " locks " + 
+           utils::to_string(this->error_code());
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+//   specializations for slow_tasks_response 
+/////////////////////////////////////////////////////////////////////////////////
+template<>
+void slow_tasks_response::pack_extra_info(norns::rpc::Response& r) const {
+
+    for(const auto& st : this->get<0>()) {
+        auto st_msg = r.add_slow_tasks();
+
+        st_msg->set_taskid(st.id());
+        st_msg->set_reason(static_cast<uint32_t>(st.get_reason()));
+        st_msg->set_sent_bytes(st.sent_bytes());
+        st_msg->set_total_bytes(st.total_bytes());
+        st_msg->set_rate(st.rate());
+        st_msg->set_expected_rate(st.expected_rate());
+        st_msg->set_idle(st.idle_time());
+    }
+}
+
+template<>
+std::string slow_tasks_response::to_string() const {
+    return std::to_string(this->get<0>().size()) + " tasks " + 
+           utils::to_string(this->error_code());
+}
+
 } // namespace detail
 
 } // namespace api
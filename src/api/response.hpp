@@ -53,8 +53,15 @@ enum class urd_error;
 namespace io {
     struct task_stats;
     struct global_stats;
+    struct transfer_estimate;
+    struct latency_stats;
+    struct slow_task;
 };
 
+namespace utils {
+    struct lock_stats_snapshot;
+}
+
 namespace rpc {
     class Response;
 }
@@ -64,7 +71,12 @@ namespace api {
 enum class response_type {
     iotask_create,
     iotask_status,
+    iotask_cancel,
     global_status,
+    transfer_estimate,
+    latency_stats,
+    lock_stats,
+    slow_tasks,
     command,
     ping,
     job_register, 
@@ -160,6 +172,10 @@ using iotask_status_response = detail::response_impl<
     io::task_stats
 >;
 
+using iotask_cancel_response = detail::response_impl<
+    response_type::iotask_cancel
+>;
+
 using ping_response = detail::response_impl<
     response_type::ping
 >;
@@ -201,6 +217,26 @@ using global_status_response = detail::response_impl<
     io::global_stats
 >;
 
+using transfer_estimate_response = detail::response_impl<
+    response_type::transfer_estimate,
+    io::transfer_estimate
+>;
+
+using latency_stats_response = detail::response_impl<
+    response_type::latency_stats,
+    std::vector<io::latency_stats>
+>;
+
+using lock_stats_response = detail::response_impl<
+    response_type::lock_stats,
+    std::vector<utils::lock_stats_snapshot>
+>;
+
+using slow_tasks_response = detail::response_impl<
+    response_type::slow_tasks,
+    std::vector<io::slow_task>
+>;
+
 using command_response = detail::response_impl<
     response_type::command
 >;
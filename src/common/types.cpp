@@ -67,11 +67,28 @@ std::string to_string(iotask_type type) {
             return "DATA_REMOVE";
         case iotask_type::remote_transfer:
             return "DATA_TRANSFER";
+        case iotask_type::noop:
+            return "NOOP";
         default:
             return "UNKNOWN_IOTASK";
     }
 }
 
+std::string to_string(iotask_priority priority) {
+    switch(priority) {
+        case iotask_priority::low:
+            return "LOW";
+        case iotask_priority::normal:
+            return "NORMAL";
+        case iotask_priority::high:
+            return "HIGH";
+        case iotask_priority::urgent:
+            return "URGENT";
+        default:
+            return "UNKNOWN_PRIORITY";
+    }
+}
+
 std::string to_string(urd_error ecode) {
 
     switch(ecode) {
@@ -117,6 +134,14 @@ std::string to_string(urd_error ecode) {
             return "NORNS_ETOOMANYTASKS";
         case urd_error::tasks_pending:
             return "NORNS_ETASKSPENDING";
+        case urd_error::task_cancelled:
+            return "NORNS_ETASKCANCELLED";
+        case urd_error::dependency_failed:
+            return "NORNS_EDEPFAILED";
+        case urd_error::task_finished:
+            return "NORNS_ETASKFINISHED";
+        case urd_error::not_task_owner:
+            return "NORNS_ENOTTASKOWNER";
         case urd_error::accept_paused:
             return "NORNS_EACCEPTPAUSED";
         case urd_error::resource_exists:
@@ -42,6 +42,7 @@
  *************************************************************************/
 
 #include <string>
+#include <chrono>
 #include "norns.h"
 #include "nornsctl.h"
 
@@ -63,6 +64,17 @@ enum class iotask_type {
     unknown
 };
 
+/*! Scheduling priorities for an I/O task */
+enum class iotask_priority {
+    low    = NORNS_PRIORITY_LOW,
+    normal = NORNS_PRIORITY_NORMAL,
+    high   = NORNS_PRIORITY_HIGH,
+    urgent = NORNS_PRIORITY_URGENT
+};
+
+/*! Absolute deadline for an I/O task */
+using iotask_deadline = std::chrono::system_clock::time_point;
+
 /*! Backend type */
 enum class backend_type {
     nvml             = NORNS_BACKEND_NVML,
@@ -78,6 +90,7 @@ enum class command_type {
     pause_listen,
     resume_listen,
     shutdown,
+    dump_trace,
     unknown
 };
 
@@ -117,6 +130,10 @@ enum class urd_error : norns_error_t {
     no_such_task      = NORNS_ENOSUCHTASK,
     too_many_tasks    = NORNS_ETOOMANYTASKS,
     tasks_pending     = NORNS_ETASKSPENDING,
+    task_cancelled    = NORNS_ETASKCANCELLED,
+    dependency_failed = NORNS_EDEPFAILED,
+    task_finished     = NORNS_ETASKFINISHED,
+    not_task_owner    = NORNS_ENOTTASKOWNER,
 
     /* errors about resources */
     resource_exists   = NORNS_ERESOURCEEXISTS,
@@ -127,6 +144,7 @@ namespace utils {
 
 std::string to_string(backend_type type);
 std::string to_string(iotask_type type);
+std::string to_string(iotask_priority priority);
 std::string to_string(urd_error ecode);
 
 }
@@ -113,10 +113,113 @@ const file_schema valid_options = declare_file({
                     opt_type::mandatory, 
                     converter<uint32_t>(parsers::parse_number)), 
 
+            declare_option<uint32_t>(
+                    keywords::min_workers, 
+                    opt_type::optional, 
+                    converter<uint32_t>(parsers::parse_number)), 
+
+            declare_option<uint32_t>(
+                    keywords::max_workers, 
+                    opt_type::optional, 
+                    converter<uint32_t>(parsers::parse_number)), 
+
+            declare_option<uint32_t>(
+                    keywords::small_task_workers, 
+                    opt_type::optional, 
+                    defaults::small_task_workers,
+                    converter<uint32_t>(parsers::parse_number)), 
+
+            declare_option<uint64_t>(
+                    keywords::small_task_threshold, 
+                    opt_type::optional, 
+                    defaults::small_task_threshold,
+                    converter<uint64_t>(parsers::parse_capacity)), 
+
             declare_option<bfs::path>(
                     keywords::staging_directory, 
                     opt_type::mandatory, 
                     converter<bfs::path>(parsers::parse_path)), 
+
+            declare_option<bfs::path>(
+                    keywords::bandwidth_model, 
+                    opt_type::optional, 
+                    converter<bfs::path>(parsers::parse_path)), 
+
+            declare_option<uint32_t>(
+                    keywords::finished_task_ttl, 
+                    opt_type::optional, 
+                    defaults::finished_task_ttl,
+                    converter<uint32_t>(parsers::parse_count)), 
+
+            declare_option<uint32_t>(
+                    keywords::max_finished_tasks, 
+                    opt_type::optional, 
+                    defaults::max_finished_tasks,
+                    converter<uint32_t>(parsers::parse_count)), 
+
+            declare_option<bfs::path>(
+                    keywords::metrics_socket, 
+                    opt_type::optional, 
+                    converter<bfs::path>(parsers::parse_path)), 
+
+            declare_option<bfs::path>(
+                    keywords::metrics_textfile, 
+                    opt_type::optional, 
+                    converter<bfs::path>(parsers::parse_path)), 
+
+            declare_option<uint32_t>(
+                    keywords::metrics_interval, 
+                    opt_type::optional, 
+                    defaults::metrics_interval,
+                    converter<uint32_t>(parsers::parse_number)), 
+
+            declare_option<uint32_t>(
+                    keywords::trace_buffer_size, 
+                    opt_type::optional, 
+                    defaults::trace_buffer_size,
+                    converter<uint32_t>(parsers::parse_count)), 
+
+            declare_option<bool>(
+                    keywords::lock_profiling, 
+                    opt_type::optional, 
+                    defaults::lock_profiling,
+                    converter<bool>(parsers::parse_bool)), 
+
+            declare_option<uint32_t>(
+                    keywords::watchdog_interval, 
+                    opt_type::optional, 
+                    defaults::watchdog_interval,
+                    converter<uint32_t>(parsers::parse_count)), 
+
+            declare_option<uint32_t>(
+                    keywords::stall_timeout, 
+                    opt_type::optional, 
+                    defaults::stall_timeout,
+                    converter<uint32_t>(parsers::parse_count)), 
+
+            declare_option<uint32_t>(
+                    keywords::slow_task_threshold, 
+                    opt_type::optional, 
+                    defaults::slow_task_threshold,
+                    converter<uint32_t>(parsers::parse_count)), 
+
+            declare_option<uint64_t>(
+                    keywords::copy_chunk_size, 
+                    opt_type::optional, 
+                    defaults::copy_chunk_size,
+                    converter<uint64_t>(parsers::parse_capacity)), 
+
+            declare_option<uint32_t>(
+                    keywords::copy_fanout, 
+                    opt_type::optional, 
+                    defaults::copy_fanout,
+                    converter<uint32_t>(parsers::parse_number)), 
+
+            declare_option<uint32_t>(
+                    keywords::io_uring_queue_depth, 
+                    opt_type::optional, 
+                    defaults::io_uring_queue_depth,
+                    converter<uint32_t>(parsers::parse_count)), 
         })
     ),
 
@@ -145,7 +248,24 @@ const file_schema valid_options = declare_file({
                     converter<uint64_t>(parsers::parse_capacity)),
             declare_option<std::string>(
                     keywords::visibility,
-                    opt_type::mandatory)
+                    opt_type::mandatory),
+            declare_option<uint64_t>(
+                    keywords::bandwidth_limit,
+                    opt_type::optional,
+                    converter<uint64_t>(parsers::parse_capacity)),
+            declare_option<std::map<std::string, uint64_t>>(
+                    keywords::pair_bandwidth_limits,
+                    opt_type::optional,
+                    converter<std::map<std::string, uint64_t>>(
+                        parsers::parse_bandwidth_limits)),
+            declare_option<int32_t>(
+                    keywords::numa_node,
+                    opt_type::optional,
+                    converter<int32_t>(parsers::parse_numa_node)),
+            declare_option<bool>(
+                    keywords::direct_io,
+                    opt_type::optional,
+                    converter<bool>(parsers::parse_bool))
         })
     )
 });
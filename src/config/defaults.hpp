@@ -62,8 +62,24 @@ namespace defaults {
     extern const in_port_t  remote_port;
     extern const char*      pidfile;
     extern const uint32_t   workers_in_pool;
+    extern const uint32_t   small_task_workers;
+    extern const uint64_t   small_task_threshold;
     extern const char*      staging_directory;
     extern const uint32_t   backlog_size;
+    extern const char*      bandwidth_model;
+    extern const uint32_t   finished_task_ttl;
+    extern const uint32_t   max_finished_tasks;
+    extern const char*      metrics_socket;
+    extern const char*      metrics_textfile;
+    extern const uint32_t   metrics_interval;
+    extern const uint32_t   trace_buffer_size;
+    extern const bool       lock_profiling;
+    extern const uint32_t   watchdog_interval;
+    extern const uint32_t   stall_timeout;
+    extern const uint32_t   slow_task_threshold;
+    extern const uint64_t   copy_chunk_size;
+    extern const uint32_t   copy_fanout;
+    extern const uint32_t   io_uring_queue_depth;
     extern const char*      config_file;
 
 } // namespace defaults
@@ -62,7 +62,25 @@ constexpr static const auto bind_address = "bind_address";
 constexpr static const auto remote_port = "remote_port";
 constexpr static const auto pidfile = "pidfile";
 constexpr static const auto workers = "workers";
+constexpr static const auto min_workers = "min_workers";
+constexpr static const auto max_workers = "max_workers";
+constexpr static const auto small_task_workers = "small_task_workers";
+constexpr static const auto small_task_threshold = "small_task_threshold";
 constexpr static const auto staging_directory = "staging_directory";
+constexpr static const auto bandwidth_model = "bandwidth_model";
+constexpr static const auto finished_task_ttl = "finished_task_ttl";
+constexpr static const auto max_finished_tasks = "max_finished_tasks";
+constexpr static const auto metrics_socket = "metrics_socket";
+constexpr static const auto metrics_textfile = "metrics_textfile";
+constexpr static const auto metrics_interval = "metrics_interval";
+constexpr static const auto trace_buffer_size = "trace_buffer_size";
+constexpr static const auto lock_profiling = "lock_profiling";
+constexpr static const auto watchdog_interval = "watchdog_interval";
+constexpr static const auto stall_timeout = "stall_timeout";
+constexpr static const auto slow_task_threshold = "slow_task_threshold";
+constexpr static const auto copy_chunk_size = "copy_chunk_size";
+constexpr static const auto copy_fanout = "copy_fanout";
+constexpr static const auto io_uring_queue_depth = "io_uring_queue_depth";
 
 // option names for 'namespaces' section
 constexpr static const auto nsid = "nsid";
@@ -71,6 +89,10 @@ constexpr static const auto mountpoint = "mountpoint";
 constexpr static const auto type = "type";
 constexpr static const auto capacity = "capacity";
 constexpr static const auto visibility = "visibility";
+constexpr static const auto bandwidth_limit = "bandwidth_limit";
+constexpr static const auto pair_bandwidth_limits = "pair_bandwidth_limits";
+constexpr static const auto numa_node = "numa_node";
+constexpr static const auto direct_io = "direct_io";
 
 }
 
@@ -36,12 +36,15 @@
  *************************************************************************/
 
 #include <cstdint>
+#include <map>
 #include <string>
+#include <vector>
 #include <cmath>
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
 #include "utils.hpp"
 #include "parsers.hpp"
+#include "settings.hpp"
 
 namespace bfs = boost::filesystem;
 
@@ -79,6 +82,25 @@ uint32_t parse_number(const std::string& name, const std::string& value) {
     return static_cast<uint32_t>(optval);
 }
 
+uint32_t parse_count(const std::string& name, const std::string& value) {
+
+    int32_t optval = 0;
+
+    try {
+        optval = std::stoi(value);
+    } catch(...) {
+        throw std::invalid_argument("Value provided for option '" + name + "' is not a number");
+    }
+
+    // unlike parse_number(), zero is accepted since it usually means that 
+    // the feature controlled by the option is disabled or unbounded
+    if(optval < 0) {
+        throw std::invalid_argument("Value provided for option '" + name + "' must not be negative");
+    }
+
+    return static_cast<uint32_t>(optval);
+}
+
 bfs::path parse_path(const std::string& name, const std::string& value) {
 
     (void) name;
@@ -105,6 +127,55 @@ uint64_t parse_capacity(const std::string& name, const std::string& value) {
     }
 }
 
+std::map<std::string, uint64_t> parse_bandwidth_limits(const std::string& name, const std::string& value) {
+
+    // expected format: "nsid0=rate0, nsid1=rate1, ..."
+    std::map<std::string, uint64_t> limits;
+    std::vector<std::string> entries;
+    boost::algorithm::split(entries, value, boost::is_any_of(","));
+
+    for(const auto& e : entries) {
+
+        const auto pos = e.find('=');
+
+        if(pos == std::string::npos) {
+            throw std::invalid_argument("Value provided in option '" + name + "' is invalid");
+        }
+
+        const auto nsid = boost::algorithm::trim_copy(e.substr(0, pos));
+
+        if(nsid.empty()) {
+            throw std::invalid_argument("Value provided in option '" + name + "' is invalid");
+        }
+
+        limits[nsid] = parse_capacity(name, e.substr(pos + 1));
+    }
+
+    return limits;
+}
+
+int32_t parse_numa_node(const std::string& name, const std::string& value) {
+
+    // expected format: "auto" or a node number
+    const auto v = boost::algorithm::trim_copy(value);
+
+    if(boost::algorithm::to_lower_copy(v) == "auto") {
+        return namespace_def::auto_numa_node;
+    }
+
+    try {
+        std::size_t pos;
+        const auto node = std::stoi(v, &pos);
+
+        if(pos == v.size() && node >= 0) {
+            return node;
+        }
+    }
+    catch(const std::exception& ex) { }
+
+    throw std::invalid_argument("Value provided in option '" + name + "' is invalid");
+}
+
 } // namespace parsers
 } // namespace config
 } // namespace norns
@@ -39,6 +39,7 @@
 #define __PARSERS_HPP__
 
 #include <cstdint>
+#include <map>
 #include <string>
 #include <boost/filesystem.hpp>
 
@@ -50,9 +51,12 @@ namespace parsers {
 
 bool parse_bool(const std::string& name, const std::string& value);
 uint32_t parse_number(const std::string& name, const std::string& value);
+uint32_t parse_count(const std::string& name, const std::string& value);
 bfs::path parse_path(const std::string& name, const std::string& value);
 bfs::path parse_existing_path(const std::string& name, const std::string& value);
 uint64_t parse_capacity(const std::string& name, const std::string& value);
+std::map<std::string, uint64_t> parse_bandwidth_limits(const std::string& name, const std::string& value);
+int32_t parse_numa_node(const std::string& name, const std::string& value);
 
 } // namespace parsers
 } // namespace config
@@ -72,8 +72,26 @@ settings::settings(const std::string& progname,
                    uint32_t remote_port,
                    const bfs::path& pidfile, 
                    uint32_t workers,
+                   uint32_t min_workers,
+                   uint32_t max_workers,
+                   uint32_t small_task_workers,
+                   uint64_t small_task_threshold,
                    const bfs::path& staging_directory,
                    uint32_t backlog_size, 
+                   const bfs::path& bandwidth_model,
+                   uint32_t finished_task_ttl,
+                   uint32_t max_finished_tasks,
+                   const bfs::path& metrics_socket,
+                   const bfs::path& metrics_textfile,
+                   uint32_t metrics_interval,
+                   uint32_t trace_buffer_size,
+                   bool lock_profiling,
+                   uint32_t watchdog_interval,
+                   uint32_t stall_timeout,
+                   uint32_t slow_task_threshold,
+                   uint64_t copy_chunk_size,
+                   uint32_t copy_fanout,
+                   uint32_t io_uring_queue_depth,
                    const bfs::path& cfgfile, 
                    const std::list<namespace_def>& defns) :
     m_progname(progname),
@@ -90,8 +108,26 @@ settings::settings(const std::string& progname,
     m_remote_port(remote_port),
     m_daemon_pidfile(pidfile),
     m_workers_in_pool(workers),
+    m_min_workers_in_pool(min_workers),
+    m_max_workers_in_pool(max_workers),
+    m_small_task_workers(small_task_workers),
+    m_small_task_threshold(small_task_threshold),
     m_staging_directory(staging_directory),
     m_backlog_size(backlog_size),
+    m_bandwidth_model(bandwidth_model),
+    m_finished_task_ttl(finished_task_ttl),
+    m_max_finished_tasks(max_finished_tasks),
+    m_metrics_socket(metrics_socket),
+    m_metrics_textfile(metrics_textfile),
+    m_metrics_interval(metrics_interval),
+    m_trace_buffer_size(trace_buffer_size),
+    m_lock_profiling(lock_profiling),
+    m_watchdog_interval(watchdog_interval),
+    m_stall_timeout(stall_timeout),
+    m_slow_task_threshold(slow_task_threshold),
+    m_copy_chunk_size(copy_chunk_size),
+    m_copy_fanout(copy_fanout),
+    m_io_uring_queue_depth(io_uring_queue_depth),
     m_config_file(cfgfile),
     m_default_namespaces(defns) { }
 
@@ -111,8 +147,26 @@ settings::load_defaults() {
     m_remote_port = defaults::remote_port;
     m_daemon_pidfile = defaults::pidfile;
     m_workers_in_pool = defaults::workers_in_pool;
+    m_min_workers_in_pool = defaults::workers_in_pool;
+    m_max_workers_in_pool = defaults::workers_in_pool;
+    m_small_task_workers = defaults::small_task_workers;
+    m_small_task_threshold = defaults::small_task_threshold;
     m_staging_directory = defaults::staging_directory;
     m_backlog_size = defaults::backlog_size;
+    m_bandwidth_model = defaults::bandwidth_model;
+    m_finished_task_ttl = defaults::finished_task_ttl;
+    m_max_finished_tasks = defaults::max_finished_tasks;
+    m_metrics_socket = defaults::metrics_socket;
+    m_metrics_textfile = defaults::metrics_textfile;
+    m_metrics_interval = defaults::metrics_interval;
+    m_trace_buffer_size = defaults::trace_buffer_size;
+    m_lock_profiling = defaults::lock_profiling;
+    m_watchdog_interval = defaults::watchdog_interval;
+    m_stall_timeout = defaults::stall_timeout;
+    m_slow_task_threshold = defaults::slow_task_threshold;
+    m_copy_chunk_size = defaults::copy_chunk_size;
+    m_copy_fanout = defaults::copy_fanout;
+    m_io_uring_queue_depth = defaults::io_uring_queue_depth;
     m_config_file = defaults::config_file;
     m_default_namespaces.clear();
 }
@@ -148,22 +202,134 @@ settings::load_from_file(const bfs::path& filename) {
     m_remote_port = gsettings.get_as<uint32_t>(keywords::remote_port);
     m_daemon_pidfile = gsettings.get_as<bfs::path>(keywords::pidfile);
     m_workers_in_pool = gsettings.get_as<uint32_t>(keywords::workers);
+
+    // the pool is only resized at runtime if min_workers and/or 
+    // max_workers are provided
+    m_min_workers_in_pool = m_workers_in_pool;
+    m_max_workers_in_pool = m_workers_in_pool;
+
+    if(gsettings.has(keywords::min_workers)) {
+        m_min_workers_in_pool = 
+            gsettings.get_as<uint32_t>(keywords::min_workers);
+    }
+
+    if(gsettings.has(keywords::max_workers)) {
+        m_max_workers_in_pool = 
+            gsettings.get_as<uint32_t>(keywords::max_workers);
+    }
+
+    if(m_min_workers_in_pool > m_workers_in_pool || 
+       m_max_workers_in_pool < m_workers_in_pool) {
+        throw std::invalid_argument("Option '" + std::string(keywords::workers) +
+                "' must be between '" + keywords::min_workers + "' and '" +
+                keywords::max_workers + "'");
+    }
+
+    m_small_task_workers = 
+        gsettings.get_as<uint32_t>(keywords::small_task_workers);
+
+    // small tasks are only run by the small lane, which needs workers
+    if(m_small_task_workers == 0) {
+        throw std::invalid_argument("Option '" + 
+                std::string(keywords::small_task_workers) + 
+                "' must be greater than zero");
+    }
+
+    m_small_task_threshold = 
+        gsettings.get_as<uint64_t>(keywords::small_task_threshold);
     m_staging_directory =
         gsettings.get_as<bfs::path>(keywords::staging_directory);
     m_backlog_size = defaults::backlog_size;
+    m_bandwidth_model = defaults::bandwidth_model;
+
+    // an empty path disables the persistence of the bandwidth model
+    if(gsettings.has(keywords::bandwidth_model)) {
+        m_bandwidth_model = 
+            gsettings.get_as<bfs::path>(keywords::bandwidth_model);
+    }
+
+    m_finished_task_ttl = 
+        gsettings.get_as<uint32_t>(keywords::finished_task_ttl);
+    m_max_finished_tasks = 
+        gsettings.get_as<uint32_t>(keywords::max_finished_tasks);
+
+    // metrics are only exported if a socket or a textfile is configured
+    m_metrics_socket = defaults::metrics_socket;
+    m_metrics_textfile = defaults::metrics_textfile;
+
+    if(gsettings.has(keywords::metrics_socket)) {
+        m_metrics_socket = 
+            gsettings.get_as<bfs::path>(keywords::metrics_socket);
+    }
+
+    if(gsettings.has(keywords::metrics_textfile)) {
+        m_metrics_textfile = 
+            gsettings.get_as<bfs::path>(keywords::metrics_textfile);
+    }
+
+    m_metrics_interval = 
+        gsettings.get_as<uint32_t>(keywords::metrics_interval);
+
+    m_trace_buffer_size = 
+        gsettings.get_as<uint32_t>(keywords::trace_buffer_size);
+
+    m_lock_profiling = gsettings.get_as<bool>(keywords::lock_profiling);
+
+    m_watchdog_interval = 
+        gsettings.get_as<uint32_t>(keywords::watchdog_interval);
+
+    m_stall_timeout = gsettings.get_as<uint32_t>(keywords::stall_timeout);
+
+    m_slow_task_threshold = 
+        gsettings.get_as<uint32_t>(keywords::slow_task_threshold);
+    m_copy_chunk_size = 
+        gsettings.get_as<uint64_t>(keywords::copy_chunk_size);
+    m_copy_fanout = 
+        gsettings.get_as<uint32_t>(keywords::copy_fanout);
+    m_io_uring_queue_depth = 
+        gsettings.get_as<uint32_t>(keywords::io_uring_queue_depth);
 
     // load definitions for default namespaces
     const auto& namespaces =
         opt_map.get_as<file_options::options_list>(keywords::namespaces);
 
     for(const auto& nsdef : namespaces) {
+
+        uint64_t bandwidth_limit = 0;
+        std::map<std::string, uint64_t> pair_bandwidth_limits;
+        int32_t numa_node = namespace_def::no_numa_node;
+        bool direct_io = false;
+
+        if(nsdef.has(keywords::bandwidth_limit)) {
+            bandwidth_limit = 
+                nsdef.get_as<uint64_t>(keywords::bandwidth_limit);
+        }
+
+        if(nsdef.has(keywords::pair_bandwidth_limits)) {
+            pair_bandwidth_limits = 
+                nsdef.get_as<std::map<std::string, uint64_t>>(
+                        keywords::pair_bandwidth_limits);
+        }
+
+        if(nsdef.has(keywords::numa_node)) {
+            numa_node = nsdef.get_as<int32_t>(keywords::numa_node);
+        }
+
+        if(nsdef.has(keywords::direct_io)) {
+            direct_io = nsdef.get_as<bool>(keywords::direct_io);
+        }
+
         m_default_namespaces.emplace_back(
                 nsdef.get_as<std::string>(keywords::nsid),
                 nsdef.get_as<bool>(keywords::track_contents),
                 nsdef.get_as<bfs::path>(keywords::mountpoint),
                 nsdef.get_as<std::string>(keywords::type),
                 nsdef.get_as<uint64_t>(keywords::capacity),
-                nsdef.get_as<std::string>(keywords::visibility));
+                nsdef.get_as<std::string>(keywords::visibility),
+                bandwidth_limit,
+                pair_bandwidth_limits,
+                numa_node,
+                direct_io);
     }
 }
 
@@ -184,8 +350,26 @@ settings::to_string() const {
            "  m_remote_port: "       + std::to_string(m_remote_port) + ",\n" +
            "  m_pidfile: "           + m_daemon_pidfile.string() + ",\n" +
            "  m_workers: "           + std::to_string(m_workers_in_pool) + ",\n" +
+           "  m_min_workers: "       + std::to_string(m_min_workers_in_pool) + ",\n" +
+           "  m_max_workers: "       + std::to_string(m_max_workers_in_pool) + ",\n" +
+           "  m_small_task_workers: " + std::to_string(m_small_task_workers) + ",\n" +
+           "  m_small_task_threshold: " + std::to_string(m_small_task_threshold) + ",\n" +
            "  m_staging_directory: " + m_staging_directory.string() + ",\n" +
            "  m_backlog_size: "      + std::to_string(m_backlog_size) + ",\n" +
+           "  m_bandwidth_model: "   + m_bandwidth_model.string() + ",\n" +
+           "  m_finished_task_ttl: " + std::to_string(m_finished_task_ttl) + ",\n" +
+           "  m_max_finished_tasks: " + std::to_string(m_max_finished_tasks) + ",\n" +
+           "  m_metrics_socket: "    + m_metrics_socket.string() + ",\n" +
+           "  m_metrics_textfile: "  + m_metrics_textfile.string() + ",\n" +
+           "  m_metrics_interval: "  + std::to_string(m_metrics_interval) + ",\n" +
+           "  m_trace_buffer_size: " + std::to_string(m_trace_buffer_size) + ",\n" +
+           "  m_lock_profiling: "    + (m_lock_profiling ? "true" : "false") + ",\n" +
+           "  m_watchdog_interval: " + std::to_string(m_watchdog_interval) + ",\n" +
+           "  m_stall_timeout: "     + std::to_string(m_stall_timeout) + ",\n" +
+           "  m_slow_task_threshold: " + std::to_string(m_slow_task_threshold) + ",\n" +
+           "  m_copy_chunk_size: " + std::to_string(m_copy_chunk_size) + ",\n" +
+           "  m_copy_fanout: " + std::to_string(m_copy_fanout) + ",\n" +
+           "  m_io_uring_queue_depth: " + std::to_string(m_io_uring_queue_depth) + ",\n" +
            "  m_config_file: "       + m_config_file.string() + ",\n" +
            "};";
     //TODO: add m_default_namespaces
@@ -332,6 +516,46 @@ settings::workers_in_pool(uint32_t workers_in_pool) {
     m_workers_in_pool = workers_in_pool;
 }
 
+uint32_t
+settings::min_workers_in_pool() const {
+    return m_min_workers_in_pool;
+}
+
+void
+settings::min_workers_in_pool(uint32_t min_workers_in_pool) {
+    m_min_workers_in_pool = min_workers_in_pool;
+}
+
+uint32_t
+settings::max_workers_in_pool() const {
+    return m_max_workers_in_pool;
+}
+
+void
+settings::max_workers_in_pool(uint32_t max_workers_in_pool) {
+    m_max_workers_in_pool = max_workers_in_pool;
+}
+
+uint32_t
+settings::small_task_workers() const {
+    return m_small_task_workers;
+}
+
+void
+settings::small_task_workers(uint32_t small_task_workers) {
+    m_small_task_workers = small_task_workers;
+}
+
+uint64_t
+settings::small_task_threshold() const {
+    return m_small_task_threshold;
+}
+
+void
+settings::small_task_threshold(uint64_t small_task_threshold) {
+    m_small_task_threshold = small_task_threshold;
+}
+
 bfs::path
 settings::staging_directory() const {
     return m_staging_directory;
@@ -352,6 +576,146 @@ settings::backlog_size(uint32_t backlog_size) {
     m_backlog_size = backlog_size;
 }
 
+bfs::path
+settings::bandwidth_model() const {
+    return m_bandwidth_model;
+}
+
+void
+settings::bandwidth_model(const bfs::path& bandwidth_model) {
+    m_bandwidth_model = bandwidth_model;
+}
+
+uint32_t
+settings::finished_task_ttl() const {
+    return m_finished_task_ttl;
+}
+
+void
+settings::finished_task_ttl(uint32_t finished_task_ttl) {
+    m_finished_task_ttl = finished_task_ttl;
+}
+
+uint32_t
+settings::max_finished_tasks() const {
+    return m_max_finished_tasks;
+}
+
+void
+settings::max_finished_tasks(uint32_t max_finished_tasks) {
+    m_max_finished_tasks = max_finished_tasks;
+}
+
+bfs::path
+settings::metrics_socket() const {
+    return m_metrics_socket;
+}
+
+void
+settings::metrics_socket(const bfs::path& metrics_socket) {
+    m_metrics_socket = metrics_socket;
+}
+
+bfs::path
+settings::metrics_textfile() const {
+    return m_metrics_textfile;
+}
+
+void
+settings::metrics_textfile(const bfs::path& metrics_textfile) {
+    m_metrics_textfile = metrics_textfile;
+}
+
+uint32_t
+settings::metrics_interval() const {
+    return m_metrics_interval;
+}
+
+void
+settings::metrics_interval(uint32_t metrics_interval) {
+    m_metrics_interval = metrics_interval;
+}
+
+uint32_t
+settings::trace_buffer_size() const {
+    return m_trace_buffer_size;
+}
+
+void
+settings::trace_buffer_size(uint32_t trace_buffer_size) {
+    m_trace_buffer_size = trace_buffer_size;
+}
+
+bool
+settings::lock_profiling() const {
+    return m_lock_profiling;
+}
+
+void
+settings::lock_profiling(bool lock_profiling) {
+    m_lock_profiling = lock_profiling;
+}
+
+uint32_t
+settings::watchdog_interval() const {
+    return m_watchdog_interval;
+}
+
+void
+settings::watchdog_interval(uint32_t watchdog_interval) {
+    m_watchdog_interval = watchdog_interval;
+}
+
+uint32_t
+settings::stall_timeout() const {
+    return m_stall_timeout;
+}
+
+void
+settings::stall_timeout(uint32_t stall_timeout) {
+    m_stall_timeout = stall_timeout;
+}
+
+uint32_t
+settings::slow_task_threshold() const {
+    return m_slow_task_threshold;
+}
+
+void
+settings::slow_task_threshold(uint32_t slow_task_threshold) {
+    m_slow_task_threshold = slow_task_threshold;
+}
+
+uint64_t
+settings::copy_chunk_size() const {
+    return m_copy_chunk_size;
+}
+
+void
+settings::copy_chunk_size(uint64_t copy_chunk_size) {
+    m_copy_chunk_size = copy_chunk_size;
+}
+
+uint32_t
+settings::copy_fanout() const {
+    return m_copy_fanout;
+}
+
+void
+settings::copy_fanout(uint32_t copy_fanout) {
+    m_copy_fanout = copy_fanout;
+}
+
+uint32_t
+settings::io_uring_queue_depth() const {
+    return m_io_uring_queue_depth;
+}
+
+void
+settings::io_uring_queue_depth(uint32_t io_uring_queue_depth) {
+    m_io_uring_queue_depth = io_uring_queue_depth;
+}
+
 bfs::path 
 settings::config_file() const {
     return m_config_file;
@@ -39,6 +39,7 @@
 #define __SETTINGS_HPP__
 
 #include <list>
+#include <map>
 #include <boost/filesystem.hpp>
 #include <netinet/in.h>
 
@@ -49,18 +50,31 @@ namespace config {
 
 struct namespace_def {
 
+    // special values for numa_node
+    constexpr static const int32_t no_numa_node = -1;
+    constexpr static const int32_t auto_numa_node = -2;
+
     namespace_def(const std::string& nsid,
                   bool track,
                   const bfs::path& mountpoint,
                   const std::string& alias,
                   const uint64_t capacity,
-                  const std::string& visibility) :
+                  const std::string& visibility,
+                  const uint64_t bandwidth_limit = 0,
+                  const std::map<std::string, uint64_t>& 
+                      pair_bandwidth_limits = {},
+                  const int32_t numa_node = no_numa_node,
+                  const bool direct_io = false) :
         m_nsid(nsid),
         m_track(track),
         m_mountpoint(mountpoint),
         m_alias(alias),
         m_capacity(capacity),
-        m_visibility(visibility) { }
+        m_visibility(visibility),
+        m_bandwidth_limit(bandwidth_limit),
+        m_pair_bandwidth_limits(pair_bandwidth_limits),
+        m_numa_node(numa_node),
+        m_direct_io(direct_io) { }
 
     namespace_def(const namespace_def& other) = default;
 
@@ -102,12 +116,45 @@ struct namespace_def {
         return m_visibility;
     }
 
+    // maximum bandwidth (bytes/sec) for all transfers involving this 
+    // namespace (0 means unlimited)
+    uint64_t
+    bandwidth_limit() const {
+        return m_bandwidth_limit;
+    }
+
+    // maximum bandwidth (bytes/sec) for transfers from this namespace 
+    // to each of the namespaces in the map
+    std::map<std::string, uint64_t>
+    pair_bandwidth_limits() const {
+        return m_pair_bandwidth_limits;
+    }
+
+    // NUMA node whose CPUs and memory should be used for transfers 
+    // involving this namespace: either a node number, no_numa_node, or 
+    // auto_numa_node (i.e. the node of the device backing the mountpoint)
+    int32_t
+    numa_node() const {
+        return m_numa_node;
+    }
+
+    // whether data read from or written to this namespace should bypass 
+    // the page cache
+    bool
+    direct_io() const {
+        return m_direct_io;
+    }
+
     std::string m_nsid;
     bool        m_track;
     bfs::path   m_mountpoint;
     std::string m_alias;
     uint64_t    m_capacity;
     std::string m_visibility;
+    uint64_t    m_bandwidth_limit;
+    std::map<std::string, uint64_t> m_pair_bandwidth_limits;
+    int32_t     m_numa_node;
+    bool        m_direct_io;
 };
 
 struct settings {
@@ -128,8 +175,26 @@ struct settings {
              uint32_t remote_port,
              const bfs::path& pidfile,
              uint32_t workers,
+             uint32_t min_workers,
+             uint32_t max_workers,
+             uint32_t small_task_workers,
+             uint64_t small_task_threshold,
              const bfs::path& staging_directory,
              uint32_t backlog_size,
+             const bfs::path& bandwidth_model,
+             uint32_t finished_task_ttl,
+             uint32_t max_finished_tasks,
+             const bfs::path& metrics_socket,
+             const bfs::path& metrics_textfile,
+             uint32_t metrics_interval,
+             uint32_t trace_buffer_size,
+             bool lock_profiling,
+             uint32_t watchdog_interval,
+             uint32_t stall_timeout,
+             uint32_t slow_task_threshold,
+             uint64_t copy_chunk_size,
+             uint32_t copy_fanout,
+             uint32_t io_uring_queue_depth,
              const bfs::path& cfgfile,
              const std::list<namespace_def>& defns);
 
@@ -237,6 +302,30 @@ struct settings {
 
     void
     workers_in_pool(uint32_t workers_in_pool);
+
+    uint32_t
+    min_workers_in_pool() const;
+
+    void
+    min_workers_in_pool(uint32_t min_workers_in_pool);
+
+    uint32_t
+    max_workers_in_pool() const;
+
+    void
+    max_workers_in_pool(uint32_t max_workers_in_pool);
+
+    uint32_t
+    small_task_workers() const;
+
+    void
+    small_task_workers(uint32_t small_task_workers);
+
+    uint64_t
+    small_task_threshold() const;
+
+    void
+    small_task_threshold(uint64_t small_task_threshold);
     
     bfs::path
     staging_directory() const;
@@ -250,6 +339,90 @@ struct settings {
     void
     backlog_size(uint32_t backlog_size);
 
+    bfs::path
+    bandwidth_model() const;
+
+    void
+    bandwidth_model(const bfs::path& bandwidth_model);
+
+    uint32_t
+    finished_task_ttl() const;
+
+    void
+    finished_task_ttl(uint32_t finished_task_ttl);
+
+    uint32_t
+    max_finished_tasks() const;
+
+    void
+    max_finished_tasks(uint32_t max_finished_tasks);
+
+    bfs::path
+    metrics_socket() const;
+
+    void
+    metrics_socket(const bfs::path& metrics_socket);
+
+    bfs::path
+    metrics_textfile() const;
+
+    void
+    metrics_textfile(const bfs::path& metrics_textfile);
+
+    uint32_t
+    metrics_interval() const;
+
+    void
+    metrics_interval(uint32_t metrics_interval);
+
+    uint32_t
+    trace_buffer_size() const;
+
+    void
+    trace_buffer_size(uint32_t trace_buffer_size);
+
+    bool
+    lock_profiling() const;
+
+    void
+    lock_profiling(bool lock_profiling);
+
+    uint32_t
+    watchdog_interval() const;
+
+    void
+    watchdog_interval(uint32_t watchdog_interval);
+
+    uint32_t
+    stall_timeout() const;
+
+    void
+    stall_timeout(uint32_t stall_timeout);
+
+    uint32_t
+    slow_task_threshold() const;
+
+    void
+    slow_task_threshold(uint32_t slow_task_threshold);
+
+    uint64_t
+    copy_chunk_size() const;
+
+    void
+    copy_chunk_size(uint64_t copy_chunk_size);
+
+    uint32_t
+    copy_fanout() const;
+
+    void
+    copy_fanout(uint32_t copy_fanout);
+
+    uint32_t
+    io_uring_queue_depth() const;
+
+    void
+    io_uring_queue_depth(uint32_t io_uring_queue_depth);
+
     bfs::path
     config_file() const;
 
@@ -276,8 +449,26 @@ struct settings {
     in_port_t   m_remote_port;
     bfs::path   m_daemon_pidfile;
     uint32_t    m_workers_in_pool;
+    uint32_t    m_min_workers_in_pool;
+    uint32_t    m_max_workers_in_pool;
+    uint32_t    m_small_task_workers;
+    uint64_t    m_small_task_threshold;
     bfs::path   m_staging_directory;
     uint32_t    m_backlog_size;
+    bfs::path   m_bandwidth_model;
+    uint32_t    m_finished_task_ttl;
+    uint32_t    m_max_finished_tasks;
+    bfs::path   m_metrics_socket;
+    bfs::path   m_metrics_textfile;
+    uint32_t    m_metrics_interval;
+    uint32_t    m_trace_buffer_size;
+    bool        m_lock_profiling;
+    uint32_t    m_watchdog_interval;
+    uint32_t    m_stall_timeout;
+    uint32_t    m_slow_task_threshold;
+    uint64_t    m_copy_chunk_size;
+    uint32_t    m_copy_fanout;
+    uint32_t    m_io_uring_queue_depth;
     bfs::path   m_config_file;
     std::list<namespace_def> m_default_namespaces;
 };
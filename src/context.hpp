@@ -39,7 +39,10 @@
 #define NORNS_CONTEXT_HPP
 
 #include <boost/filesystem.hpp>
+#include <cstdint>
 #include <memory>
+#include <string>
+#include "metrics/metrics-registry.hpp"
 
 namespace bfs = boost::filesystem;
 
@@ -52,9 +55,17 @@ namespace norns {
 struct context {
 
     context(bfs::path staging_directory,
-            std::shared_ptr<hermes::async_engine> network_service) :
+            std::shared_ptr<hermes::async_engine> network_service,
+            std::shared_ptr<metrics::registry> metrics = nullptr,
+            uint64_t copy_chunk_size = 0,
+            uint32_t copy_fanout = 1,
+            uint32_t io_uring_queue_depth = 0) :
         m_staging_directory(std::move(staging_directory)),
-        m_network_service(std::move(network_service)) { }
+        m_network_service(std::move(network_service)),
+        m_metrics(std::move(metrics)),
+        m_copy_chunk_size(copy_chunk_size),
+        m_copy_fanout(copy_fanout),
+        m_io_uring_queue_depth(io_uring_queue_depth) { }
 
     bfs::path 
     staging_directory() const {
@@ -66,8 +77,51 @@ struct context {
         return m_network_service;
     }
 
+    std::shared_ptr<metrics::registry>
+    metrics() const {
+        return m_metrics;
+    }
+
+    /*! Size of the ranges in which large local files are split so that 
+     * they can be copied concurrently (0 disables splitting) */
+    uint64_t
+    copy_chunk_size() const {
+        return m_copy_chunk_size;
+    }
+
+    /*! Maximum number of ranges of a file copied concurrently */
+    uint32_t
+    copy_fanout() const {
+        return m_copy_fanout;
+    }
+
+    /*! Number of small files kept in flight through io_uring when copying 
+     * local directories (0 disables io_uring) */
+    uint32_t
+    io_uring_queue_depth() const {
+        return m_io_uring_queue_depth;
+    }
+
+    /*! Return the counter 'name' from the daemon's metrics registry. If no 
+     * registry is available, the counter returned is not exported, so 
+     * that callers can always update it unconditionally */
+    std::shared_ptr<metrics::counter>
+    make_counter(const std::string& name, const std::string& help,
+                 const metrics::labels& lbls = metrics::labels()) const {
+
+        if(!m_metrics) {
+            return std::make_shared<metrics::counter>();
+        }
+
+        return m_metrics->make_counter(name, help, lbls);
+    }
+
     bfs::path m_staging_directory;
     std::shared_ptr<hermes::async_engine> m_network_service;
+    std::shared_ptr<metrics::registry> m_metrics;
+    uint64_t m_copy_chunk_size;
+    uint32_t m_copy_fanout;
+    uint32_t m_io_uring_queue_depth;
 };
 
 } // namespace norns
@@ -0,0 +1,143 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <algorithm>
+#include "concurrency-controller.hpp"
+
+namespace {
+
+// weight given to the most recent observation for each level
+constexpr const double ewma_alpha = 0.5;
+
+} // anonymous namespace
+
+namespace norns {
+namespace io {
+
+concurrency_controller::concurrency_controller(uint32_t min_level,
+                                               uint32_t max_level,
+                                               uint32_t initial_level,
+                                               double tolerance,
+                                               uint32_t hold_periods) :
+    m_min_level(std::max(min_level, 1u)),
+    m_max_level(std::max(max_level, m_min_level)),
+    m_tolerance(tolerance),
+    m_hold_periods(hold_periods),
+    m_base_level(std::min(std::max(initial_level, m_min_level), m_max_level)),
+    m_level(m_base_level),
+    m_direction(1),
+    m_probing(false),
+    m_hold(0) { }
+
+uint32_t
+concurrency_controller::level() const {
+    return m_level;
+}
+
+bool
+concurrency_controller::enabled() const {
+    return m_min_level != m_max_level;
+}
+
+uint32_t
+concurrency_controller::update(double throughput) {
+
+    if(!enabled() || throughput < 0) {
+        return m_level;
+    }
+
+    auto it = m_estimates.find(m_level);
+
+    if(it == m_estimates.end()) {
+        m_estimates.emplace(m_level, throughput);
+    }
+    else {
+        it->second = ewma_alpha * throughput + (1 - ewma_alpha) * it->second;
+    }
+
+    if(m_probing) {
+        m_probing = false;
+
+        const auto base_it = m_estimates.find(m_base_level);
+        const double base = 
+            (base_it != m_estimates.end() ? base_it->second : 0.0);
+
+        // the probed level is better: move there and keep going in 
+        // the same direction
+        if(m_estimates[m_level] > base * (1 + m_tolerance)) {
+            m_base_level = m_level;
+            return probe();
+        }
+
+        // otherwise, go back to the base level and try the other 
+        // direction after a while
+        m_level = m_base_level;
+        m_direction = -m_direction;
+        m_hold = m_hold_periods;
+        return m_level;
+    }
+
+    if(m_hold > 0) {
+        --m_hold;
+        return m_level;
+    }
+
+    return probe();
+}
+
+uint32_t
+concurrency_controller::probe() {
+
+    for(int attempt = 0; attempt < 2; ++attempt) {
+
+        const int64_t next = static_cast<int64_t>(m_base_level) + m_direction;
+
+        if(next >= m_min_level && next <= m_max_level) {
+            m_level = static_cast<uint32_t>(next);
+            m_probing = true;
+            return m_level;
+        }
+
+        m_direction = -m_direction;
+    }
+
+    m_level = m_base_level;
+    return m_level;
+}
+
+} // namespace io
+} // namespace norns
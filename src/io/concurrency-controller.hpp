@@ -0,0 +1,98 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#ifndef __IO_CONCURRENCY_CONTROLLER_HPP__
+#define __IO_CONCURRENCY_CONTROLLER_HPP__
+
+#include <cstdint>
+#include <map>
+
+namespace norns {
+namespace io {
+
+/*! Hill-climbing controller that searches for the number of concurrent 
+ * workers that maximizes the aggregate throughput of a worker pool. 
+ *
+ * The controller is fed periodically with the throughput observed at the
+ * current concurrency level. Starting from a base level, it probes a 
+ * neighbouring level and moves the base there if throughput improves 
+ * by more than a configurable tolerance. Otherwise, it goes back to the 
+ * base level, reverses the search direction and holds for a few periods 
+ * before probing again, so that it can react to changes in the workload.
+ * Throughput estimates for each level are smoothed with an EWMA. */
+struct concurrency_controller {
+
+    concurrency_controller(uint32_t min_level, 
+                           uint32_t max_level, 
+                           uint32_t initial_level,
+                           double tolerance = 0.05,
+                           uint32_t hold_periods = 5);
+
+    /*! Return the concurrency level currently in effect */
+    uint32_t
+    level() const;
+
+    /*! Return true if the controller can change the concurrency level */
+    bool
+    enabled() const;
+
+    /*! Feed the aggregate throughput observed during the last period and
+     * return the concurrency level that should be used for the next one */
+    uint32_t
+    update(double throughput);
+
+private:
+    uint32_t
+    probe();
+
+    const uint32_t m_min_level;
+    const uint32_t m_max_level;
+    const double m_tolerance;
+    const uint32_t m_hold_periods;
+
+    uint32_t m_base_level;
+    uint32_t m_level;
+    int m_direction;
+    bool m_probing;
+    uint32_t m_hold;
+    std::map<uint32_t, double> m_estimates;
+};
+
+} // namespace io
+} // namespace norns
+
+#endif /* __IO_CONCURRENCY_CONTROLLER_HPP__ */
@@ -0,0 +1,186 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <algorithm>
+#include <thread>
+#include "rate-limiter.hpp"
+
+namespace {
+
+// bounds for the chunk size recommended by a rate_limiter
+constexpr const std::size_t min_chunk_size = 64*1024;
+constexpr const std::size_t max_chunk_size = 8*1024*1024;
+
+// fraction of a second that should be transferred in each chunk 
+constexpr const uint64_t chunks_per_second = 10;
+
+} // anonymous namespace
+
+namespace norns {
+namespace io {
+
+token_bucket::token_bucket(uint64_t rate, uint64_t burst) :
+    m_rate(rate),
+    m_burst(std::max(burst, static_cast<uint64_t>(1))),
+    m_tokens(static_cast<double>(m_burst)),
+    m_last_refill(clock::now()) { }
+
+uint64_t
+token_bucket::rate() const {
+    return m_rate;
+}
+
+uint64_t
+token_bucket::burst() const {
+    return m_burst;
+}
+
+void
+token_bucket::consume(std::size_t nbytes) {
+
+    if(m_rate == 0 || nbytes == 0) {
+        return;
+    }
+
+    double debt = 0.0;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        const auto now = clock::now();
+        const double elapsed = 
+            std::chrono::duration<double>(now - m_last_refill).count();
+
+        m_tokens = std::min(m_tokens + elapsed * m_rate, 
+                            static_cast<double>(m_burst));
+        m_last_refill = now;
+        m_tokens -= static_cast<double>(nbytes);
+
+        if(m_tokens < 0) {
+            debt = -m_tokens;
+        }
+    }
+
+    if(debt > 0) {
+        std::this_thread::sleep_for(
+                std::chrono::duration<double>(debt / m_rate));
+    }
+}
+
+rate_limiter::rate_limiter(
+        const std::vector<std::shared_ptr<token_bucket>>& buckets) :
+    m_buckets(buckets) { }
+
+bool
+rate_limiter::enabled() const {
+    return !m_buckets.empty();
+}
+
+std::size_t
+rate_limiter::chunk_size() const {
+
+    if(m_buckets.empty()) {
+        return 0;
+    }
+
+    uint64_t min_rate = m_buckets.front()->rate();
+
+    for(const auto& b : m_buckets) {
+        min_rate = std::min(min_rate, b->rate());
+    }
+
+    return std::min(std::max(static_cast<std::size_t>(
+                        min_rate / chunks_per_second), min_chunk_size), 
+                    max_chunk_size);
+}
+
+void
+rate_limiter::consume(std::size_t nbytes) const {
+    for(const auto& b : m_buckets) {
+        b->consume(nbytes);
+    }
+}
+
+void
+rate_limit_registry::add(const std::string& nsid, uint64_t rate) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ns_buckets[nsid] = std::make_shared<token_bucket>(rate, rate);
+}
+
+void
+rate_limit_registry::add(const std::string& src_nsid, 
+                         const std::string& dst_nsid, uint64_t rate) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pair_buckets[std::make_pair(src_nsid, dst_nsid)] = 
+        std::make_shared<token_bucket>(rate, rate);
+}
+
+bool
+rate_limit_registry::empty() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pair_buckets.empty() && m_ns_buckets.empty();
+}
+
+rate_limiter
+rate_limit_registry::get(const std::string& src_nsid, 
+                         const std::string& dst_nsid) const {
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::shared_ptr<token_bucket>> buckets;
+
+    const auto it = 
+        m_pair_buckets.find(std::make_pair(src_nsid, dst_nsid));
+
+    if(it != m_pair_buckets.end()) {
+        buckets.push_back(it->second);
+    }
+
+    for(const auto& nsid : {src_nsid, dst_nsid}) {
+        const auto it = m_ns_buckets.find(nsid);
+
+        if(it != m_ns_buckets.end() && 
+           std::find(buckets.begin(), buckets.end(), it->second) == 
+                buckets.end()) {
+            buckets.push_back(it->second);
+        }
+    }
+
+    return rate_limiter(buckets);
+}
+
+} // namespace io
+} // namespace norns
@@ -0,0 +1,143 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#ifndef __IO_RATE_LIMITER_HPP__
+#define __IO_RATE_LIMITER_HPP__
+
+#include <cstdint>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace norns {
+namespace io {
+
+/*! A thread-safe token bucket that limits the number of bytes per second 
+ * that can be transferred by all the tasks sharing it. Tokens are refilled 
+ * continuously at 'rate' bytes per second up to 'burst' bytes. Consumers 
+ * are allowed to go into debt, in which case they are put to sleep until 
+ * the debt is repaid. This ensures that large requests are not starved by 
+ * smaller ones */
+struct token_bucket {
+
+    using clock = std::chrono::steady_clock;
+
+    token_bucket(uint64_t rate, uint64_t burst);
+
+    uint64_t 
+    rate() const;
+
+    uint64_t
+    burst() const;
+
+    /*! Take 'nbytes' tokens from the bucket, blocking the calling thread 
+     * until they are available */
+    void 
+    consume(std::size_t nbytes);
+
+private:
+    const uint64_t m_rate;
+    const uint64_t m_burst;
+    std::mutex m_mutex;
+    double m_tokens;
+    clock::time_point m_last_refill;
+};
+
+/*! The set of token buckets that apply to a specific task. An empty 
+ * rate_limiter does not throttle anything */
+struct rate_limiter {
+
+    rate_limiter() = default;
+    explicit rate_limiter(
+            const std::vector<std::shared_ptr<token_bucket>>& buckets);
+
+    bool 
+    enabled() const;
+
+    /*! Recommended size for each transfer chunk, so that consumers block 
+     * often enough for the limits to be smooth. Returns 0 if the limiter 
+     * is not enabled (i.e. data can be transferred in a single chunk) */
+    std::size_t 
+    chunk_size() const;
+
+    /*! Block until 'nbytes' can be transferred without exceeding any of 
+     * the configured limits */
+    void 
+    consume(std::size_t nbytes) const;
+
+private:
+    std::vector<std::shared_ptr<token_bucket>> m_buckets;
+};
+
+/*! Registry of the configured bandwidth limits, both per namespace and per 
+ * (source namespace, destination namespace) pair */
+struct rate_limit_registry {
+
+    /*! Limit the aggregated bandwidth of all transfers reading from or 
+     * writing to 'nsid' */
+    void 
+    add(const std::string& nsid, uint64_t rate);
+
+    /*! Limit the aggregated bandwidth of all transfers from 'src_nsid' to 
+     * 'dst_nsid' */
+    void 
+    add(const std::string& src_nsid, const std::string& dst_nsid, 
+        uint64_t rate);
+
+    /*! Build a rate_limiter with all the limits that apply to a transfer 
+     * from 'src_nsid' to 'dst_nsid' */
+    rate_limiter
+    get(const std::string& src_nsid, const std::string& dst_nsid) const;
+
+    /*! Return true if no limits have been registered */
+    bool
+    empty() const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::map<std::string, std::shared_ptr<token_bucket>> m_ns_buckets;
+    std::map<std::pair<std::string, std::string>, 
+             std::shared_ptr<token_bucket>> m_pair_buckets;
+};
+
+} // namespace io
+} // namespace norns
+
+#endif /* __IO_RATE_LIMITER_HPP__ */
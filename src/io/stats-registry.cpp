@@ -0,0 +1,919 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <tuple>
+#include <vector>
+#include "task-info.hpp"
+#include "task-stats.hpp"
+#include "stats-registry.hpp"
+
+namespace {
+
+using norns::io::num_size_classes;
+
+constexpr static const double MiB = 1024*1024;
+
+// task_info::m_pair_slot records the size class in which a task has been
+// accounted, and whether it has been accounted as queued or running
+constexpr static const uint32_t no_slot = 
+    std::numeric_limits<uint32_t>::max();
+
+uint32_t
+queued_slot(std::size_t sc) {
+    return sc;
+}
+
+uint32_t
+running_slot(std::size_t sc) {
+    return num_size_classes + sc;
+}
+
+bool
+is_running_slot(uint32_t slot) {
+    return slot != no_slot && slot >= num_size_classes;
+}
+
+std::size_t
+class_of(uint32_t slot) {
+    return slot % num_size_classes;
+}
+
+bool
+is_active(norns::io::task_status st) {
+    return st == norns::io::task_status::pending || 
+           st == norns::io::task_status::running;
+}
+
+// update an exponentially weighted moving average. Until 1/alpha samples 
+// have been seen, this computes a plain average so that the first samples
+// are not given too much weight
+void
+update_average(double& avg, uint32_t& nsamples, double sample, double alpha) {
+
+    if(nsamples == 0 || std::isnan(avg)) {
+        avg = sample;
+    }
+    else {
+        const double w = std::max(alpha, 1.0 / (nsamples + 1));
+        avg += w * (sample - avg);
+    }
+
+    if(nsamples != std::numeric_limits<uint32_t>::max()) {
+        ++nsamples;
+    }
+}
+
+bool
+parse_double(const std::string& str, double& value) {
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtod(str.c_str(), &end);
+    return errno == 0 && end != str.c_str() && *end == '\0';
+}
+
+bool
+parse_uint32(const std::string& str, uint32_t& value) {
+    char* end = nullptr;
+    errno = 0;
+    const unsigned long v = std::strtoul(str.c_str(), &end, 10);
+
+    if(errno != 0 || end == str.c_str() || *end != '\0' ||
+       v > std::numeric_limits<uint32_t>::max()) {
+        return false;
+    }
+
+    value = static_cast<uint32_t>(v);
+    return true;
+}
+
+// fields in a models file are separated by tabs and nsids may contain any 
+// character, so escape the ones that would break the format ('#' too, so 
+// that an nsid can't be mistaken for a comment)
+std::string
+escape_nsid(const std::string& nsid) {
+
+    std::string out;
+    out.reserve(nsid.size());
+
+    for(const char c : nsid) {
+        switch(c) {
+            case '\\': out += "\\\\"; break;
+            case '\t': out += "\\t"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '#': out += "\\#"; break;
+            default: out += c;
+        }
+    }
+
+    return out;
+}
+
+bool
+unescape_nsid(const std::string& str, std::string& nsid) {
+
+    nsid.clear();
+    nsid.reserve(str.size());
+
+    for(std::size_t i = 0; i < str.size(); ++i) {
+
+        if(str[i] != '\\') {
+            nsid += str[i];
+            continue;
+        }
+
+        if(++i == str.size()) {
+            return false;
+        }
+
+        switch(str[i]) {
+            case '\\': nsid += '\\'; break;
+            case 't': nsid += '\t'; break;
+            case 'n': nsid += '\n'; break;
+            case 'r': nsid += '\r'; break;
+            case '#': nsid += '#'; break;
+            default: return false;
+        }
+    }
+
+    return true;
+}
+
+} // anonymous namespace
+
+namespace norns {
+namespace io {
+
+std::size_t
+size_class(std::size_t bytes) {
+
+    std::size_t sc = 0;
+
+    for(std::size_t limit = 64*1024; 
+        sc < num_size_classes - 1 && bytes >= limit; limit *= 16) {
+        ++sc;
+    }
+
+    return sc;
+}
+
+void
+task_latencies::record(const task_info& tinfo) {
+
+    using std::chrono::steady_clock;
+
+    const auto submitted = tinfo.phase_time(task_phase::submitted);
+    const auto dequeued = tinfo.phase_time(task_phase::dequeued);
+    const auto resolved = tinfo.phase_time(task_phase::resolved);
+    const auto completed = tinfo.phase_time(task_phase::completed);
+    const steady_clock::time_point none{};
+
+    const auto histogram = [&](latency_phase p) -> utils::latency_histogram& {
+        return m_histograms[static_cast<std::size_t>(p)];
+    };
+
+    histogram(latency_phase::total).record(completed - submitted);
+
+    if(dequeued == none) {
+        return;
+    }
+
+    histogram(latency_phase::queued).record(dequeued - submitted);
+
+    if(resolved == none) {
+        return;
+    }
+
+    auto started = tinfo.phase_time(task_phase::started);
+
+    if(started == none) {
+        started = resolved;
+    }
+
+    histogram(latency_phase::resolve).record(resolved - dequeued);
+    histogram(latency_phase::setup).record(started - resolved);
+    histogram(latency_phase::transfer).record(completed - started);
+}
+
+const utils::latency_histogram&
+task_latencies::get(latency_phase p) const {
+    return m_histograms[static_cast<std::size_t>(p)];
+}
+
+latency_stats
+summarize(latency_stats::scope sc, const std::string& name, 
+          latency_phase phase, const utils::latency_histogram& h) {
+
+    // histograms are kept in microseconds
+    constexpr const double usec = 1e-6;
+
+    return latency_stats(sc, name, phase, h.count(), h.mean() * usec, 
+                         h.percentile(0.50) * usec, 
+                         h.percentile(0.90) * usec, 
+                         h.percentile(0.99) * usec, 
+                         h.max() * usec);
+}
+
+bandwidth_model::bandwidth_model() :
+    m_overhead(std::numeric_limits<double>::quiet_NaN()),
+    m_overhead_samples(0) {
+
+    m_bandwidth.fill(std::numeric_limits<double>::quiet_NaN());
+    m_samples.fill(0);
+}
+
+pair_stats::pair_stats(std::size_t backlog_size) :
+    m_running_tasks(0),
+    m_transferred_bytes(0),
+    m_alpha(backlog_size == 0 ? 0.0 : 2.0 / (backlog_size + 1)) {
+
+    for(std::size_t sc = 0; sc < num_size_classes; ++sc) {
+        m_queued_tasks[sc].store(0);
+        m_queued_bytes[sc].store(0);
+        m_running_bytes[sc].store(0);
+    }
+}
+
+void
+pair_stats::record_transfer(std::size_t bytes, double secs) {
+
+    // also rejects NaNs
+    if(m_alpha == 0.0 || !(secs > 0.0)) {
+        return;
+    }
+
+    const double mib = static_cast<double>(bytes) / MiB;
+    const std::size_t sc = size_class(bytes);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // the duration of the smallest transfers is dominated by the per-task 
+    // overhead, so use them to estimate it
+    if(sc == 0) {
+        const double bw = bandwidth_for(sc);
+        double overhead = secs;
+
+        if(!std::isnan(bw) && bw > 0.0) {
+            overhead = std::max(0.0, secs - mib / bw);
+        }
+
+        update_average(m_model.m_overhead, m_model.m_overhead_samples, 
+                       overhead, m_alpha);
+        return;
+    }
+
+    double streaming = secs;
+
+    if(!std::isnan(m_model.m_overhead)) {
+        streaming -= m_model.m_overhead;
+    }
+
+    // don't let an inaccurate overhead turn a single sample into an 
+    // unrealistic bandwidth
+    streaming = std::max(streaming, secs / 2);
+
+    update_average(m_model.m_bandwidth[sc], m_model.m_samples[sc], 
+                   mib / streaming, m_alpha);
+}
+
+double
+pair_stats::streaming_time(std::size_t task_bytes, std::size_t bytes) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return estimate(size_class(task_bytes), 0, bytes);
+}
+
+double
+pair_stats::predict(std::size_t bytes, std::size_t ntasks) const {
+
+    ntasks = std::max<std::size_t>(ntasks, 1);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return estimate(size_class(bytes / ntasks), ntasks, bytes);
+}
+
+double
+pair_stats::bandwidth(std::size_t sc) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return bandwidth_for(sc);
+}
+
+double
+pair_stats::backlog() const {
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    double secs = 0.0;
+
+    for(std::size_t sc = 0; sc < num_size_classes; ++sc) {
+        secs += estimate(sc, m_queued_tasks[sc].load(), 
+                         m_queued_bytes[sc].load() + 
+                         m_running_bytes[sc].load());
+    }
+
+    return secs;
+}
+
+bandwidth_model
+pair_stats::model() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_model;
+}
+
+void
+pair_stats::set_model(const bandwidth_model& model) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_model = model;
+}
+
+// N.B. m_mutex must be held
+double
+pair_stats::bandwidth_for(std::size_t sc) const {
+
+    // prefer the smaller of two equally distant classes, since it gives the
+    // more conservative estimation
+    for(std::size_t d = 0; d < num_size_classes; ++d) {
+        if(sc >= d && m_model.m_samples[sc - d] != 0) {
+            return m_model.m_bandwidth[sc - d];
+        }
+
+        if(sc + d < num_size_classes && m_model.m_samples[sc + d] != 0) {
+            return m_model.m_bandwidth[sc + d];
+        }
+    }
+
+    return std::numeric_limits<double>::quiet_NaN();
+}
+
+// N.B. m_mutex must be held
+double
+pair_stats::estimate(std::size_t sc, std::size_t ntasks, 
+                     std::size_t bytes) const {
+
+    const double bw = bandwidth_for(sc);
+    const bool has_overhead = m_model.m_overhead_samples != 0;
+
+    if(ntasks == 0 && bytes == 0) {
+        return 0.0;
+    }
+
+    // for the smallest transfers, the overhead alone is a good estimation
+    if(std::isnan(bw) && !(sc == 0 && has_overhead)) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    double secs = has_overhead ? ntasks * m_model.m_overhead : 0.0;
+
+    if(!std::isnan(bw) && bw > 0.0) {
+        secs += (static_cast<double>(bytes) / MiB) / bw;
+    }
+
+    return secs;
+}
+
+stats_registry::stats_registry(std::size_t backlog_size) :
+    m_backlog_size(backlog_size),
+    m_pending_tasks(0),
+    m_running_tasks(0),
+    m_finished_tasks(0),
+    m_deadline_tasks(0),
+    m_succeeded_tasks_total(0),
+    m_failed_tasks_total(0) { }
+
+std::shared_ptr<pair_stats>
+stats_registry::get(const std::string& src_nsid, const std::string& dst_nsid) {
+
+    if(const auto ps = find(src_nsid, dst_nsid)) {
+        return ps;
+    }
+
+    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
+
+    auto& ps = m_pairs[src_nsid][dst_nsid];
+
+    if(!ps) {
+        ps = std::make_shared<pair_stats>(m_backlog_size);
+    }
+
+    return ps;
+}
+
+std::shared_ptr<pair_stats>
+stats_registry::find(const std::string& src_nsid, 
+                     const std::string& dst_nsid) const {
+
+    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+
+    const auto it = m_pairs.find(src_nsid);
+
+    if(it != m_pairs.end()) {
+        const auto it2 = it->second.find(dst_nsid);
+
+        if(it2 != it->second.end()) {
+            return it2->second;
+        }
+    }
+
+    return nullptr;
+}
+
+void
+stats_registry::task_created(task_info& tinfo) {
+
+    enter(tinfo, task_status::pending);
+
+    if(tinfo.deadline()) {
+        ++m_deadline_tasks;
+    }
+}
+
+void
+stats_registry::status_changed(task_info& tinfo, 
+                               task_status from, task_status to) {
+
+    if(from == to) {
+        return;
+    }
+
+    leave(tinfo, from);
+    enter(tinfo, to);
+
+    if(tinfo.deadline() && is_active(from) && !is_active(to)) {
+        --m_deadline_tasks;
+    }
+
+    if(to == task_status::finished || to == task_status::finished_with_error) {
+
+        if(to == task_status::finished) {
+            m_succeeded_tasks_total.fetch_add(1, std::memory_order_relaxed);
+        }
+        else {
+            m_failed_tasks_total.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        m_type_latencies[static_cast<std::size_t>(tinfo.type())].record(tinfo);
+
+        if(tinfo.m_pair_stats) {
+            tinfo.m_pair_stats->m_latencies.record(tinfo);
+        }
+    }
+}
+
+void
+stats_registry::task_destroyed(task_info& tinfo, task_status st) {
+
+    leave(tinfo, st);
+
+    if(tinfo.deadline() && is_active(st)) {
+        --m_deadline_tasks;
+    }
+}
+
+void
+stats_registry::enter(task_info& tinfo, task_status st) {
+
+    const auto& ps = tinfo.m_pair_stats;
+    const std::size_t total = tinfo.total_bytes();
+    const std::size_t sc = size_class(total);
+
+    switch(st) {
+        case task_status::pending:
+            ++m_pending_tasks;
+
+            if(ps) {
+                ++ps->m_queued_tasks[sc];
+                tinfo.m_pair_pending.store(total);
+                ps->m_queued_bytes[sc] += total;
+                tinfo.m_pair_slot.store(queued_slot(sc));
+            }
+            break;
+
+        case task_status::running:
+            ++m_running_tasks;
+
+            if(ps) {
+                const std::size_t sent = tinfo.sent_bytes();
+                const uint64_t pending = sent < total ? total - sent : 0;
+
+                ++ps->m_running_tasks;
+                tinfo.m_pair_pending.store(pending);
+                ps->m_running_bytes[sc] += pending;
+                tinfo.m_pair_slot.store(running_slot(sc));
+            }
+            break;
+
+        case task_status::finished:
+        case task_status::finished_with_error:
+            ++m_finished_tasks;
+            break;
+
+        default:
+            break;
+    }
+}
+
+void
+stats_registry::leave(task_info& tinfo, task_status st) {
+
+    const auto& ps = tinfo.m_pair_stats;
+
+    switch(st) {
+        case task_status::pending:
+            --m_pending_tasks;
+            break;
+
+        case task_status::running:
+            --m_running_tasks;
+            break;
+
+        case task_status::finished:
+        case task_status::finished_with_error:
+            --m_finished_tasks;
+            return;
+
+        default:
+            return;
+    }
+
+    if(!ps) {
+        return;
+    }
+
+    const uint32_t slot = tinfo.m_pair_slot.exchange(no_slot);
+
+    if(slot == no_slot) {
+        return;
+    }
+
+    const std::size_t sc = class_of(slot);
+
+    // whatever the task didn't transfer is no longer pending
+    if(is_running_slot(slot)) {
+        --ps->m_running_tasks;
+        ps->m_running_bytes[sc] -= tinfo.m_pair_pending.exchange(0);
+        return;
+    }
+
+    --ps->m_queued_tasks[sc];
+    ps->m_queued_bytes[sc] -= tinfo.m_pair_pending.exchange(0);
+}
+
+void
+stats_registry::total_bytes_changed(task_info& tinfo) {
+
+    const auto& ps = tinfo.m_pair_stats;
+
+    if(!ps) {
+        return;
+    }
+
+    const uint32_t slot = tinfo.m_pair_slot.load();
+
+    if(slot == no_slot) {
+        return;
+    }
+
+    // the task stays in the size class it was accounted in
+    const std::size_t sc = class_of(slot);
+    const std::size_t total = tinfo.total_bytes();
+
+    if(is_running_slot(slot)) {
+        const std::size_t sent = tinfo.sent_bytes();
+        const uint64_t pending = sent < total ? total - sent : 0;
+
+        ps->m_running_bytes[sc] += pending;
+        ps->m_running_bytes[sc] -= tinfo.m_pair_pending.exchange(pending);
+        return;
+    }
+
+    ps->m_queued_bytes[sc] += total;
+    ps->m_queued_bytes[sc] -= tinfo.m_pair_pending.exchange(total);
+}
+
+void
+stats_registry::progress(task_info& tinfo, std::size_t bytes) {
+
+    const auto& ps = tinfo.m_pair_stats;
+
+    if(!ps) {
+        return;
+    }
+
+    ps->m_transferred_bytes.fetch_add(bytes, std::memory_order_relaxed);
+
+    const uint32_t slot = tinfo.m_pair_slot.load();
+
+    if(!is_running_slot(slot)) {
+        return;
+    }
+
+    // only subtract what the task contributed to the pair when it started 
+    // running: tasks may transfer more bytes than expected, or report them
+    // after they have finished
+    uint64_t current = tinfo.m_pair_pending.load();
+    uint64_t delta;
+
+    do {
+        delta = std::min<uint64_t>(current, bytes);
+
+        if(delta == 0) {
+            return;
+        }
+    } while(!tinfo.m_pair_pending.compare_exchange_weak(current, 
+                                                        current - delta));
+
+    ps->m_running_bytes[class_of(slot)] -= delta;
+}
+
+uint32_t
+stats_registry::pending_tasks() const {
+    return m_pending_tasks.load();
+}
+
+uint32_t
+stats_registry::running_tasks() const {
+    return m_running_tasks.load();
+}
+
+uint32_t
+stats_registry::finished_tasks() const {
+    return m_finished_tasks.load();
+}
+
+uint32_t
+stats_registry::tasks_with_deadline() const {
+    return m_deadline_tasks.load();
+}
+
+uint64_t
+stats_registry::succeeded_tasks_total() const {
+    return m_succeeded_tasks_total.load(std::memory_order_relaxed);
+}
+
+uint64_t
+stats_registry::failed_tasks_total() const {
+    return m_failed_tasks_total.load(std::memory_order_relaxed);
+}
+
+void
+stats_registry::for_each_pair(
+        const std::function<void(const std::string&, const std::string&, 
+                                 const pair_stats&)>& fn) const {
+
+    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+
+    for(const auto& kv : m_pairs) {
+        for(const auto& kv2 : kv.second) {
+            fn(kv.first, kv2.first, *kv2.second);
+        }
+    }
+}
+
+double
+stats_registry::eta() const {
+
+    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+
+    double eta = 0.0;
+
+    for(const auto& kv : m_pairs) {
+        for(const auto& kv2 : kv.second) {
+
+            const auto& ps = kv2.second;
+            const double backlog = ps->backlog();
+
+            // we can't estimate the ETA reliably
+            if(std::isnan(backlog)) {
+                return std::numeric_limits<double>::quiet_NaN();
+            }
+
+            if(backlog == 0.0) {
+                continue;
+            }
+
+            const uint32_t running = 
+                std::max<uint32_t>(ps->m_running_tasks.load(), 1);
+
+            eta = std::max(eta, backlog / running);
+        }
+    }
+
+    return eta;
+}
+
+std::vector<latency_stats>
+stats_registry::latencies() const {
+
+    std::vector<latency_stats> lstats;
+
+    const auto add = [&](latency_stats::scope sc, const std::string& name,
+                         const task_latencies& tl) {
+
+        for(std::size_t i = 0; i < num_task_latency_phases; ++i) {
+            const auto phase = static_cast<latency_phase>(i);
+            const auto& h = tl.get(phase);
+
+            if(h.count() != 0) {
+                lstats.push_back(summarize(sc, name, phase, h));
+            }
+        }
+    };
+
+    for(std::size_t i = 0; i < num_task_types; ++i) {
+        add(latency_stats::scope::task_type, 
+            utils::to_string(static_cast<iotask_type>(i)), 
+            m_type_latencies[i]);
+    }
+
+    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+
+    for(const auto& kv : m_pairs) {
+        for(const auto& kv2 : kv.second) {
+            add(latency_stats::scope::ns_pair, kv.first + " => " + kv2.first, 
+                kv2.second->m_latencies);
+        }
+    }
+
+    return lstats;
+}
+
+// models are saved as one line per pair of namespaces:
+//   src_nsid dst_nsid overhead samples (bandwidth samples){num_size_classes}
+// where unknown values are saved as 'nan'
+std::error_code
+stats_registry::save_models(const std::string& path) const {
+
+    const std::string tmp_path = path + ".tmp";
+
+    {
+        std::ofstream out(tmp_path, std::ios::trunc);
+
+        if(!out) {
+            return std::error_code(errno, std::generic_category());
+        }
+
+        out << "# src_nsid\tdst_nsid\toverhead\tsamples\t"
+               "[bandwidth\tsamples] x " << num_size_classes << "\n";
+        out << std::setprecision(std::numeric_limits<double>::max_digits10);
+
+        boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+
+        for(const auto& kv : m_pairs) {
+            for(const auto& kv2 : kv.second) {
+
+                const auto model = kv2.second->model();
+
+                out << escape_nsid(kv.first) << '\t' 
+                    << escape_nsid(kv2.first) << '\t' 
+                    << model.m_overhead << '\t' << model.m_overhead_samples;
+
+                for(std::size_t sc = 0; sc < num_size_classes; ++sc) {
+                    out << '\t' << model.m_bandwidth[sc] 
+                        << '\t' << model.m_samples[sc];
+                }
+
+                out << "\n";
+            }
+        }
+
+        out.flush();
+
+        if(!out) {
+            std::remove(tmp_path.c_str());
+            return std::make_error_code(std::errc::io_error);
+        }
+    }
+
+    // make sure that a crash never leaves a partially written file behind
+    if(std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        const std::error_code ec(errno, std::generic_category());
+        std::remove(tmp_path.c_str());
+        return ec;
+    }
+
+    return std::error_code();
+}
+
+std::error_code
+stats_registry::load_models(const std::string& path) {
+
+    std::ifstream in(path);
+
+    if(!in) {
+        return std::error_code(errno, std::generic_category());
+    }
+
+    using entry = std::tuple<std::string, std::string, bandwidth_model>;
+    std::vector<entry> entries;
+    std::string line;
+
+    // parse the whole file before updating anything, so that a corrupted 
+    // file doesn't leave models partially loaded
+    while(std::getline(in, line)) {
+
+        if(line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        std::istringstream iss(line);
+        std::vector<std::string> tokens;
+        std::string tok;
+
+        while(std::getline(iss, tok, '\t')) {
+            tokens.push_back(tok);
+        }
+
+        if(tokens.size() != 4 + 2 * num_size_classes) {
+            return std::make_error_code(std::errc::invalid_argument);
+        }
+
+        bandwidth_model model;
+
+        if(!parse_double(tokens[2], model.m_overhead) || 
+           !parse_uint32(tokens[3], model.m_overhead_samples) ||
+           model.m_overhead < 0.0) {
+            return std::make_error_code(std::errc::invalid_argument);
+        }
+
+        for(std::size_t sc = 0; sc < num_size_classes; ++sc) {
+            if(!parse_double(tokens[4 + 2*sc], model.m_bandwidth[sc]) ||
+               !parse_uint32(tokens[5 + 2*sc], model.m_samples[sc]) ||
+               model.m_bandwidth[sc] <= 0.0) {
+                return std::make_error_code(std::errc::invalid_argument);
+            }
+
+            // a class without samples must not be used for estimations
+            if(std::isnan(model.m_bandwidth[sc])) {
+                model.m_samples[sc] = 0;
+            }
+        }
+
+        if(std::isnan(model.m_overhead)) {
+            model.m_overhead_samples = 0;
+        }
+
+        std::string src_nsid, dst_nsid;
+
+        if(!unescape_nsid(tokens[0], src_nsid) ||
+           !unescape_nsid(tokens[1], dst_nsid)) {
+            return std::make_error_code(std::errc::invalid_argument);
+        }
+
+        entries.emplace_back(src_nsid, dst_nsid, model);
+    }
+
+    if(in.bad()) {
+        return std::make_error_code(std::errc::io_error);
+    }
+
+    for(const auto& e : entries) {
+        get(std::get<0>(e), std::get<1>(e))->set_model(std::get<2>(e));
+    }
+
+    return std::error_code();
+}
+
+} // namespace io
+} // namespace norns
@@ -0,0 +1,309 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#ifndef __IO_STATS_REGISTRY_HPP__
+#define __IO_STATS_REGISTRY_HPP__
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+#include <boost/thread/shared_mutex.hpp>
+#include "common.hpp"
+#include "task-stats.hpp"
+#include "utils/latency-histogram.hpp"
+
+namespace norns {
+namespace io {
+
+// forward declarations
+struct task_info;
+
+/*! Transfers are classified by size so that the bandwidth achieved by small
+ * transfers does not affect the estimations for large ones (and vice versa).
+ * Classes are [0, 64KiB), [64KiB, 1MiB), [1MiB, 16MiB), [16MiB, 256MiB) and
+ * [256MiB, inf) */
+constexpr static const std::size_t num_size_classes = 5;
+
+std::size_t
+size_class(std::size_t bytes);
+
+/*! Parameters of the bandwidth model for a pair of namespaces: the time 
+ * required to transfer 'n' bytes is modelled as 
+ * overhead + n / bandwidth[size_class(n)], where the overhead is the fixed 
+ * cost incurred by each task (e.g. opening files, allocating resources).
+ * Unknown parameters are NaN */
+struct bandwidth_model {
+
+    bandwidth_model();
+
+    // per-task overhead (in seconds) and number of samples it's based on
+    double m_overhead;
+    uint32_t m_overhead_samples;
+
+    // streaming bandwidth (MiB/s) for each size class and number of samples
+    // each of them is based on
+    std::array<double, num_size_classes> m_bandwidth;
+    std::array<uint32_t, num_size_classes> m_samples;
+};
+
+/*! Latency histograms for the phases of a set of tasks */
+struct task_latencies {
+
+    /*! Record the duration of the phases of a task that has just finished.
+     * Phases that the task did not go through are not recorded (e.g. a
+     * task cancelled while queued only contributes to the 'total' phase), 
+     * and a task whose transferor does not report when it started moving 
+     * data is considered to start as soon as its resources are resolved */
+    void
+    record(const task_info& tinfo);
+
+    const utils::latency_histogram&
+    get(latency_phase p) const;
+
+    std::array<utils::latency_histogram, num_task_latency_phases> 
+        m_histograms;
+};
+
+/*! Summarize the latencies recorded in 'h' */
+latency_stats
+summarize(latency_stats::scope sc, const std::string& name, 
+          latency_phase phase, const utils::latency_histogram& h);
+
+/*! Statistics for the transfers between a pair of namespaces */
+struct pair_stats {
+
+    /*! Model parameters are updated as exponentially weighted moving 
+     * averages with the same center of mass as a simple average of the last
+     * 'backlog_size' samples */
+    explicit pair_stats(std::size_t backlog_size);
+
+    /*! Update the model with a task that transferred 'bytes' in 'secs' 
+     * seconds */
+    void
+    record_transfer(std::size_t bytes, double secs);
+
+    /*! Expected time (in seconds) required by a task of 'task_bytes' to 
+     * transfer 'bytes' of its data, not including the per-task overhead. 
+     * If no samples are available for the task's size class, the nearest 
+     * class with samples is used. Returns NaN if no estimation is possible */
+    double
+    streaming_time(std::size_t task_bytes, std::size_t bytes) const;
+
+    /*! Expected time (in seconds) required by 'ntasks' tasks to transfer a
+     * total of 'bytes' (evenly distributed among them) one after the other, 
+     * or NaN if no estimation is possible */
+    double
+    predict(std::size_t bytes, std::size_t ntasks = 1) const;
+
+    /*! Streaming bandwidth (MiB/s) used for estimations in size class 'sc', 
+     * or NaN if unknown */
+    double
+    bandwidth(std::size_t sc) const;
+
+    /*! Expected time (in seconds) required to complete all the queued and 
+     * running tasks between the pair if they were executed one after the 
+     * other. Returns NaN if there are such tasks but no estimation is 
+     * possible */
+    double
+    backlog() const;
+
+    bandwidth_model
+    model() const;
+
+    void
+    set_model(const bandwidth_model& model);
+
+    // number of running tasks
+    std::atomic<uint32_t> m_running_tasks;
+
+    // number of queued tasks and the bytes that they will transfer, and 
+    // bytes that running tasks still have to transfer, per size class
+    std::array<std::atomic<uint32_t>, num_size_classes> m_queued_tasks;
+    std::array<std::atomic<uint64_t>, num_size_classes> m_queued_bytes;
+    std::array<std::atomic<uint64_t>, num_size_classes> m_running_bytes;
+
+    // bytes transferred so far by all tasks between the pair
+    std::atomic<uint64_t> m_transferred_bytes;
+
+    // latencies of the tasks between the pair
+    task_latencies m_latencies;
+
+private:
+    double
+    bandwidth_for(std::size_t sc) const;
+
+    double
+    estimate(std::size_t sc, std::size_t ntasks, std::size_t bytes) const;
+
+    const double m_alpha;
+    mutable std::mutex m_mutex;
+    bandwidth_model m_model;
+};
+
+/*! Task statistics maintained incrementally as tasks are created and 
+ * change status, so that querying them does not require visiting all the
+ * tasks known to the daemon. task_infos report their own status changes 
+ * (see task_info::update_status()) */
+struct stats_registry {
+
+    explicit stats_registry(std::size_t backlog_size);
+
+    stats_registry(const stats_registry& other) = delete;
+    stats_registry& operator=(const stats_registry& other) = delete;
+
+    /*! Return the stats for transfers from src_nsid to dst_nsid, creating 
+     * them if needed */
+    std::shared_ptr<pair_stats>
+    get(const std::string& src_nsid, const std::string& dst_nsid);
+
+    /*! Return the stats for transfers from src_nsid to dst_nsid, or nullptr 
+     * if no task has been registered between them */
+    std::shared_ptr<pair_stats>
+    find(const std::string& src_nsid, const std::string& dst_nsid) const;
+
+    /*! Account for a new task (created with status pending) */
+    void
+    task_created(task_info& tinfo);
+
+    /*! Account for a task changing its status from 'from' to 'to' */
+    void
+    status_changed(task_info& tinfo, task_status from, task_status to);
+
+    /*! Account for a task being destroyed while in status 'st' (tasks 
+     * dropped before finishing, e.g. if they could not be enqueued, must 
+     * not be accounted as pending or running anymore) */
+    void
+    task_destroyed(task_info& tinfo, task_status st);
+
+    /*! Account for a change in the number of bytes that a task is expected
+     * to transfer (the task's status must not change in the meantime) */
+    void
+    total_bytes_changed(task_info& tinfo);
+
+    /*! Account for bytes transferred by a running task */
+    void
+    progress(task_info& tinfo, std::size_t bytes);
+
+    uint32_t
+    pending_tasks() const;
+
+    uint32_t
+    running_tasks() const;
+
+    /*! Number of finished tasks (successfully or not) that are still 
+     * alive, i.e. whose status has not been reaped yet */
+    uint32_t
+    finished_tasks() const;
+
+    /*! Number of pending or running tasks that have a deadline */
+    uint32_t
+    tasks_with_deadline() const;
+
+    /*! Number of tasks that have finished successfully (or with an error)
+     * since the registry was created, including those already reaped */
+    uint64_t
+    succeeded_tasks_total() const;
+
+    uint64_t
+    failed_tasks_total() const;
+
+    /*! Invoke 'fn(src_nsid, dst_nsid, stats)' for each pair of namespaces
+     * with registered tasks. 'fn' must not register new pairs */
+    void
+    for_each_pair(const std::function<void(const std::string&, 
+                                           const std::string&, 
+                                           const pair_stats&)>& fn) const;
+
+    /*! Estimated time (in seconds) to complete all pending and running 
+     * tasks, based on the bandwidth model for each pair of namespaces. 
+     * Tasks between the same pair are assumed to proceed concurrently over
+     * as many runners as tasks are currently running for the pair. Returns 
+     * NaN if no estimation is available for some of the pairs involved. 
+     * Cost is proportional to the number of namespace pairs, not tasks */
+    double
+    eta() const;
+
+    /*! Summaries of the latencies recorded for each task type and each 
+     * pair of namespaces (only phases with samples are reported) */
+    std::vector<latency_stats>
+    latencies() const;
+
+    /*! Save the bandwidth models for all namespace pairs to 'path' */
+    std::error_code
+    save_models(const std::string& path) const;
+
+    /*! Load bandwidth models previously saved with save_models() */
+    std::error_code
+    load_models(const std::string& path);
+
+private:
+    void
+    enter(task_info& tinfo, task_status st);
+
+    void
+    leave(task_info& tinfo, task_status st);
+
+    const std::size_t m_backlog_size;
+
+    std::atomic<uint32_t> m_pending_tasks;
+    std::atomic<uint32_t> m_running_tasks;
+    std::atomic<uint32_t> m_finished_tasks;
+    std::atomic<uint32_t> m_deadline_tasks;
+    std::atomic<uint64_t> m_succeeded_tasks_total;
+    std::atomic<uint64_t> m_failed_tasks_total;
+
+    // latencies of the tasks of each type
+    constexpr static const std::size_t num_task_types = 
+        static_cast<std::size_t>(iotask_type::unknown) + 1;
+    std::array<task_latencies, num_task_types> m_type_latencies;
+
+    mutable boost::shared_mutex m_mutex;
+    std::unordered_map<std::string, 
+        std::unordered_map<std::string, std::shared_ptr<pair_stats>>> m_pairs;
+};
+
+} // namespace io
+} // namespace norns
+
+#endif /* __IO_STATS_REGISTRY_HPP__ */
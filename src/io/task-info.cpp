@@ -42,6 +42,31 @@
 #include "task-info.hpp"
 #include "logger.hpp"
 
+namespace {
+
+// whether a change from status 'from' to status 'to' finishes a task
+bool
+finishes(norns::io::task_status from, norns::io::task_status to) {
+
+    using norns::io::task_status;
+
+    const auto is_finished = [](task_status st) {
+        return st == task_status::finished || 
+               st == task_status::finished_with_error;
+    };
+
+    return is_finished(to) && !is_finished(from);
+}
+
+// all task_info locks share the same record
+norns::utils::lock_stats&
+task_info_lock_stats() {
+    static auto& stats = norns::utils::lock_stats::named("task_info");
+    return stats;
+}
+
+} // anonymous namespace
+
 namespace norns {
 namespace io {
 
@@ -53,10 +78,24 @@ task_info::task_info(const iotask_id tid,
                      const resource_info_ptr src_rinfo,
                      const backend_ptr dst_backend, 
                      const resource_info_ptr dst_rinfo,
-                     const boost::any& ctx) :
+                     const boost::any& ctx,
+                     const iotask_priority priority,
+                     const boost::optional<iotask_deadline>& deadline,
+                     const rate_limiter& limiter,
+                     const std::vector<iotask_id>& parents,
+                     const int32_t numa_node,
+                     const bool direct_io,
+                     const std::shared_ptr<stats_registry>& registry) :
+    m_mutex(::task_info_lock_stats()),
     m_id(tid),
     m_type(type),
     m_is_remote(is_remote),
+    m_priority(priority),
+    m_deadline(deadline),
+    m_parents(parents),
+    m_numa_node(numa_node),
+    m_direct_io(direct_io),
+    m_limiter(limiter),
     m_auth(auth),
     m_src_backend(src_backend),
     m_src_rinfo(src_rinfo),
@@ -66,24 +105,46 @@ task_info::task_info(const iotask_id tid,
     m_status(task_status::pending),
     m_task_error(urd_error::success),
     m_sys_error(),
+    m_cancelled(false),
+    m_deadline_at_risk(false),
     m_bandwidth(std::numeric_limits<double>::quiet_NaN()),
-    m_sent_bytes(),
-    m_total_bytes() {
-
-    if(!src_rinfo) {
-        return;
+    m_sent_bytes(0),
+    m_total_bytes(0),
+    m_copy_engines(0),
+    m_stats_registry(registry),
+    m_pair_stats(registry && src_rinfo && dst_rinfo ? 
+                    registry->get(src_rinfo->nsid(), dst_rinfo->nsid()) :
+                    nullptr),
+    m_pair_pending(0),
+    m_pair_slot(std::numeric_limits<uint32_t>::max()) {
+
+    for(auto& ts : m_phases) {
+        ts.store(0, std::memory_order_relaxed);
     }
 
-    std::error_code ec;
-    m_total_bytes = src_backend->get_size(src_rinfo, ec);
+    mark(task_phase::submitted);
+
+    if(src_rinfo) {
+        std::error_code ec;
+        const std::size_t total_bytes = src_backend->get_size(src_rinfo, ec);
 
-    // make sure that m_total_bytes is 0 if an error occurred
-    if(ec) {
-        m_total_bytes = 0;
+        // m_total_bytes stays at 0 if the size can't be determined
+        if(!ec) {
+            m_total_bytes.store(total_bytes, std::memory_order_relaxed);
+        }
+    }
+
+    if(m_stats_registry) {
+        m_stats_registry->task_created(*this);
     }
 }
 
-task_info::~task_info() { }
+task_info::~task_info() { 
+
+    if(m_stats_registry) {
+        m_stats_registry->task_destroyed(*this, m_status);
+    }
+}
 
 iotask_id
 task_info::id() const {
@@ -100,6 +161,41 @@ task_info::is_remote() const {
     return m_is_remote;
 }
 
+iotask_priority
+task_info::priority() const {
+    return m_priority;
+}
+
+boost::optional<iotask_deadline>
+task_info::deadline() const {
+    return m_deadline;
+}
+
+const rate_limiter&
+task_info::limiter() const {
+    return m_limiter;
+}
+
+const std::vector<iotask_id>&
+task_info::parents() const {
+    return m_parents;
+}
+
+int32_t
+task_info::numa_node() const {
+    return m_numa_node;
+}
+
+bool
+task_info::direct_io() const {
+    return m_direct_io;
+}
+
+const std::shared_ptr<pair_stats>&
+task_info::pair_stats() const {
+    return m_pair_stats;
+}
+
 auth::credentials 
 task_info::auth() const {
     return m_auth;
@@ -146,13 +242,22 @@ task_info::clear_context() {
 
 task_status
 task_info::status() const {
-    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+    boost::shared_lock<utils::profiled_shared_mutex> lock(m_mutex);
     return m_status;
 }
 
 void
 task_info::update_status(const task_status st) {
-    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
+    boost::unique_lock<utils::profiled_shared_mutex> lock(m_mutex);
+
+    if(finishes(m_status, st)) {
+        mark(task_phase::completed);
+    }
+
+    if(m_stats_registry) {
+        m_stats_registry->status_changed(*this, m_status, st);
+    }
+
     m_status = st;
 }
 
@@ -160,7 +265,16 @@ void
 task_info::update_status(const task_status st, const urd_error ec, 
                          const std::error_code& sc) {
 
-    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
+    boost::unique_lock<utils::profiled_shared_mutex> lock(m_mutex);
+
+    if(finishes(m_status, st)) {
+        mark(task_phase::completed);
+    }
+
+    if(m_stats_registry) {
+        m_stats_registry->status_changed(*this, m_status, st);
+    }
+
     m_status = st;
     m_task_error = ec;
     m_sys_error = sc;
@@ -168,10 +282,40 @@ task_info::update_status(const task_status st, const urd_error ec,
 
 urd_error 
 task_info::task_error() const {
-    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+    boost::shared_lock<utils::profiled_shared_mutex> lock(m_mutex);
     return m_task_error;
 }
 
+void
+task_info::mark(task_phase p) {
+    m_phases[static_cast<std::size_t>(p)].store(
+            std::chrono::steady_clock::now().time_since_epoch().count(),
+            std::memory_order_relaxed);
+}
+
+std::chrono::steady_clock::time_point
+task_info::phase_time(task_phase p) const {
+    return std::chrono::steady_clock::time_point(
+            std::chrono::steady_clock::duration(
+                m_phases[static_cast<std::size_t>(p)].load(
+                    std::memory_order_relaxed)));
+}
+
+void
+task_info::cancel() {
+    m_cancelled.store(true, std::memory_order_relaxed);
+}
+
+bool
+task_info::is_cancelled() const {
+    return m_cancelled.load(std::memory_order_relaxed);
+}
+
+bool
+task_info::mark_deadline_at_risk() {
+    return !m_deadline_at_risk.exchange(true, std::memory_order_relaxed);
+}
+
 std::error_code 
 task_info::sys_error() const {
     return m_sys_error;
@@ -179,32 +323,74 @@ task_info::sys_error() const {
 
 std::size_t
 task_info::sent_bytes() const {
-    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
-    return m_sent_bytes;
+    return m_sent_bytes.load(std::memory_order_relaxed);
 }
 
 std::size_t
 task_info::total_bytes() const {
-    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
-    return m_total_bytes;
+    return m_total_bytes.load(std::memory_order_relaxed);
+}
+
+void
+task_info::set_total_bytes(std::size_t bytes) {
+
+    if(!m_stats_registry) {
+        m_total_bytes.store(bytes, std::memory_order_relaxed);
+        return;
+    }
+
+    // what the task contributes to the queued or running bytes of its 
+    // namespace pair needs to be updated as well. Holding m_mutex prevents 
+    // the status from changing in the meantime
+    boost::shared_lock<utils::profiled_shared_mutex> lock(m_mutex);
+
+    m_total_bytes.store(bytes, std::memory_order_relaxed);
+    m_stats_registry->total_bytes_changed(*this);
+}
+
+void
+task_info::record_progress(std::size_t bytes) {
+    m_sent_bytes.fetch_add(bytes, std::memory_order_relaxed);
+
+    if(m_stats_registry) {
+        m_stats_registry->progress(*this, bytes);
+    }
+}
+
+void
+task_info::record_copy_engine(copy_engine e) {
+    m_copy_engines.fetch_or(static_cast<uint32_t>(e), 
+                            std::memory_order_relaxed);
+}
+
+uint32_t
+task_info::copy_engines() const {
+    return m_copy_engines.load(std::memory_order_relaxed);
 }
 
 task_stats 
 task_info::stats() const {
-    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
-    return task_stats(m_status, m_task_error, m_sys_error,
-                      m_total_bytes, m_total_bytes - m_sent_bytes);
+
+    const std::size_t total = total_bytes();
+    const std::size_t sent = sent_bytes();
+
+    // the size of the source may change while it is being transferred
+    const std::size_t pending = sent < total ? total - sent : 0;
+
+    boost::shared_lock<utils::profiled_shared_mutex> lock(m_mutex);
+    return task_stats(m_status, m_task_error, m_sys_error, total, pending,
+                      copy_engines());
 }
 
 double
 task_info::bandwidth() const {
-    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+    boost::shared_lock<utils::profiled_shared_mutex> lock(m_mutex);
     return m_bandwidth;
 }
 
 void
 task_info::update_bandwidth(std::size_t bytes, double usecs) {
-    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
+    boost::unique_lock<utils::profiled_shared_mutex> lock(m_mutex);
     m_bandwidth = (static_cast<double>(bytes)/(1024*1024) / (usecs/1e6));
 
     LOGGER_DEBUG("[{}] {}({}, {}) => {}", m_id, __FUNCTION__, bytes, usecs, m_bandwidth);
@@ -212,22 +398,23 @@ task_info::update_bandwidth(std::size_t bytes, double usecs) {
 
 void
 task_info::record_transfer(std::size_t bytes, double usecs) {
-    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
-    m_sent_bytes += bytes;
+    record_progress(bytes);
+
+    boost::unique_lock<utils::profiled_shared_mutex> lock(m_mutex);
     m_bandwidth = (static_cast<double>(bytes)/(1024*1024) / (usecs/1e6));
 
     LOGGER_DEBUG("[{}] {}({}, {}) => {}", m_id, __FUNCTION__, bytes, usecs, m_bandwidth);
 }
 
-boost::shared_lock<boost::shared_mutex>
+boost::shared_lock<utils::profiled_shared_mutex>
 task_info::lock_shared() const {
-    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+    boost::shared_lock<utils::profiled_shared_mutex> lock(m_mutex);
     return lock;
 }
 
-boost::unique_lock<boost::shared_mutex>
+boost::unique_lock<utils::profiled_shared_mutex>
 task_info::lock_unique() const {
-    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
+    boost::unique_lock<utils::profiled_shared_mutex> lock(m_mutex);
     return lock;
 }
 
@@ -38,19 +38,25 @@
 #ifndef __TASK_INFO_HPP__
 #define __TASK_INFO_HPP__
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <vector>
 #include <boost/any.hpp>
+#include <boost/optional.hpp>
 #include <boost/thread/shared_mutex.hpp>
 #include "backends.hpp"
 #include "resources.hpp"
 #include "auth.hpp"
+#include "rate-limiter.hpp"
+#include "stats-registry.hpp"
+#include "task-stats.hpp"
+#include "utils/numa.hpp"
+#include "utils/profiled-mutex.hpp"
 
 namespace norns {
 namespace io {
 
-// forward declaration
-enum class task_status;
-struct task_stats;
-
 struct task_info {
 
     using backend_ptr = std::shared_ptr<storage::backend>;
@@ -64,7 +70,14 @@ struct task_info {
               const resource_info_ptr src_rinfo,
               const backend_ptr dst_backend, 
               const resource_info_ptr dst_rinfo,
-              const boost::any& ctx = {});
+              const boost::any& ctx = {},
+              const iotask_priority priority = iotask_priority::normal,
+              const boost::optional<iotask_deadline>& deadline = boost::none,
+              const rate_limiter& limiter = rate_limiter(),
+              const std::vector<iotask_id>& parents = {},
+              const int32_t numa_node = utils::numa::no_node,
+              const bool direct_io = false,
+              const std::shared_ptr<stats_registry>& registry = nullptr);
 
     ~task_info();
 
@@ -77,6 +90,31 @@ struct task_info {
     bool 
     is_remote() const;
 
+    iotask_priority
+    priority() const;
+
+    boost::optional<iotask_deadline>
+    deadline() const;
+
+    const rate_limiter&
+    limiter() const;
+
+    const std::vector<iotask_id>&
+    parents() const;
+
+    int32_t
+    numa_node() const;
+
+    /*! Whether local copies should bypass the page cache */
+    bool
+    direct_io() const;
+
+    /*! Stats for the pair of namespaces involved in the task (nullptr if
+     * the task is not tracked by a stats_registry or involves a single 
+     * namespace) */
+    const std::shared_ptr<io::pair_stats>&
+    pair_stats() const;
+
     auth::credentials 
     auth() const ;
 
@@ -114,6 +152,31 @@ struct task_info {
     urd_error 
     task_error() const;
 
+    /*! Record that the task has reached phase 'p' now. The submitted and
+     * completed phases are recorded automatically when the task is created
+     * and when it finishes */
+    void
+    mark(task_phase p);
+
+    /*! Time at which the task reached phase 'p' (or a default constructed 
+     * time_point if it has not) */
+    std::chrono::steady_clock::time_point
+    phase_time(task_phase p) const;
+
+    /*! Request the cancellation of the task. Running transfers check this
+     * flag at chunk boundaries and abort with ECANCELED */
+    void
+    cancel();
+
+    bool
+    is_cancelled() const;
+
+    /*! Record that the task's deadline is expected to be missed. Returns 
+     * true only the first time it is called, so that callers that check
+     * deadlines periodically can report each task once */
+    bool
+    mark_deadline_at_risk();
+
     std::error_code 
     sys_error() const;
 
@@ -123,31 +186,65 @@ struct task_info {
     std::size_t 
     total_bytes() const;
 
+    /*! Set the number of bytes that the task is expected to transfer, for
+     * transferors that only learn it when the transfer starts */
+    void
+    set_total_bytes(std::size_t bytes);
+
+    /*! Account for bytes that have just been transferred. Intended to be
+     * called from copy loops as each chunk completes so that status 
+     * queries can report live progress */
+    void
+    record_progress(std::size_t bytes);
+
+    /*! Record that the task has copied (some of its) data with 'e' */
+    void
+    record_copy_engine(copy_engine e);
+
+    /*! copy_engine values used by the task so far, or'ed together */
+    uint32_t
+    copy_engines() const;
+
     double 
     bandwidth() const;
 
     void 
     update_bandwidth(std::size_t bytes, double usecs);
 
+    /*! Account for a completed transfer of 'bytes' that took 'usecs' 
+     * (equivalent to record_progress() + update_bandwidth()) */
     void 
     record_transfer(std::size_t bytes, double usecs);
 
     task_stats 
     stats() const;
 
-    boost::shared_lock<boost::shared_mutex>
+    boost::shared_lock<utils::profiled_shared_mutex>
     lock_shared() const;
 
-    boost::unique_lock<boost::shared_mutex>
+    boost::unique_lock<utils::profiled_shared_mutex>
     lock_unique() const;
 
-    mutable boost::shared_mutex m_mutex;
+    mutable utils::profiled_shared_mutex m_mutex;
 
     // task id and type
     const iotask_id m_id;
     const iotask_type m_type;
     const bool m_is_remote;
 
+    // scheduling information
+    const iotask_priority m_priority;
+    const boost::optional<iotask_deadline> m_deadline;
+    // tasks that must finish successfully before this one can start
+    const std::vector<iotask_id> m_parents;
+    // NUMA node where the task should run (or utils::numa::no_node)
+    const int32_t m_numa_node;
+    // copy data with O_DIRECT
+    const bool m_direct_io;
+
+    // bandwidth limits that apply to this task
+    const rate_limiter m_limiter;
+
     // user credentials
     const auth::credentials m_auth;
 
@@ -164,11 +261,27 @@ struct task_info {
     task_status m_status;
     urd_error m_task_error;
     std::error_code m_sys_error;
+    std::atomic<bool> m_cancelled;
+    std::atomic<bool> m_deadline_at_risk;
+
+    // when each phase was reached (steady_clock ticks, 0 if not reached)
+    std::array<std::atomic<int64_t>, num_task_phases> m_phases;
 
-    // some statistics
+    // some statistics (byte counters are updated by the copy loops and 
+    // read by status queries without taking m_mutex)
     double m_bandwidth;
-    std::size_t m_sent_bytes;
-    std::size_t m_total_bytes;
+    std::atomic<std::size_t> m_sent_bytes;
+    std::atomic<std::size_t> m_total_bytes;
+    std::atomic<uint32_t> m_copy_engines;
+
+    // aggregated statistics that this task contributes to. 
+    // m_pair_pending is the part of m_pair_stats' queued or running bytes
+    // that belongs to this task, and m_pair_slot records where it has been
+    // accounted (see stats_registry)
+    const std::shared_ptr<stats_registry> m_stats_registry;
+    const std::shared_ptr<io::pair_stats> m_pair_stats;
+    std::atomic<uint64_t> m_pair_pending;
+    std::atomic<uint32_t> m_pair_slot;
 };
 
 } // namespace io
@@ -36,26 +36,133 @@
  *************************************************************************/
 
 #include <boost/optional.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <limits>
 #include <numeric>
+#include <queue>
 
 #include "task-stats.hpp"
 #include "task-info.hpp"
 #include "common.hpp"
 #include "logger.hpp"
+#include "metrics/metrics-registry.hpp"
+#include "utils/trace.hpp"
 #include "task-manager.hpp"
 
+namespace {
+
+// length (in seconds) of each observation window for the concurrency 
+// controller
+constexpr const double controller_period = 10.0;
+
+// maximum number of small tasks that a runner executes in one go
+constexpr const std::size_t max_coalesced_tasks = 64;
+
+// how often the bandwidth models are saved while the daemon runs
+constexpr const std::chrono::seconds model_save_interval(300);
+
+// small copies and moves between the same pair of namespaces are coalesced
+// so that a runner can process them back to back, saving the notification
+// of a runner for each of them
+bool
+can_coalesce(const norns::io::generic_task& head,
+             const norns::io::generic_task& other) {
+
+    using norns::iotask_type;
+
+    if(head.m_type != other.m_type) {
+        return false;
+    }
+
+    if(head.m_type != iotask_type::copy && head.m_type != iotask_type::move) {
+        return false;
+    }
+
+    const auto head_info = head.info();
+    const auto other_info = other.info();
+
+    return head_info->src_backend() == other_info->src_backend() &&
+           head_info->dst_backend() == other_info->dst_backend();
+}
+
+} // anonymous namespace
+
 namespace norns {
 namespace io {
 
+task_manager::lane::runner_task::runner_task(task_manager& manager, 
+                                             lane& l) :
+    m_manager(manager),
+    m_lane(l) {}
+
+void
+task_manager::lane::runner_task::execute() {
+    m_manager.run_next_task(m_lane);
+}
+
+void
+task_manager::lane::runner_task::release() {
+    // owned by the lane: nothing to do
+}
+
+task_manager::lane::lane(task_manager& manager, const std::string& name, 
+                         uint32_t nrunners, uint32_t max_nrunners) :
+    m_name(name),
+    m_runner_task(manager, *this),
+    m_runners(nrunners, max_nrunners),
+    m_busy_runners(0),
+    m_busy_usecs(0) {}
+
+task_manager::blocked_task::blocked_task(generic_task&& tsk, 
+                                         std::size_t pending_parents) :
+    m_task(std::move(tsk)),
+    m_pending_parents(pending_parents) {}
+
 task_manager::task_manager(uint32_t nrunners, 
+                           uint32_t min_nrunners,
+                           uint32_t max_nrunners,
+                           uint32_t small_task_nrunners,
+                           uint64_t small_task_threshold,
                            uint32_t backlog_size, 
+                           uint32_t finished_task_ttl,
+                           uint32_t max_finished_tasks,
                            bool dry_run,
                            uint32_t dry_run_duration) :
-    m_backlog_size(backlog_size),
+    m_id_base(0),
+    m_stats(std::make_shared<stats_registry>(backlog_size)),
     m_dry_run(dry_run),
     m_dry_run_duration(dry_run_duration),
-    m_runners(nrunners) {}
+    m_small_task_threshold(small_task_threshold),
+    m_block_cache(std::make_shared<utils::block_cache>()),
+    m_task_table(m_block_cache),
+    m_small_lane(*this, "small", small_task_nrunners, small_task_nrunners),
+    m_bulk_lane(*this, "bulk", nrunners, max_nrunners),
+    m_controller(min_nrunners, max_nrunners, nrunners),
+    m_window_bytes(0),
+    m_window_start(std::chrono::steady_clock::now()),
+    m_finished_task_ttl(finished_task_ttl),
+    m_max_finished_tasks(max_finished_tasks),
+    m_reaper_stop(false),
+    m_watchdog_interval(0),
+    m_stall_timeout(0),
+    m_slow_fraction(0.0),
+    m_watchdog_stop(false),
+    m_slow_flags_total(0),
+    m_stalled_flags_total(0),
+    m_model_saver_stop(false) {
+
+    if(m_finished_task_ttl.count() != 0 || m_max_finished_tasks != 0) {
+        m_reaper = std::thread(&task_manager::reaper_loop, this);
+    }
+}
+
+task_manager::~task_manager() {
+    // runners refer to the task_manager through their lane's runner_task,
+    // so make sure that they are all gone before any member is destroyed
+    stop_all_tasks();
+}
 
 bool
 task_manager::register_transfer_plugin(const data::resource_type t1,
@@ -66,6 +173,88 @@ task_manager::register_transfer_plugin(const data::resource_type t1,
                     std::forward<std::shared_ptr<io::transferor>>(trp));
 }
 
+void
+task_manager::add_bandwidth_limit(const std::string& nsid, uint64_t rate) {
+    m_rate_limits.add(nsid, rate);
+}
+
+void
+task_manager::add_bandwidth_limit(const std::string& src_nsid,
+                                  const std::string& dst_nsid,
+                                  uint64_t rate) {
+    m_rate_limits.add(src_nsid, dst_nsid, rate);
+}
+
+rate_limiter
+task_manager::get_rate_limiter(const backend_ptr& src_backend,
+                               const backend_ptr& dst_backend) const {
+
+    // common case: no limits configured, avoid building the keys
+    if(m_rate_limits.empty()) {
+        return rate_limiter();
+    }
+
+    // tasks involving remote resources may lack one of the backends
+    const std::string src_nsid = src_backend ? src_backend->nsid() : "";
+    const std::string dst_nsid = dst_backend ? dst_backend->nsid() : "";
+
+    return m_rate_limits.get(src_nsid, dst_nsid);
+}
+
+void
+task_manager::add_numa_affinity(const std::string& nsid, int32_t node) {
+    m_numa_affinities[nsid] = node;
+}
+
+int32_t
+task_manager::get_numa_node(const backend_ptr& src_backend,
+                            const backend_ptr& dst_backend) const {
+
+    // common case: no affinities configured
+    if(m_numa_affinities.empty()) {
+        return utils::numa::no_node;
+    }
+
+    // the destination takes precedence since that's where staging 
+    // buffers are written back from and where dirty pages accumulate
+    for(const auto& b : {dst_backend, src_backend}) {
+        if(!b) {
+            continue;
+        }
+
+        const auto it = m_numa_affinities.find(b->nsid());
+
+        if(it != m_numa_affinities.end()) {
+            return it->second;
+        }
+    }
+
+    return utils::numa::no_node;
+}
+
+void
+task_manager::add_direct_io(const std::string& nsid) {
+    m_direct_io_namespaces.insert(nsid);
+}
+
+bool
+task_manager::uses_direct_io(const backend_ptr& src_backend,
+                             const backend_ptr& dst_backend) const {
+
+    // common case: no namespaces configured for direct I/O
+    if(m_direct_io_namespaces.empty()) {
+        return false;
+    }
+
+    for(const auto& b : {src_backend, dst_backend}) {
+        if(b && m_direct_io_namespaces.count(b->nsid()) != 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 /// boost::optional<iotask_id>
 /// task_manager::create_task(iotask_type type, const auth::credentials& auth,
 ///         const backend_ptr src_backend, const resource_info_ptr src_rinfo, 
@@ -117,22 +306,22 @@ task_manager::register_transfer_plugin(const data::resource_type t1,
 ///     if(!m_dry_run) {
 ///         switch(type) {
 ///             case iotask_type::copy:
-///                 m_runners.submit_with_epilog_and_forget(
+///                 m_bulk_lane.m_runners.submit_with_epilog_and_forget(
 ///                     io::task<iotask_type::copy>(
 ///                         std::move(task_info_ptr), std::move(tx_ptr)), register_completion);
 ///                 break;
 ///             case iotask_type::move:
-///                 m_runners.submit_with_epilog_and_forget(
+///                 m_bulk_lane.m_runners.submit_with_epilog_and_forget(
 ///                     io::task<iotask_type::move>(
 ///                         std::move(task_info_ptr), std::move(tx_ptr)), register_completion);
 ///                 break;
 ///             case iotask_type::remove:
-///                 m_runners.submit_with_epilog_and_forget(
+///                 m_bulk_lane.m_runners.submit_with_epilog_and_forget(
 ///                     io::task<iotask_type::remove>(
 ///                         std::move(task_info_ptr), std::move(tx_ptr)), register_completion);
 ///                 break;
 ///             default:
-///                 m_runners.submit_and_forget(
+///                 m_bulk_lane.m_runners.submit_and_forget(
 ///                     io::task<iotask_type::unknown>(
 ///                         std::move(task_info_ptr), std::move(tx_ptr)));
 ///         }
@@ -155,18 +344,45 @@ task_manager::create_task(iotask_type type,
 
     assert(backend_ptrs.size() == rinfo_ptrs.size());
 
-    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
+    const iotask_type exec_type = (m_dry_run ? iotask_type::noop : type);
 
-    // fetch an iotask_id for this task
-    iotask_id tid = ++m_id_base;
+    // find a transferor and validate the request before the task becomes 
+    // visible, so that rejected requests don't leave a task behind
+    std::shared_ptr<io::transferor> tx_ptr;
+
+    switch(exec_type) {
+        case iotask_type::remove:
+            assert(backend_ptrs.size() == 1);
+            break;
+
+        case iotask_type::copy:
+        case iotask_type::move:
+        case iotask_type::noop:
+        {
+            assert(backend_ptrs.size() == 2);
+
+            tx_ptr = m_transferor_registry.get(rinfo_ptrs[0]->type(), 
+                                               rinfo_ptrs[1]->type());
+            if(!tx_ptr) {
+                return std::make_tuple(urd_error::not_supported, boost::none);
+            }
+
+            LOGGER_DEBUG("Selected plugin: {}", tx_ptr->to_string());
+
+            if(!tx_ptr->validate(rinfo_ptrs[0], rinfo_ptrs[1])) {
+                return std::make_tuple(urd_error::bad_args, boost::none);
+            }
+            break;
+        }
 
-    if(m_task_info.count(tid) != 0) {
-        --m_id_base;
-        return std::make_tuple(urd_error::too_many_tasks, -1);
+        default:
+            return std::make_tuple(urd_error::bad_args, boost::none);
     }
 
+    // fetch an iotask_id for this task
+    const iotask_id tid = ++m_id_base;
+
     // immediately-invoked lambda to create the appropriate metadata for the task
-    // and register it into m_task_info
     const auto task_info_ptr = [&]() {
 
         assert(backend_ptrs.size() == 1 || backend_ptrs.size() == 2);
@@ -178,14 +394,24 @@ task_manager::create_task(iotask_type type,
         const resource_info_ptr dst_rinfo = (rinfo_ptrs.size() == 1 ? 
                                             nullptr : rinfo_ptrs[1]);
 
-        auto it = m_task_info.end();
-        std::tie(it, std::ignore) = m_task_info.emplace(tid,
-                std::make_shared<task_info>(tid, type, false, auth,
-                                            src_backend, src_rinfo,
-                                            dst_backend, dst_rinfo));
-        return it->second;
+        return std::allocate_shared<task_info>(
+                        task_info_allocator(m_block_cache),
+                        tid, type, false, auth,
+                        src_backend, src_rinfo,
+                        dst_backend, dst_rinfo,
+                        boost::any(), iotask_priority::normal, boost::none,
+                        rate_limiter(), std::vector<iotask_id>(),
+                        utils::numa::no_node, false, m_stats);
     }();
 
+    // the id space wrapped around and the old task is still around. Give
+    // the id back, unless another task has been assigned one since then
+    if(!m_task_table.insert(tid, task_info_ptr)) {
+        iotask_id expected = tid;
+        m_id_base.compare_exchange_strong(expected, tid - 1);
+        return std::make_tuple(urd_error::too_many_tasks, boost::none);
+    }
+
     auto self(std::enable_shared_from_this<task_manager>::shared_from_this());
 
     // helper lambda to register the completion of tasks so that we can keep
@@ -201,53 +427,26 @@ task_manager::create_task(iotask_type type,
 
         auto bw = task_info_ptr->bandwidth();
 
-        // bw might be nan if the task did not finish correctly
-        if(!std::isnan(bw)) {
-
-            const auto key = std::make_pair(task_info_ptr->src_rinfo()->nsid(),
-                                            task_info_ptr->dst_rinfo()->nsid());
-
-            if(!self->m_bandwidth_backlog.count(key)) {
-                self->m_bandwidth_backlog.emplace(key, 
-                        boost::circular_buffer<double>(self->m_backlog_size));
-            }
-
-            self->m_bandwidth_backlog.at(key).push_back(bw);
+        // bw might be nan if the task did not finish correctly. The 
+        // duration of remote transfers is only known through it
+        if(!std::isnan(bw) && bw > 0.0 && task_info_ptr->pair_stats()) {
+            const std::size_t bytes = task_info_ptr->sent_bytes();
+            task_info_ptr->pair_stats()->record_transfer(bytes, 
+                    (static_cast<double>(bytes) / (1024*1024)) / bw);
         }
     };
 
-    if(m_dry_run) {
-        type = iotask_type::noop;
-    }
-
-    switch(type) {
+    switch(exec_type) {
         case iotask_type::remove:
         {
-            assert(backend_ptrs.size() == 1);
-
-            m_runners.submit_and_forget(
+            m_bulk_lane.m_runners.submit_and_forget(
                 io::task<iotask_type::remove>(std::move(task_info_ptr)));
             break;
         }
 
         case iotask_type::copy:
         {
-            assert(backend_ptrs.size() == 2);
-
-            // find a transferor for this task
-            const auto tx_ptr = m_transferor_registry.get(rinfo_ptrs[0]->type(), 
-                                                          rinfo_ptrs[1]->type());
-            if(!tx_ptr) {
-                return std::make_tuple(urd_error::not_supported, boost::none);
-            }
-
-            LOGGER_DEBUG("Selected plugin: {}", tx_ptr->to_string());
-            
-            if(!tx_ptr->validate(rinfo_ptrs[0], rinfo_ptrs[1])) {
-                return std::make_tuple(urd_error::bad_args, boost::none);
-            }
-
-            m_runners.submit_with_epilog_and_forget(
+            m_bulk_lane.m_runners.submit_with_epilog_and_forget(
                 io::task<iotask_type::copy>(
                     std::move(task_info_ptr), std::move(tx_ptr)), 
                 register_completion);
@@ -256,22 +455,7 @@ task_manager::create_task(iotask_type type,
 
         case iotask_type::move:
         {
-            assert(backend_ptrs.size() == 2);
-
-            // find a transferor for this task
-            const auto tx_ptr = m_transferor_registry.get(rinfo_ptrs[0]->type(), 
-                                                          rinfo_ptrs[1]->type());
-            if(!tx_ptr) {
-                return std::make_tuple(urd_error::not_supported, boost::none);
-            }
-
-            LOGGER_DEBUG("Selected plugin: {}", tx_ptr->to_string());
-            
-            if(!tx_ptr->validate(rinfo_ptrs[0], rinfo_ptrs[1])) {
-                return std::make_tuple(urd_error::bad_args, boost::none);
-            }
-
-            m_runners.submit_with_epilog_and_forget(
+            m_bulk_lane.m_runners.submit_with_epilog_and_forget(
                 io::task<iotask_type::move>(
                     std::move(task_info_ptr), std::move(tx_ptr)), 
                 register_completion);
@@ -280,29 +464,15 @@ task_manager::create_task(iotask_type type,
 
         case iotask_type::noop:
         {
-            assert(backend_ptrs.size() == 2);
-
-            // find a transferor for this task
-            const auto tx_ptr = m_transferor_registry.get(rinfo_ptrs[0]->type(), 
-                                                          rinfo_ptrs[1]->type());
-            if(!tx_ptr) {
-                return std::make_tuple(urd_error::not_supported, boost::none);
-            }
-
-            LOGGER_DEBUG("Selected plugin: {}", tx_ptr->to_string());
-            
-            if(!tx_ptr->validate(rinfo_ptrs[0], rinfo_ptrs[1])) {
-                return std::make_tuple(urd_error::bad_args, boost::none);
-            }
-
-            m_runners.submit_and_forget(
+            m_bulk_lane.m_runners.submit_and_forget(
                 io::task<iotask_type::noop>(std::move(task_info_ptr),
                                             m_dry_run_duration));
             break;
         }
 
         default:
-            return std::make_tuple(urd_error::bad_args, boost::none);
+            // unreachable: rejected above
+            break;
     }
 
     return std::make_tuple(urd_error::success, tid);
@@ -312,40 +482,36 @@ std::tuple<urd_error, boost::optional<io::generic_task>>
 task_manager::create_local_initiated_task(iotask_type type,
                             const auth::credentials& auth,
                             const std::vector<backend_ptr>& backend_ptrs,
-                            const std::vector<resource_info_ptr>& rinfo_ptrs) {
-
-    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
-
-    // fetch an iotask_id for this task
-    iotask_id tid = ++m_id_base;
-
-    if(m_task_info.count(tid) != 0) {
-        --m_id_base;
-        return std::make_tuple(urd_error::too_many_tasks, boost::none);
-    }
+                            const std::vector<resource_info_ptr>& rinfo_ptrs,
+                            const iotask_priority priority,
+                            const boost::optional<iotask_deadline>& deadline,
+                            const std::vector<iotask_id>& parents) {
 
-    // immediately-invoked lambda to create the appropriate metadata for the task
-    // and register it into m_task_info
-    const auto task_info_ptr = [&]() {
-
-        assert(backend_ptrs.size() == 1 || backend_ptrs.size() == 2);
+    // parents must be known local tasks (possibly already reaped). Since 
+    // a task's id is only returned after it is created, this also prevents
+    // dependency cycles. (A parent erased after this check is handled by 
+    // enqueue_task())
+    for(const auto pid : parents) {
 
-        const backend_ptr src_backend = backend_ptrs[0];
-        const resource_info_ptr src_rinfo = rinfo_ptrs[0];
-        const backend_ptr dst_backend = (backend_ptrs.size() == 1 ? 
-                                            nullptr : backend_ptrs[1]);
-        const resource_info_ptr dst_rinfo = (rinfo_ptrs.size() == 1 ? 
-                                            nullptr : rinfo_ptrs[1]);
+        bool is_remote;
 
-        auto it = m_task_info.end();
-        std::tie(it, std::ignore) = m_task_info.emplace(tid,
-                std::make_shared<task_info>(tid, type, false, auth,
-                                            src_backend, src_rinfo,
-                                            dst_backend, dst_rinfo));
-        return it->second;
-    }();
+        if(const auto parent_ptr = m_task_table.find(pid)) {
+            is_remote = parent_ptr->is_remote();
+        }
+        else if(const auto tombstone = m_task_table.find_tombstone(pid)) {
+            is_remote = tombstone->is_remote();
+        }
+        else {
+            return std::make_tuple(urd_error::no_such_task, boost::none);
+        }
 
+        if(is_remote) {
+            return std::make_tuple(urd_error::bad_args, boost::none);
+        }
+    }
 
+    // find a transferor and validate the request before the task becomes 
+    // visible, so that rejected requests don't leave a task behind
     std::shared_ptr<io::transferor> tx_ptr;
 
     if(type == iotask_type::copy || type == iotask_type::move) {
@@ -365,6 +531,40 @@ task_manager::create_local_initiated_task(iotask_type type,
         }
     }
 
+    // fetch an iotask_id for this task
+    const iotask_id tid = ++m_id_base;
+
+    // immediately-invoked lambda to create the appropriate metadata for the task
+    const auto task_info_ptr = [&]() {
+
+        assert(backend_ptrs.size() == 1 || backend_ptrs.size() == 2);
+
+        const backend_ptr src_backend = backend_ptrs[0];
+        const resource_info_ptr src_rinfo = rinfo_ptrs[0];
+        const backend_ptr dst_backend = (backend_ptrs.size() == 1 ? 
+                                            nullptr : backend_ptrs[1]);
+        const resource_info_ptr dst_rinfo = (rinfo_ptrs.size() == 1 ? 
+                                            nullptr : rinfo_ptrs[1]);
+
+        return std::allocate_shared<task_info>(
+                        task_info_allocator(m_block_cache),
+                        tid, type, false, auth,
+                        src_backend, src_rinfo,
+                        dst_backend, dst_rinfo,
+                        boost::any(), priority, deadline,
+                        get_rate_limiter(src_backend, 
+                                         dst_backend),
+                        parents,
+                        get_numa_node(src_backend, dst_backend),
+                        uses_direct_io(src_backend, dst_backend),
+                        m_stats);
+    }();
+
+    // the id space wrapped around and the old task is still around
+    if(!m_task_table.insert(tid, task_info_ptr)) {
+        return std::make_tuple(urd_error::too_many_tasks, boost::none);
+    }
+
     if(m_dry_run) {
         type = iotask_type::noop;
     }
@@ -428,29 +628,6 @@ task_manager::create_remote_initiated_task(iotask_type task_type,
                                     const backend_ptr dst_backend,
                                     const resource_info_ptr dst_rinfo) {
 
-    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
-
-    // fetch an iotask_id for this task
-    iotask_id tid = ++m_id_base;
-
-    if(m_task_info.count(tid) != 0) {
-        --m_id_base;
-        return std::make_tuple(urd_error::too_many_tasks, boost::none);
-    }
-
-    // immediately-invoked lambda to create the appropriate metadata for the task
-    // and register it into m_task_info
-    const auto task_info_ptr = [&]() {
-
-        auto it = m_task_info.end();
-        std::tie(it, std::ignore) = m_task_info.emplace(tid,
-                std::make_shared<task_info>(tid, task_type, true, auth, 
-                                            src_backend, src_rinfo,
-                                            dst_backend, dst_rinfo,
-                                            ctx));
-        return it->second;
-    }();
-
     //auto tx_ptr = 
     //    m_transferor_registry.get(src_rinfo->type(), dst_rinfo->type());
 
@@ -469,6 +646,29 @@ task_manager::create_remote_initiated_task(iotask_type task_type,
         return std::make_tuple(urd_error::bad_args, boost::none);
     }
 
+    // fetch an iotask_id for this task
+    const iotask_id tid = ++m_id_base;
+
+    const auto task_info_ptr = 
+        std::allocate_shared<task_info>(
+                task_info_allocator(m_block_cache),
+                tid, task_type, true, auth, 
+                src_backend, src_rinfo,
+                dst_backend, dst_rinfo,
+                ctx, iotask_priority::normal, 
+                boost::none,
+                get_rate_limiter(src_backend, 
+                                 dst_backend),
+                std::vector<iotask_id>(),
+                get_numa_node(src_backend, dst_backend),
+                uses_direct_io(src_backend, dst_backend),
+                m_stats);
+
+    // the id space wrapped around and the old task is still around
+    if(!m_task_table.insert(tid, task_info_ptr)) {
+        return std::make_tuple(urd_error::too_many_tasks, boost::none);
+    }
+
     return std::make_tuple(
             urd_error::success,
             generic_task(task_type,
@@ -480,177 +680,1100 @@ task_manager::create_remote_initiated_task(iotask_type task_type,
 urd_error
 task_manager::enqueue_task(io::generic_task&& tsk) {
 
-    auto self(std::enable_shared_from_this<task_manager>::shared_from_this());
+    switch(tsk.m_type) {
+        case iotask_type::remove:
+        case iotask_type::noop:
+        case iotask_type::copy:
+        case iotask_type::move:
+            break;
+        default:
+            return urd_error::bad_args;
+    }
 
-    // helper lambda to register the completion of tasks so that we can keep track
-    // of the consumed bandwidth by each task
-    // N.B: we use capture-by-value here so that the task_info_ptr is valid when 
-    // the callback is invoked.
-    const auto completion_callback = [self, tsk]() {
-        assert(tsk.info()->status() == task_status::finished ||
-               tsk.info()->status() == task_status::finished_with_error);
+    utils::trace::instant("task", "enqueue", tsk.id());
 
-        LOGGER_DEBUG("Task {} finished [{} MiB/s]", 
-                tsk.info()->id(), tsk.info()->bandwidth());
+    const auto task_info_ptr = tsk.info();
+
+    if(task_info_ptr->parents().empty()) {
+        schedule(std::move(tsk));
+        return urd_error::success;
+    }
 
-        auto bw = tsk.info()->bandwidth();
+    // the task can't be scheduled until all its parents finish 
+    // successfully, and it must fail if any of them doesn't
+    std::vector<iotask_id> unfinished;
+    bool parent_failed = false;
 
-        // bw might be nan if the task did not finish correctly
-        if(!std::isnan(bw)) {
+    std::unique_lock<utils::profiled_mutex> lock(m_deps_mutex);
 
-            const auto key = std::make_pair(tsk.info()->src_rinfo()->nsid(),
-                                            tsk.info()->dst_rinfo()->nsid());
+    for(const auto pid : task_info_ptr->parents()) {
 
-            if(!self->m_bandwidth_backlog.count(key)) {
-                self->m_bandwidth_backlog.emplace(key, 
-                        boost::circular_buffer<double>(self->m_backlog_size));
+        const auto parent = find(pid);
+
+        // parents are checked when the task is created, so a missing 
+        // parent has finished and been reaped since then. Its tombstone
+        // tells whether it succeeded, and if it is gone too we can't know,
+        // so err on the side of caution
+        if(!parent) {
+            const auto tombstone = m_task_table.find_tombstone(pid);
+
+            if(!tombstone || 
+               tombstone->m_status != task_status::finished) {
+                parent_failed = true;
+                break;
             }
 
-            self->m_bandwidth_backlog.at(key).push_back(bw);
+            continue;
         }
-    };
 
-    switch(tsk.m_type) {
-        case iotask_type::remove:
-        case iotask_type::noop:
-        {
-            m_runners.submit_and_forget(tsk);
-            break;
+        // N.B: if the parent is not finished, release_dependents() will 
+        // be called for it once it does, but not before we release 
+        // m_deps_mutex
+        switch(parent->status()) {
+            case task_status::finished:
+                break;
+            case task_status::finished_with_error:
+                parent_failed = true;
+                break;
+            default:
+                unfinished.push_back(pid);
+                break;
         }
 
-        case iotask_type::copy:
-        case iotask_type::move:
-        {
-            m_runners.submit_with_epilog_and_forget(tsk, completion_callback);
+        if(parent_failed) {
             break;
         }
-
-        default:
-            return urd_error::bad_args;
     }
 
-    return urd_error::success;
-}
+    if(parent_failed) {
+        lock.unlock();
+        LOGGER_WARN("[{}] I/O task not run: a parent task did not complete "
+                    "successfully", tsk.id());
+        task_info_ptr->update_status(task_status::finished_with_error,
+                                     urd_error::dependency_failed, 
+                                     std::error_code());
+        return urd_error::success;
+    }
 
-// XXX we could return the iterator here so that it can be reused for erase()
-// later
-std::shared_ptr<task_info>
-task_manager::find(iotask_id tid) const {
+    if(unfinished.empty()) {
+        lock.unlock();
+        schedule(std::move(tsk));
+        return urd_error::success;
+    }
 
-    boost::shared_lock<boost::shared_mutex> lock(m_mutex);
+    for(const auto pid : unfinished) {
+        m_dependents[pid].push_back(tsk.id());
+    }
 
-    const auto& it = m_task_info.find(tid);
+    LOGGER_DEBUG("Task {} waiting for {} parent tasks", 
+                 tsk.id(), unfinished.size());
 
-    if(it != m_task_info.end()) {
-        return it->second;
-    }
+    const iotask_id tid = tsk.id();
+    m_blocked_tasks.emplace(tid, blocked_task(std::move(tsk), 
+                                              unfinished.size()));
 
-    return nullptr;
+    return urd_error::success;
 }
 
-bool
-task_manager::erase(iotask_id tid) {
-    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
-
-    const auto it = m_task_info.find(tid);
+void
+task_manager::schedule(io::generic_task&& tsk) {
 
-    if(it == m_task_info.end()) {
-        return false;
-    }
+    // tasks are not handed directly to the runners. Instead, they are
+    // placed in the pending queue of the appropriate lane (which sorts them
+    // according to their priority and deadline) and each runner invocation 
+    // picks the most urgent task available at the time it starts.
+    lane& l = is_small_task(*tsk.info()) ? m_small_lane : m_bulk_lane;
 
-    m_task_info.erase(it);
+    LOGGER_DEBUG("Task {} routed to {} lane", tsk.id(), l.m_name);
 
-    return true;
+    // a runner only needs to be notified if the task can't be picked up
+    // by one that was left without work by a coalesced task
+    if(l.m_pending_tasks.push(std::move(tsk))) {
+        l.m_runners.submit_intrusive(&l.m_runner_task);
+    }
 }
 
-io::global_stats
-task_manager::global_stats() const {
+// once a task finishes, its dependents can be scheduled if it was their 
+// last unfinished parent. If the task didn't finish successfully, its 
+// dependents (and theirs, transitively) fail instead
+void
+task_manager::release_dependents(const task_info& parent) {
 
-    uint32_t running_tasks = 0;
-    uint32_t pending_tasks = 0;
+    std::vector<generic_task> ready;
 
-    const auto get_avg_bandwidth = [&](const std::string& nsid1, 
-                                       const std::string& nsid2) -> double {
+    {
+        std::lock_guard<utils::profiled_mutex> lock(m_deps_mutex);
 
-        if(!m_bandwidth_backlog.count({nsid1, nsid2})) {
-            return std::numeric_limits<double>::quiet_NaN();
+        if(m_dependents.empty()) {
+            return;
         }
 
-        if(m_bandwidth_backlog.at({nsid1, nsid2}).size() == 0) {
-            return std::numeric_limits<double>::quiet_NaN();
-        }
+        std::vector<iotask_id> failed;
 
-        return std::accumulate(m_bandwidth_backlog.at({nsid1, nsid2}).begin(),
-                               m_bandwidth_backlog.at({nsid1, nsid2}).end(),
-                               0.0) / m_bandwidth_backlog.size();
-    };
+        const auto resolve = [&](iotask_id pid, bool succeeded) {
 
-    std::vector<double> etas;
+            const auto it = m_dependents.find(pid);
 
-    // lock map so that no new tasks are added until we finish
-    // (though the stats for already existing tasks can still be updated)
-    boost::unique_lock<boost::shared_mutex> lock(m_mutex);
-
-    bool unreliable_eta = false;
+            if(it == m_dependents.end()) {
+                return;
+            }
 
-    for(const auto& kv : m_task_info) {
+            for(const auto tid : it->second) {
 
-        // stats() locks the task_info before creating the result, so that 
-        // the data retrieved is stable
-        const task_stats st{kv.second->stats()};
+                const auto bt = m_blocked_tasks.find(tid);
 
-        switch(st.status()) {
-            case task_status::running:
-            {
-                ++running_tasks;
+                // the dependent may have already failed because of 
+                // another parent, or been cancelled
+                if(bt == m_blocked_tasks.end()) {
+                    continue;
+                }
 
-                const std::string& nsid1 = kv.second->src_rinfo()->nsid();
-                const std::string& nsid2 = kv.second->dst_rinfo()->nsid();
-                const double avg_bw = get_avg_bandwidth(nsid1, nsid2);
+                if(!succeeded) {
+                    LOGGER_WARN("[{}] I/O task not run: parent task {} did "
+                                "not complete successfully", tid, pid);
+                    bt->second.m_task.info()->update_status(
+                            task_status::finished_with_error,
+                            urd_error::dependency_failed, 
+                            std::error_code());
+                    m_blocked_tasks.erase(bt);
+                    failed.push_back(tid);
+                    continue;
+                }
 
-                // if avg_bw is NAN, we can't estimate the ETA reliably
-                if(std::isnan(avg_bw)) {
-                    unreliable_eta = true;
+                if(--bt->second.m_pending_parents == 0) {
+                    ready.push_back(std::move(bt->second.m_task));
+                    m_blocked_tasks.erase(bt);
                 }
+            }
 
-                etas.push_back(static_cast<double>(
-                            st.pending_bytes()/(1024*1024))/avg_bw);
+            m_dependents.erase(it);
+        };
 
-                LOGGER_DEBUG("Pending {} bytes for task {}: E.T.A {} seconds "
-                             "(inter-namespace avg bw: {} MiB/s)", 
-                             st.pending_bytes(), kv.first, etas.back(), avg_bw);
-                break;
+        resolve(parent.id(), parent.status() == task_status::finished);
+
+        while(!failed.empty()) {
+            const iotask_id tid = failed.back();
+            failed.pop_back();
+            resolve(tid, false);
+        }
+    }
+
+    for(auto& tsk : ready) {
+        LOGGER_DEBUG("Task {} released: all its parents finished", tsk.id());
+        schedule(std::move(tsk));
+    }
+}
+
+bool
+task_manager::is_small_task(const task_info& tinfo) const {
+
+    switch(tinfo.type()) {
+        case iotask_type::copy:
+        case iotask_type::move:
+            // total_bytes() is estimated with backend::get_size() when 
+            // the task is created
+            return tinfo.total_bytes() <= m_small_task_threshold;
+        default:
+            return true;
+    }
+}
+
+void
+task_manager::run_next_task(lane& l) {
+
+    // reused across invocations so that popping tasks does not allocate
+    static thread_local std::vector<generic_task> batch;
+
+    batch.clear();
+
+    // only the small lane coalesces tasks: bulk tasks take long enough 
+    // that notifying a runner for each of them is negligible. Also, 
+    // batches are kept small enough to let all runners take part when 
+    // there are few pending tasks
+    const std::size_t max_tasks = (&l != &m_small_lane ? 1 :
+        std::min(max_coalesced_tasks, 
+                 l.m_pending_tasks.size() / 
+                    std::max<uint32_t>(1, l.m_runners.size())));
+
+    if(l.m_pending_tasks.pop_batch(batch, max_tasks, can_coalesce) == 0) {
+        return;
+    }
+
+    utils::trace::set_thread_name(l.m_name.c_str());
+
+    // account for the time that the runner spends executing the batch
+    struct busy_guard {
+        explicit busy_guard(lane& l) : 
+            m_lane(l),
+            m_start(std::chrono::steady_clock::now()) {
+            m_lane.m_busy_runners.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        ~busy_guard() {
+            m_lane.m_busy_usecs.fetch_add(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - m_start).count(),
+                std::memory_order_relaxed);
+            m_lane.m_busy_runners.fetch_sub(1, std::memory_order_relaxed);
+        }
+
+        lane& m_lane;
+        const std::chrono::steady_clock::time_point m_start;
+    } guard(l);
+
+    if(batch.size() == 1) {
+        run_task(batch.front());
+        batch.clear();
+        return;
+    }
+
+    // each member of the batch still reports its own status through its
+    // task_info, but the batch is logged as a whole
+    const auto first = batch.front().info();
+    const utils::trace::scope trace_scope("batch", "coalesced", first->id());
+
+    LOGGER_WARN("[{}..{}] Starting batch of {} coalesced I/O tasks", 
+                first->id(), batch.back().id(), batch.size());
+    LOGGER_WARN("[{}..{}]   TYPE: {}", first->id(), batch.back().id(),
+                utils::to_string(first->type()));
+    LOGGER_WARN("[{}..{}]   FROM: {}", first->id(), batch.back().id(),
+                first->src_backend()->to_string());
+    LOGGER_WARN("[{}..{}]     TO: {}", first->id(), batch.back().id(),
+                first->dst_backend()->to_string());
+
+    std::size_t nerrors = 0;
+
+    for(auto& tsk : batch) {
+        tsk.set_coalesced(true);
+        run_task(tsk);
+
+        if(tsk.info()->status() != task_status::finished) {
+            ++nerrors;
+        }
+    }
+
+    LOGGER_WARN("[{}..{}] Batch of coalesced I/O tasks completed "
+                "({} succeeded, {} failed)", first->id(), batch.back().id(), 
+                batch.size() - nerrors, nerrors);
+
+    batch.clear();
+}
+
+void
+task_manager::run_task(generic_task& tsk) {
+
+    const auto task_info_ptr = tsk.info();
+
+    if(!task_info_ptr) {
+        return;
+    }
+
+    task_info_ptr->mark(task_phase::dequeued);
+
+    // the task may have been cancelled after we popped it but before 
+    // it had a chance to start
+    if(task_info_ptr->is_cancelled()) {
+        task_info_ptr->update_status(task_status::finished_with_error,
+                urd_error::task_cancelled, 
+                std::make_error_code(std::errc::operation_canceled));
+    }
+    else {
+        // run the task close to the devices it touches. Runners are 
+        // shared by all namespaces, so they move between nodes as needed 
+        // (this is a no-op when the runner is already on the right node)
+        if(const auto ec = utils::numa::bind_current_thread(
+                    task_info_ptr->numa_node())) {
+            LOGGER_DEBUG("Failed to bind runner to NUMA node {}: {}", 
+                         task_info_ptr->numa_node(), ec.message());
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+
+        tsk();
+
+        if(tsk.m_type == iotask_type::copy || 
+           tsk.m_type == iotask_type::move) {
+            record_completion(task_info_ptr, 
+                    std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start).count());
+        }
+    }
+
+    release_dependents(*task_info_ptr);
+
+    // don't wait for the reaper's next pass if too many finished tasks 
+    // are being retained
+    if(m_max_finished_tasks != 0 && 
+       m_stats->finished_tasks() > m_max_finished_tasks) {
+        m_reaper_cv.notify_one();
+    }
+}
+
+// register the completion of tasks so that we can keep track of the
+// consumed bandwidth by each task. 'secs' is the wall time taken by the 
+// task, which (unlike its bandwidth) includes the per-task overhead
+void
+task_manager::record_completion(
+        const std::shared_ptr<task_info>& task_info_ptr, double secs) {
+
+    assert(task_info_ptr->status() == task_status::finished ||
+           task_info_ptr->status() == task_status::finished_with_error);
+
+    LOGGER_DEBUG("Task {} finished [{} MiB/s, {} seconds]", 
+            task_info_ptr->id(), task_info_ptr->bandwidth(), secs);
+
+    auto bw = task_info_ptr->bandwidth();
+
+    // bw might be nan if the task did not finish correctly
+    if(!std::isnan(bw)) {
+
+        if(task_info_ptr->pair_stats()) {
+            task_info_ptr->pair_stats()->record_transfer(
+                    task_info_ptr->sent_bytes(), secs);
+        }
+
+        if(!is_small_task(*task_info_ptr)) {
+            adjust_concurrency(task_info_ptr->sent_bytes());
+        }
+    }
+}
+
+// the bulk lane is resized at runtime by m_controller, which is fed with 
+// the aggregate throughput (MiB/s) achieved by the lane during each 
+// observation window. Since per-task bandwidth samples alone can't tell 
+// whether adding runners helps, the throughput is computed from the bytes 
+// transferred by all the tasks completed during the window
+void
+task_manager::adjust_concurrency(std::size_t bytes) {
+
+    std::lock_guard<std::mutex> lock(m_controller_mutex);
+
+    if(!m_controller.enabled()) {
+        return;
+    }
+
+    m_window_bytes += bytes;
+
+    const auto now = std::chrono::steady_clock::now();
+    const double elapsed = 
+        std::chrono::duration<double>(now - m_window_start).count();
+
+    if(elapsed < controller_period) {
+        return;
+    }
+
+    // the observed throughput only reflects the lane's concurrency if
+    // there was enough work to keep all runners busy
+    if(!m_bulk_lane.m_pending_tasks.empty()) {
+
+        const double throughput = 
+            (static_cast<double>(m_window_bytes) / (1024*1024)) / elapsed;
+        const uint32_t nrunners = m_controller.update(throughput);
+
+        if(nrunners != m_bulk_lane.m_runners.size()) {
+            LOGGER_INFO("Resizing bulk lane: {} -> {} runners "
+                        "(observed throughput: {} MiB/s)", 
+                        m_bulk_lane.m_runners.size(), nrunners, throughput);
+            m_bulk_lane.m_runners.resize(nrunners);
+        }
+    }
+
+    m_window_bytes = 0;
+    m_window_start = now;
+}
+
+std::shared_ptr<task_info>
+task_manager::find(iotask_id tid) const {
+    return m_task_table.find(tid);
+}
+
+bool
+task_manager::erase(iotask_id tid) {
+    return m_task_table.bury(tid);
+}
+
+boost::optional<task_tombstone>
+task_manager::find_tombstone(iotask_id tid) const {
+    return m_task_table.find_tombstone(tid);
+}
+
+urd_error
+task_manager::cancel(iotask_id tid, const auth::credentials& auth) {
+
+    const auto task_info_ptr = find(tid);
+
+    if(!task_info_ptr) {
+        // tasks whose final status has already been reported or that have
+        // been reaped only keep a tombstone
+        if(find_tombstone(tid)) {
+            return urd_error::task_finished;
+        }
+
+        return urd_error::no_such_task;
+    }
+
+    if(auth.uid() != 0 && auth.uid() != task_info_ptr->auth().uid()) {
+        return urd_error::not_task_owner;
+    }
+
+    const auto status = task_info_ptr->status();
+
+    if(status == task_status::finished || 
+       status == task_status::finished_with_error) {
+        return urd_error::task_finished;
+    }
+
+    // set the flag first so that a runner that has already popped the 
+    // task notices the cancellation before (or while) transferring data
+    task_info_ptr->cancel();
+
+    // if the task is still waiting for its parents or queued, drop it 
+    // right away
+    bool dropped = false;
+
+    {
+        std::lock_guard<utils::profiled_mutex> lock(m_deps_mutex);
+
+        if(m_blocked_tasks.erase(tid) != 0) {
+            LOGGER_INFO("Task {} cancelled while waiting for its parents", 
+                        tid);
+            dropped = true;
+        }
+    }
+
+    for(lane* l : {&m_small_lane, &m_bulk_lane}) {
+        if(!dropped && l->m_pending_tasks.remove(tid)) {
+            LOGGER_INFO("Task {} cancelled while pending in {} lane", 
+                        tid, l->m_name);
+            dropped = true;
+        }
+    }
+
+    if(dropped) {
+        task_info_ptr->update_status(task_status::finished_with_error,
+                urd_error::task_cancelled, 
+                std::make_error_code(std::errc::operation_canceled));
+        release_dependents(*task_info_ptr);
+        return urd_error::success;
+    }
+
+    LOGGER_INFO("Task {} flagged for cancellation", tid);
+
+    return urd_error::success;
+}
+
+io::global_stats
+task_manager::global_stats() const {
+
+    // task counters and per-pair aggregates are updated as tasks change 
+    // status, so that we don't need to visit every task here
+    const uint32_t running_tasks = m_stats->running_tasks();
+    const uint32_t pending_tasks = m_stats->pending_tasks();
+    const double eta = m_stats->eta();
+
+    LOGGER_DEBUG("E.T.A. for all pending and running tasks: {} seconds", eta);
+
+    std::vector<iotask_id> at_risk;
+
+    // estimating which deadlines are at risk requires simulating the 
+    // execution of queued tasks, which is only needed if some of them 
+    // has a deadline
+    if(m_stats->tasks_with_deadline() == 0) {
+        return io::global_stats(running_tasks, pending_tasks, eta, at_risk);
+    }
+
+    std::vector<std::shared_ptr<task_info>> small_running;
+    std::vector<std::shared_ptr<task_info>> bulk_running;
+
+    m_task_table.for_each([&](const std::shared_ptr<task_info>& tinfo) {
+
+        if(tinfo->status() != task_status::running) {
+            return;
+        }
+
+        if(is_small_task(*tinfo)) {
+            small_running.push_back(tinfo);
+            return;
+        }
+        bulk_running.push_back(tinfo);
+    });
+
+    at_risk = deadlines_at_risk(m_small_lane, small_running);
+    const auto bulk_at_risk = deadlines_at_risk(m_bulk_lane, bulk_running);
+
+    at_risk.insert(at_risk.end(), bulk_at_risk.begin(), bulk_at_risk.end());
+
+    return io::global_stats(running_tasks, pending_tasks, eta, at_risk);
+}
+
+// estimate which deadlines will be missed by simulating the execution of 
+// all running and pending tasks of a lane (the latter in scheduling order) 
+// over the lane's runners, using the bandwidth model for each pair of 
+// namespaces to estimate the duration of each task. Tasks for which no 
+// estimation is available yet are considered instantaneous
+std::vector<iotask_id>
+task_manager::deadlines_at_risk(
+        const lane& l,
+        const std::vector<std::shared_ptr<task_info>>& running) const {
+
+    using seconds = std::chrono::duration<double>;
+
+    const auto now = std::chrono::system_clock::now();
+    std::vector<iotask_id> at_risk;
+
+    const auto or_zero = [](double secs) {
+        return std::isnan(secs) ? 0.0 : secs;
+    };
+
+    const auto check = [&](task_info& tinfo, double completion) {
+        const auto deadline = tinfo.deadline();
+
+        if(!deadline) {
+            return;
+        }
+
+        const auto expected = now + 
+            std::chrono::duration_cast<iotask_deadline::duration>(
+                    seconds(completion));
+
+        if(expected > *deadline) {
+            // deadlines are checked on every status poll, warn only once
+            if(tinfo.mark_deadline_at_risk()) {
+                LOGGER_WARN("Deadline for task {} at risk (expected "
+                            "completion in {} seconds)", tinfo.id(), 
+                            completion);
             }
+            at_risk.push_back(tinfo.id());
+        }
+    };
 
-            case task_status::pending:
-                ++pending_tasks;
-                break;
+    // min-heap with the time (in seconds from now) at which each runner 
+    // will become available
+    std::priority_queue<double, std::vector<double>, 
+                        std::greater<double>> runners;
+
+    for(const auto& tinfo : running) {
+        const task_stats st{tinfo->stats()};
+        const double completion = !tinfo->pair_stats() ? 0.0 : 
+            or_zero(tinfo->pair_stats()->streaming_time(
+                        tinfo->total_bytes(), st.pending_bytes()));
+        check(*tinfo, completion);
+        runners.push(completion);
+    }
 
-            default:
-                break;
+    while(runners.size() < std::max(l.m_runners.size(), 1u)) {
+        runners.push(0.0);
+    }
+
+    for(const auto& tinfo : l.m_pending_tasks.snapshot()) {
+        const double start = runners.top();
+        runners.pop();
+
+        const double completion = start + (!tinfo->pair_stats() ? 0.0 : 
+            or_zero(tinfo->pair_stats()->predict(tinfo->total_bytes())));
+        check(*tinfo, completion);
+        runners.push(completion);
+    }
+
+    return at_risk;
+}
+
+io::transfer_estimate
+task_manager::estimate_transfer(const std::string& src_nsid, 
+                                const std::string& dst_nsid,
+                                std::size_t bytes, std::size_t nfiles) const {
+
+    const auto ps = m_stats->find(src_nsid, dst_nsid);
+
+    if(!ps) {
+        return io::transfer_estimate();
+    }
+
+    nfiles = std::max<std::size_t>(nfiles, 1);
+
+    const std::size_t sc = size_class(bytes / nfiles);
+    const auto model = ps->model();
+    const uint32_t running = 
+        std::max<uint32_t>(ps->m_running_tasks.load(), 1);
+
+    return io::transfer_estimate(ps->bandwidth(sc), 
+                                 model.m_overhead,
+                                 ps->predict(bytes, nfiles),
+                                 ps->backlog() / running,
+                                 model.m_samples[sc]);
+}
+
+std::error_code
+task_manager::save_bandwidth_models(const std::string& path) const {
+    return m_stats->save_models(path);
+}
+
+std::vector<io::latency_stats>
+task_manager::latencies() const {
+    return m_stats->latencies();
+}
+
+void
+task_manager::register_metrics(metrics::registry& registry) {
+
+    using metrics::metric_type;
+    using metrics::sample;
+
+    registry.add_collector("norns_tasks", 
+            "Number of tasks known to the daemon, by status",
+            metric_type::gauge, [this](std::vector<sample>& samples) {
+                samples.emplace_back(metrics::labels{{"status", "pending"}},
+                                     m_stats->pending_tasks());
+                samples.emplace_back(metrics::labels{{"status", "running"}},
+                                     m_stats->running_tasks());
+                samples.emplace_back(metrics::labels{{"status", "finished"}},
+                                     m_stats->finished_tasks());
+            });
+
+    registry.add_collector("norns_tasks_completed_total", 
+            "Number of tasks completed since the daemon started, by result",
+            metric_type::counter, [this](std::vector<sample>& samples) {
+                samples.emplace_back(metrics::labels{{"result", "success"}},
+                                     m_stats->succeeded_tasks_total());
+                samples.emplace_back(metrics::labels{{"result", "error"}},
+                                     m_stats->failed_tasks_total());
+            });
+
+    registry.add_collector("norns_blocked_tasks", 
+            "Number of tasks waiting for their parents to finish",
+            metric_type::gauge, [this](std::vector<sample>& samples) {
+                std::lock_guard<utils::profiled_mutex> lock(m_deps_mutex);
+                samples.emplace_back(metrics::labels(), 
+                                     m_blocked_tasks.size());
+            });
+
+    for(const lane* l : { &m_small_lane, &m_bulk_lane }) {
+
+        const metrics::labels lbls{{"lane", l->m_name}};
+
+        registry.add_collector("norns_queued_tasks", 
+                "Number of tasks waiting for a runner",
+                metric_type::gauge, [l, lbls](std::vector<sample>& samples) {
+                    samples.emplace_back(lbls, l->m_pending_tasks.size());
+                });
+
+        registry.add_collector("norns_runners", 
+                "Number of runners that may execute tasks",
+                metric_type::gauge, [l, lbls](std::vector<sample>& samples) {
+                    samples.emplace_back(lbls, l->m_runners.size());
+                });
+
+        registry.add_collector("norns_busy_runners", 
+                "Number of runners currently executing tasks",
+                metric_type::gauge, [l, lbls](std::vector<sample>& samples) {
+                    samples.emplace_back(lbls, l->m_busy_runners.load());
+                });
+
+        registry.add_collector("norns_runner_busy_seconds_total", 
+                "Time spent by runners executing tasks",
+                metric_type::counter, 
+                [l, lbls](std::vector<sample>& samples) {
+                    samples.emplace_back(lbls, l->m_busy_usecs.load() / 1e6);
+                });
+    }
+
+    registry.add_collector("norns_transferred_bytes_total", 
+            "Bytes transferred between each pair of namespaces",
+            metric_type::counter, [this](std::vector<sample>& samples) {
+                m_stats->for_each_pair([&](const std::string& src, 
+                                           const std::string& dst,
+                                           const pair_stats& ps) {
+                    samples.emplace_back(
+                            metrics::labels{{"src", src}, {"dst", dst}},
+                            ps.m_transferred_bytes.load());
+                });
+            });
+
+    registry.add_collector("norns_pending_bytes", 
+            "Bytes that queued and running tasks between each pair of "
+            "namespaces still have to transfer",
+            metric_type::gauge, [this](std::vector<sample>& samples) {
+                m_stats->for_each_pair([&](const std::string& src, 
+                                           const std::string& dst,
+                                           const pair_stats& ps) {
+                    uint64_t bytes = 0;
+
+                    for(std::size_t sc = 0; sc < num_size_classes; ++sc) {
+                        bytes += ps.m_queued_bytes[sc].load() + 
+                                 ps.m_running_bytes[sc].load();
+                    }
+
+                    samples.emplace_back(
+                            metrics::labels{{"src", src}, {"dst", dst}},
+                            bytes);
+                });
+            });
+
+    registry.add_collector("norns_flagged_tasks", 
+            "Number of running tasks flagged by the watchdog, by reason",
+            metric_type::gauge, [this](std::vector<sample>& samples) {
+                const auto flagged = slow_tasks();
+                const auto stalled = std::count_if(
+                        flagged.begin(), flagged.end(), 
+                        [](const slow_task& st) {
+                            return st.get_reason() == 
+                                slow_task::reason::stalled;
+                        });
+
+                samples.emplace_back(metrics::labels{{"reason", "slow"}},
+                                     flagged.size() - stalled);
+                samples.emplace_back(metrics::labels{{"reason", "stalled"}},
+                                     stalled);
+            });
+
+    registry.add_collector("norns_flagged_tasks_total", 
+            "Number of times that the watchdog flagged a task, by reason",
+            metric_type::counter, [this](std::vector<sample>& samples) {
+                samples.emplace_back(metrics::labels{{"reason", "slow"}},
+                                     m_slow_flags_total.load());
+                samples.emplace_back(metrics::labels{{"reason", "stalled"}},
+                                     m_stalled_flags_total.load());
+            });
+}
+
+std::error_code
+task_manager::load_bandwidth_models(const std::string& path) {
+    return m_stats->load_models(path);
+}
+
+void
+task_manager::start_model_saver(const std::string& path) {
+
+    if(path.empty() || m_model_saver.joinable()) {
+        return;
+    }
+
+    m_models_path = path;
+    m_model_saver = std::thread(&task_manager::model_saver_loop, this);
+}
+
+void
+task_manager::model_saver_loop() {
+
+    utils::trace::set_thread_name("model-saver");
+
+    std::unique_lock<std::mutex> lock(m_model_saver_mutex);
+
+    while(!m_model_saver_stop) {
+        m_model_saver_cv.wait_for(lock, model_save_interval);
+
+        if(m_model_saver_stop) {
+            break;
+        }
+
+        lock.unlock();
+
+        // models are written to a temporary file and renamed, so a crash
+        // while saving never leaves a truncated file behind
+        if(const auto ec = m_stats->save_models(m_models_path)) {
+            LOGGER_WARN("Failed to save bandwidth model to {}: {}", 
+                        m_models_path, ec.message());
         }
+
+        lock.lock();
+    }
+}
+
+void
+task_manager::stop_model_saver() {
+
+    {
+        std::lock_guard<std::mutex> lock(m_model_saver_mutex);
+        m_model_saver_stop = true;
+    }
+
+    m_model_saver_cv.notify_all();
+
+    if(m_model_saver.joinable()) {
+        m_model_saver.join();
     }
+}
+
+void
+task_manager::reaper_loop() {
+
+    // with a TTL, finished tasks are checked often enough that none of 
+    // them outlives it by much more than a quarter of it. Otherwise, the 
+    // reaper only needs to enforce m_max_finished_tasks, and is woken up 
+    // by run_task() when it is exceeded
+    const auto period = m_finished_task_ttl.count() != 0 ?
+        std::min(std::max(m_finished_task_ttl / 4, 
+                          std::chrono::seconds(1)), 
+                 std::chrono::seconds(60)) :
+        std::chrono::seconds(1);
 
-    const double eta = [&]() -> double {
-        if(running_tasks == 0) {
-            return 0.0;
+    std::unique_lock<std::mutex> lock(m_reaper_mutex);
+
+    while(!m_reaper_stop) {
+        m_reaper_cv.wait_for(lock, period);
+
+        if(m_reaper_stop) {
+            break;
         }
 
-        if(unreliable_eta) {
-            return std::numeric_limits<double>::quiet_NaN();
+        lock.unlock();
+
+        if(const auto n = reap_finished_tasks()) {
+            LOGGER_DEBUG("Reaped {} finished tasks", n);
         }
 
-        return *std::max_element(etas.begin(), etas.end());
-    }();
+        lock.lock();
+    }
+}
+
+std::size_t
+task_manager::reap_finished_tasks() {
+
+    // without a TTL only the cap matters, and the registry already keeps
+    // count of the finished tasks that are still alive
+    if(m_finished_task_ttl.count() == 0 &&
+       m_stats->finished_tasks() <= m_max_finished_tasks) {
+        return 0;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+
+    std::vector<std::pair<std::chrono::steady_clock::time_point, 
+                          iotask_id>> finished;
+    std::vector<iotask_id> expired;
+
+    m_task_table.for_each([&](const std::shared_ptr<task_info>& tinfo) {
+
+        const auto st = tinfo->status();
+
+        if(st != task_status::finished && 
+           st != task_status::finished_with_error) {
+            return;
+        }
+
+        const auto finish_time = tinfo->phase_time(task_phase::completed);
+
+        if(m_finished_task_ttl.count() != 0 && 
+           now - finish_time >= m_finished_task_ttl) {
+            expired.push_back(tinfo->id());
+            return;
+        }
+
+        if(m_max_finished_tasks != 0) {
+            finished.emplace_back(finish_time, tinfo->id());
+        }
+    });
+
+    std::size_t n = 0;
+
+    for(const auto tid : expired) {
+        n += m_task_table.bury(tid);
+    }
+
+    // when over the limit, reap the oldest tasks down to 90% of it so 
+    // that the reaper is not woken up again by every single task that 
+    // finishes
+    if(m_max_finished_tasks != 0 && finished.size() > m_max_finished_tasks) {
 
-    LOGGER_DEBUG("E.T.A. for all running tasks: {} seconds", eta);
+        const std::size_t excess = 
+            finished.size() - (m_max_finished_tasks - m_max_finished_tasks / 10);
 
-    return io::global_stats(running_tasks, pending_tasks, eta);
+        std::nth_element(finished.begin(), finished.begin() + excess - 1,
+                         finished.end());
+
+        for(std::size_t i = 0; i < excess; ++i) {
+            n += m_task_table.bury(finished[i].second);
+        }
+    }
+
+    return n;
+}
+
+void
+task_manager::stop_reaper() {
+
+    {
+        std::lock_guard<std::mutex> lock(m_reaper_mutex);
+        m_reaper_stop = true;
+    }
+
+    m_reaper_cv.notify_all();
+
+    if(m_reaper.joinable()) {
+        m_reaper.join();
+    }
+}
+
+void
+task_manager::start_watchdog(std::chrono::seconds interval, 
+                             std::chrono::seconds stall_timeout,
+                             double slow_fraction) {
+
+    if(interval.count() == 0 || m_watchdog.joinable()) {
+        return;
+    }
+
+    m_watchdog_interval = interval;
+    m_stall_timeout = stall_timeout;
+    m_slow_fraction = slow_fraction;
+    m_watchdog = std::thread(&task_manager::watchdog_loop, this);
+}
+
+bool
+task_manager::watchdog_enabled() const {
+    return m_watchdog_interval.count() != 0;
+}
+
+std::vector<io::slow_task>
+task_manager::slow_tasks() const {
+    std::lock_guard<std::mutex> lock(m_watchdog_mutex);
+    return m_slow_tasks;
+}
+
+void
+task_manager::watchdog_loop() {
+
+    utils::trace::set_thread_name("watchdog");
+
+    std::unique_lock<std::mutex> lock(m_watchdog_mutex);
+
+    while(!m_watchdog_stop) {
+        m_watchdog_cv.wait_for(lock, m_watchdog_interval);
+
+        if(m_watchdog_stop) {
+            break;
+        }
+
+        lock.unlock();
+        check_progress();
+        lock.lock();
+    }
+}
+
+void
+task_manager::check_progress() {
+
+    using clock = std::chrono::steady_clock;
+    using secs = std::chrono::duration<double>;
+
+    const auto now = clock::now();
+    constexpr const double mib = 1024 * 1024;
+
+    std::unordered_map<iotask_id, progress_sample> progress;
+    std::vector<io::slow_task> flagged;
+
+    m_task_table.for_each([&](const std::shared_ptr<task_info>& tinfo) {
+
+        if(tinfo->status() != task_status::running) {
+            return;
+        }
+
+        const auto tid = tinfo->id();
+        const std::size_t sent = tinfo->sent_bytes();
+        const std::size_t total = tinfo->total_bytes();
+
+        // transferors that don't report when they start moving data are 
+        // considered to start as soon as their resources are resolved
+        auto start = tinfo->phase_time(task_phase::started);
+
+        if(start == clock::time_point()) {
+            start = tinfo->phase_time(task_phase::resolved);
+        }
+
+        if(start == clock::time_point()) {
+            start = tinfo->phase_time(task_phase::dequeued);
+        }
+
+        const auto it = m_progress.find(tid);
+
+        progress_sample sample = it != m_progress.end() ? 
+            it->second : progress_sample{0, start, false};
+
+        if(sent > sample.m_sent_bytes) {
+            sample.m_sent_bytes = sent;
+            sample.m_last_progress = now;
+        }
+
+        const double elapsed = secs(now - start).count();
+        const double idle = secs(now - sample.m_last_progress).count();
+        const double rate = elapsed > 0 ? sent / mib / elapsed : 0.0;
+
+        double expected_rate = std::numeric_limits<double>::quiet_NaN();
+
+        if(const auto& ps = tinfo->pair_stats()) {
+            const double t = total != 0 ? 
+                ps->streaming_time(total, total) : 
+                std::numeric_limits<double>::quiet_NaN();
+
+            if(std::isfinite(t) && t > 0) {
+                expected_rate = total / mib / t;
+            }
+        }
+
+        boost::optional<slow_task::reason> why;
+
+        if(m_stall_timeout.count() != 0 && 
+           idle >= secs(m_stall_timeout).count()) {
+            why = slow_task::reason::stalled;
+        }
+        // give tasks a full period to ramp up before judging their rate
+        else if(m_slow_fraction > 0 && !std::isnan(expected_rate) && 
+                elapsed >= secs(m_watchdog_interval).count() &&
+                rate < m_slow_fraction * expected_rate) {
+            why = slow_task::reason::slow;
+        }
+
+        if(why) {
+            flagged.emplace_back(tid, *why, sent, total, rate, 
+                                 expected_rate, idle);
+
+            if(!sample.m_flagged) {
+                (*why == slow_task::reason::stalled ? 
+                    m_stalled_flags_total : m_slow_flags_total)++;
+
+                LOGGER_WARN("[{}] Task is {}: {} of {} bytes transferred "
+                            "({} MiB/s, expected {} MiB/s, no progress "
+                            "for {} secs)", tid, utils::to_string(*why),
+                            sent, total, rate, expected_rate, idle);
+            }
+        }
+        else if(sample.m_flagged) {
+            LOGGER_INFO("[{}] Task is progressing again", tid);
+        }
+
+        sample.m_flagged = static_cast<bool>(why);
+        progress.emplace(tid, sample);
+    });
+
+    // forget the tasks that are no longer running
+    m_progress.swap(progress);
+
+    std::lock_guard<std::mutex> lock(m_watchdog_mutex);
+    m_slow_tasks.swap(flagged);
+}
+
+void
+task_manager::stop_watchdog() {
+
+    {
+        std::lock_guard<std::mutex> lock(m_watchdog_mutex);
+        m_watchdog_stop = true;
+    }
+
+    m_watchdog_cv.notify_all();
+
+    if(m_watchdog.joinable()) {
+        m_watchdog.join();
+    }
 }
 
 void
 task_manager::stop_all_tasks() {
-    m_runners.stop();
+    stop_model_saver();
+    stop_watchdog();
+    stop_reaper();
+    m_small_lane.m_runners.stop();
+    m_bulk_lane.m_runners.stop();
 }
 
 } // namespace io
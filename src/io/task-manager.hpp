@@ -38,12 +38,28 @@
 #ifndef __TASK_MANAGER_HPP__
 #define __TASK_MANAGER_HPP__
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <functional>
+#include <string>
+#include <system_error>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 #include <boost/optional.hpp>
-#include <boost/circular_buffer.hpp>
 #include "thread-pool.hpp"
 #include "task.hpp"
+#include "task-queue.hpp"
+#include "task-table.hpp"
+#include "rate-limiter.hpp"
+#include "stats-registry.hpp"
+#include "concurrency-controller.hpp"
+#include "utils/block-cache.hpp"
+#include "utils/profiled-mutex.hpp"
 #include "common.hpp"
 
 namespace norns {
@@ -53,25 +69,22 @@ namespace data {
 enum class resource_type;
 }
 
+namespace metrics {
+struct registry;
+}
+
 namespace io {
 
 // forward declarations
 enum class task_status;
 struct task_stats;
+struct transfer_estimate;
+struct latency_stats;
+struct slow_task;
 struct task_info;
 
 struct task_manager : public std::enable_shared_from_this<task_manager> {
 
-    struct pair_hash {
-        template <typename T, typename U>
-        std::size_t operator()(const std::pair<T, U> &x) const {
-            std::size_t seed = 0;
-            boost::hash_combine(seed, x.first);
-            boost::hash_combine(seed, x.second);
-            return seed;
-        }
-    };
-
     using key_type = iotask_id; 
     using value_type = std::shared_ptr<task_info>;
     using backend_ptr = std::shared_ptr<storage::backend>;
@@ -81,15 +94,39 @@ struct task_manager : public std::enable_shared_from_this<task_manager> {
     using ReturnType = std::tuple<iotask_id, std::shared_ptr<task_info>>;
 
     task_manager(uint32_t nrunners, 
+                 uint32_t min_nrunners,
+                 uint32_t max_nrunners,
+                 uint32_t small_task_nrunners,
+                 uint64_t small_task_threshold,
                  uint32_t backlog_size, 
+                 uint32_t finished_task_ttl,
+                 uint32_t max_finished_tasks,
                  bool dry_run, 
                  uint32_t dry_run_duration);
 
+    ~task_manager();
+
     bool
     register_transfer_plugin(const data::resource_type t1,
                              const data::resource_type t2,
                              std::shared_ptr<io::transferor>&& trp);
 
+    void
+    add_bandwidth_limit(const std::string& nsid, uint64_t rate);
+
+    void
+    add_bandwidth_limit(const std::string& src_nsid, 
+                        const std::string& dst_nsid, 
+                        uint64_t rate);
+
+    void
+    add_numa_affinity(const std::string& nsid, int32_t node);
+
+    /*! Make local copies that read from or write to 'nsid' bypass the 
+     * page cache */
+    void
+    add_direct_io(const std::string& nsid);
+
     boost::optional<iotask_id>
     create_task(iotask_type type, const auth::credentials& creds, 
             const backend_ptr src_backend, const resource_info_ptr src_rinfo, 
@@ -105,7 +142,10 @@ struct task_manager : public std::enable_shared_from_this<task_manager> {
     create_local_initiated_task(iotask_type type,
                         const auth::credentials& auth,
                         const std::vector<backend_ptr>& backend_ptrs,
-                        const std::vector<resource_info_ptr>& rinfo_ptrs);
+                        const std::vector<resource_info_ptr>& rinfo_ptrs,
+                        const iotask_priority priority = iotask_priority::normal,
+                        const boost::optional<iotask_deadline>& deadline = boost::none,
+                        const std::vector<iotask_id>& parents = {});
 
     std::tuple<urd_error, boost::optional<io::generic_task>>
     create_remote_initiated_task(iotask_type task_type,
@@ -122,37 +162,262 @@ struct task_manager : public std::enable_shared_from_this<task_manager> {
     std::shared_ptr<task_info>
     find(iotask_id) const;
 
+    /*! Remove a finished task, keeping a tombstone with its final status */
     bool
     erase(iotask_id);
 
+    /*! Return the final status of a task that has already been erased or 
+     * reaped, if its tombstone is still available */
+    boost::optional<task_tombstone>
+    find_tombstone(iotask_id) const;
+
+    /*! Cancel a task on behalf of the user identified by 'auth', who must 
+     * own it (or be root). Tasks that have already finished cannot be 
+     * cancelled */
+    urd_error
+    cancel(iotask_id, const auth::credentials& auth);
+
     template <typename UnaryPredicate>
     std::size_t
     count_if(UnaryPredicate&& p) {
-        boost::unique_lock<boost::shared_mutex> lock(m_mutex);
-        return std::count_if(m_task_info.begin(),
-                             m_task_info.end(),
-                             [&](const std::pair<key_type, value_type>& kv) {
-                                return p(kv.second);
-                             });
+        return m_task_table.count_if(std::forward<UnaryPredicate>(p));
     }
 
     io::global_stats
     global_stats() const;
 
+    /*! Estimate the cost of transferring 'bytes' distributed over 'nfiles' 
+     * files from src_nsid to dst_nsid, according to the bandwidth model 
+     * learnt from previous transfers between them */
+    io::transfer_estimate
+    estimate_transfer(const std::string& src_nsid, 
+                      const std::string& dst_nsid,
+                      std::size_t bytes, std::size_t nfiles) const;
+
+    /*! Latencies of the phases of completed tasks, per task type and 
+     * pair of namespaces */
+    std::vector<io::latency_stats>
+    latencies() const;
+
+    /*! Register collectors for the task manager's metrics (tasks by 
+     * status, queue depths, runner utilization and bytes transferred 
+     * between namespaces). The registry must not collect them once the 
+     * task manager has been destroyed */
+    void
+    register_metrics(metrics::registry& registry);
+
+    /*! Start a watchdog that checks the progress of running tasks every 
+     * 'interval'. Tasks are flagged as stalled if they make no progress 
+     * for 'stall_timeout', and as slow if their rate since they started 
+     * transferring data falls below 'slow_fraction' times the one expected 
+     * by the bandwidth model of their namespaces (0 disables either check).
+     * Tasks whose transferor only reports progress once the transfer 
+     * completes are flagged as stalled if they take longer than 
+     * 'stall_timeout' */
+    void
+    start_watchdog(std::chrono::seconds interval, 
+                   std::chrono::seconds stall_timeout,
+                   double slow_fraction);
+
+    bool
+    watchdog_enabled() const;
+
+    /*! Running tasks flagged by the last check of the watchdog */
+    std::vector<io::slow_task>
+    slow_tasks() const;
+
+    /*! Save the bandwidth models learnt so far to 'path' */
+    std::error_code
+    save_bandwidth_models(const std::string& path) const;
+
+    /*! Load bandwidth models previously saved to 'path' */
+    std::error_code
+    load_bandwidth_models(const std::string& path);
+
+    /*! Save the bandwidth models to 'path' periodically, so that what has
+     * been learnt survives a crash of the daemon */
+    void
+    start_model_saver(const std::string& path);
+
     void 
     stop_all_tasks();
 
 private:
-    mutable boost::shared_mutex m_mutex;
-    iotask_id m_id_base = 0;
-    const uint32_t m_backlog_size;
+    /*! A set of runners with its own queue of pending tasks. Tasks are
+     * routed either to the small lane (removals, noops, and transfers up
+     * to m_small_task_threshold bytes) or to the bulk lane (everything
+     * else), so that long transfers cannot delay short ones indefinitely.
+     * Runners of the small lane coalesce consecutive copies or moves 
+     * between the same pair of namespaces and execute them as a batch */
+    struct lane {
+
+        /*! Pool task that makes a runner execute the next pending task of
+         * the lane. The lane owns a single instance that is submitted once
+         * for every enqueued task, so that handing work over to the 
+         * runners does not require any allocations */
+        struct runner_task final : public detail::task {
+            runner_task(task_manager& manager, lane& l);
+            void execute() override;
+            void release() override;
+
+            task_manager& m_manager;
+            lane& m_lane;
+        };
+
+        lane(task_manager& manager, const std::string& name, 
+             uint32_t nrunners, uint32_t max_nrunners);
+
+        const std::string m_name;
+        task_queue m_pending_tasks;
+        runner_task m_runner_task;
+        thread_pool m_runners;
+        // runners currently executing tasks and total time spent doing so
+        std::atomic<uint32_t> m_busy_runners;
+        std::atomic<uint64_t> m_busy_usecs;
+    };
+
+    /*! A task waiting for its parents to finish before it can be handed 
+     * over to a lane */
+    struct blocked_task {
+        blocked_task(generic_task&& tsk, std::size_t pending_parents);
+
+        generic_task m_task;
+        std::size_t m_pending_parents;
+    };
+
+    void
+    schedule(generic_task&& tsk);
+
+    void
+    release_dependents(const task_info& parent);
+
+    bool
+    is_small_task(const task_info& tinfo) const;
+
+    rate_limiter
+    get_rate_limiter(const backend_ptr& src_backend,
+                     const backend_ptr& dst_backend) const;
+
+    int32_t
+    get_numa_node(const backend_ptr& src_backend,
+                  const backend_ptr& dst_backend) const;
+
+    bool
+    uses_direct_io(const backend_ptr& src_backend,
+                   const backend_ptr& dst_backend) const;
+
+    void
+    run_next_task(lane& l);
+
+    void
+    run_task(generic_task& tsk);
+
+    void
+    record_completion(const std::shared_ptr<task_info>& task_info_ptr,
+                      double secs);
+
+    void
+    adjust_concurrency(std::size_t bytes);
+
+    std::vector<iotask_id>
+    deadlines_at_risk(const lane& l,
+                      const std::vector<std::shared_ptr<task_info>>& running) const;
+
+    void
+    reaper_loop();
+
+    std::size_t
+    reap_finished_tasks();
+
+    void
+    stop_reaper();
+
+    void
+    watchdog_loop();
+
+    void
+    check_progress();
+
+    void
+    stop_watchdog();
+
+    void
+    model_saver_loop();
+
+    void
+    stop_model_saver();
+
+private:
+    using task_info_allocator = utils::cached_allocator<task_info>;
+
+    std::atomic<iotask_id> m_id_base;
+    // incrementally maintained task statistics (see global_stats())
+    const std::shared_ptr<stats_registry> m_stats;
     bool m_dry_run;
     uint32_t m_dry_run_duration;
-    std::unordered_map<iotask_id, std::shared_ptr<task_info>> m_task_info;
-    std::unordered_map<std::pair<std::string, std::string>,
-                       boost::circular_buffer<double>, pair_hash> m_bandwidth_backlog;
-    thread_pool m_runners;
+    const uint64_t m_small_task_threshold;
+    // task_infos and the nodes of m_task_table are recycled through 
+    // m_block_cache so that creating tasks does not allocate once the 
+    // daemon reaches a steady state
+    std::shared_ptr<utils::block_cache> m_block_cache;
+    task_table m_task_table;
+    rate_limit_registry m_rate_limits;
+    // NUMA node whose CPUs should run the tasks involving each namespace
+    std::unordered_map<std::string, int32_t> m_numa_affinities;
+    // namespaces whose data should not go through the page cache
+    std::unordered_set<std::string> m_direct_io_namespaces;
+    lane m_small_lane;
+    lane m_bulk_lane;
+
+    // task dependencies: tasks waiting for their parents and, for each 
+    // unfinished parent, the tasks that depend on it
+    utils::profiled_mutex m_deps_mutex{"task_manager.dependencies"};
+    std::unordered_map<iotask_id, blocked_task> m_blocked_tasks;
+    std::unordered_map<iotask_id, std::vector<iotask_id>> m_dependents;
+
+    // adaptive sizing of the bulk lane
+    std::mutex m_controller_mutex;
+    concurrency_controller m_controller;
+    std::size_t m_window_bytes;
+    std::chrono::steady_clock::time_point m_window_start;
     io::transferor_registry m_transferor_registry;
+
+    // reaping of finished tasks: tasks are replaced by tombstones once 
+    // they have been finished for longer than m_finished_task_ttl or if 
+    // more than m_max_finished_tasks are retained (0 disables either limit)
+    const std::chrono::seconds m_finished_task_ttl;
+    const uint32_t m_max_finished_tasks;
+    std::mutex m_reaper_mutex;
+    std::condition_variable m_reaper_cv;
+    bool m_reaper_stop;
+    std::thread m_reaper;
+
+    // watchdog: progress observed for each running task (only accessed 
+    // by the watchdog thread) and the tasks flagged by the last check
+    struct progress_sample {
+        std::size_t m_sent_bytes;
+        std::chrono::steady_clock::time_point m_last_progress;
+        bool m_flagged;
+    };
+
+    std::chrono::seconds m_watchdog_interval;
+    std::chrono::seconds m_stall_timeout;
+    double m_slow_fraction;
+    std::unordered_map<iotask_id, progress_sample> m_progress;
+    mutable std::mutex m_watchdog_mutex;
+    std::condition_variable m_watchdog_cv;
+    bool m_watchdog_stop;
+    std::vector<io::slow_task> m_slow_tasks;
+    std::atomic<uint64_t> m_slow_flags_total;
+    std::atomic<uint64_t> m_stalled_flags_total;
+    std::thread m_watchdog;
+
+    // periodic saving of the bandwidth models
+    std::string m_models_path;
+    std::mutex m_model_saver_mutex;
+    std::condition_variable m_model_saver_cv;
+    bool m_model_saver_stop;
+    std::thread m_model_saver;
 };
 
 } // namespace io
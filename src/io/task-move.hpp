@@ -51,6 +51,7 @@ task<iotask_type::move>::operator()() {
     std::error_code ec;
 
     const auto tid = m_task_info->id();
+    const utils::trace::scope trace_scope("task", "move", tid);
     const auto type = m_task_info->type();
     const auto src_backend = m_task_info->src_backend();
     const auto src_rinfo = m_task_info->src_rinfo();
@@ -69,10 +70,13 @@ task<iotask_type::move>::operator()() {
         LOGGER_WARN("[{}] I/O task completed with error", tid);
     };
 
-    LOGGER_WARN("[{}] Starting I/O task", tid);
-    LOGGER_WARN("[{}]   TYPE: {}", tid, utils::to_string(type));
-    LOGGER_WARN("[{}]   FROM: {}", tid, src_backend->to_string());
-    LOGGER_WARN("[{}]     TO: {}", tid, dst_backend->to_string());
+    // coalesced tasks are announced by the task manager as a batch
+    if(!m_coalesced) {
+        LOGGER_WARN("[{}] Starting I/O task", tid);
+        LOGGER_WARN("[{}]   TYPE: {}", tid, utils::to_string(type));
+        LOGGER_WARN("[{}]   FROM: {}", tid, src_backend->to_string());
+        LOGGER_WARN("[{}]     TO: {}", tid, dst_backend->to_string());
+    }
 
     m_task_info->update_status(task_status::running);
 
@@ -90,15 +94,26 @@ task<iotask_type::move>::operator()() {
         return;
     }
 
+    m_task_info->mark(task_phase::resolved);
+
     ec = m_transferor->transfer(auth, m_task_info, src, dst);
 
     if(ec) {
+        if(m_task_info->is_cancelled()) {
+            m_task_info->update_status(task_status::finished_with_error,
+                                       urd_error::task_cancelled, ec);
+            LOGGER_WARN("[{}] I/O task cancelled", tid);
+            return;
+        }
+
         log_error("Transfer failed");
         return;
     }
 
-    LOGGER_WARN("[{}] I/O task completed successfully [{} MiB/s]", 
-                tid, m_task_info->bandwidth());
+    if(!m_coalesced) {
+        LOGGER_WARN("[{}] I/O task completed successfully [{} MiB/s]", 
+                    tid, m_task_info->bandwidth());
+    }
 
     m_task_info->update_status(task_status::finished, urd_error::success, 
                     std::make_error_code(static_cast<std::errc>(ec.value())));
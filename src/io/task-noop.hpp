@@ -53,13 +53,14 @@ struct task<iotask_type::noop> {
         : m_task_info(std::move(task_info)),
           m_sleep_duration(sleep_duration) { }
 
-    task(const task& other) = default;
+    task(const task& other) = delete;
     task(task&& rhs) = default;
-    task& operator=(const task& other) = default;
+    task& operator=(const task& other) = delete;
     task& operator=(task&& rhs) = default;
 
     void operator()() {
         const auto tid = m_task_info->id();
+        const utils::trace::scope trace_scope("task", "noop", tid);
 
         LOGGER_WARN("[{}] Starting noop I/O task", tid);
 
@@ -0,0 +1,201 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <algorithm>
+#include "task-info.hpp"
+#include "task-queue.hpp"
+
+namespace norns {
+namespace io {
+
+task_queue::entry::entry(uint64_t seqno, generic_task&& tsk) :
+    m_priority(tsk.info()->priority()),
+    m_deadline(tsk.info()->deadline().get_value_or(iotask_deadline::max())),
+    m_seqno(seqno),
+    m_task(std::move(tsk)) { }
+
+bool
+task_queue::entry_compare::operator()(const entry& lhs, 
+                                      const entry& rhs) const {
+
+    if(lhs.m_priority != rhs.m_priority) {
+        return static_cast<int>(lhs.m_priority) < 
+               static_cast<int>(rhs.m_priority);
+    }
+
+    if(lhs.m_deadline != rhs.m_deadline) {
+        return lhs.m_deadline > rhs.m_deadline;
+    }
+
+    return lhs.m_seqno > rhs.m_seqno;
+}
+
+bool
+task_queue::push(generic_task&& tsk) {
+    std::lock_guard<utils::profiled_mutex> lock(m_mutex);
+    m_heap.emplace_back(m_seqno++, std::move(tsk));
+    std::push_heap(m_heap.begin(), m_heap.end(), entry_compare());
+
+    if(m_credits != 0) {
+        --m_credits;
+        return false;
+    }
+
+    return true;
+}
+
+boost::optional<generic_task>
+task_queue::pop() {
+    std::lock_guard<utils::profiled_mutex> lock(m_mutex);
+
+    if(m_heap.empty()) {
+        // the caller was a notification left behind by a coalesced or 
+        // removed task
+        if(m_credits != 0) {
+            --m_credits;
+        }
+        return boost::none;
+    }
+
+    std::pop_heap(m_heap.begin(), m_heap.end(), entry_compare());
+    generic_task tsk(std::move(m_heap.back().m_task));
+    m_heap.pop_back();
+
+    return tsk;
+}
+
+std::size_t
+task_queue::pop_batch(std::vector<generic_task>& batch, 
+                      std::size_t max_tasks,
+                      const coalesce_fn& can_coalesce) {
+
+    std::lock_guard<utils::profiled_mutex> lock(m_mutex);
+
+    if(m_heap.empty()) {
+        if(m_credits != 0) {
+            --m_credits;
+        }
+        return 0;
+    }
+
+    const std::size_t head = batch.size();
+    const bool has_deadline = 
+        m_heap.front().m_deadline != iotask_deadline::max();
+    std::size_t ntasks = 0;
+
+    // tasks are only coalesced while they are next in scheduling order, so
+    // that a batch never delays tasks that would have been scheduled before
+    // any of its members
+    do {
+        std::pop_heap(m_heap.begin(), m_heap.end(), entry_compare());
+        batch.emplace_back(std::move(m_heap.back().m_task));
+        m_heap.pop_back();
+        ++ntasks;
+    } while(!has_deadline && ntasks < max_tasks && !m_heap.empty() &&
+            m_heap.front().m_deadline == iotask_deadline::max() &&
+            can_coalesce(batch[head], m_heap.front().m_task));
+
+    m_credits += ntasks - 1;
+
+    return ntasks;
+}
+
+bool
+task_queue::remove(iotask_id tid) {
+    std::lock_guard<utils::profiled_mutex> lock(m_mutex);
+
+    const auto it = std::find_if(m_heap.begin(), m_heap.end(),
+            [&](const entry& e) {
+                return e.m_task.id() == tid;
+            });
+
+    if(it == m_heap.end()) {
+        return false;
+    }
+
+    m_heap.erase(it);
+    std::make_heap(m_heap.begin(), m_heap.end(), entry_compare());
+
+    // the runner notified for this task will find no work
+    ++m_credits;
+
+    return true;
+}
+
+std::size_t
+task_queue::size() const {
+    std::lock_guard<utils::profiled_mutex> lock(m_mutex);
+    return m_heap.size();
+}
+
+bool
+task_queue::empty() const {
+    std::lock_guard<utils::profiled_mutex> lock(m_mutex);
+    return m_heap.empty();
+}
+
+std::vector<std::shared_ptr<task_info>>
+task_queue::snapshot() const {
+
+    std::vector<const entry*> entries;
+
+    std::lock_guard<utils::profiled_mutex> lock(m_mutex);
+
+    entries.reserve(m_heap.size());
+
+    for(const auto& e : m_heap) {
+        entries.push_back(&e);
+    }
+
+    std::sort(entries.begin(), entries.end(), 
+            [](const entry* lhs, const entry* rhs) {
+                // sort from highest to lowest precedence
+                return entry_compare()(*rhs, *lhs);
+            });
+
+    std::vector<std::shared_ptr<task_info>> infos;
+    infos.reserve(entries.size());
+
+    for(const auto e : entries) {
+        infos.push_back(e->m_task.info());
+    }
+
+    return infos;
+}
+
+} // namespace io
+} // namespace norns
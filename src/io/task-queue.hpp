@@ -0,0 +1,132 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#ifndef __IO_TASK_QUEUE_HPP__
+#define __IO_TASK_QUEUE_HPP__
+
+#include <functional>
+#include <mutex>
+#include <vector>
+#include <boost/optional.hpp>
+
+#include "common.hpp"
+#include "utils/profiled-mutex.hpp"
+#include "task.hpp"
+
+namespace norns {
+namespace io {
+
+// forward declarations
+struct task_info;
+
+/*! Queue of I/O tasks waiting for a worker thread. Tasks are ordered by
+ * priority class and, within the same class, by earliest deadline first. 
+ * Tasks without a deadline go after those that have one, and ties are 
+ * resolved in FIFO order */
+struct task_queue {
+
+    /*! Predicate that determines whether a queued task (second argument) 
+     * can be executed together with the task at the head of the queue 
+     * (first argument) */
+    using coalesce_fn = 
+        std::function<bool(const generic_task&, const generic_task&)>;
+
+    /*! Add a task to the queue. Returns true if the caller needs to 
+     * notify a runner, or false if the task will be picked up by a runner 
+     * that was notified earlier and found no work (see pop_batch()) */
+    bool
+    push(generic_task&& tsk);
+
+    boost::optional<generic_task>
+    pop();
+
+    /*! Pop the task at the head of the queue along with up to 
+     * max_tasks - 1 of the tasks that follow it in scheduling order, 
+     * stopping at the first one for which can_coalesce() returns false, 
+     * and append them to batch. Tasks with a deadline are never coalesced.
+     * Returns the number of tasks popped.
+     *
+     * Since runners are notified once per pushed task, every task 
+     * coalesced into a batch leaves one notification without work. These
+     * are recorded as credits so that push() can skip notifying runners
+     * until they are consumed */
+    std::size_t
+    pop_batch(std::vector<generic_task>& batch, std::size_t max_tasks,
+              const coalesce_fn& can_coalesce);
+
+    /*! Remove the task with id tid from the queue, if present. Returns 
+     * true if the task was found (and thus never reached a runner) */
+    bool
+    remove(iotask_id tid);
+
+    std::size_t 
+    size() const;
+
+    bool 
+    empty() const;
+
+    /*! Return the task_infos of all queued tasks, in scheduling order */
+    std::vector<std::shared_ptr<task_info>>
+    snapshot() const;
+
+private:
+    struct entry {
+        entry(uint64_t seqno, generic_task&& tsk);
+
+        iotask_priority m_priority;
+        iotask_deadline m_deadline;
+        uint64_t m_seqno;
+        generic_task m_task;
+    };
+
+    // returns true if lhs should be scheduled after rhs
+    struct entry_compare {
+        bool operator()(const entry& lhs, const entry& rhs) const;
+    };
+
+    mutable utils::profiled_mutex m_mutex{"task_queue"};
+    uint64_t m_seqno = 0;
+    // number of runner notifications that have already been issued but
+    // that no longer have a task associated
+    std::size_t m_credits = 0;
+    std::vector<entry> m_heap;
+};
+
+} // namespace io
+} // namespace norns
+
+#endif /* __IO_TASK_QUEUE_HPP__ */
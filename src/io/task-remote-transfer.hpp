@@ -49,6 +49,7 @@ inline void
 task<iotask_type::remote_transfer>::operator()() {
 
     const auto tid = m_task_info->id();
+    const utils::trace::scope trace_scope("task", "remote_transfer", tid);
     const auto type = m_task_info->type();
     const auto auth = m_task_info->auth();
     const auto src_backend = m_task_info->src_backend();
@@ -90,6 +91,8 @@ task<iotask_type::remote_transfer>::operator()() {
         return;
     }
 
+    m_task_info->mark(task_phase::resolved);
+
     if(m_task_info->is_remote()) {
         ec = m_transferor->accept_transfer(auth, m_task_info, src, dst);
     }
@@ -99,6 +102,13 @@ task<iotask_type::remote_transfer>::operator()() {
 
 
     if(ec) {
+        if(m_task_info->is_cancelled()) {
+            m_task_info->update_status(task_status::finished_with_error,
+                                       urd_error::task_cancelled, ec);
+            LOGGER_WARN("[{}] I/O task cancelled", tid);
+            return;
+        }
+
         log_error("Transfer failed");
         return;
     }
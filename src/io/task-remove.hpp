@@ -51,6 +51,7 @@ task<iotask_type::remove>::operator()() {
     std::error_code ec;
 
     const auto tid = m_task_info->id();
+    const utils::trace::scope trace_scope("task", "remove", tid);
     const auto type = m_task_info->type();
     const auto src_backend = m_task_info->src_backend();
     const auto src_rinfo = m_task_info->src_rinfo();
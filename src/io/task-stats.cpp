@@ -46,15 +46,18 @@ task_stats::task_stats() :
     m_task_error(urd_error::success),
     m_sys_error(),
     m_total_bytes(),
-    m_pending_bytes() { }
+    m_pending_bytes(),
+    m_copy_engines(0) { }
 
 task_stats::task_stats(task_status st, urd_error ec, const std::error_code& sc,
-            std::size_t total_bytes, std::size_t pending_bytes) :
+            std::size_t total_bytes, std::size_t pending_bytes,
+            uint32_t copy_engines) :
     m_status(st),
     m_task_error(ec),
     m_sys_error(sc),
     m_total_bytes(total_bytes),
-    m_pending_bytes(pending_bytes) { }
+    m_pending_bytes(pending_bytes),
+    m_copy_engines(copy_engines) { }
 
 std::size_t task_stats::pending_bytes() const {
     return m_pending_bytes;
@@ -64,6 +67,10 @@ std::size_t task_stats::total_bytes() const {
     return m_total_bytes;
 }
 
+uint32_t task_stats::copy_engines() const {
+    return m_copy_engines;
+}
+
 task_status task_stats::status() const {
     return m_status;
 }
@@ -95,10 +102,12 @@ global_stats::global_stats() :
     m_eta(std::numeric_limits<double>::quiet_NaN()) {}
 
 global_stats::global_stats(uint32_t running_tasks, uint32_t pending_tasks, 
-                           double eta) :
+                           double eta, 
+                           const std::vector<iotask_id>& deadlines_at_risk) :
     m_running_tasks(running_tasks),
     m_pending_tasks(pending_tasks),
-    m_eta(eta) {}
+    m_eta(eta),
+    m_deadlines_at_risk(deadlines_at_risk) {}
 
 uint32_t
 global_stats::running_tasks() const {
@@ -115,6 +124,176 @@ global_stats::eta() const {
     return m_eta;
 }
 
+std::vector<iotask_id>
+global_stats::deadlines_at_risk() const {
+    return m_deadlines_at_risk;
+}
+
+transfer_estimate::transfer_estimate() :
+    m_bandwidth(std::numeric_limits<double>::quiet_NaN()),
+    m_overhead(std::numeric_limits<double>::quiet_NaN()),
+    m_duration(std::numeric_limits<double>::quiet_NaN()),
+    m_backlog(0.0),
+    m_samples(0) {}
+
+transfer_estimate::transfer_estimate(double bandwidth, double overhead, 
+                                     double duration, double backlog, 
+                                     uint32_t samples) :
+    m_bandwidth(bandwidth),
+    m_overhead(overhead),
+    m_duration(duration),
+    m_backlog(backlog),
+    m_samples(samples) {}
+
+double
+transfer_estimate::bandwidth() const {
+    return m_bandwidth;
+}
+
+double
+transfer_estimate::overhead() const {
+    return m_overhead;
+}
+
+double
+transfer_estimate::duration() const {
+    return m_duration;
+}
+
+double
+transfer_estimate::backlog() const {
+    return m_backlog;
+}
+
+uint32_t
+transfer_estimate::samples() const {
+    return m_samples;
+}
+
+latency_stats::latency_stats() :
+    m_scope(scope::task_type),
+    m_phase(latency_phase::total),
+    m_count(0),
+    m_mean(0.0),
+    m_p50(0.0),
+    m_p90(0.0),
+    m_p99(0.0),
+    m_max(0.0) {}
+
+latency_stats::latency_stats(scope sc, const std::string& name, 
+                             latency_phase phase, uint64_t count, 
+                             double mean, double p50, double p90, 
+                             double p99, double max) :
+    m_scope(sc),
+    m_name(name),
+    m_phase(phase),
+    m_count(count),
+    m_mean(mean),
+    m_p50(p50),
+    m_p90(p90),
+    m_p99(p99),
+    m_max(max) {}
+
+latency_stats::scope
+latency_stats::get_scope() const {
+    return m_scope;
+}
+
+std::string
+latency_stats::name() const {
+    return m_name;
+}
+
+latency_phase
+latency_stats::phase() const {
+    return m_phase;
+}
+
+uint64_t
+latency_stats::count() const {
+    return m_count;
+}
+
+double
+latency_stats::mean() const {
+    return m_mean;
+}
+
+double
+latency_stats::p50() const {
+    return m_p50;
+}
+
+double
+latency_stats::p90() const {
+    return m_p90;
+}
+
+double
+latency_stats::p99() const {
+    return m_p99;
+}
+
+double
+latency_stats::max() const {
+    return m_max;
+}
+
+slow_task::slow_task() :
+    m_tid(0),
+    m_reason(reason::slow),
+    m_sent_bytes(0),
+    m_total_bytes(0),
+    m_rate(0.0),
+    m_expected_rate(std::numeric_limits<double>::quiet_NaN()),
+    m_idle_time(0.0) {}
+
+slow_task::slow_task(iotask_id tid, reason why, std::size_t sent_bytes, 
+                     std::size_t total_bytes, double rate, 
+                     double expected_rate, double idle_time) :
+    m_tid(tid),
+    m_reason(why),
+    m_sent_bytes(sent_bytes),
+    m_total_bytes(total_bytes),
+    m_rate(rate),
+    m_expected_rate(expected_rate),
+    m_idle_time(idle_time) {}
+
+iotask_id
+slow_task::id() const {
+    return m_tid;
+}
+
+slow_task::reason
+slow_task::get_reason() const {
+    return m_reason;
+}
+
+std::size_t
+slow_task::sent_bytes() const {
+    return m_sent_bytes;
+}
+
+std::size_t
+slow_task::total_bytes() const {
+    return m_total_bytes;
+}
+
+double
+slow_task::rate() const {
+    return m_rate;
+}
+
+double
+slow_task::expected_rate() const {
+    return m_expected_rate;
+}
+
+double
+slow_task::idle_time() const {
+    return m_idle_time;
+}
+
 } // namespace io
 
 namespace utils {
@@ -137,7 +316,83 @@ std::string to_string(io::task_status st) {
 std::string to_string(const io::global_stats& gst) {
     return "(r: " + std::to_string(gst.running_tasks()) + 
            ", p:" + std::to_string(gst.pending_tasks()) + 
-           ", eta: " + std::to_string(gst.eta()) + ")";
+           ", eta: " + std::to_string(gst.eta()) + 
+           ", at risk: " + std::to_string(gst.deadlines_at_risk().size()) + ")";
+}
+
+std::string to_string(const io::transfer_estimate& est) {
+    return "(bw: " + std::to_string(est.bandwidth()) + 
+           ", overhead: " + std::to_string(est.overhead()) + 
+           ", duration: " + std::to_string(est.duration()) + 
+           ", backlog: " + std::to_string(est.backlog()) + 
+           ", samples: " + std::to_string(est.samples()) + ")";
+}
+
+std::string to_string(io::latency_phase phase) {
+    switch(phase) {
+        case io::latency_phase::queued:
+            return "queued";
+        case io::latency_phase::resolve:
+            return "resolve";
+        case io::latency_phase::setup:
+            return "setup";
+        case io::latency_phase::transfer:
+            return "transfer";
+        case io::latency_phase::total:
+            return "total";
+        case io::latency_phase::handler:
+            return "handler";
+        default:
+            return "unknown!";
+    }
+}
+
+std::string to_string(const io::latency_stats& lst) {
+    return "(" + lst.name() + "/" + to_string(lst.phase()) + 
+           ", n: " + std::to_string(lst.count()) + 
+           ", mean: " + std::to_string(lst.mean()) + 
+           ", p50: " + std::to_string(lst.p50()) + 
+           ", p99: " + std::to_string(lst.p99()) + 
+           ", max: " + std::to_string(lst.max()) + ")";
+}
+
+std::string to_string(io::slow_task::reason r) {
+    switch(r) {
+        case io::slow_task::reason::slow:
+            return "slow";
+        case io::slow_task::reason::stalled:
+            return "stalled";
+        default:
+            return "unknown";
+    }
+}
+
+std::string to_string(io::copy_engine e) {
+    switch(e) {
+        case io::copy_engine::reflink:
+            return "reflink";
+        case io::copy_engine::copy_file_range:
+            return "copy_file_range";
+        case io::copy_engine::sendfile:
+            return "sendfile";
+        case io::copy_engine::read_write:
+            return "read_write";
+        case io::copy_engine::io_uring:
+            return "io_uring";
+        case io::copy_engine::direct:
+            return "direct";
+        default:
+            return "unknown";
+    }
+}
+
+std::string to_string(const io::slow_task& st) {
+    return "(" + std::to_string(st.id()) + ": " + to_string(st.get_reason()) + 
+           ", " + std::to_string(st.sent_bytes()) + "/" + 
+           std::to_string(st.total_bytes()) + " bytes" + 
+           ", rate: " + std::to_string(st.rate()) + 
+           ", expected: " + std::to_string(st.expected_rate()) + 
+           ", idle: " + std::to_string(st.idle_time()) + ")";
 }
 
 
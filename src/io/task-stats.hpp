@@ -41,6 +41,8 @@
 #include <string>
 #include <system_error>
 #include <limits>
+#include <vector>
+#include "common.hpp"
 
 namespace norns {
 
@@ -57,15 +59,53 @@ enum class task_status {
     finished_with_error,
 };
 
+/*! Points in the lifetime of an I/O task that are timestamped */
+enum class task_phase {
+    submitted,  // the task is created
+    dequeued,   // a runner picks the task
+    resolved,   // the task's resources have been resolved
+    started,    // the transferor starts moving data
+    completed,  // the task finishes (successfully or not)
+};
+
+constexpr static const std::size_t num_task_phases = 5;
+
+/*! Intervals whose latency is tracked: those between consecutive task 
+ * phases (and the whole lifetime of a task), plus the time taken by the
+ * daemon to handle API requests */
+enum class latency_phase {
+    queued   = NORNSCTL_PHASE_QUEUED,   // submitted -> dequeued
+    resolve  = NORNSCTL_PHASE_RESOLVE,  // dequeued  -> resolved
+    setup    = NORNSCTL_PHASE_SETUP,    // resolved  -> started
+    transfer = NORNSCTL_PHASE_TRANSFER, // started   -> completed
+    total    = NORNSCTL_PHASE_TOTAL,    // submitted -> completed
+    handler  = NORNSCTL_PHASE_HANDLER,
+};
+
+// phases up to 'total' apply to tasks
+constexpr static const std::size_t num_task_latency_phases = 5;
+
+/*! Mechanisms used to copy data between local paths */
+enum class copy_engine : uint32_t {
+    reflink         = NORNS_COPY_REFLINK,
+    copy_file_range = NORNS_COPY_FILE_RANGE,
+    sendfile        = NORNS_COPY_SENDFILE,
+    read_write      = NORNS_COPY_READ_WRITE,
+    io_uring        = NORNS_COPY_IO_URING,
+    direct          = NORNS_COPY_DIRECT,
+};
+
 /*! Stats about a registered I/O task */
 struct task_stats {
 
     task_stats();
     task_stats(task_status st, urd_error ec, const std::error_code& sc, 
-               std::size_t total_bytes, std::size_t pending_bytes);
+               std::size_t total_bytes, std::size_t pending_bytes,
+               uint32_t copy_engines = 0);
 
     std::size_t pending_bytes() const;
     std::size_t total_bytes() const;
+    uint32_t copy_engines() const;
     task_status status() const;
     void set_status(const task_status status);
     urd_error error() const;
@@ -78,20 +118,120 @@ struct task_stats {
     std::error_code m_sys_error;
     std::size_t m_total_bytes;
     std::size_t m_pending_bytes;
+    // copy_engine values used by the task, or'ed together
+    uint32_t m_copy_engines;
 };
 
 /*! Global stats about all registered I/O tasks */
 struct global_stats {
     global_stats();
-    global_stats(uint32_t running_tasks, uint32_t pending_tasks, double eta);
+    global_stats(uint32_t running_tasks, uint32_t pending_tasks, double eta,
+                 const std::vector<iotask_id>& deadlines_at_risk = {});
 
     uint32_t running_tasks() const;
     uint32_t pending_tasks() const;
     double eta() const;
+    std::vector<iotask_id> deadlines_at_risk() const;
 
     uint32_t m_running_tasks;
     uint32_t m_pending_tasks;
     double m_eta;
+    std::vector<iotask_id> m_deadlines_at_risk;
+};
+
+/*! Estimated cost of transferring data between a pair of namespaces */
+struct transfer_estimate {
+    transfer_estimate();
+    transfer_estimate(double bandwidth, double overhead, double duration,
+                      double backlog, uint32_t samples);
+
+    double bandwidth() const;
+    double overhead() const;
+    double duration() const;
+    double backlog() const;
+    uint32_t samples() const;
+
+    // expected streaming bandwidth (MiB/s) and per-task overhead (seconds)
+    double m_bandwidth;
+    double m_overhead;
+    // expected duration (seconds) of the transfer
+    double m_duration;
+    // expected time (seconds) until the tasks already pending or running 
+    // between the namespaces complete
+    double m_backlog;
+    // number of completed tasks of similar size the estimation is based on
+    uint32_t m_samples;
+};
+
+/*! Summary of the latencies observed for a phase of the tasks of a type 
+ * or between a pair of namespaces, or for the handling of a type of API 
+ * request. Values are in seconds */
+struct latency_stats {
+
+    enum class scope {
+        task_type = NORNSCTL_LATENCY_TASK_TYPE,
+        ns_pair   = NORNSCTL_LATENCY_NS_PAIR,
+        request   = NORNSCTL_LATENCY_REQUEST,
+    };
+
+    latency_stats();
+    latency_stats(scope sc, const std::string& name, latency_phase phase,
+                  uint64_t count, double mean, double p50, double p90, 
+                  double p99, double max);
+
+    scope get_scope() const;
+    std::string name() const;
+    latency_phase phase() const;
+    uint64_t count() const;
+    double mean() const;
+    double p50() const;
+    double p90() const;
+    double p99() const;
+    double max() const;
+
+    scope m_scope;
+    std::string m_name;
+    latency_phase m_phase;
+    uint64_t m_count;
+    double m_mean;
+    double m_p50;
+    double m_p90;
+    double m_p99;
+    double m_max;
+};
+
+/*! A running task that the watchdog found to be progressing too slowly 
+ * or not at all. Rates are in MiB/s and times in seconds */
+struct slow_task {
+
+    enum class reason {
+        slow    = NORNSCTL_TASK_SLOW,
+        stalled = NORNSCTL_TASK_STALLED,
+    };
+
+    slow_task();
+    slow_task(iotask_id tid, reason why, std::size_t sent_bytes, 
+              std::size_t total_bytes, double rate, double expected_rate,
+              double idle_time);
+
+    iotask_id id() const;
+    reason get_reason() const;
+    std::size_t sent_bytes() const;
+    std::size_t total_bytes() const;
+    double rate() const;
+    double expected_rate() const;
+    double idle_time() const;
+
+    iotask_id m_tid;
+    reason m_reason;
+    std::size_t m_sent_bytes;
+    std::size_t m_total_bytes;
+    // rate since the transfer started, and the one expected according to
+    // the bandwidth model of its namespaces (NaN if unknown)
+    double m_rate;
+    double m_expected_rate;
+    // time since the task last made progress
+    double m_idle_time;
 };
 
 } // namespace io
@@ -99,7 +239,13 @@ struct global_stats {
 namespace utils {
 
 std::string to_string(io::task_status st);
+std::string to_string(io::copy_engine e);
 std::string to_string(const io::global_stats& gst);
+std::string to_string(const io::transfer_estimate& est);
+std::string to_string(io::latency_phase phase);
+std::string to_string(const io::latency_stats& lst);
+std::string to_string(io::slow_task::reason r);
+std::string to_string(const io::slow_task& st);
 
 }
 
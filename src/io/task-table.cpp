@@ -0,0 +1,223 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <algorithm>
+#include "task-info.hpp"
+#include "task-table.hpp"
+
+namespace norns {
+namespace io {
+
+task_tombstone::task_tombstone(const task_info& tinfo) {
+
+    const task_stats st{tinfo.stats()};
+
+    m_status = st.status();
+    m_task_error = st.error();
+    m_sys_errnum = st.sys_error().value();
+    m_is_remote = tinfo.is_remote();
+    m_total_bytes = st.total_bytes();
+    m_copy_engines = st.copy_engines();
+}
+
+task_stats
+task_tombstone::stats() const {
+    return task_stats(m_status, m_task_error, 
+                      std::error_code(m_sys_errnum, std::system_category()),
+                      m_total_bytes, 0, m_copy_engines);
+}
+
+bool
+task_tombstone::is_remote() const {
+    return m_is_remote;
+}
+
+task_table::shard::shard(const std::shared_ptr<utils::block_cache>& cache,
+                         std::size_t max_tombstones) :
+    m_mutex("task_table.shard"),
+    m_map(0, std::hash<iotask_id>(), std::equal_to<iotask_id>(),
+          allocator_type(cache)),
+    m_graveyard(max_tombstones) { }
+
+task_table::task_table(const std::shared_ptr<utils::block_cache>& cache,
+                       std::size_t max_tombstones) {
+
+    // tombstones are spread evenly across shards, as tasks are
+    const std::size_t per_shard = 
+        std::max<std::size_t>(max_tombstones / num_shards, 1);
+
+    for(auto& s : m_shards) {
+        s.reset(new shard(cache, per_shard));
+    }
+}
+
+bool
+task_table::insert(iotask_id tid, const value_type& tinfo) {
+
+    auto& s = shard_for(tid);
+    boost::unique_lock<utils::profiled_shared_mutex> lock(s.m_mutex);
+
+    return s.m_map.emplace(tid, tinfo).second;
+}
+
+task_table::value_type
+task_table::find(iotask_id tid) const {
+
+    const auto& s = shard_for(tid);
+    boost::shared_lock<utils::profiled_shared_mutex> lock(s.m_mutex);
+
+    const auto it = s.m_map.find(tid);
+
+    if(it == s.m_map.end()) {
+        return nullptr;
+    }
+
+    return it->second;
+}
+
+bool
+task_table::erase(iotask_id tid) {
+
+    value_type tinfo;
+
+    {
+        auto& s = shard_for(tid);
+        boost::unique_lock<utils::profiled_shared_mutex> lock(s.m_mutex);
+
+        const auto it = s.m_map.find(tid);
+
+        if(it == s.m_map.end()) {
+            return false;
+        }
+
+        // keep the task_info alive until the lock is released, so that
+        // it is not destroyed inside the critical section
+        tinfo = std::move(it->second);
+        s.m_map.erase(it);
+    }
+
+    return true;
+}
+
+bool
+task_table::bury(iotask_id tid) {
+
+    value_type tinfo;
+
+    {
+        auto& s = shard_for(tid);
+        boost::unique_lock<utils::profiled_shared_mutex> lock(s.m_mutex);
+
+        const auto it = s.m_map.find(tid);
+
+        if(it == s.m_map.end()) {
+            return false;
+        }
+
+        // the id may already have a tombstone if it was reused after 
+        // wrapping around: refresh it, but don't queue the id twice or 
+        // evicting one copy would drop the tombstone too early
+        const auto ts = s.m_tombstones.find(tid);
+
+        if(ts != s.m_tombstones.end()) {
+            ts->second = task_tombstone(*it->second);
+        }
+        else {
+            if(s.m_graveyard.full()) {
+                s.m_tombstones.erase(s.m_graveyard.front());
+            }
+
+            s.m_tombstones.emplace(tid, task_tombstone(*it->second));
+            s.m_graveyard.push_back(tid);
+        }
+
+        // as in erase(), destroy the task_info outside the critical section
+        tinfo = std::move(it->second);
+        s.m_map.erase(it);
+    }
+
+    return true;
+}
+
+boost::optional<task_tombstone>
+task_table::find_tombstone(iotask_id tid) const {
+
+    const auto& s = shard_for(tid);
+    boost::shared_lock<utils::profiled_shared_mutex> lock(s.m_mutex);
+
+    const auto it = s.m_tombstones.find(tid);
+
+    if(it == s.m_tombstones.end()) {
+        return boost::none;
+    }
+
+    return it->second;
+}
+
+std::size_t
+task_table::size() const {
+
+    std::size_t n = 0;
+
+    for(const auto& s : m_shards) {
+        boost::shared_lock<utils::profiled_shared_mutex> lock(s->m_mutex);
+        n += s->m_map.size();
+    }
+
+    return n;
+}
+
+std::size_t
+task_table::tombstones() const {
+
+    std::size_t n = 0;
+
+    for(const auto& s : m_shards) {
+        boost::shared_lock<utils::profiled_shared_mutex> lock(s->m_mutex);
+        n += s->m_tombstones.size();
+    }
+
+    return n;
+}
+
+task_table::shard&
+task_table::shard_for(iotask_id tid) const {
+    return *m_shards[tid % num_shards];
+}
+
+} // namespace io
+} // namespace norns
@@ -0,0 +1,193 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#ifndef __IO_TASK_TABLE_HPP__
+#define __IO_TASK_TABLE_HPP__
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <boost/circular_buffer.hpp>
+#include <boost/optional.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/shared_mutex.hpp>
+
+#include "common.hpp"
+#include "task-stats.hpp"
+#include "utils/block-cache.hpp"
+#include "utils/profiled-mutex.hpp"
+
+namespace norns {
+namespace io {
+
+// forward declarations
+struct task_info;
+
+/*! Compact record of the final status of a finished task, kept once its 
+ * task_info has been removed from the table so that late status queries 
+ * (and tasks depending on it) can still learn how it ended */
+struct task_tombstone {
+
+    explicit task_tombstone(const task_info& tinfo);
+
+    task_stats
+    stats() const;
+
+    bool
+    is_remote() const;
+
+    task_status m_status;
+    urd_error m_task_error;
+    int32_t m_sys_errnum;
+    bool m_is_remote;
+    uint64_t m_total_bytes;
+    uint32_t m_copy_engines;
+};
+
+/*! Concurrent table of the task_infos known to the daemon, indexed by 
+ * iotask_id. The table is split into shards, each one protected by its own 
+ * lock, so that tasks being created, queried and erased by different 
+ * threads rarely contend with each other. Since task ids are allocated 
+ * sequentially, consecutive tasks fall on different shards */
+struct task_table {
+
+    using key_type = iotask_id;
+    using value_type = std::shared_ptr<task_info>;
+
+    constexpr static const std::size_t num_shards = 64;
+
+    /*! Maximum number of tombstones kept by default. The oldest ones are 
+     * discarded first */
+    constexpr static const std::size_t default_max_tombstones = 1 << 18;
+
+    explicit task_table(const std::shared_ptr<utils::block_cache>& cache,
+                        std::size_t max_tombstones = default_max_tombstones);
+
+    task_table(const task_table& other) = delete;
+    task_table& operator=(const task_table& other) = delete;
+
+    /*! Insert tinfo under key tid. Returns false if tid is already in use */
+    bool
+    insert(iotask_id tid, const value_type& tinfo);
+
+    /*! Return the task_info for tid, or nullptr if it is not in the table */
+    value_type
+    find(iotask_id tid) const;
+
+    /*! Remove tid from the table. Returns false if it was not present */
+    bool
+    erase(iotask_id tid);
+
+    /*! Replace the (finished) task tid with a tombstone recording its final 
+     * status. Returns false if it was not present */
+    bool
+    bury(iotask_id tid);
+
+    /*! Return the tombstone for tid, if the task has been buried and its
+     * tombstone has not been discarded yet */
+    boost::optional<task_tombstone>
+    find_tombstone(iotask_id tid) const;
+
+    /*! Number of tasks in the table (not including tombstones) */
+    std::size_t
+    size() const;
+
+    std::size_t
+    tombstones() const;
+
+    /*! Invoke fn on each task_info in the table. Shards are visited one at
+     * a time while holding their lock in shared mode, so fn must not call 
+     * back into the table. Tasks inserted or erased concurrently may or may 
+     * not be visited */
+    template <typename Function>
+    void
+    for_each(Function&& fn) const {
+        for(const auto& s : m_shards) {
+            boost::shared_lock<utils::profiled_shared_mutex> lock(s->m_mutex);
+
+            for(const auto& kv : s->m_map) {
+                fn(kv.second);
+            }
+        }
+    }
+
+    template <typename UnaryPredicate>
+    std::size_t
+    count_if(UnaryPredicate&& p) const {
+        std::size_t n = 0;
+        for_each([&](const value_type& tinfo) {
+            if(p(tinfo)) {
+                ++n;
+            }
+        });
+        return n;
+    }
+
+private:
+    // the nodes of the maps are recycled through the block_cache so that 
+    // inserting tasks does not allocate once the daemon reaches a steady 
+    // state
+    using allocator_type = 
+        utils::cached_allocator<std::pair<const iotask_id, value_type>>;
+
+    using map_type = 
+        std::unordered_map<iotask_id, value_type, std::hash<iotask_id>, 
+                           std::equal_to<iotask_id>, allocator_type>;
+
+    // shards are allocated separately to keep their locks on different 
+    // cache lines
+    struct shard {
+        shard(const std::shared_ptr<utils::block_cache>& cache,
+              std::size_t max_tombstones);
+
+        mutable utils::profiled_shared_mutex m_mutex;
+        map_type m_map;
+        // tombstones, and the order in which they were created
+        std::unordered_map<iotask_id, task_tombstone> m_tombstones;
+        boost::circular_buffer<iotask_id> m_graveyard;
+    };
+
+    shard&
+    shard_for(iotask_id tid) const;
+
+    std::array<std::unique_ptr<shard>, num_shards> m_shards;
+};
+
+} // namespace io
+} // namespace norns
+
+#endif /* __IO_TASK_TABLE_HPP__ */
@@ -47,9 +47,9 @@ namespace io {
 template <>
 struct task<iotask_type::unknown> {
     task() { }
-    task(const task& other) = default;
+    task(const task& other) = delete;
     task(task&& rhs) = default;
-    task& operator=(const task& other) = default;
+    task& operator=(const task& other) = delete;
     task& operator=(task&& rhs) = default;
     void operator()() { }
 };
@@ -51,6 +51,7 @@
 #include "auth.hpp"
 #include "task-stats.hpp"
 #include "task-info.hpp"
+#include "utils/trace.hpp"
 
 namespace norns {
 namespace io {
@@ -72,15 +73,18 @@ struct task {
         : m_task_info(std::move(task_info)),
           m_transferor(std::move(tx_ptr)) { }
 
-    task(const task& other) = default;
+    task(const task& other) = delete;
     task(task&& rhs) = default;
-    task& operator=(const task& other) = default;
+    task& operator=(const task& other) = delete;
     task& operator=(task&& rhs) = default;
 
     void operator()();
 
     task_info_ptr m_task_info;
     transferor_ptr m_transferor;
+    // set when the task is executed as part of a batch of coalesced tasks,
+    // in which case the batch is reported as a whole
+    bool m_coalesced = false;
 };
 
 } // namespace io
@@ -110,9 +114,9 @@ struct generic_task {
         m_type(type),
         m_impl(std::forward<TaskImpl>(impl)) { }
 
-    generic_task(const generic_task& other) = default;
+    generic_task(const generic_task& other) = delete;
     generic_task(generic_task&& rhs) = default;
-    generic_task& operator=(const generic_task& other) = default;
+    generic_task& operator=(const generic_task& other) = delete;
     generic_task& operator=(generic_task&& rhs) = default;
 
     iotask_id 
@@ -191,6 +195,22 @@ struct generic_task {
         }
     }
 
+    void
+    set_coalesced(bool coalesced) {
+        switch(m_type) {
+            case iotask_type::copy:
+                boost::get<io::task<iotask_type::copy>>(m_impl).m_coalesced = 
+                    coalesced;
+                break;
+            case iotask_type::move:
+                boost::get<io::task<iotask_type::move>>(m_impl).m_coalesced = 
+                    coalesced;
+                break;
+            default:
+                break;
+        }
+    }
+
     void 
     operator()() {
         switch(m_type) {
@@ -0,0 +1,350 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#ifndef __THREAD_POOL_DEQUE_HPP__
+#define __THREAD_POOL_DEQUE_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace detail {
+    constexpr std::size_t cache_line_size = 64;
+}
+
+/* lock-free work-stealing deque (Chase & Lev, "Dynamic Circular 
+ * Work-Stealing Deque", SPAA'05; memory orderings as proposed by Lê et al.,
+ * "Correct and Efficient Work-Stealing for Weak Memory Models", PPoPP'13).
+ *
+ * only the owner thread may call push() and pop(), which operate on the
+ * bottom end of the deque in LIFO order. any other thread may call steal(),
+ * which takes elements from the top end in FIFO order.
+ *
+ * T must be trivially copyable (the pool stores raw task pointers) */
+template <typename T>
+class work_stealing_deque {
+
+    static_assert(std::is_trivially_copyable<T>::value, 
+                  "work_stealing_deque requires a trivially copyable type");
+
+    class ring_buffer {
+
+    public:
+        explicit ring_buffer(int64_t capacity)
+            : m_capacity(capacity),
+              m_mask(capacity - 1),
+              m_buffer(new std::atomic<T>[capacity]) { }
+
+        int64_t capacity() const {
+            return m_capacity;
+        }
+
+        void put(int64_t i, T value) {
+            m_buffer[i & m_mask].store(value, std::memory_order_relaxed);
+        }
+
+        T get(int64_t i) const {
+            return m_buffer[i & m_mask].load(std::memory_order_relaxed);
+        }
+
+        ring_buffer* grow(int64_t bottom, int64_t top) const {
+            auto rb = new ring_buffer(2 * m_capacity);
+
+            for(int64_t i = top; i != bottom; ++i) {
+                rb->put(i, get(i));
+            }
+
+            return rb;
+        }
+
+    private:
+        int64_t m_capacity;
+        int64_t m_mask;
+        std::unique_ptr<std::atomic<T>[]> m_buffer;
+    };
+
+public:
+    explicit work_stealing_deque(int64_t capacity = 1024)
+        : m_top(0),
+          m_bottom(0),
+          m_buffer(new ring_buffer(round_up(capacity))) {
+
+        m_retired.emplace_back(m_buffer.load(std::memory_order_relaxed));
+    }
+
+    work_stealing_deque(const work_stealing_deque& /*rhs*/) = delete;
+    work_stealing_deque& operator=(const work_stealing_deque& /*rhs*/) = delete;
+
+    /* push a new value into the bottom of the deque (owner only) */
+    void push(T value) {
+
+        int64_t b = m_bottom.load(std::memory_order_relaxed);
+        int64_t t = m_top.load(std::memory_order_acquire);
+        ring_buffer* rb = m_buffer.load(std::memory_order_relaxed);
+
+        if(b - t > rb->capacity() - 1) {
+            rb = rb->grow(b, t);
+
+            // thieves may still be reading from old buffers, so we keep
+            // them alive until the deque itself is destroyed. since the
+            // size doubles each time, this costs at most as much memory
+            // as the current buffer
+            m_retired.emplace_back(rb);
+
+            m_buffer.store(rb, std::memory_order_release);
+        }
+
+        rb->put(b, value);
+        m_bottom.store(b + 1, std::memory_order_release);
+    }
+
+    /* pop a value from the bottom of the deque (owner only).
+     * returns true if a value was successfully written to the out parameter */
+    bool pop(T& out) {
+
+        int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+        ring_buffer* rb = m_buffer.load(std::memory_order_relaxed);
+        m_bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = m_top.load(std::memory_order_relaxed);
+
+        if(t > b) {
+            // deque was empty
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        out = rb->get(b);
+
+        if(t == b) {
+            // last element: race against thieves for it
+            bool won = m_top.compare_exchange_strong(t, t + 1, 
+                                                     std::memory_order_seq_cst,
+                                                     std::memory_order_relaxed);
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+
+        return true;
+    }
+
+    /* steal a value from the top of the deque (any thread).
+     * returns true if a value was successfully written to the out parameter.
+     * a false return may also mean that we lost a race with another thief 
+     * or with the owner */
+    bool steal(T& out) {
+
+        int64_t t = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = m_bottom.load(std::memory_order_acquire);
+
+        if(t >= b) {
+            return false;
+        }
+
+        ring_buffer* rb = m_buffer.load(std::memory_order_acquire);
+        T value = rb->get(t);
+
+        if(!m_top.compare_exchange_strong(t, t + 1, 
+                                          std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return false;
+        }
+
+        out = value;
+        return true;
+    }
+
+    /* check whether the deque is (approximately) empty */
+    bool empty() const {
+        int64_t b = m_bottom.load(std::memory_order_relaxed);
+        int64_t t = m_top.load(std::memory_order_relaxed);
+        return b <= t;
+    }
+
+    /* return the (approximate) number of elements in the deque */
+    std::size_t size() const {
+        int64_t b = m_bottom.load(std::memory_order_relaxed);
+        int64_t t = m_top.load(std::memory_order_relaxed);
+        return b > t ? static_cast<std::size_t>(b - t) : 0;
+    }
+
+private:
+    static int64_t round_up(int64_t n) {
+        int64_t c = 2;
+        while(c < n) {
+            c <<= 1;
+        }
+        return c;
+    }
+
+private:
+    // keep top and bottom on separate cache lines to avoid false sharing
+    // between the owner and the thieves
+    std::atomic<int64_t> m_top;
+    char m_pad0[detail::cache_line_size - sizeof(std::atomic<int64_t>)];
+    std::atomic<int64_t> m_bottom;
+    char m_pad1[detail::cache_line_size - sizeof(std::atomic<int64_t>)];
+    std::atomic<ring_buffer*> m_buffer;
+    std::vector<std::unique_ptr<ring_buffer>> m_retired;
+
+}; // class work_stealing_deque
+
+
+/* bounded lock-free multi-producer/multi-consumer queue (D. Vyukov's 
+ * algorithm). used as the per-worker inbox where threads not belonging to 
+ * the pool (e.g. the API listener) deposit new tasks, since only a worker 
+ * may push into its own work_stealing_deque.
+ *
+ * T must be trivially copyable */
+template <typename T>
+class mpmc_queue {
+
+    static_assert(std::is_trivially_copyable<T>::value, 
+                  "mpmc_queue requires a trivially copyable type");
+
+    struct cell {
+        std::atomic<std::size_t> m_sequence;
+        T m_data;
+    };
+
+public:
+    explicit mpmc_queue(std::size_t capacity = 4096)
+        : m_mask(round_up(capacity) - 1),
+          m_buffer(new cell[m_mask + 1]),
+          m_enqueue_pos(0),
+          m_dequeue_pos(0) {
+
+        for(std::size_t i = 0; i <= m_mask; ++i) {
+            m_buffer[i].m_sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    mpmc_queue(const mpmc_queue& /*rhs*/) = delete;
+    mpmc_queue& operator=(const mpmc_queue& /*rhs*/) = delete;
+
+    /* push a new value into the queue.
+     * returns false if the queue is full */
+    bool try_push(T value) {
+
+        cell* c;
+        std::size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+
+        for(;;) {
+            c = &m_buffer[pos & m_mask];
+            std::size_t seq = c->m_sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - 
+                            static_cast<intptr_t>(pos);
+
+            if(diff == 0) {
+                if(m_enqueue_pos.compare_exchange_weak(
+                            pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if(diff < 0) {
+                return false;
+            }
+            else {
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        c->m_data = value;
+        c->m_sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /* attempt to get the first value in the queue.
+     * returns true if a value was successfully written to the out parameter */
+    bool try_pop(T& out) {
+
+        cell* c;
+        std::size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+
+        for(;;) {
+            c = &m_buffer[pos & m_mask];
+            std::size_t seq = c->m_sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - 
+                            static_cast<intptr_t>(pos + 1);
+
+            if(diff == 0) {
+                if(m_dequeue_pos.compare_exchange_weak(
+                            pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if(diff < 0) {
+                return false;
+            }
+            else {
+                pos = m_dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+
+        out = c->m_data;
+        c->m_sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /* check whether the queue is (approximately) empty */
+    bool empty() const {
+        return m_enqueue_pos.load(std::memory_order_relaxed) == 
+               m_dequeue_pos.load(std::memory_order_relaxed);
+    }
+
+private:
+    static std::size_t round_up(std::size_t n) {
+        std::size_t c = 2;
+        while(c < n) {
+            c <<= 1;
+        }
+        return c;
+    }
+
+private:
+    const std::size_t m_mask;
+    std::unique_ptr<cell[]> m_buffer;
+    std::atomic<std::size_t> m_enqueue_pos;
+    char m_pad0[detail::cache_line_size - sizeof(std::atomic<std::size_t>)];
+    std::atomic<std::size_t> m_dequeue_pos;
+
+}; // class mpmc_queue
+
+#endif /* __THREAD_POOL_DEQUE_HPP__ */
@@ -38,6 +38,7 @@
 #ifndef __THREAD_POOL_HPP__
 #define __THREAD_POOL_HPP__
 
+#include <algorithm>
 #include <vector>
 #include <thread>
 #include <future>
@@ -46,6 +47,7 @@
 
 #include "common.hpp"
 #include "thread-pool-queue.hpp"
+#include "thread-pool-deque.hpp"
 
 namespace detail {
 
@@ -69,6 +71,24 @@ public:
         * Run the task.
         */
     virtual void execute() = 0;
+
+    /**
+        * Called by the pool once the task has been executed (or discarded
+        * because the pool was destroyed). Tasks created by the submit_*() 
+        * functions are heap-allocated and simply delete themselves, but 
+        * tasks submitted with submit_intrusive() can override this to be
+        * recycled instead.
+        */
+    virtual void release() {
+        delete this;
+    }
+};
+
+/* deleter for owning pointers to tasks that honors task::release() */
+struct task_releaser {
+    void operator()(task* task_ptr) const {
+        task_ptr->release();
+    }
 };
 
 }
@@ -135,12 +155,27 @@ public:
         : pool(std::max(std::thread::hardware_concurrency(), 2u) - 1u) {}
 
     explicit pool(const uint32_t num_threads)
-        : m_done(false) { 
+        : pool(num_threads, num_threads) {}
+
+    /* create a pool with 'num_threads' active workers that can be 
+     * resized at runtime up to 'max_threads' workers */
+    pool(const uint32_t num_threads, const uint32_t max_threads)
+        : m_done(false),
+          m_next_inbox(0),
+          m_queued(0),
+          m_sleepers(0),
+          m_active(0) { 
+
+        // worker slots are allocated upfront so that m_workers never 
+        // changes while other threads are accessing it. Even if no 
+        // threads are requested, we need at least one slot so that 
+        // submitted tasks have somewhere to go
+        for(uint32_t i = 0; i < std::max({num_threads, max_threads, 1u}); ++i) {
+            m_workers.emplace_back(std::make_unique<worker_state>(this, i));
+        }
 
         try {
-            for(uint32_t i = 0; i < num_threads; ++i) {
-                m_threads.emplace_back(&pool::worker, this);
-            }
+            resize(num_threads);
         }
         catch(...) {
             destroy();
@@ -153,6 +188,7 @@ public:
 
     ~pool() {
         destroy();
+        drain();
     }
 
     template <typename FuncType, typename... Args>
@@ -166,7 +202,7 @@ public:
 
         PackagedTaskType task{std::move(bound_task)};
         task_future<ResultType> result{task.get_future()};
-        m_work_queue.push(std::make_unique<TaskType>(std::move(task)));
+        enqueue(std::make_unique<TaskType>(std::move(task)));
 
         return result;
     }
@@ -179,7 +215,7 @@ public:
 
         TaskType task{std::move(bound_task)};
 
-        m_work_queue.push(std::make_unique<TaskType>(std::move(task)));
+        enqueue(std::make_unique<TaskType>(std::move(task)));
     }
 
     template <typename CallableTask, typename CallableEpilog, typename... TaskArgs>
@@ -192,32 +228,244 @@ public:
 
         TaskType task{std::move(bound_task), std::move(bound_epilog)};
 
-        m_work_queue.push(std::make_unique<TaskType>(std::move(task)));
+        enqueue(std::make_unique<TaskType>(std::move(task)));
+    }
+
+    /* submit a task owned by the caller. The pool does not allocate
+     * anything to track it and invokes task_ptr->release() (rather than 
+     * deleting it) once it has been executed. The same object can be 
+     * submitted several times if its execute() and release() allow it */
+    void submit_intrusive(detail::task* task_ptr) {
+        enqueue(task_ptr);
     }
 
     void stop() {
         destroy();
     }
 
+    /* number of workers currently allowed to run tasks */
+    uint32_t size() const {
+        return m_active.load();
+    }
+
+    /* maximum number of workers */
+    uint32_t capacity() const {
+        return static_cast<uint32_t>(m_workers.size());
+    }
+
+    /* change the number of active workers. Threads are spawned lazily the
+     * first time their slot is activated. Deactivated workers finish 
+     * their current task and park until they are needed again, while 
+     * any tasks left in their queues are stolen by the remaining ones */
+    void resize(uint32_t num_threads) {
+
+        num_threads = std::min(num_threads, capacity());
+
+        std::lock_guard<std::mutex> lock{m_resize_mutex};
+
+        if(m_done) {
+            return;
+        }
+
+        while(m_threads.size() < num_threads) {
+            m_threads.emplace_back(&pool::worker, this, m_threads.size());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock{m_sleep_mutex};
+            m_active.store(num_threads);
+            m_park_condition.notify_all();
+
+            // wake up any sleepers in case some of the queued tasks were
+            // waiting in the queues of deactivated workers
+            m_sleep_condition.notify_all();
+        }
+    }
+
     
 private:
 
-    void worker() {
+    using owned_task_ptr = std::unique_ptr<detail::task, detail::task_releaser>;
+
+    /* per-worker scheduling state: tasks submitted by the worker itself 
+     * go to its own deque, while tasks submitted from any other thread
+     * are deposited in one of the workers' inboxes */
+    struct worker_state {
+        worker_state(const pool* owner, const std::size_t index)
+            : m_owner(owner),
+              m_index(index) {}
+
+        const pool* m_owner;
+        const std::size_t m_index;
+        work_stealing_deque<detail::task*> m_deque;
+        mpmc_queue<detail::task*> m_inbox;
+    };
+
+    /* number of times an idle worker checks for new work before going 
+     * to sleep */
+    static constexpr int spin_rounds = 64;
+
+    static worker_state*& current_worker() {
+        static thread_local worker_state* self = nullptr;
+        return self;
+    }
+
+    void enqueue(std::unique_ptr<detail::task>&& task_ptr) {
+        enqueue(task_ptr.release());
+    }
+
+    void enqueue(detail::task* task_ptr) {
+
+        worker_state* self = current_worker();
+
+        if(self != nullptr && self->m_owner == this) {
+            self->m_deque.push(task_ptr);
+        }
+        else {
+            const std::size_t n = m_workers.size();
+            const std::size_t start = 
+                m_next_inbox.fetch_add(1, std::memory_order_relaxed);
+
+            bool pushed = false;
+
+            for(std::size_t i = 0; i < n && !pushed; ++i) {
+                if(m_workers[(start + i) % n]->m_inbox.try_push(task_ptr)) {
+                    pushed = true;
+                }
+            }
+
+            // all inboxes full: this should be extremely rare, so it's 
+            // acceptable to use the (locking) overflow queue here
+            if(!pushed) {
+                m_overflow.push(owned_task_ptr(task_ptr));
+            }
+        }
+
+        m_queued.fetch_add(1);
+
+        if(m_sleepers.load() > 0) {
+            std::lock_guard<std::mutex> lock{m_sleep_mutex};
+            m_sleep_condition.notify_one();
+        }
+    }
+
+    bool find_task(worker_state* self, detail::task*& out) {
+
+        if(self->m_deque.pop(out) || self->m_inbox.try_pop(out)) {
+            return true;
+        }
+
+        const std::size_t n = m_workers.size();
+
+        for(std::size_t i = 1; i < n; ++i) {
+            const auto& victim = m_workers[(self->m_index + i) % n];
+
+            if(victim->m_deque.steal(out) || victim->m_inbox.try_pop(out)) {
+                return true;
+            }
+        }
+
+        owned_task_ptr task_ptr;
+
+        if(m_overflow.try_pop(task_ptr)) {
+            out = task_ptr.release();
+            return true;
+        }
+
+        return false;
+    }
+
+    /* wait until there are tasks queued, the worker is deactivated or
+     * the pool is destroyed. Deactivated workers must not stay in 
+     * m_sleep_condition: enqueue() only wakes one sleeper, and if it 
+     * picked a deactivated worker, the task would never run */
+    void wait_for_work(const std::size_t index) {
+
+        for(int i = 0; i < spin_rounds; ++i) {
+            if(m_queued.load() > 0 || m_done || !is_active(index)) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+
+        std::unique_lock<std::mutex> lock{m_sleep_mutex};
+
+        // m_sleepers must be incremented before checking m_queued (and 
+        // enqueue() does the opposite) so that no wakeup can be lost
+        m_sleepers.fetch_add(1);
+
+        m_sleep_condition.wait(lock, 
+                [this, index]() {
+                    return m_queued.load() > 0 || m_done || 
+                           !is_active(index);
+                });
+
+        m_sleepers.fetch_sub(1);
+    }
+
+    bool is_active(const std::size_t index) const {
+        return index < m_active.load();
+    }
+
+    /* block a deactivated worker until it is reactivated or the pool
+     * is destroyed */
+    void park(const std::size_t index) {
+        std::unique_lock<std::mutex> lock{m_sleep_mutex};
+
+        m_park_condition.wait(lock, 
+                [this, index]() {
+                    return is_active(index) || m_done;
+                });
+    }
+
+    void worker(const std::size_t index) {
+
+        worker_state* self = m_workers[index].get();
+        current_worker() = self;
 
         while(!m_done) {
-            std::unique_ptr<detail::task> task_ptr;
 
-            if(m_work_queue.wait_pop(task_ptr)) {
-                task_ptr->execute();
+            if(!is_active(index)) {
+                park(index);
+                continue;
+            }
+
+            detail::task* task_raw_ptr = nullptr;
+
+            if(find_task(self, task_raw_ptr)) {
+                m_queued.fetch_sub(1);
+                task_raw_ptr->execute();
+                task_raw_ptr->release();
+                continue;
             }
+
+            wait_for_work(index);
         }
+
+        current_worker() = nullptr;
     }
 
     void destroy() {
         m_done = true;
-        m_work_queue.invalidate();
+        m_overflow.invalidate();
+
+        {
+            std::lock_guard<std::mutex> lock{m_sleep_mutex};
+            m_sleep_condition.notify_all();
+            m_park_condition.notify_all();
+        }
 
-        for(auto& th : m_threads) {
+        // move the threads out of m_threads so that we don't need to hold
+        // m_resize_mutex while joining them (a worker could be trying to 
+        // resize the pool)
+        std::vector<std::thread> threads;
+
+        {
+            std::lock_guard<std::mutex> lock{m_resize_mutex};
+            threads.swap(m_threads);
+        }
+
+        for(auto& th : threads) {
 
             if(th.joinable()) {
                 th.join();
@@ -225,9 +473,34 @@ private:
         }
     }
 
+    /* release any tasks that were never executed. 
+     * must only be called once all workers have been joined */
+    void drain() {
+        for(auto& w : m_workers) {
+            detail::task* task_raw_ptr = nullptr;
+
+            while(w->m_deque.pop(task_raw_ptr) || 
+                  w->m_inbox.try_pop(task_raw_ptr)) {
+                task_raw_ptr->release();
+            }
+        }
+    }
+
 private:
     std::atomic<bool> m_done;
-    queue<std::unique_ptr<detail::task>> m_work_queue;
+    std::vector<std::unique_ptr<worker_state>> m_workers;
+    std::atomic<std::size_t> m_next_inbox;
+    queue<owned_task_ptr> m_overflow;
+
+    std::atomic<int64_t> m_queued;
+    std::atomic<int32_t> m_sleepers;
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_sleep_condition;
+
+    std::atomic<uint32_t> m_active;
+    std::condition_variable m_park_condition;
+
+    std::mutex m_resize_mutex;
     std::vector<std::thread> m_threads;
 };
 
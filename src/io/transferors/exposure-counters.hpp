@@ -0,0 +1,95 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#ifndef __IO_EXPOSURE_COUNTERS_HPP__
+#define __IO_EXPOSURE_COUNTERS_HPP__
+
+#include <cstddef>
+#include <memory>
+#include "context.hpp"
+
+namespace norns {
+namespace io {
+
+/*! Counters for the memory that transferors expose to remote peers through
+ * the network service, depending on whether peers may read from it 
+ * ('read_only') or write into it ('write_only') */
+struct exposure_counters {
+
+    explicit exposure_counters(const context& ctx) :
+        m_read_only_bytes(make_bytes_counter(ctx, "read_only")),
+        m_write_only_bytes(make_bytes_counter(ctx, "write_only")),
+        m_read_only_buffers(make_buffers_counter(ctx, "read_only")),
+        m_write_only_buffers(make_buffers_counter(ctx, "write_only")) { }
+
+    void
+    exposed_for_reading(std::size_t bytes) const {
+        m_read_only_bytes->inc(bytes);
+        m_read_only_buffers->inc();
+    }
+
+    void
+    exposed_for_writing(std::size_t bytes) const {
+        m_write_only_bytes->inc(bytes);
+        m_write_only_buffers->inc();
+    }
+
+private:
+    static std::shared_ptr<metrics::counter>
+    make_bytes_counter(const context& ctx, const char* access) {
+        return ctx.make_counter("norns_exposed_bytes_total",
+                "Bytes of memory exposed to remote peers for transfers",
+                {{"access", access}});
+    }
+
+    static std::shared_ptr<metrics::counter>
+    make_buffers_counter(const context& ctx, const char* access) {
+        return ctx.make_counter("norns_exposed_buffers_total",
+                "Memory regions exposed to remote peers for transfers",
+                {{"access", access}});
+    }
+
+    const std::shared_ptr<metrics::counter> m_read_only_bytes;
+    const std::shared_ptr<metrics::counter> m_write_only_bytes;
+    const std::shared_ptr<metrics::counter> m_read_only_buffers;
+    const std::shared_ptr<metrics::counter> m_write_only_buffers;
+};
+
+} // namespace io
+} // namespace norns
+
+#endif /* __IO_EXPOSURE_COUNTERS_HPP__ */
@@ -35,24 +35,78 @@
  * SOFTWARE.                                                             *
  *************************************************************************/
 
+#include <sys/ioctl.h>
 #include <sys/sendfile.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <unistd.h>
 #include <climits>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include "config.h"
 
+#ifdef HAVE_FICLONE
+#include <linux/fs.h>
+#endif
+
 #include "utils.hpp"
 #include "logger.hpp"
 #include "resources.hpp"
 #include "auth.hpp"
 #include "io/task-info.hpp"
 #include "backends/posix-fs.hpp"
+#include "io/uring-copier.hpp"
 #include "local-path-to-local-path.hpp"
 #include <iostream>
 
 namespace {
 
+// maximum number of bytes copied by a single call to sendfile() or 
+// copy_file_range() when the task has no bandwidth limits, so that 
+// cancellation requests are noticed within a reasonable time
+constexpr std::size_t max_bytes_per_call = 64*1024*1024;
+
+// size of the buffer used when data must be copied with pread()/pwrite()
+constexpr std::size_t rw_buffer_size = 1024*1024;
+
+// files up to this size found in a directory tree are copied in batches 
+// through io_uring (if enabled), since for them the cost of a copy is 
+// dominated by the syscalls rather than by the data
+constexpr std::uintmax_t uring_max_file_size = 1024*1024;
+
+// number of files in each io_uring batch, as a multiple of the queue depth
+constexpr std::size_t uring_batch_factor = 8;
+
+// alignment of the buffers, offsets and lengths of O_DIRECT transfers, 
+// which covers the logical block size of common devices
+constexpr std::size_t direct_io_alignment = 4096;
+
+// size of the buffers used by O_DIRECT copies (each copy uses two)
+constexpr std::size_t direct_io_buffer_size = 4*1024*1024;
+
+// how the ranges of large files are distributed among several threads
+struct parallel_copy_args {
+    std::size_t m_chunk_size;
+    uint32_t m_fanout;
+    thread_pool* m_pool;
+    uint32_t m_uring_queue_depth;
+    norns::utils::aligned_buffer_pool* m_direct_buffers;
+    // writes the blocks of copies that bypass the page cache when there 
+    // is no m_pool (i.e. copy_fanout <= 1)
+    thread_pool* m_writer_pool;
+};
+
+std::size_t
+align_up(std::size_t n) {
+    return (n + direct_io_alignment - 1) & ~(direct_io_alignment - 1);
+}
+
 ssize_t
 get_filesize(int fd) {
 	struct stat st;
@@ -67,53 +121,818 @@ get_filesize(int fd) {
     return static_cast<ssize_t>(-1);
 }
 
+// errors returned by ioctl(FICLONE) and copy_file_range() when the kernel
+// or the filesystems involved don't support them, rather than because the
+// copy itself failed
+bool
+is_unsupported(int err) {
+    return err == EOPNOTSUPP || err == ENOSYS || err == EXDEV ||
+           err == EINVAL || err == ENOTTY;
+}
+
+// make the destination share the source's data blocks (e.g. in XFS or 
+// btrfs), which turns the copy into a metadata operation. Returns false 
+// if this is not possible, in which case the data must be copied
+bool
+do_reflink(int in_fd, int out_fd, ssize_t sz, 
+           norns::io::task_info& task_info) {
+
+#ifdef HAVE_FICLONE
+    if(::ioctl(out_fd, FICLONE, in_fd) == 0) {
+        task_info.record_progress(sz);
+        task_info.record_copy_engine(norns::io::copy_engine::reflink);
+        return true;
+    }
+
+    if(!::is_unsupported(errno)) {
+        LOGGER_DEBUG("[{}] ioctl(FICLONE) failed: {}", task_info.id(),
+                     std::make_error_code(static_cast<std::errc>(errno))
+                        .message());
+    }
+#else
+    (void) in_fd;
+    (void) out_fd;
+    (void) sz;
+    (void) task_info;
+#endif // HAVE_FICLONE
+
+    return false;
+}
+
+// copy the data between 'offset' and 'sz' in chunks of at most 
+// 'max_count' bytes so that we can check for cancellation requests and, 
+// if the task is subject to bandwidth limits, pay for the bytes actually
+// copied by each of them (interrupted or short copies are not charged 
+// for what they didn't copy). 'copy_chunk(offset, count)' must copy up to
+// 'count' bytes at 'offset', advance it, and return the number of bytes 
+// copied (0 at the end of the file) or -1 on error. 'offset' is left 
+// where the copy stopped
+template <typename CopyFunction>
 ssize_t
-do_sendfile(int in_fd, int out_fd) {
+copy_chunks(off_t& offset, ssize_t sz, norns::io::task_info& task_info, 
+            CopyFunction&& copy_chunk, 
+            std::size_t max_count = max_bytes_per_call) {
 
-	ssize_t sz = ::get_filesize(in_fd);
+    const auto& limiter = task_info.limiter();
+    const std::size_t chunk_size = std::min(limiter.enabled() ? 
+        limiter.chunk_size() : max_bytes_per_call, max_count);
+
+    while(offset < sz) {
+
+        if(task_info.is_cancelled()) {
+            errno = ECANCELED;
+            return static_cast<ssize_t>(-1);
+        }
+
+        std::size_t count = std::min(static_cast<std::size_t>(sz - offset), 
+                                     chunk_size);
+
+        const ssize_t n = copy_chunk(offset, count);
+
+        if(n == -1) {
+            if(errno != EINTR) {
+                return static_cast<ssize_t>(-1);
+            }
+            continue;
+        }
+
+        // the file was truncated while we were copying it
+        if(n == 0) {
+            break;
+        }
+
+        // the limiter keeps a debt, so charging after the fact blocks us 
+        // just as long as charging before
+        if(limiter.enabled()) {
+            limiter.consume(n);
+        }
+
+        task_info.record_progress(n);
+    }
+
+    return 0;
+}
+
+// let the kernel copy the data without bouncing it through userspace, or 
+// the filesystem copy it server-side (e.g. NFS 4.2). Returns false if 
+// this is not possible for (the rest of) the file, in which case 'offset' 
+// tells how much was copied
+bool
+do_copy_file_range(int in_fd, int out_fd, off_t& offset, ssize_t sz,
+                   norns::io::task_info& task_info, ssize_t& rv) {
+
+#ifdef HAVE_COPY_FILE_RANGE
+    const off_t saved_offset = offset;
+
+    rv = ::copy_chunks(offset, sz, task_info, 
+            [&](off_t& off, std::size_t count) {
+                loff_t in_off = off;
+                loff_t out_off = off;
+                const ssize_t n = ::copy_file_range(in_fd, &in_off, 
+                                                    out_fd, &out_off, 
+                                                    count, 0);
+                if(n > 0) {
+                    off += n;
+                }
+                return n;
+            });
+
+    if(offset != saved_offset) {
+        task_info.record_copy_engine(
+                norns::io::copy_engine::copy_file_range);
+    }
+
+    return rv == 0 || !::is_unsupported(errno);
+#else
+    (void) in_fd;
+    (void) out_fd;
+    (void) offset;
+    (void) sz;
+    (void) task_info;
+    (void) rv;
+    return false;
+#endif // HAVE_COPY_FILE_RANGE
+}
+
+ssize_t
+do_sendfile(int in_fd, int out_fd, off_t& offset, ssize_t sz, 
+            norns::io::task_info& task_info) {
+
+    // provide kernel with advices on how we are going to use the data. 
+    // Copies that should bypass the page cache (but had to fall back to 
+    // buffered I/O) must not read the whole file ahead into it
+    if(!task_info.direct_io() &&
+       ::posix_fadvise(in_fd, offset, sz - offset, 
+                       POSIX_FADV_WILLNEED) != 0) {
+        return static_cast<ssize_t>(-1);
+    }
 
-    // provide kernel with advices on how we are going to use the data
-    if(::posix_fadvise(in_fd, 0, sz, POSIX_FADV_WILLNEED) != 0) {
+    if(::posix_fadvise(in_fd, offset, sz - offset, 
+                       POSIX_FADV_SEQUENTIAL) != 0) {
         return static_cast<ssize_t>(-1);
     }
 
-    if(::posix_fadvise(in_fd, 0, sz, POSIX_FADV_SEQUENTIAL) != 0) {
+    // sendfile() writes at the current position of out_fd
+    if(::lseek(out_fd, offset, SEEK_SET) == static_cast<off_t>(-1)) {
+        return static_cast<ssize_t>(-1);
+    }
+
+    task_info.record_copy_engine(norns::io::copy_engine::sendfile);
+
+    return ::copy_chunks(offset, sz, task_info, 
+            [&](off_t& off, std::size_t count) {
+                return ::sendfile(out_fd, in_fd, &off, count);
+            });
+}
+
+// write back and evict the pages cached for [offset, offset + count) of
+// both files. POSIX_FADV_DONTNEED ignores dirty pages, so the range of 
+// 'out_fd' is flushed first. Failures are ignored since this is only 
+// advice to the kernel
+void
+drop_cached_range(int in_fd, int out_fd, off_t offset, off_t count) {
+    ::sync_file_range(out_fd, offset, count, 
+                      SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | 
+                      SYNC_FILE_RANGE_WAIT_AFTER);
+    ::posix_fadvise(out_fd, offset, count, POSIX_FADV_DONTNEED);
+    ::posix_fadvise(in_fd, offset, count, POSIX_FADV_DONTNEED);
+}
+
+// copy the data through a userspace buffer. Unlike sendfile(), this 
+// doesn't depend on the current position of out_fd, so it can be used by 
+// several threads at a time when copy_file_range() is not available. If
+// 'drop_cache' is set, the pages of each chunk are evicted once copied
+ssize_t
+do_pread_pwrite(int in_fd, int out_fd, off_t& offset, ssize_t sz, 
+                norns::io::task_info& task_info, bool drop_cache = false) {
+
+    std::unique_ptr<char[]> buffer(new char[rw_buffer_size]);
+
+    // pages being read ahead when a chunk is evicted would stay cached
+    if(drop_cache && ::posix_fadvise(in_fd, offset, sz - offset, 
+                                     POSIX_FADV_RANDOM) != 0) {
         return static_cast<ssize_t>(-1);
     }
 
-    // preallocate output file
+    task_info.record_copy_engine(norns::io::copy_engine::read_write);
+
+    return ::copy_chunks(offset, sz, task_info, 
+            [&](off_t& off, std::size_t count) {
+
+                const ssize_t n = ::pread(in_fd, buffer.get(), count, off);
+
+                if(n <= 0) {
+                    return n;
+                }
+
+                for(ssize_t written = 0; written < n; ) {
+                    const ssize_t m = ::pwrite(out_fd, buffer.get() + written, 
+                                               n - written, off + written);
+
+                    if(m == -1) {
+                        if(errno == EINTR) {
+                            continue;
+                        }
+                        return m;
+                    }
+
+                    written += m;
+                }
+
+                if(drop_cache) {
+                    ::drop_cached_range(in_fd, out_fd, off, n);
+                }
+
+                off += n;
+                return n;
+            }, rw_buffer_size);
+}
+
+// enable or disable O_DIRECT for an open file. Fails with EINVAL if the 
+// filesystem doesn't support direct I/O
+bool
+set_direct_io(int fd, bool enable) {
+
+    const int flags = ::fcntl(fd, F_GETFL);
+
+    if(flags == -1) {
+        return false;
+    }
+
+    const int new_flags = enable ? (flags | O_DIRECT) : (flags & ~O_DIRECT);
+
+    return new_flags == flags || ::fcntl(fd, F_SETFL, new_flags) != -1;
+}
+
+// writes the blocks read by do_direct_copy(). Blocks are handed over one 
+// at a time, so that the next one can be read into the other buffer 
+// while the previous one is being written. A block is written by whoever
+// claims it first: a helper running run() or the reader itself when it
+// needs the buffer back, so that copies never wait for a busy helper
+struct direct_writer {
+
+    direct_writer(int out_fd, off_t offset, norns::io::task_info& task_info) :
+        m_fd(out_fd),
+        m_written_up_to(offset),
+        m_task_info(task_info) { }
+
+    // write 'length' bytes (a multiple of the alignment) of which 'valid' 
+    // are data from the file, the rest being padding at its end
+    void
+    write(const char* data, off_t offset, std::size_t length, 
+          std::size_t valid) {
+
+        for(std::size_t done = 0; done < length; ) {
+            const ssize_t n = ::pwrite(m_fd, data + done, length - done, 
+                                       offset + done);
+
+            if(n == -1) {
+                if(errno == EINTR) {
+                    continue;
+                }
+                m_errno = errno;
+                return;
+            }
+
+            done += n;
+        }
+
+        m_task_info.record_progress(valid);
+        m_written_up_to = offset + valid;
+    }
+
+    // write blocks as they are submitted until stop() is called. Helpers
+    // that start after that return right away
+    void
+    run() {
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        for(;;) {
+            m_cv.wait(lock, [&] { 
+                return (m_pending && !m_claimed) || m_stopped; 
+            });
+
+            if(m_stopped) {
+                return;
+            }
+
+            write_pending(lock);
+        }
+    }
+
+    void
+    submit(const char* data, off_t offset, std::size_t length, 
+           std::size_t valid) {
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_data = data;
+        m_offset = offset;
+        m_length = length;
+        m_valid = valid;
+        m_pending = true;
+        m_claimed = false;
+        m_cv.notify_all();
+    }
+
+    // make sure that the last block submitted has been written, writing it
+    // with the calling thread if no helper has claimed it. Returns false 
+    // if any write failed
+    bool
+    wait_idle() {
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+
+        if(m_pending && !m_claimed) {
+            write_pending(lock);
+        }
+
+        m_cv.wait(lock, [&] { return !m_pending; });
+        return m_errno == 0;
+    }
+
+    void
+    stop() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopped = true;
+        m_cv.notify_all();
+    }
+
+    // claim and write the pending block ('lock' must be held)
+    void
+    write_pending(std::unique_lock<std::mutex>& lock) {
+
+        m_claimed = true;
+
+        lock.unlock();
+        write(m_data, m_offset, m_length, m_valid);
+        lock.lock();
+
+        m_pending = false;
+        m_cv.notify_all();
+    }
+
+    const int m_fd;
+    off_t m_written_up_to;
+    int m_errno = 0;
+    norns::io::task_info& m_task_info;
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_pending = false;
+    bool m_claimed = false;
+    bool m_stopped = false;
+    const char* m_data = nullptr;
+    off_t m_offset = 0;
+    std::size_t m_length = 0;
+    std::size_t m_valid = 0;
+};
+
+// read up to 'count' bytes at 'offset', stopping early only at the end of
+// the file
+ssize_t
+read_fully(int fd, char* buffer, std::size_t count, off_t offset) {
+
+    std::size_t done = 0;
+
+    while(done < count) {
+        const ssize_t n = ::pread(fd, buffer + done, count - done, 
+                                  offset + done);
+
+        if(n == -1) {
+            if(errno == EINTR) {
+                continue;
+            }
+            return n;
+        }
+
+        if(n == 0) {
+            break;
+        }
+
+        done += n;
+    }
+
+    return done;
+}
+
+// copy [offset, end) between two descriptors opened with O_DIRECT, 
+// reading each block while the previous one is written by a helper from
+// 'pargs.m_pool' or 'pargs.m_writer_pool' (if any helper is idle). 'offset' must be aligned, and 
+// so must 'end' unless it is the end of the file: the last block is then
+// written padded, and the caller must truncate the output file to its 
+// size. Returns false if the filesystems rejected direct I/O, in which 
+// case 'offset' tells how much was copied
+bool
+do_direct_copy(int in_fd, int out_fd, off_t& offset, ssize_t end,
+               norns::io::task_info& task_info, 
+               const parallel_copy_args& pargs, ssize_t& rv) {
+
+    auto& pool = *pargs.m_direct_buffers;
+
+    // as in copy_chunks(), throttled tasks copy smaller blocks so that 
+    // they don't wait too long for tokens
+    const auto& limiter = task_info.limiter();
+    std::size_t block_size = pool.buffer_size();
+
+    if(limiter.enabled()) {
+        block_size = std::min(block_size, limiter.chunk_size());
+    }
+
+    block_size = std::max(block_size & ~(direct_io_alignment - 1), 
+                          direct_io_alignment);
+
+    const bool pipelined = 
+        static_cast<std::size_t>(end - offset) > block_size;
+
+    norns::utils::aligned_buffer_pool::buffer_ptr buffers[2];
+
+    try {
+        buffers[0] = pool.acquire();
+
+        if(pipelined) {
+            buffers[1] = pool.acquire();
+        }
+    }
+    catch(const std::bad_alloc&) {
+        errno = ENOMEM;
+        rv = -1;
+        return true;
+    }
+
+    // a helper that only starts once the copy is done must not find the
+    // writer gone
+    const auto writer = 
+        std::make_shared<direct_writer>(out_fd, offset, task_info);
+
+    thread_pool* const helpers = 
+        pargs.m_pool != nullptr ? pargs.m_pool : pargs.m_writer_pool;
+
+    if(pipelined && helpers != nullptr) {
+        helpers->submit_and_forget([writer]() {
+            writer->run();
+        });
+    }
+
+    int read_errno = 0;
+
+    off_t read_offset = offset;
+
+    for(std::size_t i = 0; read_offset < end; ++i) {
+
+        if(task_info.is_cancelled()) {
+            read_errno = ECANCELED;
+            break;
+        }
+
+        const std::size_t count = 
+            std::min(static_cast<std::size_t>(end - read_offset), block_size);
+
+        if(limiter.enabled()) {
+            limiter.consume(count);
+        }
+
+        char* buffer = buffers[pipelined ? i % 2 : 0].get();
+
+        const ssize_t n = ::read_fully(in_fd, buffer, ::align_up(count), 
+                                       read_offset);
+
+        if(n == -1) {
+            read_errno = errno;
+            break;
+        }
+
+        // the file was truncated while we were copying it
+        if(n == 0) {
+            break;
+        }
+
+        const std::size_t valid = std::min(static_cast<std::size_t>(n), count);
+        const std::size_t length = ::align_up(valid);
+
+        // don't write stale data past the end of the file, even if it's 
+        // going to be truncated
+        std::memset(buffer + valid, 0, length - valid);
+
+        if(!pipelined) {
+            writer->write(buffer, read_offset, length, valid);
+            break;
+        }
+
+        if(!writer->wait_idle()) {
+            break;
+        }
+
+        writer->submit(buffer, read_offset, length, valid);
+        read_offset += valid;
+
+        if(valid < count) {
+            break;
+        }
+    }
+
+    if(pipelined) {
+        writer->wait_idle();
+        writer->stop();
+    }
+
+    if(writer->m_written_up_to != offset) {
+        task_info.record_copy_engine(norns::io::copy_engine::direct);
+        offset = writer->m_written_up_to;
+    }
+
+    const int err = read_errno != 0 ? read_errno : writer->m_errno;
+
+    if(err == 0) {
+        rv = 0;
+        return true;
+    }
+
+    // the device requires a larger alignment, or the filesystem doesn't 
+    // support O_DIRECT after all
+    if(err == EINVAL) {
+        return false;
+    }
+
+    errno = err;
+    rv = -1;
+    return true;
+}
+
+// reserve space for the whole output file, so that its ranges can be 
+// written in any order
+bool
+preallocate(int out_fd, ssize_t sz) {
+
 #ifdef HAVE_FALLOCATE
-    if(::fallocate(out_fd, 0, 0, sz) == -1) {
+    if(sz != 0 && ::fallocate(out_fd, 0, 0, sz) == -1) {
         if(errno != EOPNOTSUPP) {
-            return static_cast<ssize_t>(-1);
+            return false;
         }
 #endif // HAVE_FALLOCATE
 
         // filesystem doesn't support fallocate(), fallback to truncate()
         if(::ftruncate(out_fd, sz) != 0) {
-            return static_cast<ssize_t>(-1);
+            return false;
         }
 
 #ifdef HAVE_FALLOCATE
     }
 #endif // HAVE_FALLOCATE
 
-    // copy data
-	off_t offset = 0;
-	while(offset < sz) {
-		if(::sendfile(out_fd, in_fd, &offset, sz - offset) == -1) {
-			if(errno != EINTR) {
-                return static_cast<ssize_t>(-1);
-			}
-		}
-	}
+    return true;
+}
+
+// state shared by the threads running a parallel_for()
+struct parallel_work {
+
+    parallel_work(std::size_t n, std::function<void(std::size_t)> fn) :
+        m_total(n),
+        m_fn(std::move(fn)) { }
+
+    // run items until none are left. Threads that start once all items 
+    // have been claimed return without calling m_fn
+    void
+    run() {
+
+        std::size_t i;
+
+        while((i = m_next.fetch_add(1)) < m_total) {
+
+            m_fn(i);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if(++m_done_items == m_total) {
+                m_done.notify_all();
+            }
+        }
+    }
+
+    void
+    wait() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [&]{ return m_done_items == m_total; });
+    }
+
+    const std::size_t m_total;
+    const std::function<void(std::size_t)> m_fn;
+    std::atomic<std::size_t> m_next{0};
+
+    std::mutex m_mutex;
+    std::condition_variable m_done;
+    std::size_t m_done_items = 0;
+};
+
+// call fn(i) for every i in [0, n) with the calling thread and up to 
+// 'pargs.m_fanout - 1' helpers from 'pargs.m_pool'. The calling thread 
+// also runs items, so this completes even if all helpers are busy
+void
+parallel_for(std::size_t n, const parallel_copy_args& pargs, 
+             std::function<void(std::size_t)> fn) {
+
+    if(n == 0) {
+        return;
+    }
+
+    auto work = std::make_shared<parallel_work>(n, std::move(fn));
+
+    if(pargs.m_pool != nullptr) {
+        const std::size_t num_helpers = 
+            std::min<std::size_t>(pargs.m_fanout, n) - 1;
+
+        for(std::size_t i = 0; i < num_helpers; ++i) {
+            pargs.m_pool->submit_and_forget([work]() {
+                work->run();
+            });
+        }
+    }
+
+    work->run();
+    work->wait();
+}
+
+// split the file in ranges of 'chunk_size' bytes and copy them 
+// concurrently with 'copy_range(offset, end)', which returns -1 on error.
+// Ranges are copied at explicit offsets, so sendfile() can't be used here
+template <typename RangeFunction>
+ssize_t
+do_parallel_copy(ssize_t sz, std::size_t chunk_size, 
+                 norns::io::task_info& task_info,
+                 const parallel_copy_args& pargs,
+                 RangeFunction&& copy_range) {
+
+    const std::size_t num_chunks = (sz + chunk_size - 1) / chunk_size;
+
+    std::mutex mutex;
+    int first_errno = 0;
+    std::atomic<bool> failed{false};
+
+    LOGGER_DEBUG("[{}] copying {} ranges of {} bytes", task_info.id(), 
+                 num_chunks, chunk_size);
+
+    ::parallel_for(num_chunks, pargs, [&](std::size_t i) {
+
+        // ranges claimed after an error are skipped so that the copy 
+        // finishes as soon as possible
+        if(failed.load()) {
+            return;
+        }
+
+        const off_t offset = i * chunk_size;
+        const ssize_t end = 
+            std::min(sz, static_cast<ssize_t>(offset + chunk_size));
+
+        if(copy_range(offset, end) == -1) {
+            const int err = errno;
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if(first_errno == 0) {
+                first_errno = err;
+                failed.store(true);
+            }
+        }
+    });
+
+    if(first_errno != 0) {
+        errno = first_errno;
+        return static_cast<ssize_t>(-1);
+    }
+
+    return sz;
+}
+
+// copy in_fd into out_fd without going through the page cache: with 
+// O_DIRECT if the filesystems support it and, otherwise, through a user 
+// buffer, evicting the pages of each chunk once copied. Files larger than
+// 'pargs.m_chunk_size' are copied in parallel ranges
+ssize_t
+do_uncached_copy(int in_fd, int out_fd, ssize_t sz, 
+                 norns::io::task_info& task_info,
+                 const parallel_copy_args& pargs) {
+
+    const bool direct = 
+        ::set_direct_io(in_fd, true) && ::set_direct_io(out_fd, true);
+
+    if(!direct) {
+        LOGGER_DEBUG("[{}] O_DIRECT not supported, copying with buffered "
+                     "I/O", task_info.id());
+        ::set_direct_io(in_fd, false);
+    }
+
+    // set once any range had to fall back to buffered I/O
+    std::atomic<bool> fell_back{!direct};
+
+    const auto copy_range = [&](off_t offset, ssize_t end) {
+
+        ssize_t rv = 0;
+
+        if(!fell_back.load()) {
+            if(::do_direct_copy(in_fd, out_fd, offset, end, task_info, 
+                                pargs, rv)) {
+                return rv;
+            }
+
+            // O_DIRECT is a property of the open file, so this affects 
+            // the ranges being copied by other threads too
+            if(!fell_back.exchange(true)) {
+                LOGGER_DEBUG("[{}] O_DIRECT transfer rejected, copying "
+                             "with buffered I/O", task_info.id());
+                ::set_direct_io(in_fd, false);
+                ::set_direct_io(out_fd, false);
+            }
+        }
+
+        return ::do_pread_pwrite(in_fd, out_fd, offset, end, task_info, true);
+    };
+
+    ssize_t rv;
+
+    if(pargs.m_pool != nullptr && pargs.m_chunk_size != 0 && 
+       static_cast<std::size_t>(sz) > pargs.m_chunk_size) {
+        // ranges must start at aligned offsets
+        rv = ::do_parallel_copy(sz, ::align_up(pargs.m_chunk_size), 
+                                task_info, pargs, copy_range);
+    }
+    else {
+        rv = copy_range(0, sz);
+    }
+
+    if(rv == -1) {
+        return rv;
+    }
+
+    // the last block of O_DIRECT copies is padded
+    if(direct && ::ftruncate(out_fd, sz) != 0) {
+        return static_cast<ssize_t>(-1);
+    }
+
+    // ranges copied directly after another one fell back went through the
+    // page cache
+    if(direct && fell_back.load()) {
+        ::drop_cached_range(in_fd, out_fd, 0, sz);
+    }
+
+    return sz;
+}
+
+// copy in_fd into out_fd with the cheapest mechanism available: a reflink,
+// copy_file_range() and, if neither can be used, sendfile(). Files larger
+// than 'pargs.m_chunk_size' are copied in parallel ranges. Tasks that 
+// must not pollute the page cache skip the in-kernel mechanisms, which 
+// copy the data through it
+ssize_t
+do_copy(int in_fd, int out_fd, norns::io::task_info& task_info,
+        const parallel_copy_args& pargs) {
+
+	ssize_t sz = ::get_filesize(in_fd);
+
+    if(sz == -1) {
+        return static_cast<ssize_t>(-1);
+    }
+
+    if(sz != 0 && ::do_reflink(in_fd, out_fd, sz, task_info)) {
+        return sz;
+    }
+
+    if(!::preallocate(out_fd, sz)) {
+        return static_cast<ssize_t>(-1);
+    }
+
+    if(task_info.direct_io() && pargs.m_direct_buffers != nullptr) {
+        return ::do_uncached_copy(in_fd, out_fd, sz, task_info, pargs);
+    }
+
+    if(pargs.m_pool != nullptr && pargs.m_chunk_size != 0 && 
+       static_cast<std::size_t>(sz) > pargs.m_chunk_size) {
+        return ::do_parallel_copy(sz, pargs.m_chunk_size, task_info, pargs,
+                [&](off_t offset, ssize_t end) {
+                    ssize_t rv = 0;
+
+                    if(!::do_copy_file_range(in_fd, out_fd, offset, end, 
+                                             task_info, rv)) {
+                        rv = ::do_pread_pwrite(in_fd, out_fd, offset, end, 
+                                               task_info);
+                    }
+
+                    return rv;
+                });
+    }
+
+    off_t offset = 0;
+    ssize_t rv = 0;
+
+    if(!::do_copy_file_range(in_fd, out_fd, offset, sz, task_info, rv)) {
+        rv = ::do_sendfile(in_fd, out_fd, offset, sz, task_info);
+    }
 
-	return sz;
+    return rv == -1 ? rv : sz;
 }
 
 std::error_code
 copy_file(const std::shared_ptr<norns::io::task_info>& task_info, 
-          const bfs::path& src, const bfs::path& dst) {
+          const bfs::path& src, const bfs::path& dst,
+          const parallel_copy_args& pargs) {
 
     auto start = std::chrono::steady_clock::now();
 
@@ -134,7 +953,7 @@ copy_file(const std::shared_ptr<norns::io::task_info>& task_info,
         return std::make_error_code(static_cast<std::errc>(errno));
     }
 
-    if((file_size = do_sendfile(in_fd, out_fd)) == -1) {
+    if((file_size = do_copy(in_fd, out_fd, *task_info, pargs)) == -1) {
         close(in_fd);
         close(out_fd);
         return std::make_error_code(static_cast<std::errc>(errno));
@@ -154,44 +973,287 @@ retry_close:
     double usecs = std::chrono::duration<double, std::micro>(
             std::chrono::steady_clock::now() - start).count();
 
-    task_info->record_transfer(file_size, usecs);
+    // progress was already accounted for by do_copy()
+    task_info->update_bandwidth(file_size, usecs);
 
     return std::make_error_code(static_cast<std::errc>(0));
 }
 
+// concurrent traversal of a directory tree. Each directory queued is 
+// listed by whichever thread picks it up: its subdirectories are created
+// in the destination and queued in turn, and its files are added to the 
+// list of files to copy. Errors are recorded per entry and don't stop 
+// the traversal
+struct tree_walk {
+
+    struct file_entry {
+        bfs::path m_src;
+        bfs::path m_dst;
+        std::uintmax_t m_size;
+    };
+
+    tree_walk(const bfs::path& src, const bfs::path& dst) :
+        m_pending_dirs(1) {
+        m_queue.emplace_back(src, dst);
+    }
+
+    // process queued directories until the whole tree has been listed. 
+    // Threads that start once the traversal is complete return 
+    // immediately
+    void
+    run(const norns::io::task_info& task_info) {
+
+        for(;;) {
+            std::pair<bfs::path, bfs::path> dir;
+
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_queue_cv.wait(lock, [&] { 
+                    return !m_queue.empty() || m_pending_dirs == 0; 
+                });
+
+                if(m_pending_dirs == 0) {
+                    return;
+                }
+
+                dir = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+
+            if(!task_info.is_cancelled()) {
+                list_directory(dir.first, dir.second);
+            }
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if(--m_pending_dirs == 0) {
+                m_queue_cv.notify_all();
+            }
+        }
+    }
+
+    // list 'src_dir', whose contents are copied into 'dst_dir'
+    void
+    list_directory(const bfs::path& src_dir, const bfs::path& dst_dir) {
+
+        boost::system::error_code ec;
+        std::vector<std::pair<bfs::path, bfs::path>> subdirs;
+        std::vector<file_entry> files;
+
+        for(auto it = bfs::directory_iterator(src_dir, ec); 
+            !ec && it != bfs::directory_iterator(); it.increment(ec)) {
+
+            const auto dst_path = dst_dir / it->path().filename();
+
+            if(bfs::is_directory(it->status())) {
+
+                boost::system::error_code dir_ec;
+
+                if(!bfs::exists(dst_path)) {
+                    bfs::create_directory(dst_path, dir_ec);
+
+                    if(dir_ec) {
+                        record_error(dst_path, dir_ec);
+                        continue;
+                    }
+                }
+
+                // as recursive_directory_iterator, don't follow symlinks
+                // to directories
+                if(!bfs::is_symlink(it->symlink_status())) {
+                    subdirs.emplace_back(it->path(), dst_path);
+                }
+                continue;
+            }
+
+            boost::system::error_code size_ec;
+            std::uintmax_t sz = bfs::file_size(it->path(), size_ec);
+
+            files.push_back({it->path(), dst_path, size_ec ? 0 : sz});
+        }
+
+        if(ec) {
+            record_error(src_dir, ec);
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        m_files.insert(m_files.end(), files.begin(), files.end());
+
+        for(auto& d : subdirs) {
+            m_queue.push_back(std::move(d));
+            ++m_pending_dirs;
+        }
+
+        if(!subdirs.empty()) {
+            m_queue_cv.notify_all();
+        }
+    }
+
+    void
+    record_error(const bfs::path& path, const boost::system::error_code& ec) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_errors.emplace_back(path, 
+                std::make_error_code(static_cast<std::errc>(ec.value())));
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_queue_cv;
+    std::deque<std::pair<bfs::path, bfs::path>> m_queue;
+    std::size_t m_pending_dirs;
+    std::vector<file_entry> m_files;
+    std::vector<std::pair<bfs::path, std::error_code>> m_errors;
+};
+
+// copy the contents of 'src' into 'dst' (which must exist). The tree is 
+// traversed concurrently and then its files are copied by up to 
+// 'pargs.m_fanout' threads, largest first, so that a large file found 
+// late doesn't delay the completion of the whole task. All directories 
+// are created before any file is copied. Errors are logged for each 
+// entry affected, and the first of them is returned once the rest of 
+// the tree has been copied
 std::error_code
 copy_directory(const std::shared_ptr<norns::io::task_info>& task_info,
-               const bfs::path& src, const bfs::path& dst) {
+               const bfs::path& src, const bfs::path& dst,
+               const parallel_copy_args& pargs) {
 
-    boost::system::error_code ec;
-    auto it = bfs::recursive_directory_iterator(src, ec);
-    const auto end = bfs::recursive_directory_iterator();
     std::size_t saved_sent_bytes = task_info->sent_bytes();
+    auto start = std::chrono::steady_clock::now();
+
+    auto walk = std::make_shared<tree_walk>(src, dst);
 
-    if(ec) {
-        return std::make_error_code(static_cast<std::errc>(ec.value()));
+    if(pargs.m_pool != nullptr) {
+        for(std::size_t i = 0; i < pargs.m_fanout - 1; ++i) {
+            pargs.m_pool->submit_and_forget([walk, task_info]() {
+                walk->run(*task_info);
+            });
+        }
     }
 
-    auto start = std::chrono::steady_clock::now();
+    walk->run(*task_info);
+
+    if(task_info->is_cancelled()) {
+        return std::make_error_code(std::errc::operation_canceled);
+    }
+
+    auto& files = walk->m_files;
+
+    std::sort(files.begin(), files.end(), 
+              [](const tree_walk::file_entry& lhs, 
+                 const tree_walk::file_entry& rhs) {
+                  return lhs.m_size > rhs.m_size;
+              });
+
+    LOGGER_DEBUG("[{}] copying {} files from {}", task_info->id(), 
+                 files.size(), src);
+
+    // files larger than 'uring_max_file_size' are copied one per item, 
+    // and the rest (which are at the end of the list) in batches that 
+    // are submitted to io_uring together
+    std::size_t num_large = files.size();
+    std::size_t batch_size = 0;
+
+    // io_uring copies go through the page cache
+    if(pargs.m_uring_queue_depth != 0 && !task_info->direct_io()) {
+        num_large = std::distance(files.begin(), 
+                std::find_if(files.begin(), files.end(), 
+                    [](const tree_walk::file_entry& f) {
+                        return f.m_size <= uring_max_file_size;
+                    }));
+        batch_size = pargs.m_uring_queue_depth * uring_batch_factor;
+    }
+
+    const std::size_t num_batches = batch_size == 0 ? 0 : 
+        (files.size() - num_large + batch_size - 1) / batch_size;
+
+    const auto copy_one = [&](std::size_t i) {
+        if(auto err = ::copy_file(task_info, files[i].m_src, 
+                                  files[i].m_dst, pargs)) {
+            std::lock_guard<std::mutex> lock(walk->m_mutex);
+            walk->m_errors.emplace_back(files[i].m_src, err);
+        }
+    };
 
-    for(; it != end; ++it) {
-        const auto dst_path = dst / bfs::relative(*it, src);
+    const auto copy_batch = [&](std::size_t first, std::size_t last) {
 
-        if(bfs::is_directory(*it)) {
-            if(!bfs::exists(dst_path)) {
+        std::vector<norns::io::uring_copier::file_pair> batch;
+        batch.reserve(last - first);
 
-                bfs::create_directory(dst_path, ec);
+        for(std::size_t i = first; i < last; ++i) {
+            batch.push_back({files[i].m_src, files[i].m_dst});
+        }
+
+        std::vector<std::error_code> results;
+        bool no_ring = false;
+
+        try {
+            norns::io::uring_copier copier(pargs.m_uring_queue_depth);
+            results = copier.copy(batch, *task_info);
+        }
+        catch(const std::system_error& ex) {
+            LOGGER_WARN("[{}] io_uring copy failed ({}), falling back to "
+                        "synchronous copies", task_info->id(), ex.what());
+
+            results.assign(batch.size(), std::make_error_code(
+                        norns::io::uring_copier::not_copied));
+            no_ring = true;
+        }
 
-                if(ec) {
-                    return std::make_error_code(static_cast<std::errc>(ec.value()));
+        // files that the ring didn't get to copy are retried one by one
+        std::vector<std::size_t> retries;
+
+        {
+            std::lock_guard<std::mutex> lock(walk->m_mutex);
+            for(std::size_t i = 0; i < results.size(); ++i) {
+                if(results[i] == norns::io::uring_copier::not_copied) {
+                    retries.push_back(first + i);
+                }
+                else if(results[i]) {
+                    walk->m_errors.emplace_back(batch[i].m_src, results[i]);
                 }
             }
-            continue;
         }
 
-        if(auto err = ::copy_file(task_info, *it, dst_path)) {
-            return err;
+        if(!retries.empty() && !no_ring) {
+            LOGGER_WARN("[{}] io_uring failed, copying the remaining {} "
+                        "files synchronously", task_info->id(), 
+                        retries.size());
+        }
+
+        for(const auto i : retries) {
+            if(task_info->is_cancelled()) {
+                return;
+            }
+            copy_one(i);
         }
+    };
+
+    ::parallel_for(num_large + num_batches, pargs, [&](std::size_t i) {
+
+        if(task_info->is_cancelled()) {
+            return;
+        }
+
+        if(i < num_large) {
+            copy_one(i);
+            return;
+        }
+
+        const std::size_t first = num_large + (i - num_large) * batch_size;
+        copy_batch(first, std::min(first + batch_size, files.size()));
+    });
+
+    if(task_info->is_cancelled()) {
+        return std::make_error_code(std::errc::operation_canceled);
+    }
+
+    if(!walk->m_errors.empty()) {
+        for(const auto& err : walk->m_errors) {
+            LOGGER_ERROR("[{}] Failed to copy {}: {}", task_info->id(), 
+                         err.first, err.second.message());
+        }
+
+        return walk->m_errors.front().second;
     }
 
     double usecs = std::chrono::duration<double, std::micro>(
@@ -211,7 +1273,31 @@ namespace io {
 
 local_path_to_local_path_transferor::local_path_to_local_path_transferor(
     const context& ctx) :
-        m_ctx(ctx) {}
+        m_ctx(ctx) {
+
+    // the thread running a task copies ranges and directory entries too, 
+    // so only fanout - 1 helpers are needed. The pool is needed to copy 
+    // directories in parallel even if files are never split into ranges 
+    // (i.e. copy_chunk_size == 0)
+    if(m_ctx.copy_fanout() > 1) {
+        m_copy_pool = std::make_shared<thread_pool>(m_ctx.copy_fanout() - 1);
+    }
+
+    // each copy that bypasses the page cache uses two buffers
+    m_direct_buffers = std::make_shared<utils::aligned_buffer_pool>(
+            direct_io_buffer_size, direct_io_alignment, 
+            2 * std::max(m_ctx.copy_fanout(), 1u));
+
+    if(m_ctx.io_uring_queue_depth() != 0) {
+        if(uring_copier::available()) {
+            m_uring_queue_depth = m_ctx.io_uring_queue_depth();
+        }
+        else {
+            LOGGER_WARN("io_uring is not available, local directories will "
+                        "be copied with synchronous I/O");
+        }
+    }
+}
 
 bool 
 local_path_to_local_path_transferor::validate(
@@ -243,13 +1329,32 @@ local_path_to_local_path_transferor::transfer(
     LOGGER_DEBUG("[{}] transfer: {} -> {}", task_info->id(),
             d_src.canonical_path(), d_dst.canonical_path());
 
+    // without a copy pool, the blocks of copies that bypass the page 
+    // cache are written by a dedicated helper so that reads and writes 
+    // still overlap. Only created once such a copy is seen
+    thread_pool* writer_pool = nullptr;
+
+    if(!m_copy_pool && task_info->direct_io()) {
+        std::call_once(m_writer_pool_once, [this]() {
+            m_writer_pool = std::make_shared<thread_pool>(1);
+        });
+        writer_pool = m_writer_pool.get();
+    }
+
+    const parallel_copy_args pargs{m_ctx.copy_chunk_size(), 
+                                   m_ctx.copy_fanout(), 
+                                   m_copy_pool.get(),
+                                   m_uring_queue_depth,
+                                   m_direct_buffers.get(),
+                                   writer_pool};
+
     if(bfs::is_directory(d_src.canonical_path())) {
         return ::copy_directory(task_info, d_src.canonical_path(), 
-                                d_dst.canonical_path());
+                                d_dst.canonical_path(), pargs);
     }
 
     return ::copy_file(task_info, d_src.canonical_path(), 
-                       d_dst.canonical_path());
+                       d_dst.canonical_path(), pargs);
 }
 
 std::error_code 
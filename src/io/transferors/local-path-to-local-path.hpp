@@ -39,8 +39,11 @@
 #define __IO_LOCAL_PATH_TO_LOCAL_PATH_TX__
 
 #include <memory>
+#include <mutex>
 #include <system_error>
 #include "context.hpp"
+#include "io/thread-pool.hpp"
+#include "utils/aligned-buffer-pool.hpp"
 #include "transferor.hpp"
 
 namespace norns {
@@ -85,6 +88,17 @@ struct local_path_to_local_path_transferor : public transferor {
 
 private:
     context m_ctx;
+    // helper threads that copy ranges of large files
+    std::shared_ptr<thread_pool> m_copy_pool;
+    // files kept in flight by io_uring when copying directories (0 if 
+    // io_uring is disabled or not available)
+    uint32_t m_uring_queue_depth = 0;
+    // buffers for copies that bypass the page cache
+    std::shared_ptr<utils::aligned_buffer_pool> m_direct_buffers;
+    // helper that writes the blocks of copies that bypass the page cache
+    // when there is no m_copy_pool (created on first use)
+    mutable std::once_flag m_writer_pool_once;
+    mutable std::shared_ptr<thread_pool> m_writer_pool;
 };
 
 
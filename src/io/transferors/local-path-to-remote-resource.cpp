@@ -48,6 +48,7 @@
 #include "auth.hpp"
 #include "io/task-info.hpp"
 #include "io/task-stats.hpp"
+#include "utils/trace.hpp"
 #include "hermes.hpp"
 #include "rpcs.hpp"
 #include "local-path-to-remote-resource.hpp"
@@ -64,9 +65,12 @@ bfs::path
 pack_archive(const std::string& name_pattern,
              const bfs::path& parent_path,
              const std::vector<archive_entry>& entries,
+             const std::shared_ptr<norns::io::task_info>& task_info,
              std::error_code& ec) {
 
     using norns::utils::tar;
+    const norns::utils::trace::scope trace_scope(
+            "transferor", "pack_archive", task_info->id());
 
     bfs::path ar_path = parent_path / bfs::unique_path(name_pattern);
 
@@ -79,6 +83,11 @@ pack_archive(const std::string& name_pattern,
 
     LOGGER_INFO("Archive created in {}", ar.path());
 
+    // stop packing data as soon as the task is cancelled
+    ar.set_cancellation_check([task_info]() {
+        return task_info->is_cancelled();
+    });
+
     for(auto&& e : entries) {
         e.m_is_directory ?
             ar.add_directory(e.m_realpath, e.m_archive_path, ec) :
@@ -140,7 +149,8 @@ namespace io {
 local_path_to_remote_resource_transferor::
     local_path_to_remote_resource_transferor(const context& ctx) :
         m_staging_directory(ctx.staging_directory()),
-        m_network_service(ctx.network_service()) { }
+        m_network_service(ctx.network_service()),
+        m_exposure(ctx) { }
 
 bool 
 local_path_to_remote_resource_transferor::validate(
@@ -185,7 +195,7 @@ local_path_to_remote_resource_transferor::transfer(
                 ::pack_archive("norns-archive-%%%%-%%%%-%%%%.tar",
                                m_staging_directory,
                                {{true, d_src.canonical_path(), d_dst.name()}},
-                               ec);
+                               task_info, ec);
 
             if(ec) {
                 LOGGER_ERROR("Failed to create temporary archive: {}", 
@@ -204,6 +214,9 @@ local_path_to_remote_resource_transferor::transfer(
             return tempfile->path();
         }(); // <<== XXX (IILE)
 
+    if(ec) {
+        return ec;
+    }
 
     LOGGER_DEBUG("[{}] start_transfer: {} -> {}", 
                  task_info->id(), d_src.canonical_path(), d_dst.to_string());
@@ -220,12 +233,22 @@ local_path_to_remote_resource_transferor::transfer(
             return ec;
         }
 
+        // the data actually sent may be an archive, whose size differs 
+        // from the one estimated when the task was created
+        task_info->set_total_bytes(input_buffer.size());
+
         std::vector<hermes::mutable_buffer> bufvec{
             hermes::mutable_buffer{input_buffer.data(), input_buffer.size()}
         };
 
         auto local_buffers = 
             m_network_service->expose(bufvec, hermes::access_mode::read_only);
+        m_exposure.exposed_for_reading(input_buffer.size());
+
+        // anything done so far (e.g. packing the archive) was setup
+        task_info->mark(task_phase::started);
+
+        const auto rpc_start = utils::trace::clock::now();
 
         auto resp = 
             m_network_service->post<rpc::push_resource>(
@@ -247,6 +270,9 @@ local_path_to_remote_resource_transferor::transfer(
                     local_buffers
                 }).get();
 
+        utils::trace::complete("transferor", "push_resource", task_info->id(),
+                               rpc_start, utils::trace::clock::now());
+
         if(static_cast<task_status>(resp.at(0).status()) ==
             task_status::finished_with_error) {
             // XXX error interface should be improved
@@ -310,6 +336,8 @@ local_path_to_remote_resource_transferor::accept_transfer(
 
     assert(remote_buffers.count() == 1);
 
+    task_info->set_total_bytes(remote_buffers.size());
+
     bool is_collection = d_src.is_collection();
 
     // TODO this should probably go into validate(), but we need to change
@@ -363,6 +391,7 @@ local_path_to_remote_resource_transferor::accept_transfer(
 
     hermes::exposed_memory local_buffers =
         m_network_service->expose(bufseq, hermes::access_mode::write_only);
+    m_exposure.exposed_for_writing(output_buffer->size());
 
     LOGGER_DEBUG("pulling remote data into {}", tempfile->path());
 
@@ -380,13 +409,21 @@ local_path_to_remote_resource_transferor::accept_transfer(
 //                            std::chrono::steady_clock::now().time_since_epoch())
 //                            .count());
 
+        const auto end = std::chrono::steady_clock::now();
         uint32_t usecs = 
             std::chrono::duration_cast<std::chrono::microseconds>(
-                std::chrono::steady_clock::now() - start).count();
+                end - start).count();
+
+        // completion callbacks are run by the network progress thread
+        utils::trace::set_thread_name("network");
+        utils::trace::complete("transferor", "async_pull", task_info->id(), 
+                               start, end);
 
         //TODO: hermes offers no way to check for an error yet
         LOGGER_DEBUG("Pull completed ({} usecs)", usecs);
 
+        task_info->record_transfer(output_buffer->size(), usecs);
+
         // default response (success)
         rpc::push_resource::output out = {
                 static_cast<uint32_t>(task_status::finished),
@@ -395,6 +432,8 @@ local_path_to_remote_resource_transferor::accept_transfer(
                 usecs};
 
         if(is_collection) {
+            const utils::trace::scope trace_scope(
+                    "transferor", "unpack_archive", task_info->id());
             std::error_code ec = 
                 ::unpack_archive(tempfile->path(), d_dst.parent()->mount());
 
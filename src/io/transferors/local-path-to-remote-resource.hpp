@@ -41,6 +41,7 @@
 #include <memory>
 #include <system_error>
 #include "context.hpp"
+#include "exposure-counters.hpp"
 #include "transferor.hpp"
 
 namespace hermes {
@@ -93,6 +94,7 @@ struct local_path_to_remote_resource_transferor : public transferor {
 private:
     bfs::path m_staging_directory;
     std::shared_ptr<hermes::async_engine> m_network_service;
+    exposure_counters m_exposure;
 
 };
 
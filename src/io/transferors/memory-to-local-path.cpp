@@ -38,6 +38,7 @@
 #include <sys/uio.h>
 #include <sys/mman.h>
 #include <fcntl.h>
+#include <algorithm>
 
 #include "utils.hpp"
 #include "logger.hpp"
@@ -49,6 +50,11 @@
 
 namespace {
 
+// maximum number of bytes copied by a single call to process_vm_readv() 
+// when the task has no bandwidth limits, so that progress is reported and 
+// cancellation requests are noticed within a reasonable time
+constexpr std::size_t readv_chunk_size = 64*1024*1024;
+
 std::error_code
 copy_memory_region(const std::shared_ptr<norns::io::task_info>& task_info, 
                    pid_t pid, void* src_addr, size_t size, const bfs::path& dst) {
@@ -56,6 +62,9 @@ copy_memory_region(const std::shared_ptr<norns::io::task_info>& task_info,
     int out_fd = -1;
     void* dst_addr = NULL;
     ssize_t nbytes = -1;
+    size_t chunk_size = 0;
+    size_t offset = 0;
+    size_t count = 0;
     int rv = 0;
     struct iovec local_region, remote_region;
 
@@ -102,26 +111,49 @@ copy_memory_region(const std::shared_ptr<norns::io::task_info>& task_info,
         goto cleanup_on_error;
     }
 
-    local_region.iov_base = dst_addr;
-    remote_region.iov_base = src_addr;
-    local_region.iov_len = remote_region.iov_len = size;
-
-    nbytes = ::process_vm_readv(pid, &local_region, 1, &remote_region, 1, 0);
+    // copy the region in chunks (so that we can report progress and, if the 
+    // task is subject to bandwidth limits, wait for the necessary tokens 
+    // before each of them)
+    chunk_size = task_info->limiter().chunk_size();
 
-    if(nbytes == -1) {
-        LOGGER_ERROR("process_vm_readv() error");
-        rv = errno;
-        goto cleanup_on_error;
+    if(chunk_size == 0) {
+        chunk_size = readv_chunk_size;
     }
 
-    // according to the documentation, partial reads should only happen
-    // at the granularity of iovec elements. Given that we only have one
-    // element in our 'src' iovec, we should never hit this, but just in case
-    // we return an EIO
-    if(static_cast<size_t>(nbytes) < size) {
-        LOGGER_ERROR("process_vm_readv() received fewer data than expected");
-        rv = EIO;
-        goto cleanup_on_error;
+    for(offset = 0; offset < size; offset += count) {
+
+        if(task_info->is_cancelled()) {
+            rv = ECANCELED;
+            goto cleanup_on_error;
+        }
+
+        count = std::min(size - offset, chunk_size);
+        task_info->limiter().consume(count);
+
+        local_region.iov_base = static_cast<char*>(dst_addr) + offset;
+        remote_region.iov_base = static_cast<char*>(src_addr) + offset;
+        local_region.iov_len = remote_region.iov_len = count;
+
+        nbytes = 
+            ::process_vm_readv(pid, &local_region, 1, &remote_region, 1, 0);
+
+        if(nbytes == -1) {
+            LOGGER_ERROR("process_vm_readv() error");
+            rv = errno;
+            goto cleanup_on_error;
+        }
+
+        // according to the documentation, partial reads should only happen
+        // at the granularity of iovec elements. Given that we only have one
+        // element in our 'src' iovec, we should never hit this, but just in 
+        // case we return an EIO
+        if(static_cast<size_t>(nbytes) < count) {
+            LOGGER_ERROR("process_vm_readv() received fewer data than expected");
+            rv = EIO;
+            goto cleanup_on_error;
+        }
+
+        task_info->record_progress(nbytes);
     }
 
     // success: set rv to 0 and fall through
@@ -35,12 +35,14 @@
  * SOFTWARE.                                                             *
  *************************************************************************/
 
+#include <algorithm>
 #include "utils.hpp"
 #include "logger.hpp"
 #include "resources.hpp"
 #include "auth.hpp"
 #include "io/task-info.hpp"
 #include "io/task-stats.hpp"
+#include "utils/trace.hpp"
 #include "memory-to-remote-resource.hpp"
 
 namespace {
@@ -49,32 +51,47 @@ std::error_code
 copy_from_process(pid_t pid, 
                   void* input_address, 
                   void* output_address, 
-                  size_t size) {
+                  size_t size,
+                  const norns::io::rate_limiter& limiter) {
 
     std::error_code ec;
 
-    struct iovec local_region, remote_region;
-    local_region.iov_base = output_address;
-    remote_region.iov_base = input_address;
-    local_region.iov_len = remote_region.iov_len = size;
+    // copy the region (in chunks if the task is subject to bandwidth limits,
+    // so that we can wait for the necessary tokens before each of them)
+    size_t chunk_size = limiter.chunk_size();
 
-    ssize_t nbytes =
-        ::process_vm_readv(pid, &local_region, 1, &remote_region, 1, 0);
-
-    if(nbytes == -1) {
-        LOGGER_ERROR("process_vm_readv() error");
-        ec.assign(errno, std::generic_category());
-        return ec;
+    if(chunk_size == 0) {
+        chunk_size = size;
     }
 
-    // according to the documentation, partial reads should only happen
-    // at the granularity of iovec elements. Given that we only have one
-    // element in our 'src' iovec, we should never hit this, but just in case
-    // we return an EIO
-    if(static_cast<size_t>(nbytes) < size) {
-        LOGGER_ERROR("process_vm_readv() received fewer data than expected");
-        ec.assign(EIO, std::generic_category());
-        return ec;
+    for(size_t offset = 0, count = 0; offset < size; offset += count) {
+
+        count = std::min(size - offset, chunk_size);
+        limiter.consume(count);
+
+        struct iovec local_region, remote_region;
+        local_region.iov_base = static_cast<char*>(output_address) + offset;
+        remote_region.iov_base = static_cast<char*>(input_address) + offset;
+        local_region.iov_len = remote_region.iov_len = count;
+
+        ssize_t nbytes =
+            ::process_vm_readv(pid, &local_region, 1, &remote_region, 1, 0);
+
+        if(nbytes == -1) {
+            LOGGER_ERROR("process_vm_readv() error");
+            ec.assign(errno, std::generic_category());
+            return ec;
+        }
+
+        // according to the documentation, partial reads should only happen
+        // at the granularity of iovec elements. Given that we only have one
+        // element in our 'src' iovec, we should never hit this, but just in 
+        // case we return an EIO
+        if(static_cast<size_t>(nbytes) < count) {
+            LOGGER_ERROR("process_vm_readv() received fewer data than expected");
+            ec.assign(EIO, std::generic_category());
+            return ec;
+        }
     }
 
     if(::msync(output_address, size, MS_SYNC) != 0) {
@@ -94,7 +111,8 @@ namespace io {
 memory_region_to_remote_resource_transferor::
     memory_region_to_remote_resource_transferor(const context& ctx) :
         m_staging_directory(ctx.staging_directory()),
-        m_network_service(ctx.network_service()) {}
+        m_network_service(ctx.network_service()),
+        m_exposure(ctx) {}
 
 bool 
 memory_region_to_remote_resource_transferor::validate(
@@ -168,7 +186,8 @@ memory_region_to_remote_resource_transferor::transfer(
 
     if((ec = ::copy_from_process(auth.pid(),
                                 reinterpret_cast<void *>(d_src.address()),
-                                output_buffer->data(), d_src.size()))) {
+                                output_buffer->data(), d_src.size(),
+                                task_info->limiter()))) {
         LOGGER_ERROR("Failed to copy data from process memory: {}", 
                      ec.message());
         return ec;
@@ -187,18 +206,25 @@ memory_region_to_remote_resource_transferor::transfer(
 
         hermes::endpoint endp = m_network_service->lookup(d_dst.address());
 
+        task_info->set_total_bytes(output_buffer->size());
+
         std::vector<hermes::mutable_buffer> bufvec{
             hermes::mutable_buffer{output_buffer->data(), output_buffer->size()}
         };
 
         auto local_buffers = 
             m_network_service->expose(bufvec, hermes::access_mode::read_only);
+        m_exposure.exposed_for_reading(output_buffer->size());
+
+        task_info->mark(task_phase::started);
 
 //        LOGGER_CRITICAL("push_resource RPC posted: {}",
 //                        std::chrono::duration_cast<std::chrono::nanoseconds>(
 //                            std::chrono::steady_clock::now().time_since_epoch())
 //                            .count());
 
+        const auto rpc_start = utils::trace::clock::now();
+
         auto resp = 
             m_network_service->post<rpc::push_resource>(
                 endp, 
@@ -219,6 +245,9 @@ memory_region_to_remote_resource_transferor::transfer(
                     local_buffers
                 }).get();
 
+        utils::trace::complete("transferor", "push_resource", task_info->id(),
+                               rpc_start, utils::trace::clock::now());
+
 //        LOGGER_CRITICAL("push_resource response retrieved: {}",
 //                        std::chrono::duration_cast<std::chrono::nanoseconds>(
 //                            std::chrono::steady_clock::now().time_since_epoch())
@@ -41,6 +41,7 @@
 #include "auth.hpp"
 #include "io/task-info.hpp"
 #include "io/task-stats.hpp"
+#include "utils/trace.hpp"
 #include "hermes.hpp"
 #include "rpcs.hpp"
 #include "remote-resource-to-local-path.hpp"
@@ -57,9 +58,12 @@ bfs::path
 pack_archive(const std::string& name_pattern,
              const bfs::path& parent_path,
              const std::vector<archive_entry>& entries,
+             const std::shared_ptr<norns::io::task_info>& task_info,
              std::error_code& ec) {
 
     using norns::utils::tar;
+    const norns::utils::trace::scope trace_scope(
+            "transferor", "pack_archive", task_info->id());
 
     bfs::path ar_path = parent_path / bfs::unique_path(name_pattern);
 
@@ -72,6 +76,11 @@ pack_archive(const std::string& name_pattern,
 
     LOGGER_INFO("Archive created in {}", ar.path());
 
+    // stop packing data as soon as the task is cancelled
+    ar.set_cancellation_check([task_info]() {
+        return task_info->is_cancelled();
+    });
+
     for(auto&& e : entries) {
         e.m_is_directory ?
             ar.add_directory(e.m_realpath, e.m_archive_path, ec) :
@@ -133,7 +142,8 @@ namespace io {
 remote_resource_to_local_path_transferor::
     remote_resource_to_local_path_transferor(const context& ctx) :
         m_staging_directory(ctx.staging_directory()),
-        m_network_service(ctx.network_service()) { }
+        m_network_service(ctx.network_service()),
+        m_exposure(ctx) { }
 
 bool
 remote_resource_to_local_path_transferor::validate(
@@ -168,6 +178,8 @@ remote_resource_to_local_path_transferor::transfer(
 
     hermes::endpoint endp = m_network_service->lookup(d_src.address());
 
+    auto rpc_start = utils::trace::clock::now();
+
     auto resp = 
         m_network_service->post<rpc::stat_resource>(
             endp, 
@@ -178,6 +190,9 @@ remote_resource_to_local_path_transferor::transfer(
                 d_src.name()
             }).get();
 
+    utils::trace::complete("transferor", "stat_resource", task_info->id(), 
+                           rpc_start, utils::trace::clock::now());
+
     LOGGER_DEBUG("remote_stat returned [task_error: {}, sys_errnum: {}, "
                  "is_collection: {}, packed_size: {}]", 
                  resp.at(0).task_error(),
@@ -210,6 +225,8 @@ remote_resource_to_local_path_transferor::transfer(
 
     LOGGER_DEBUG("created local resource: {}", tempfile.path());
 
+    task_info->set_total_bytes(resp.at(0).packed_size());
+
     auto output_buffer = 
         std::make_shared<hermes::mapped_buffer>(
                 tempfile.path().string(),
@@ -228,6 +245,13 @@ remote_resource_to_local_path_transferor::transfer(
 
     hermes::exposed_memory local_buffers =
         m_network_service->expose(bufseq, hermes::access_mode::write_only);
+    m_exposure.exposed_for_writing(output_buffer->size());
+
+    // anything done so far (e.g. querying the peer and preparing the 
+    // output file) was setup
+    task_info->mark(task_phase::started);
+
+    rpc_start = utils::trace::clock::now();
 
     auto resp2 = 
         m_network_service->post<rpc::pull_resource>(
@@ -248,6 +272,9 @@ remote_resource_to_local_path_transferor::transfer(
                 local_buffers
             }).get();
 
+    utils::trace::complete("transferor", "pull_resource", task_info->id(), 
+                           rpc_start, utils::trace::clock::now());
+
     LOGGER_DEBUG("Remote push request completed with output "
                  "{{status: {}, task_error: {}, sys_errnum: {}}} "
                  "({} bytes, {} usecs)",
@@ -266,6 +293,8 @@ remote_resource_to_local_path_transferor::transfer(
                                resp2.at(0).elapsed_time());
 
     if(resp.at(0).is_collection()) {
+        const utils::trace::scope trace_scope(
+                "transferor", "unpack_archive", task_info->id());
         return ::unpack_archive(tempfile.path(), d_dst.parent()->mount());
     }
 
@@ -304,7 +333,7 @@ remote_resource_to_local_path_transferor::accept_transfer(
                 ::pack_archive("norns-archive-%%%%-%%%%-%%%%.tar",
                                m_staging_directory,
                                {{true, d_src.canonical_path(), d_dst.name()}},
-                               ec);
+                               task_info, ec);
 
             if(ec) {
                 LOGGER_ERROR("Failed to create temporary archive: {}", 
@@ -345,12 +374,15 @@ remote_resource_to_local_path_transferor::accept_transfer(
         return ec;
     }
 
+    task_info->set_total_bytes(input_buffer->size());
+
     std::vector<hermes::mutable_buffer> bufvec{
         hermes::mutable_buffer{input_buffer->data(), input_buffer->size()}
     };
 
     auto local_buffers = 
         m_network_service->expose(bufvec, hermes::access_mode::read_only);
+    m_exposure.exposed_for_reading(input_buffer->size());
 
     // retrieve remote buffers descriptor
     hermes::exposed_memory remote_buffers = d_dst.buffers();
@@ -372,9 +404,15 @@ remote_resource_to_local_path_transferor::accept_transfer(
         [this, tempfile, input_buffer, start, task_info](
                 hermes::request<rpc::pull_resource>&& req) { 
 
+        const auto end = std::chrono::steady_clock::now();
         uint32_t usecs = 
             std::chrono::duration_cast<std::chrono::microseconds>(
-                std::chrono::steady_clock::now() - start).count();
+                end - start).count();
+
+        // completion callbacks are run by the network progress thread
+        utils::trace::set_thread_name("network");
+        utils::trace::complete("transferor", "async_push", task_info->id(), 
+                               start, end);
 
         // default response
         rpc::pull_resource::output out(
@@ -386,6 +424,8 @@ remote_resource_to_local_path_transferor::accept_transfer(
         //TODO: hermes offers no way to check for an error yet
         LOGGER_DEBUG("Push completed");
 
+        task_info->record_transfer(input_buffer->size(), usecs);
+
         if(req.requires_response()) {
             m_network_service->respond<rpc::pull_resource>(
                     std::move(req), 
@@ -42,6 +42,7 @@
 #include <memory>
 
 #include "context.hpp"
+#include "exposure-counters.hpp"
 #include "transferor.hpp"
 
 namespace hermes {
@@ -94,6 +95,7 @@ struct remote_resource_to_local_path_transferor : public transferor {
 private:
     bfs::path m_staging_directory;
     std::shared_ptr<hermes::async_engine> m_network_service;
+    exposure_counters m_exposure;
 };
 
 } // namespace io
@@ -0,0 +1,571 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <algorithm>
+#include "config.h"
+
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#endif
+
+#include "io/task-info.hpp"
+#include "io/task-stats.hpp"
+#include "uring-copier.hpp"
+
+namespace {
+
+// size of the buffer used by each file in flight
+constexpr const std::size_t buffer_size = 128*1024;
+
+} // anonymous namespace
+
+namespace norns {
+namespace io {
+
+#ifdef HAVE_LIBURING
+
+struct uring_copier::impl {
+
+    // a file being copied. Only one operation per file is in flight at 
+    // any time, except when both of its descriptors are being closed
+    struct slot {
+
+        enum class state { open_src, open_dst, read, write, close };
+
+        std::size_t m_index;
+        state m_state;
+        int m_src_fd;
+        int m_dst_fd;
+        off_t m_offset;
+        std::size_t m_length;
+        std::size_t m_written;
+        int m_pending_closes;
+        int m_inflight;
+        int m_error;
+        std::unique_ptr<char[]> m_buffer;
+    };
+
+    // an entry queued in the submission ring. 'm_close_fd' is the 
+    // descriptor to close for close operations (-1 otherwise), which 
+    // must be closed by hand if the entry never reaches the kernel
+    struct queued_entry {
+        slot* m_slot;
+        int m_close_fd;
+    };
+
+    explicit impl(uint32_t queue_depth) :
+        m_slots(queue_depth),
+        m_copied(0) {
+
+        // each file needs at most two entries at a time
+        const int rv = ::io_uring_queue_init(2 * queue_depth, &m_ring, 0);
+
+        if(rv != 0) {
+            throw std::system_error(-rv, std::generic_category(), 
+                                    "io_uring_queue_init");
+        }
+
+        for(auto& s : m_slots) {
+            s.m_buffer.reset(new char[buffer_size]);
+        }
+    }
+
+    ~impl() {
+        ::io_uring_queue_exit(&m_ring);
+    }
+
+    struct io_uring_sqe*
+    get_sqe() {
+        struct io_uring_sqe* sqe;
+
+        while((sqe = ::io_uring_get_sqe(&m_ring)) == nullptr) {
+            ::io_uring_submit(&m_ring);
+            forget_submitted();
+        }
+
+        return sqe;
+    }
+
+    void
+    queue(slot& s, struct io_uring_sqe* sqe, int close_fd = -1) {
+        ::io_uring_sqe_set_data(sqe, &s);
+        ++s.m_inflight;
+        m_unsubmitted.push_back({&s, close_fd});
+    }
+
+    // drop the entries that the kernel has already consumed
+    void
+    forget_submitted() {
+        const std::size_t ready = ::io_uring_sq_ready(&m_ring);
+        m_unsubmitted.erase(m_unsubmitted.begin(), 
+                            m_unsubmitted.end() - ready);
+    }
+
+    void
+    start(slot& s, std::size_t index, const file_pair& fp) {
+        s.m_index = index;
+        s.m_state = slot::state::open_src;
+        s.m_src_fd = -1;
+        s.m_dst_fd = -1;
+        s.m_offset = 0;
+        s.m_length = 0;
+        s.m_written = 0;
+        s.m_pending_closes = 0;
+        s.m_inflight = 0;
+        s.m_error = 0;
+
+        auto sqe = get_sqe();
+        ::io_uring_prep_openat(sqe, AT_FDCWD, fp.m_src.c_str(), O_RDONLY, 0);
+        queue(s, sqe);
+    }
+
+    void
+    open_dst(slot& s, const file_pair& fp) {
+        s.m_state = slot::state::open_dst;
+
+        auto sqe = get_sqe();
+        ::io_uring_prep_openat(sqe, AT_FDCWD, fp.m_dst.c_str(), 
+                               O_CREAT | O_WRONLY | O_TRUNC, 
+                               S_IRUSR | S_IWUSR);
+        queue(s, sqe);
+    }
+
+    bool
+    read_next(slot& s, const task_info& task_info) {
+
+        if(task_info.is_cancelled()) {
+            return fail(s, ECANCELED);
+        }
+
+        s.m_state = slot::state::read;
+
+        auto sqe = get_sqe();
+        ::io_uring_prep_read(sqe, s.m_src_fd, s.m_buffer.get(), buffer_size, 
+                             s.m_offset);
+        queue(s, sqe);
+        return false;
+    }
+
+    void
+    write_next(slot& s) {
+        s.m_state = slot::state::write;
+
+        auto sqe = get_sqe();
+        ::io_uring_prep_write(sqe, s.m_dst_fd, s.m_buffer.get() + s.m_written,
+                              s.m_length - s.m_written, 
+                              s.m_offset + s.m_written);
+        queue(s, sqe);
+    }
+
+    // close any descriptors opened for the file. Returns true if there 
+    // were none, i.e. if the file is done
+    bool
+    close_files(slot& s) {
+        s.m_state = slot::state::close;
+
+        for(int fd : {s.m_src_fd, s.m_dst_fd}) {
+            if(fd != -1) {
+                auto sqe = get_sqe();
+                ::io_uring_prep_close(sqe, fd);
+                queue(s, sqe, fd);
+                ++s.m_pending_closes;
+            }
+        }
+
+        // from now on the descriptors belong to the queued entries
+        s.m_src_fd = -1;
+        s.m_dst_fd = -1;
+
+        return s.m_pending_closes == 0;
+    }
+
+    bool
+    fail(slot& s, int error) {
+        s.m_error = error;
+        return close_files(s);
+    }
+
+    // process the completion of the operation in flight for 's' and 
+    // queue the next one. Returns true once the file is done
+    bool
+    complete(slot& s, int res, const file_pair& fp, task_info& task_info) {
+
+        switch(s.m_state) {
+            case slot::state::open_src:
+                if(res < 0) {
+                    return fail(s, -res);
+                }
+
+                s.m_src_fd = res;
+                open_dst(s, fp);
+                return false;
+
+            case slot::state::open_dst:
+                if(res < 0) {
+                    return fail(s, -res);
+                }
+
+                s.m_dst_fd = res;
+                return read_next(s, task_info);
+
+            case slot::state::read:
+                if(res < 0) {
+                    return fail(s, -res);
+                }
+
+                // end of file
+                if(res == 0) {
+                    return close_files(s);
+                }
+
+                // throttling blocks all the files in flight, which is 
+                // what we want since they share the same limits
+                if(task_info.limiter().enabled()) {
+                    task_info.limiter().consume(res);
+                }
+
+                s.m_length = res;
+                s.m_written = 0;
+                write_next(s);
+                return false;
+
+            case slot::state::write:
+                if(res <= 0) {
+                    return fail(s, res < 0 ? -res : EIO);
+                }
+
+                s.m_written += res;
+
+                if(s.m_written < s.m_length) {
+                    write_next(s);
+                    return false;
+                }
+
+                s.m_offset += s.m_length;
+                return read_next(s, task_info);
+
+            case slot::state::close:
+                if(res < 0 && s.m_error == 0) {
+                    s.m_error = -res;
+                }
+
+                return --s.m_pending_closes == 0;
+        }
+
+        return false;
+    }
+
+    // record the result of a file that is done. Progress is only 
+    // recorded here so that the files abandoned by abort() are never
+    // accounted twice when copied again by the caller
+    void
+    finish(slot& s, std::vector<std::error_code>& results, 
+           task_info& task_info) {
+
+        results[s.m_index] = std::make_error_code(
+                static_cast<std::errc>(s.m_error));
+
+        if(s.m_offset != 0) {
+            task_info.record_progress(s.m_offset);
+        }
+
+        if(s.m_error == 0) {
+            ++m_copied;
+        }
+    }
+
+    // the ring can't be used anymore: wait for the operations that the 
+    // kernel already has so that none of them is still writing to a file
+    // when the caller copies it again, and close the descriptors of the
+    // files in flight. Those files are reported as 'not_copied'
+    void
+    abort(const std::vector<slot*>& active, 
+          std::vector<std::error_code>& results, task_info& task_info) {
+
+        forget_submitted();
+
+        for(const auto& e : m_unsubmitted) {
+            --e.m_slot->m_inflight;
+
+            if(e.m_close_fd != -1) {
+                ::close(e.m_close_fd);
+                --e.m_slot->m_pending_closes;
+            }
+        }
+
+        m_unsubmitted.clear();
+
+        const auto inflight = [&] {
+            for(const auto s : active) {
+                if(s->m_inflight != 0) {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        while(inflight()) {
+
+            struct io_uring_cqe* cqe;
+            const int rv = ::io_uring_wait_cqe(&m_ring, &cqe);
+
+            if(rv == -EINTR) {
+                continue;
+            }
+
+            // nothing else can be done: whatever is left is cancelled 
+            // when the ring is destroyed
+            if(rv < 0) {
+                break;
+            }
+
+            auto s = static_cast<slot*>(::io_uring_cqe_get_data(cqe));
+            const int res = cqe->res;
+            ::io_uring_cqe_seen(&m_ring, cqe);
+
+            --s->m_inflight;
+
+            switch(s->m_state) {
+                case slot::state::open_src:
+                    if(res >= 0) {
+                        s->m_src_fd = res;
+                    }
+                    break;
+                case slot::state::open_dst:
+                    if(res >= 0) {
+                        s->m_dst_fd = res;
+                    }
+                    break;
+                case slot::state::close:
+                    if(res < 0 && s->m_error == 0) {
+                        s->m_error = -res;
+                    }
+                    --s->m_pending_closes;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        for(const auto s : active) {
+
+            // files that were only waiting for their descriptors to be 
+            // closed are done
+            if(s->m_state == slot::state::close && 
+               s->m_pending_closes == 0) {
+                finish(*s, results, task_info);
+                continue;
+            }
+
+            for(int fd : {s->m_src_fd, s->m_dst_fd}) {
+                if(fd != -1) {
+                    ::close(fd);
+                }
+            }
+
+            results[s->m_index] = 
+                std::make_error_code(uring_copier::not_copied);
+        }
+    }
+
+    std::vector<std::error_code>
+    copy(const std::vector<file_pair>& files, task_info& task_info) {
+
+        std::vector<std::error_code> results(files.size());
+        std::vector<slot*> free_slots;
+        std::size_t next = 0;
+        std::size_t active = 0;
+
+        m_copied = 0;
+
+        for(auto& s : m_slots) {
+            free_slots.push_back(&s);
+        }
+
+        while(next < files.size() || active != 0) {
+
+            while(next < files.size() && !free_slots.empty()) {
+
+                if(task_info.is_cancelled()) {
+                    results[next++] = 
+                        std::make_error_code(std::errc::operation_canceled);
+                    continue;
+                }
+
+                start(*free_slots.back(), next, files[next]);
+                free_slots.pop_back();
+                ++next;
+                ++active;
+            }
+
+            if(active == 0) {
+                break;
+            }
+
+            const int rv = ::io_uring_submit_and_wait(&m_ring, 1);
+
+            if(rv < 0) {
+                if(rv == -EINTR || rv == -EAGAIN || rv == -EBUSY) {
+                    continue;
+                }
+
+                std::vector<slot*> busy;
+
+                for(auto& s : m_slots) {
+                    if(std::find(free_slots.begin(), free_slots.end(), &s) == 
+                            free_slots.end()) {
+                        busy.push_back(&s);
+                    }
+                }
+
+                abort(busy, results, task_info);
+
+                for(; next < files.size(); ++next) {
+                    results[next] = 
+                        std::make_error_code(uring_copier::not_copied);
+                }
+
+                break;
+            }
+
+            forget_submitted();
+
+            struct io_uring_cqe* cqe;
+            unsigned head;
+            unsigned count = 0;
+
+            io_uring_for_each_cqe(&m_ring, head, cqe) {
+                ++count;
+
+                auto s = static_cast<slot*>(::io_uring_cqe_get_data(cqe));
+                --s->m_inflight;
+
+                if(complete(*s, cqe->res, files[s->m_index], task_info)) {
+                    finish(*s, results, task_info);
+                    free_slots.push_back(s);
+                    --active;
+                }
+            }
+
+            ::io_uring_cq_advance(&m_ring, count);
+        }
+
+        if(m_copied != 0) {
+            task_info.record_copy_engine(copy_engine::io_uring);
+        }
+
+        return results;
+    }
+
+    struct io_uring m_ring;
+    std::vector<slot> m_slots;
+    std::vector<queued_entry> m_unsubmitted;
+    std::size_t m_copied;
+};
+
+bool
+uring_copier::available() {
+
+    static const bool is_available = [] {
+        struct io_uring ring;
+
+        if(::io_uring_queue_init(2, &ring, 0) != 0) {
+            return false;
+        }
+
+        bool rv = false;
+        struct io_uring_probe* probe = ::io_uring_get_probe_ring(&ring);
+
+        if(probe != nullptr) {
+            rv = ::io_uring_opcode_supported(probe, IORING_OP_OPENAT) &&
+                 ::io_uring_opcode_supported(probe, IORING_OP_READ) &&
+                 ::io_uring_opcode_supported(probe, IORING_OP_WRITE) &&
+                 ::io_uring_opcode_supported(probe, IORING_OP_CLOSE);
+            ::io_uring_free_probe(probe);
+        }
+
+        ::io_uring_queue_exit(&ring);
+        return rv;
+    }();
+
+    return is_available;
+}
+
+uring_copier::uring_copier(uint32_t queue_depth) :
+    m_impl(new impl(std::max(queue_depth, 1u))) { }
+
+std::vector<std::error_code>
+uring_copier::copy(const std::vector<file_pair>& files, 
+                   task_info& task_info) {
+    return m_impl->copy(files, task_info);
+}
+
+#else // ! HAVE_LIBURING
+
+struct uring_copier::impl { };
+
+bool
+uring_copier::available() {
+    return false;
+}
+
+uring_copier::uring_copier(uint32_t queue_depth) {
+    (void) queue_depth;
+    throw std::system_error(ENOSYS, std::generic_category(), 
+                            "norns was built without io_uring support");
+}
+
+std::vector<std::error_code>
+uring_copier::copy(const std::vector<file_pair>& files, 
+                   task_info& task_info) {
+    (void) task_info;
+    return std::vector<std::error_code>(files.size(), 
+            std::make_error_code(not_copied));
+}
+
+#endif // HAVE_LIBURING
+
+uring_copier::~uring_copier() = default;
+
+constexpr const std::errc uring_copier::not_copied;
+
+} // namespace io
+} // namespace norns
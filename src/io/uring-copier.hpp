@@ -0,0 +1,98 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#ifndef __IO_URING_COPIER_HPP__
+#define __IO_URING_COPIER_HPP__
+
+#include <cstdint>
+#include <memory>
+#include <system_error>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+namespace bfs = boost::filesystem;
+
+namespace norns {
+namespace io {
+
+// forward declarations
+struct task_info;
+
+/*! Copies batches of local files with io_uring. Instead of blocking on 
+ * each open(), read(), write() and close(), the operations of up to 
+ * 'queue_depth' files are kept in flight from the calling thread, which 
+ * hides the per-file syscall latency in workloads with many small files.
+ * Each instance owns a ring and must be used by a single thread */
+struct uring_copier {
+
+    struct file_pair {
+        bfs::path m_src;
+        bfs::path m_dst;
+    };
+
+    /*! Returns true if norns was built with io_uring support and the 
+     * running kernel supports all the operations needed (io_uring may 
+     * also be disabled by seccomp policies, e.g. in containers) */
+    static bool 
+    available();
+
+    /*! Create a ring that keeps up to 'queue_depth' files in flight. 
+     * Throws std::system_error if the ring can't be created */
+    explicit uring_copier(uint32_t queue_depth);
+    ~uring_copier();
+
+    /*! Result reported for the files that were not copied because the 
+     * ring itself failed. Nothing is left in flight for them, so the 
+     * caller may copy them by other means */
+    static constexpr const std::errc not_copied = 
+        std::errc::resource_unavailable_try_again;
+
+    /*! Copy each file in 'files' to its destination, recording the 
+     * progress in 'task_info'. Returns the result of each copy in the 
+     * same order as 'files' */
+    std::vector<std::error_code>
+    copy(const std::vector<file_pair>& files, task_info& task_info);
+
+private:
+    struct impl;
+    std::unique_ptr<impl> m_impl;
+};
+
+} // namespace io
+} // namespace norns
+
+#endif /* __IO_URING_COPIER_HPP__ */
@@ -0,0 +1,348 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include "logger.hpp"
+#include "metrics-registry.hpp"
+#include "metrics-exporter.hpp"
+
+namespace {
+
+// time allowed to clients to send their requests before we reply anyway
+constexpr const int request_timeout_ms = 1000;
+
+// time allowed to clients to read the whole response. Connections are 
+// served one at a time, so a client that stops reading must not be able
+// to block the exporter (and the textfile refreshes) for longer
+constexpr const int response_timeout_ms = 5000;
+
+// wait until 'fd' is ready for 'events' or 'deadline' expires. Returns 
+// false on timeout or error
+bool
+wait_for(int fd, short events, 
+         std::chrono::steady_clock::time_point deadline) {
+
+    for(;;) {
+        const auto remaining = 
+            std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now()).count();
+
+        if(remaining <= 0) {
+            return false;
+        }
+
+        struct pollfd pfd = { fd, events, 0 };
+        const int rv = ::poll(&pfd, 1, static_cast<int>(remaining));
+
+        if(rv < 0 && errno == EINTR) {
+            continue;
+        }
+
+        return rv > 0;
+    }
+}
+
+bool
+write_all(int fd, const std::string& data, 
+          std::chrono::steady_clock::time_point deadline) {
+
+    std::size_t written = 0;
+
+    while(written < data.size()) {
+        const ssize_t n = ::send(fd, data.data() + written, 
+                                 data.size() - written, 
+                                 MSG_NOSIGNAL | MSG_DONTWAIT);
+
+        if(n < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+
+            if((errno == EAGAIN || errno == EWOULDBLOCK) && 
+               wait_for(fd, POLLOUT, deadline)) {
+                continue;
+            }
+
+            return false;
+        }
+
+        written += n;
+    }
+
+    return true;
+}
+
+} // anonymous namespace
+
+namespace norns {
+namespace metrics {
+
+exporter::exporter(std::shared_ptr<registry> registry, 
+                   const bfs::path& socket_path,
+                   const bfs::path& textfile_path,
+                   std::chrono::seconds interval) :
+    m_registry(std::move(registry)),
+    m_socket_path(socket_path),
+    m_textfile_path(textfile_path),
+    m_interval(std::max(interval, std::chrono::seconds(1))),
+    m_listen_fd(-1),
+    m_wakeup_fds{-1, -1} {}
+
+exporter::~exporter() {
+    stop();
+}
+
+std::error_code
+exporter::start() {
+
+    if(m_thread.joinable()) {
+        return std::make_error_code(std::errc::device_or_resource_busy);
+    }
+
+    if(::pipe2(m_wakeup_fds, O_CLOEXEC | O_NONBLOCK) != 0) {
+        return std::error_code(errno, std::generic_category());
+    }
+
+    if(!m_socket_path.empty()) {
+
+        struct sockaddr_un addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+
+        if(m_socket_path.string().size() >= sizeof(addr.sun_path)) {
+            stop();
+            return std::make_error_code(std::errc::filename_too_long);
+        }
+
+        std::strncpy(addr.sun_path, m_socket_path.c_str(), 
+                     sizeof(addr.sun_path) - 1);
+
+        m_listen_fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+
+        // remove any stale socket left behind by a previous instance
+        ::unlink(m_socket_path.c_str());
+
+        if(m_listen_fd == -1 ||
+           ::bind(m_listen_fd, reinterpret_cast<struct sockaddr*>(&addr), 
+                  sizeof(addr)) != 0 ||
+           ::listen(m_listen_fd, SOMAXCONN) != 0) {
+            const std::error_code ec(errno, std::generic_category());
+            stop();
+            return ec;
+        }
+    }
+
+    m_thread = std::thread(&exporter::run, this);
+
+    return std::error_code();
+}
+
+void
+exporter::stop() {
+
+    if(m_thread.joinable()) {
+        const char c = 0;
+        while(::write(m_wakeup_fds[1], &c, 1) == -1 && errno == EINTR) { }
+        m_thread.join();
+    }
+
+    if(m_listen_fd != -1) {
+        ::close(m_listen_fd);
+        ::unlink(m_socket_path.c_str());
+        m_listen_fd = -1;
+    }
+
+    for(auto& fd : m_wakeup_fds) {
+        if(fd != -1) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+}
+
+std::error_code
+exporter::write_textfile() const {
+
+    if(m_textfile_path.empty()) {
+        return std::error_code();
+    }
+
+    const std::string path = m_textfile_path.string();
+    // node_exporter only reads files ending in '.prom', so it will never 
+    // see a partially written file
+    const std::string tmp_path = path + ".tmp";
+
+    {
+        std::ofstream out(tmp_path, std::ios::trunc);
+
+        if(!out) {
+            return std::error_code(errno, std::generic_category());
+        }
+
+        out << m_registry->to_prometheus();
+        out.flush();
+
+        if(!out) {
+            std::remove(tmp_path.c_str());
+            return std::make_error_code(std::errc::io_error);
+        }
+    }
+
+    if(std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        const std::error_code ec(errno, std::generic_category());
+        std::remove(tmp_path.c_str());
+        return ec;
+    }
+
+    return std::error_code();
+}
+
+void
+exporter::run() {
+
+    using clock = std::chrono::steady_clock;
+
+    auto next_write = clock::now();
+
+    for(;;) {
+
+        if(!m_textfile_path.empty() && clock::now() >= next_write) {
+            if(const auto ec = write_textfile()) {
+                LOGGER_WARN("Failed to write metrics to {}: {}", 
+                            m_textfile_path, ec.message());
+            }
+            next_write = clock::now() + m_interval;
+        }
+
+        struct pollfd fds[2] = {
+            { m_wakeup_fds[0], POLLIN, 0 },
+            { m_listen_fd, POLLIN, 0 }
+        };
+
+        // wait forever if there is no textfile to rewrite
+        const int timeout = m_textfile_path.empty() ? -1 :
+            std::max(0, static_cast<int>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    next_write - clock::now()).count()) + 1);
+
+        const int rv = ::poll(fds, m_listen_fd != -1 ? 2 : 1, timeout);
+
+        if(rv < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            LOGGER_ERROR("Metrics exporter failed: {}", std::strerror(errno));
+            return;
+        }
+
+        if(fds[0].revents != 0) {
+            return;
+        }
+
+        if(m_listen_fd != -1 && (fds[1].revents & POLLIN)) {
+
+            const int fd = ::accept4(m_listen_fd, nullptr, nullptr, 
+                                     SOCK_CLOEXEC);
+
+            if(fd != -1) {
+                serve(fd);
+                ::close(fd);
+            }
+        }
+    }
+}
+
+void
+exporter::serve(int fd) const {
+
+    using clock = std::chrono::steady_clock;
+
+    // we answer any request with the metrics, but we need to consume it 
+    // first: clients may fail to read the response otherwise
+    const auto request_deadline = clock::now() + 
+        std::chrono::milliseconds(request_timeout_ms);
+
+    std::string request;
+    char buffer[1024];
+
+    while(request.find("\r\n\r\n") == std::string::npos && 
+          request.size() < 8192) {
+
+        const ssize_t n = ::recv(fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+
+        if(n < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if(n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK) && 
+           wait_for(fd, POLLIN, request_deadline)) {
+            continue;
+        }
+
+        if(n <= 0) {
+            break;
+        }
+
+        request.append(buffer, n);
+    }
+
+    const std::string body = m_registry->to_prometheus();
+    const auto response_deadline = clock::now() + 
+        std::chrono::milliseconds(response_timeout_ms);
+
+    // a client that doesn't read the response in time is dropped when 
+    // the caller closes the connection
+    write_all(fd, "HTTP/1.0 200 OK\r\n"
+                  "Content-Type: text/plain; version=0.0.4\r\n"
+                  "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                  "Connection: close\r\n"
+                  "\r\n" + body, response_deadline);
+}
+
+} // namespace metrics
+} // namespace norns
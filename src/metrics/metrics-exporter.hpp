@@ -0,0 +1,105 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#ifndef __METRICS_EXPORTER_HPP__
+#define __METRICS_EXPORTER_HPP__
+
+#include <chrono>
+#include <memory>
+#include <system_error>
+#include <thread>
+#include <boost/filesystem.hpp>
+
+namespace bfs = boost::filesystem;
+
+namespace norns {
+namespace metrics {
+
+// forward declarations
+struct registry;
+
+/*! Publishes the metrics in a registry in the Prometheus text format, 
+ * either by answering the HTTP requests received through a UNIX socket 
+ * (e.g. 'curl --unix-socket <path> http://localhost/metrics') or by 
+ * periodically rewriting a file (e.g. for node_exporter's textfile 
+ * collector), or both. Empty paths disable the corresponding method */
+struct exporter {
+
+    exporter(std::shared_ptr<registry> registry, 
+             const bfs::path& socket_path,
+             const bfs::path& textfile_path,
+             std::chrono::seconds interval);
+
+    exporter(const exporter& other) = delete;
+    exporter& operator=(const exporter& other) = delete;
+
+    ~exporter();
+
+    /*! Create the socket (if any) and start the thread that serves 
+     * requests and rewrites the textfile */
+    std::error_code
+    start();
+
+    void
+    stop();
+
+    /*! Write the current metrics to the textfile, atomically replacing it */
+    std::error_code
+    write_textfile() const;
+
+private:
+    void
+    run();
+
+    void
+    serve(int fd) const;
+
+    const std::shared_ptr<registry> m_registry;
+    const bfs::path m_socket_path;
+    const bfs::path m_textfile_path;
+    const std::chrono::seconds m_interval;
+
+    int m_listen_fd;
+    // written to in order to wake up the thread when stopping
+    int m_wakeup_fds[2];
+    std::thread m_thread;
+};
+
+} // namespace metrics
+} // namespace norns
+
+#endif /* __METRICS_EXPORTER_HPP__ */
@@ -0,0 +1,290 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include "metrics-registry.hpp"
+
+namespace {
+
+bool
+is_valid_name(const std::string& name, bool allow_colons) {
+
+    if(name.empty()) {
+        return false;
+    }
+
+    for(std::size_t i = 0; i < name.size(); ++i) {
+        const char c = name[i];
+
+        if((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' ||
+           (c == ':' && allow_colons) || (c >= '0' && c <= '9' && i != 0)) {
+            continue;
+        }
+
+        return false;
+    }
+
+    return true;
+}
+
+// escape a label value or a help string: the latter keeps double quotes
+std::string
+escape(const std::string& str, bool escape_quotes) {
+
+    std::string escaped;
+    escaped.reserve(str.size());
+
+    for(const char c : str) {
+        switch(c) {
+            case '\\':
+                escaped += "\\\\";
+                break;
+            case '\n':
+                escaped += "\\n";
+                break;
+            case '"':
+                escaped += (escape_quotes ? "\\\"" : "\"");
+                break;
+            default:
+                escaped += c;
+        }
+    }
+
+    return escaped;
+}
+
+// render labels as '{name="value",...}' (or nothing if there are none)
+std::string
+format_labels(const norns::metrics::labels& lbls) {
+
+    if(lbls.empty()) {
+        return "";
+    }
+
+    std::string str = "{";
+
+    for(const auto& kv : lbls) {
+
+        if(!is_valid_name(kv.first, false)) {
+            throw std::invalid_argument("Invalid label name '" + 
+                                        kv.first + "'");
+        }
+
+        if(str.size() != 1) {
+            str += ",";
+        }
+
+        str += kv.first + "=\"" + escape(kv.second, true) + "\"";
+    }
+
+    return str + "}";
+}
+
+std::string
+format_value(double value) {
+
+    if(std::isnan(value)) {
+        return "NaN";
+    }
+
+    if(std::isinf(value)) {
+        return value > 0 ? "+Inf" : "-Inf";
+    }
+
+    // integral values (e.g. byte counts) are printed in full
+    if(value == std::floor(value) && std::fabs(value) < 1e18) {
+        return std::to_string(static_cast<int64_t>(value));
+    }
+
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+    return buffer;
+}
+
+const char*
+type_name(norns::metrics::metric_type type) {
+    return type == norns::metrics::metric_type::counter ? "counter" : "gauge";
+}
+
+} // anonymous namespace
+
+namespace norns {
+namespace metrics {
+
+registry::family::family(const std::string& help, metric_type type) :
+    m_help(help),
+    m_type(type) {}
+
+registry::family&
+registry::get_family(const std::string& name, const std::string& help, 
+                     metric_type type) {
+
+    if(!is_valid_name(name, true)) {
+        throw std::invalid_argument("Invalid metric name '" + name + "'");
+    }
+
+    auto it = m_families.find(name);
+
+    if(it == m_families.end()) {
+        it = m_families.emplace(name, family(help, type)).first;
+    }
+
+    if(it->second.m_type != type) {
+        throw std::invalid_argument("Metric '" + name + "' already "
+                                    "registered as a " + 
+                                    type_name(it->second.m_type));
+    }
+
+    return it->second;
+}
+
+std::shared_ptr<counter>
+registry::make_counter(const std::string& name, const std::string& help, 
+                       const labels& lbls) {
+
+    const auto key = format_labels(lbls);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto& ptr = get_family(name, help, metric_type::counter).m_counters[key];
+
+    if(!ptr) {
+        ptr = std::make_shared<counter>();
+    }
+
+    return ptr;
+}
+
+std::shared_ptr<gauge>
+registry::make_gauge(const std::string& name, const std::string& help, 
+                     const labels& lbls) {
+
+    const auto key = format_labels(lbls);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto& ptr = get_family(name, help, metric_type::gauge).m_gauges[key];
+
+    if(!ptr) {
+        ptr = std::make_shared<gauge>();
+    }
+
+    return ptr;
+}
+
+void
+registry::add_collector(const std::string& name, const std::string& help, 
+                        metric_type type, collector fn) {
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    get_family(name, help, type).m_collectors.emplace_back(std::move(fn));
+}
+
+std::string
+registry::to_prometheus() const {
+
+    struct snapshot {
+        std::string m_name;
+        std::string m_help;
+        metric_type m_type;
+        std::vector<std::pair<std::string, double>> m_series;
+        std::vector<collector> m_collectors;
+    };
+
+    std::vector<snapshot> snapshots;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        snapshots.reserve(m_families.size());
+
+        for(const auto& kv : m_families) {
+
+            const auto& f = kv.second;
+            snapshot s{kv.first, f.m_help, f.m_type, {}, f.m_collectors};
+
+            for(const auto& c : f.m_counters) {
+                s.m_series.emplace_back(c.first, 
+                        static_cast<double>(c.second->value()));
+            }
+
+            for(const auto& g : f.m_gauges) {
+                s.m_series.emplace_back(g.first, 
+                        static_cast<double>(g.second->value()));
+            }
+
+            snapshots.emplace_back(std::move(s));
+        }
+    }
+
+    // collectors run without holding the lock, since they may take a 
+    // while or create metrics themselves
+    std::string out;
+    std::vector<sample> samples;
+
+    for(auto& s : snapshots) {
+
+        for(const auto& fn : s.m_collectors) {
+            samples.clear();
+            fn(samples);
+
+            for(const auto& smp : samples) {
+                s.m_series.emplace_back(format_labels(smp.m_labels), 
+                                        smp.m_value);
+            }
+        }
+
+        if(s.m_series.empty()) {
+            continue;
+        }
+
+        out += "# HELP " + s.m_name + " " + escape(s.m_help, false) + "\n";
+        out += "# TYPE " + s.m_name + " " + type_name(s.m_type) + "\n";
+
+        for(const auto& series : s.m_series) {
+            out += s.m_name + series.first + " " + 
+                   format_value(series.second) + "\n";
+        }
+    }
+
+    return out;
+}
+
+} // namespace metrics
+} // namespace norns
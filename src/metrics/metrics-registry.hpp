@@ -0,0 +1,182 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#ifndef __METRICS_REGISTRY_HPP__
+#define __METRICS_REGISTRY_HPP__
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace norns {
+namespace metrics {
+
+/*! Label names and values that identify a time series within a metric, 
+ * e.g. {{"src", "tmp0"}, {"dst", "tmp1"}} */
+using labels = std::vector<std::pair<std::string, std::string>>;
+
+enum class metric_type {
+    counter,
+    gauge
+};
+
+/*! A value that can only increase. Updates are relaxed atomic additions, 
+ * so that counters can be incremented from hot paths once they have been 
+ * created (creating them requires a lookup in the registry) */
+struct counter {
+
+    counter() : 
+        m_value(0) {}
+
+    void
+    inc(uint64_t n = 1) {
+        m_value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint64_t
+    value() const {
+        return m_value.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> m_value;
+};
+
+/*! A value that can go up and down */
+struct gauge {
+
+    gauge() : 
+        m_value(0) {}
+
+    void
+    set(int64_t v) {
+        m_value.store(v, std::memory_order_relaxed);
+    }
+
+    void
+    add(int64_t n) {
+        m_value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void
+    sub(int64_t n) {
+        m_value.fetch_sub(n, std::memory_order_relaxed);
+    }
+
+    int64_t
+    value() const {
+        return m_value.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<int64_t> m_value;
+};
+
+/*! A value reported by a collector */
+struct sample {
+    sample(labels lbls, double value) :
+        m_labels(std::move(lbls)),
+        m_value(value) {}
+
+    labels m_labels;
+    double m_value;
+};
+
+/*! Function invoked each time metrics are collected to report the current 
+ * samples of a metric */
+using collector = std::function<void(std::vector<sample>&)>;
+
+/*! Set of metrics exported by the daemon. Metrics are either owned by the 
+ * registry (counters and gauges updated by their users) or computed on 
+ * demand by collectors, which suits values that are already maintained 
+ * elsewhere (e.g. the length of a queue). Registering a metric twice with 
+ * the same name and labels returns the same instance, while reusing a name 
+ * with a different type or using an invalid name throws 
+ * std::invalid_argument */
+struct registry {
+
+    registry() = default;
+    registry(const registry& other) = delete;
+    registry& operator=(const registry& other) = delete;
+
+    std::shared_ptr<counter>
+    make_counter(const std::string& name, const std::string& help, 
+                 const labels& lbls = labels());
+
+    std::shared_ptr<gauge>
+    make_gauge(const std::string& name, const std::string& help, 
+               const labels& lbls = labels());
+
+    void
+    add_collector(const std::string& name, const std::string& help, 
+                  metric_type type, collector fn);
+
+    /*! Render all metrics in the Prometheus text exposition format 
+     * (version 0.0.4). Metrics without samples are omitted */
+    std::string
+    to_prometheus() const;
+
+private:
+    struct family {
+        family(const std::string& help, metric_type type);
+
+        const std::string m_help;
+        const metric_type m_type;
+        // series are keyed by their rendered labels
+        std::map<std::string, std::shared_ptr<counter>> m_counters;
+        std::map<std::string, std::shared_ptr<gauge>> m_gauges;
+        std::vector<collector> m_collectors;
+    };
+
+    family&
+    get_family(const std::string& name, const std::string& help, 
+               metric_type type);
+
+    mutable std::mutex m_mutex;
+    std::map<std::string, family> m_families;
+};
+
+} // namespace metrics
+} // namespace norns
+
+#endif /* __METRICS_REGISTRY_HPP__ */
@@ -73,13 +73,17 @@
 #include "hermes.hpp"
 #include "rpcs.hpp"
 #include "context.hpp"
+#include "utils/numa.hpp"
+#include "utils/trace.hpp"
+#include "metrics.hpp"
 #include "urd.hpp"
 
 namespace norns {
 
 urd::urd() :
     m_is_paused(false),
-    m_settings(std::make_shared<config::settings>()) {}
+    m_settings(std::make_shared<config::settings>()),
+    m_metrics(std::make_shared<metrics::registry>()) {}
 
 urd::~urd() {}
 
@@ -248,6 +252,9 @@ urd::iotask_create_handler(const request_ptr base_request) {
     const auto type = request->get<0>();
     const auto src_rinfo = request->get<1>();
     const auto dst_rinfo = request->get<2>().get_value_or(nullptr);
+    const auto priority = request->get<3>();
+    const auto deadline = request->get<4>();
+    const auto parents = request->get<5>();
 
     std::vector<std::string> nsids;
     std::vector<bool> remotes;
@@ -304,7 +311,7 @@ urd::iotask_create_handler(const request_ptr base_request) {
 
     {
         bool all_found = false;
-        boost::shared_lock<boost::shared_mutex> lock(m_namespace_mgr_mutex);
+        boost::shared_lock<utils::profiled_shared_mutex> lock(m_namespace_mgr_mutex);
         std::tie(all_found, backend_ptrs) = m_namespace_mgr->find(nsids, remotes);
 
         if(!all_found) {
@@ -325,15 +332,21 @@ urd::iotask_create_handler(const request_ptr base_request) {
         case iotask_type::move:
         case iotask_type::copy:
             std::tie(rv, t) = 
-                m_task_mgr->create_local_initiated_task(type, *auth, backend_ptrs, rinfo_ptrs);
+                m_task_mgr->create_local_initiated_task(type, *auth, backend_ptrs, 
+                                                        rinfo_ptrs, priority,
+                                                        deadline, parents);
             break;
         case iotask_type::remove:
             std::tie(rv, t) =
-                m_task_mgr->create_local_initiated_task(type, *auth, backend_ptrs, rinfo_ptrs);
+                m_task_mgr->create_local_initiated_task(type, *auth, backend_ptrs, 
+                                                        rinfo_ptrs, priority,
+                                                        deadline, parents);
             break;
         case iotask_type::noop:
             std::tie(rv, t) = 
-                m_task_mgr->create_local_initiated_task(type, *auth, backend_ptrs, rinfo_ptrs);
+                m_task_mgr->create_local_initiated_task(type, *auth, backend_ptrs, 
+                                                        rinfo_ptrs, priority,
+                                                        deadline, parents);
             break;
         default:
             rv = urd_error::bad_args;
@@ -375,14 +388,24 @@ urd::iotask_status_handler(const request_ptr base_request) const {
 
         // stats provides a thread-safe view of a task status 
         // (locking is done internally)
-        resp->set<0>(task_info_ptr->stats());
+        const auto stats = task_info_ptr->stats();
+        resp->set<0>(stats);
 
-        if(task_info_ptr->status() == io::task_status::finished ||
-           task_info_ptr->status() == io::task_status::finished_with_error) {
+        // once the final status has been reported, the task can be 
+        // replaced by its tombstone
+        if(stats.status() == io::task_status::finished ||
+           stats.status() == io::task_status::finished_with_error) {
             m_task_mgr->erase(request->get<0>());
         }
 
     }
+    // the task may have been reaped already, but its final status is 
+    // still known if its tombstone has not been discarded
+    else if(const auto tombstone = 
+                m_task_mgr->find_tombstone(request->get<0>())) {
+        resp->set_error_code(urd_error::success);
+        resp->set<0>(tombstone->stats());
+    }
     else {
         resp->set_error_code(urd_error::no_such_task);
     }
@@ -393,6 +416,35 @@ urd::iotask_status_handler(const request_ptr base_request) const {
     return std::move(resp);
 }
 
+response_ptr 
+urd::iotask_cancel_handler(const request_ptr base_request) {
+
+    auto resp = std::make_unique<api::iotask_cancel_response>();
+
+    // downcast the generic request to the concrete implementation
+    auto request = 
+        utils::static_unique_ptr_cast<api::iotask_cancel_request>(
+                std::move(base_request));
+
+    const auto auth = request->credentials();
+
+    if(!auth) {
+        LOGGER_CRITICAL("Request without credentials");
+        resp->set_error_code(urd_error::snafu);
+    }
+    else {
+        // pending tasks are removed from the queue right away, whereas 
+        // running tasks are flagged and finish (with NORNS_ETASKCANCELLED) 
+        // as soon as they reach the next chunk boundary
+        resp->set_error_code(m_task_mgr->cancel(request->get<0>(), *auth));
+    }
+
+    LOGGER_INFO("IOTASK_CANCEL({}) = {}", 
+                request->to_string(), resp->to_string());
+
+    return std::move(resp);
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 //                 handlers for control requests
@@ -419,7 +471,7 @@ response_ptr urd::job_register_handler(const request_ptr base_request) {
     auto hosts = request->get<1>();
 
     {
-        boost::unique_lock<boost::shared_mutex> lock(m_jobs_mutex);
+        boost::unique_lock<utils::profiled_shared_mutex> lock(m_jobs_mutex);
 
         if(m_jobs.find(jobid) != m_jobs.end()) {
             resp->set_error_code(urd_error::job_exists);
@@ -445,7 +497,7 @@ response_ptr urd::job_update_handler(const request_ptr base_request) {
     auto hosts = request->get<1>();
 
     {
-        boost::unique_lock<boost::shared_mutex> lock(m_jobs_mutex);
+        boost::unique_lock<utils::profiled_shared_mutex> lock(m_jobs_mutex);
 
         const auto& it = m_jobs.find(jobid);
 
@@ -472,7 +524,7 @@ response_ptr urd::job_remove_handler(const request_ptr base_request) {
     uint32_t jobid = request->get<0>();
 
     {
-        boost::unique_lock<boost::shared_mutex> lock(m_jobs_mutex);
+        boost::unique_lock<utils::profiled_shared_mutex> lock(m_jobs_mutex);
 
         const auto& it = m_jobs.find(jobid);
 
@@ -501,7 +553,7 @@ response_ptr urd::process_add_handler(const request_ptr base_request) {
     gid_t gid = request->get<2>();
     pid_t pid = request->get<3>();
 
-    boost::unique_lock<boost::shared_mutex> lock(m_jobs_mutex);
+    boost::unique_lock<utils::profiled_shared_mutex> lock(m_jobs_mutex);
 
     const auto& it = m_jobs.find(jobid);
 
@@ -530,7 +582,7 @@ response_ptr urd::process_remove_handler(const request_ptr base_request) {
     gid_t gid = request->get<2>();
     pid_t pid = request->get<3>();
 
-    boost::unique_lock<boost::shared_mutex> lock(m_jobs_mutex);
+    boost::unique_lock<utils::profiled_shared_mutex> lock(m_jobs_mutex);
 
     const auto& it = m_jobs.find(jobid);
 
@@ -568,7 +620,7 @@ urd_error urd::create_namespace(const std::string& nsid, backend_type type,
                                 bool track, const bfs::path& mount, 
                                 uint32_t quota) {
 
-    boost::unique_lock<boost::shared_mutex> lock(m_namespace_mgr_mutex);
+    boost::unique_lock<utils::profiled_shared_mutex> lock(m_namespace_mgr_mutex);
 
     if(m_namespace_mgr->contains(nsid)) {
         return urd_error::namespace_exists;
@@ -627,7 +679,7 @@ response_ptr urd::namespace_remove_handler(const request_ptr base_request) {
     std::string nsid = request->get<0>();
 
     {
-        boost::unique_lock<boost::shared_mutex> lock(m_namespace_mgr_mutex);
+        boost::unique_lock<utils::profiled_shared_mutex> lock(m_namespace_mgr_mutex);
 
         if(m_namespace_mgr->remove(nsid)) {
             resp->set_error_code(urd_error::success);
@@ -652,6 +704,80 @@ response_ptr urd::global_status_handler(const request_ptr /*base_request*/) {
     return std::move(resp);
 }
 
+response_ptr urd::transfer_estimate_handler(const request_ptr base_request) {
+
+    // downcast the generic request to the concrete implementation
+    auto request = 
+        utils::static_unique_ptr_cast<api::transfer_estimate_request>(
+                std::move(base_request));
+
+    auto resp = std::make_unique<api::transfer_estimate_response>();
+
+    resp->set_error_code(urd_error::success);
+    resp->set<0>(m_task_mgr->estimate_transfer(request->get<0>(), 
+                                               request->get<1>(),
+                                               request->get<2>(), 
+                                               request->get<3>()));
+
+    LOGGER_INFO("TRANSFER_ESTIMATE({}) = {}", request->to_string(), 
+                resp->to_string());
+    return std::move(resp);
+}
+
+response_ptr urd::latency_stats_handler(const request_ptr /*base_request*/) {
+
+    auto resp = std::make_unique<api::latency_stats_response>();
+
+    auto lstats = m_task_mgr->latencies();
+
+    for(const auto& kv : m_ipc_latencies) {
+        if(kv.second.count() != 0) {
+            lstats.push_back(io::summarize(io::latency_stats::scope::request, 
+                                           utils::to_string(kv.first), 
+                                           io::latency_phase::handler, 
+                                           kv.second));
+        }
+    }
+
+    resp->set_error_code(urd_error::success);
+    resp->set<0>(std::move(lstats));
+
+    LOGGER_INFO("LATENCY_STATS() = {}", resp->to_string());
+    return std::move(resp);
+}
+
+response_ptr urd::lock_stats_handler(const request_ptr /*base_request*/) {
+
+    auto resp = std::make_unique<api::lock_stats_response>();
+
+    if(!m_settings->lock_profiling()) {
+        resp->set_error_code(urd_error::not_supported);
+    }
+    else {
+        resp->set_error_code(urd_error::success);
+        resp->set<0>(utils::lock_stats::collect());
+    }
+
+    LOGGER_INFO("LOCK_STATS() = {}", resp->to_string());
+    return std::move(resp);
+}
+
+response_ptr urd::slow_tasks_handler(const request_ptr /*base_request*/) {
+
+    auto resp = std::make_unique<api::slow_tasks_response>();
+
+    if(!m_task_mgr->watchdog_enabled()) {
+        resp->set_error_code(urd_error::not_supported);
+    }
+    else {
+        resp->set_error_code(urd_error::success);
+        resp->set<0>(m_task_mgr->slow_tasks());
+    }
+
+    LOGGER_INFO("SLOW_TASKS() = {}", resp->to_string());
+    return std::move(resp);
+}
+
 response_ptr
 urd::command_handler(const request_ptr base_request) {
 
@@ -686,6 +812,27 @@ urd::command_handler(const request_ptr base_request) {
             shutdown();
             break;
         }
+        case command_type::dump_trace:
+        {
+            if(!utils::trace::enabled()) {
+                resp->set_error_code(urd_error::not_supported);
+                break;
+            }
+
+            std::ofstream out(request->get<1>(), std::ios::trunc);
+
+            if(out) {
+                utils::trace::write_chrome_json(out);
+                out.flush();
+            }
+
+            if(!out) {
+                LOGGER_ERROR("Failed to write trace to {}", 
+                             request->get<1>());
+                resp->set_error_code(urd_error::system_error);
+            }
+            break;
+        }
         case command_type::unknown:
             resp->set_error_code(urd_error::bad_args);
             break;
@@ -710,6 +857,8 @@ response_ptr urd::unknown_request_handler(const request_ptr /*base_request*/) {
 void
 urd::push_resource_handler(hermes::request<rpc::push_resource>&& req) {
 
+    utils::trace::set_thread_name("network");
+
     const auto args = req.args();
 
     LOGGER_WARN("incoming rpc::push_resource(from: \"{}@{}:{}\", to: \"{}:{}\")", 
@@ -770,7 +919,7 @@ urd::push_resource_handler(hermes::request<rpc::push_resource>&& req) {
         std::make_shared<storage::detail::remote_backend>(args.in_nsid());
 
     {
-        boost::shared_lock<boost::shared_mutex> lock(m_namespace_mgr_mutex);
+        boost::shared_lock<utils::profiled_shared_mutex> lock(m_namespace_mgr_mutex);
         dst_backend = m_namespace_mgr->find(args.out_nsid());
     }
 
@@ -817,6 +966,8 @@ urd::push_resource_handler(hermes::request<rpc::push_resource>&& req) {
 void
 urd::pull_resource_handler(hermes::request<rpc::pull_resource>&& req) {
 
+    utils::trace::set_thread_name("network");
+
     const auto args = req.args();
 
     LOGGER_WARN("incoming rpc::push_request(from: \"{}:{}\", to: \"{}@{}:{}\")", 
@@ -875,7 +1026,7 @@ urd::pull_resource_handler(hermes::request<rpc::pull_resource>&& req) {
     // TODO: actually retrieve and validate credentials, etc
 
     {
-        boost::shared_lock<boost::shared_mutex> lock(m_namespace_mgr_mutex);
+        boost::shared_lock<utils::profiled_shared_mutex> lock(m_namespace_mgr_mutex);
         src_backend = m_namespace_mgr->find(args.in_nsid());
     }
 
@@ -925,6 +1076,8 @@ urd::pull_resource_handler(hermes::request<rpc::pull_resource>&& req) {
 void
 urd::stat_resource_handler(hermes::request<rpc::stat_resource>&& req) {
 
+    utils::trace::set_thread_name("network");
+
     const auto args = req.args();
 
     LOGGER_WARN("incoming rpc::stat_resource(\"{}:{}\")", 
@@ -935,7 +1088,7 @@ urd::stat_resource_handler(hermes::request<rpc::stat_resource>&& req) {
     boost::optional<std::shared_ptr<storage::backend>> dst_backend;
 
     {
-        boost::shared_lock<boost::shared_mutex> lock(m_namespace_mgr_mutex);
+        boost::shared_lock<utils::profiled_shared_mutex> lock(m_namespace_mgr_mutex);
         dst_backend = m_namespace_mgr->find(args.nsid());
     }
 
@@ -1174,62 +1327,86 @@ void urd::init_event_handlers() {
     LOGGER_INFO(" * Installing message handlers...");
 
     /* user-level functionalities */
-    m_ipc_service->register_callback(
+    register_ipc_callback(
             api::request_type::iotask_create,
             std::bind(&urd::iotask_create_handler, this, std::placeholders::_1));
 
-    m_ipc_service->register_callback(
+    register_ipc_callback(
             api::request_type::iotask_status,
             std::bind(&urd::iotask_status_handler, this, std::placeholders::_1));
 
-    m_ipc_service->register_callback(
+    register_ipc_callback(
+            api::request_type::iotask_cancel,
+            std::bind(&urd::iotask_cancel_handler, this, std::placeholders::_1));
+
+    register_ipc_callback(
             api::request_type::ping,
             std::bind(&urd::ping_handler, this, std::placeholders::_1));
 
     /* admin-level functionalities */
-    m_ipc_service->register_callback(
+    register_ipc_callback(
             api::request_type::job_register,
             std::bind(&urd::job_register_handler, this, std::placeholders::_1));
 
-    m_ipc_service->register_callback(
+    register_ipc_callback(
             api::request_type::job_update,
             std::bind(&urd::job_update_handler, this, std::placeholders::_1));
 
-    m_ipc_service->register_callback(
+    register_ipc_callback(
             api::request_type::job_unregister,
             std::bind(&urd::job_remove_handler, this, std::placeholders::_1));
 
-    m_ipc_service->register_callback(
+    register_ipc_callback(
             api::request_type::process_register,
             std::bind(&urd::process_add_handler, this, std::placeholders::_1));
 
-    m_ipc_service->register_callback(
+    register_ipc_callback(
             api::request_type::process_unregister,
             std::bind(&urd::process_remove_handler, this, std::placeholders::_1));
 
-    m_ipc_service->register_callback(
+    register_ipc_callback(
         api::request_type::backend_register,
         std::bind(&urd::namespace_register_handler, this,
                   std::placeholders::_1));
 
-    /*    m_ipc_service->register_callback(
+    /*    register_ipc_callback(
                 api::request_type::backend_update,
                 std::bind(&urd::namespace_update_handler, this,
        std::placeholders::_1));*/
 
-    m_ipc_service->register_callback(
+    register_ipc_callback(
             api::request_type::backend_unregister,
             std::bind(&urd::namespace_remove_handler, this, std::placeholders::_1));
 
-    m_ipc_service->register_callback(
+    register_ipc_callback(
             api::request_type::global_status,
             std::bind(&urd::global_status_handler, this, std::placeholders::_1));
 
-    m_ipc_service->register_callback(
+    register_ipc_callback(
+            api::request_type::transfer_estimate,
+            std::bind(&urd::transfer_estimate_handler, this, 
+                      std::placeholders::_1));
+
+    register_ipc_callback(
+            api::request_type::latency_stats,
+            std::bind(&urd::latency_stats_handler, this, 
+                      std::placeholders::_1));
+
+    register_ipc_callback(
+            api::request_type::lock_stats,
+            std::bind(&urd::lock_stats_handler, this, 
+                      std::placeholders::_1));
+
+    register_ipc_callback(
+            api::request_type::slow_tasks,
+            std::bind(&urd::slow_tasks_handler, this, 
+                      std::placeholders::_1));
+
+    register_ipc_callback(
             api::request_type::command,
             std::bind(&urd::command_handler, this, std::placeholders::_1));
 
-    m_ipc_service->register_callback(
+    register_ipc_callback(
             api::request_type::bad_request,
             std::bind(&urd::unknown_request_handler, this, std::placeholders::_1));
 
@@ -1255,6 +1432,24 @@ void urd::init_event_handlers() {
         SIGHUP, SIGTERM, SIGINT);
 }
 
+void urd::register_ipc_callback(api::request_type type, 
+        std::function<response_ptr(request_ptr)> handler) {
+
+    // keep track of how long it takes to handle each type of request. 
+    // References to the elements of an unordered_map remain valid when
+    // other elements are inserted
+    auto& latencies = m_ipc_latencies[type];
+
+    m_ipc_service->register_callback(type, 
+        [&latencies, handler](request_ptr req) {
+            utils::trace::set_thread_name("api");
+            const auto start = std::chrono::steady_clock::now();
+            auto resp = handler(std::move(req));
+            latencies.record(std::chrono::steady_clock::now() - start);
+            return resp;
+        });
+}
+
 void urd::init_namespace_manager() {
 
     LOGGER_INFO(" * Creating namespace manager...");
@@ -1283,7 +1478,13 @@ void urd::init_task_manager() {
 
     try {
         m_task_mgr = std::make_unique<io::task_manager>(m_settings->workers_in_pool(),
+                                                        m_settings->min_workers_in_pool(),
+                                                        m_settings->max_workers_in_pool(),
+                                                        m_settings->small_task_workers(),
+                                                        m_settings->small_task_threshold(),
                                                         m_settings->backlog_size(),
+                                                        m_settings->finished_task_ttl(),
+                                                        m_settings->max_finished_tasks(),
                                                         m_settings->dry_run(),
                                                         m_settings->dry_run_duration());
     }
@@ -1292,6 +1493,93 @@ void urd::init_task_manager() {
                      "not happen under normal conditions.");
         exit(EXIT_FAILURE);
     }
+
+    m_task_mgr->start_watchdog(
+            std::chrono::seconds(m_settings->watchdog_interval()),
+            std::chrono::seconds(m_settings->stall_timeout()),
+            m_settings->slow_task_threshold() / 100.0);
+
+    // restore the bandwidth model learnt by previous executions, if any
+    const auto model_path = m_settings->bandwidth_model();
+
+    if(model_path.empty()) {
+        return;
+    }
+
+    if(const auto ec = m_task_mgr->load_bandwidth_models(model_path.string())) {
+        if(ec == std::errc::no_such_file_or_directory) {
+            LOGGER_INFO(" * No bandwidth model found at {}", model_path);
+        }
+        else {
+            LOGGER_WARN(" * Failed to load bandwidth model from {}: {}", 
+                        model_path, ec.message());
+        }
+    }
+    else {
+        LOGGER_INFO(" * Bandwidth model loaded from {}", model_path);
+    }
+
+    // besides saving the model on shutdown, save it from time to time so
+    // that a crash doesn't lose everything learnt since startup
+    m_task_mgr->start_model_saver(model_path.string());
+}
+
+void urd::init_metrics() {
+
+    m_task_mgr->register_metrics(*m_metrics);
+
+    m_metrics->add_collector("norns_api_requests_total", 
+            "Number of API requests handled, by type", 
+            metrics::metric_type::counter, 
+            [this](std::vector<metrics::sample>& samples) {
+                for(const auto& kv : m_ipc_latencies) {
+                    samples.emplace_back(
+                        metrics::labels{{"type", utils::to_string(kv.first)}}, 
+                        kv.second.count());
+                }
+            });
+
+    // the staging directory is only scanned when metrics are collected
+    const bfs::path staging_dir = m_settings->staging_directory();
+
+    m_metrics->add_collector("norns_staging_directory_bytes", 
+            "Size of the files in the staging directory",
+            metrics::metric_type::gauge,
+            [staging_dir](std::vector<metrics::sample>& samples) {
+                boost::system::error_code ec;
+                uint64_t bytes = 0;
+
+                for(bfs::recursive_directory_iterator it(staging_dir, ec), end;
+                    !ec && it != end; it.increment(ec)) {
+
+                    if(bfs::is_regular_file(it->symlink_status())) {
+                        const auto size = bfs::file_size(it->path(), ec);
+                        bytes += ec ? 0 : size;
+                        ec.clear();
+                    }
+                }
+
+                samples.emplace_back(metrics::labels(), bytes);
+            });
+
+    if(m_settings->metrics_socket().empty() && 
+       m_settings->metrics_textfile().empty()) {
+        return;
+    }
+
+    LOGGER_INFO(" * Starting metrics exporter...");
+
+    m_metrics_exporter = std::make_unique<metrics::exporter>(
+            m_metrics, 
+            m_settings->metrics_socket(),
+            m_settings->metrics_textfile(),
+            std::chrono::seconds(m_settings->metrics_interval()));
+
+    if(const auto ec = m_metrics_exporter->start()) {
+        LOGGER_WARN("    Failed to start metrics exporter: {} "
+                    "(metrics will not be exported)", ec.message());
+        m_metrics_exporter.reset();
+    }
 }
 
 void urd::load_backend_plugins() {
@@ -1381,7 +1669,11 @@ void urd::load_transfer_plugins() {
     };
 
     context ctx(m_settings->staging_directory(),
-                m_network_service);
+                m_network_service,
+                m_metrics,
+                m_settings->copy_chunk_size(),
+                m_settings->copy_fanout(),
+                m_settings->io_uring_queue_depth());
 
     // memory region -> local path
     load_plugin(
@@ -1440,6 +1732,53 @@ void urd::load_default_namespaces() {
         LOGGER_INFO("    Loaded namespace \"{}://\" -> {} (type: {}, {})", 
                     nsdef.nsid(), nsdef.mountpoint(), nsdef.alias(), 
                     (nsdef.track() ? "tracked" : "untracked"));
+
+        if(nsdef.bandwidth_limit() != 0) {
+            m_task_mgr->add_bandwidth_limit(nsdef.nsid(), 
+                                            nsdef.bandwidth_limit());
+            LOGGER_INFO("      Bandwidth limited to {} bytes/sec", 
+                        nsdef.bandwidth_limit());
+        }
+
+        for(const auto& kv : nsdef.pair_bandwidth_limits()) {
+            if(kv.second == 0) {
+                continue;
+            }
+
+            m_task_mgr->add_bandwidth_limit(nsdef.nsid(), kv.first, kv.second);
+            LOGGER_INFO("      Bandwidth to \"{}://\" limited to {} bytes/sec", 
+                        kv.first, kv.second);
+        }
+
+        if(nsdef.direct_io()) {
+            m_task_mgr->add_direct_io(nsdef.nsid());
+            LOGGER_INFO("      Local copies bypass the page cache");
+        }
+
+        if(nsdef.numa_node() != config::namespace_def::no_numa_node) {
+
+            int32_t node = nsdef.numa_node();
+
+            if(node == config::namespace_def::auto_numa_node) {
+                node = utils::numa::node_of(nsdef.mountpoint());
+
+                if(node == utils::numa::no_node) {
+                    LOGGER_INFO("      Unable to determine the NUMA node of "
+                                "{}: transfers will not be pinned", 
+                                nsdef.mountpoint());
+                    continue;
+                }
+            }
+
+            if(!utils::numa::is_valid_node(node)) {
+                LOGGER_WARN("      NUMA node {} does not exist or has no "
+                            "CPUs: transfers will not be pinned", node);
+                continue;
+            }
+
+            m_task_mgr->add_numa_affinity(nsdef.nsid(), node);
+            LOGGER_INFO("      Transfers pinned to NUMA node {}", node);
+        }
     }
 }
 
@@ -1496,7 +1835,84 @@ void urd::print_configuration() {
     LOGGER_INFO("  - global socket: {}", m_settings->global_socket());
     LOGGER_INFO("  - staging directory: {}", m_settings->staging_directory());
     LOGGER_INFO("  - port for remote requests: {}", m_settings->remote_port());
-    LOGGER_INFO("  - workers: {}", m_settings->workers_in_pool());
+    LOGGER_INFO("  - workers: {} [min: {}, max: {}]", 
+            m_settings->workers_in_pool(), m_settings->min_workers_in_pool(), 
+            m_settings->max_workers_in_pool());
+    LOGGER_INFO("  - small task workers: {} [threshold: {} bytes]", 
+            m_settings->small_task_workers(), 
+            m_settings->small_task_threshold());
+
+    if(!m_settings->bandwidth_model().empty()) {
+        LOGGER_INFO("  - bandwidth model: {}", m_settings->bandwidth_model());
+    }
+    else {
+        LOGGER_INFO("  - bandwidth model: not persisted");
+    }
+
+    LOGGER_INFO("  - finished tasks retained: {} [ttl: {} seconds]", 
+            m_settings->max_finished_tasks() != 0 ? 
+                std::to_string(m_settings->max_finished_tasks()) : "unlimited",
+            m_settings->finished_task_ttl() != 0 ? 
+                std::to_string(m_settings->finished_task_ttl()) : "none");
+
+    if(!m_settings->metrics_socket().empty() || 
+       !m_settings->metrics_textfile().empty()) {
+        LOGGER_INFO("  - metrics: socket: {}, textfile: {} "
+                    "[interval: {} seconds]", 
+                m_settings->metrics_socket().empty() ? 
+                    "none" : m_settings->metrics_socket().string(),
+                m_settings->metrics_textfile().empty() ? 
+                    "none" : m_settings->metrics_textfile().string(),
+                m_settings->metrics_interval());
+    }
+    else {
+        LOGGER_INFO("  - metrics: not exported");
+    }
+
+    if(m_settings->trace_buffer_size() != 0) {
+        LOGGER_INFO("  - tracing: {} events per thread", 
+                m_settings->trace_buffer_size());
+    }
+    else {
+        LOGGER_INFO("  - tracing: disabled");
+    }
+
+    LOGGER_INFO("  - lock profiling: {}", 
+            (m_settings->lock_profiling() ? "enabled" : "disabled"));
+
+    if(m_settings->watchdog_interval() != 0) {
+        LOGGER_INFO("  - watchdog: every {} seconds (stall timeout: {} "
+                    "seconds, slow task threshold: {}%)", 
+                m_settings->watchdog_interval(), 
+                m_settings->stall_timeout(),
+                m_settings->slow_task_threshold());
+    }
+    else {
+        LOGGER_INFO("  - watchdog: disabled");
+    }
+
+    if(m_settings->copy_fanout() > 1) {
+        if(m_settings->copy_chunk_size() != 0) {
+            LOGGER_INFO("  - parallel local copies: {} chunks of {} bytes", 
+                    m_settings->copy_fanout(), m_settings->copy_chunk_size());
+        }
+        else {
+            LOGGER_INFO("  - parallel local copies: {} files", 
+                    m_settings->copy_fanout());
+        }
+    }
+    else {
+        LOGGER_INFO("  - parallel local copies: disabled");
+    }
+
+    if(m_settings->io_uring_queue_depth() != 0) {
+        LOGGER_INFO("  - io_uring queue depth: {}", 
+                m_settings->io_uring_queue_depth());
+    }
+    else {
+        LOGGER_INFO("  - io_uring queue depth: disabled");
+    }
+
     LOGGER_INFO("");
 }
 
@@ -1550,7 +1966,7 @@ urd_error urd::check_shutdown() {
             return (b->is_tracked() && !b->is_empty());
         };
 
-    boost::shared_lock<boost::shared_mutex> lock(m_namespace_mgr_mutex);
+    boost::shared_lock<utils::profiled_shared_mutex> lock(m_namespace_mgr_mutex);
     if(m_namespace_mgr->count_if(tracked_namespace_not_empty) != 0) {
         return urd_error::namespace_not_empty;
     }
@@ -1587,6 +2003,10 @@ int urd::run() {
 
     LOGGER_INFO("[[ Starting up ]]");
 
+    // start recording task lifecycle events (if enabled)
+    utils::trace::configure(m_settings->trace_buffer_size());
+    utils::enable_lock_profiling(m_settings->lock_profiling());
+
     init_task_manager();
     init_event_handlers();
     init_namespace_manager();
@@ -1597,6 +2017,8 @@ int urd::run() {
     // everything is set up
     load_transfer_plugins();
 
+    init_metrics();
+
     // start the listener for remote transfers
     // N.B. This call returns immediately
     m_network_service->run();
@@ -1619,6 +2041,13 @@ int urd::run() {
 
 void urd::teardown() {
 
+    // collectors refer to the task manager, so stop collecting first
+    if(m_metrics_exporter) {
+        LOGGER_INFO("* Stopping metrics exporter...");
+        m_metrics_exporter->stop();
+        m_metrics_exporter.reset();
+    }
+
 //XXX deprecated, signals_are now managed by api_listener
 //    if(m_signal_listener) {
 //        LOGGER_INFO("* Stopping signal listener...");
@@ -1634,6 +2063,10 @@ void urd::teardown() {
 
     api_listener::cleanup();
 
+    // the settings are released below, so keep the path for later
+    const bfs::path model_path = 
+        m_settings ? m_settings->bandwidth_model() : bfs::path();
+
     if(m_settings) {
         boost::system::error_code ec;
 
@@ -1650,6 +2083,15 @@ void urd::teardown() {
     if(m_task_mgr) {
         LOGGER_INFO("* Stopping task manager...");
         m_task_mgr->stop_all_tasks();
+
+        if(!model_path.empty()) {
+            if(const auto ec = 
+                    m_task_mgr->save_bandwidth_models(model_path.string())) {
+                LOGGER_ERROR("Failed to save bandwidth model to {}: {}", 
+                             model_path, ec.message());
+            }
+        }
+
         m_task_mgr.reset();
     }
 }
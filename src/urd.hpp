@@ -38,6 +38,7 @@
 #ifndef __URD_HPP__
 #define __URD_HPP__
 
+#include <functional>
 #include <unordered_map>
 #include <boost/thread/shared_mutex.hpp>
 
@@ -46,6 +47,8 @@
 #include "backends.hpp"
 #include "logger.hpp"
 #include "api.hpp"
+#include "utils/latency-histogram.hpp"
+#include "utils/profiled-mutex.hpp"
 
 #include "job.hpp"
 
@@ -81,6 +84,11 @@ namespace ns {
     struct namespace_manager;
 }
 
+namespace metrics {
+    struct registry;
+    struct exporter;
+}
+
 namespace rpc {
     struct push_resource;
     struct pull_resource;
@@ -107,11 +115,14 @@ private:
 
     void init_logger();
     void init_event_handlers();
+    void register_ipc_callback(api::request_type type, 
+            std::function<response_ptr(request_ptr)> handler);
     void init_namespace_manager();
     void init_task_manager();
     void load_backend_plugins();
     void load_transfer_plugins();
     void load_default_namespaces();
+    void init_metrics();
     void check_configuration();
     void print_greeting();
     void print_configuration();
@@ -123,6 +134,7 @@ private:
 
     response_ptr iotask_create_handler(const request_ptr req);
     response_ptr iotask_status_handler(const request_ptr req) const;
+    response_ptr iotask_cancel_handler(const request_ptr req);
     response_ptr ping_handler(const request_ptr req);
     response_ptr job_register_handler(const request_ptr req);
     response_ptr job_update_handler(const request_ptr req);
@@ -133,6 +145,10 @@ private:
     response_ptr namespace_update_handler(const request_ptr req);
     response_ptr namespace_remove_handler(const request_ptr req);
     response_ptr global_status_handler(const request_ptr req);
+    response_ptr transfer_estimate_handler(const request_ptr req);
+    response_ptr latency_stats_handler(const request_ptr req);
+    response_ptr lock_stats_handler(const request_ptr req);
+    response_ptr slow_tasks_handler(const request_ptr req);
     response_ptr command_handler(const request_ptr req);
     response_ptr unknown_request_handler(const request_ptr req);
 
@@ -159,17 +175,28 @@ private:
 
     std::unique_ptr<api_listener> m_ipc_service;
 
+    // time taken to handle each type of API request (entries are only 
+    // added while registering the callbacks)
+    std::unordered_map<api::request_type, utils::latency_histogram, 
+                       api::request_type_hash> m_ipc_latencies;
+
     std::shared_ptr<hermes::async_engine> m_network_service;
 
     std::unique_ptr<ns::namespace_manager> m_namespace_mgr;
-    mutable boost::shared_mutex m_namespace_mgr_mutex;
+    mutable utils::profiled_shared_mutex
+        m_namespace_mgr_mutex{"urd.namespace_manager"};
 
 
     std::unordered_map<uint32_t, std::shared_ptr<job>>    m_jobs;
-    boost::shared_mutex                         m_jobs_mutex;
+    utils::profiled_shared_mutex m_jobs_mutex{"urd.jobs"};
 
     std::shared_ptr<io::task_manager> m_task_mgr;
     mutable boost::shared_mutex  m_task_mgr_mutex;
+
+    // metrics are always maintained so that plugins can register theirs,
+    // but they are only exported if configured
+    std::shared_ptr<metrics::registry> m_metrics;
+    std::unique_ptr<metrics::exporter> m_metrics_exporter;
 };
 
 } // namespace norns 
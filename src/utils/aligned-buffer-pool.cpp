@@ -0,0 +1,121 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <cstdlib>
+#include <new>
+#include "aligned-buffer-pool.hpp"
+
+namespace norns {
+namespace utils {
+
+void
+aligned_buffer_pool::deleter::operator()(char* ptr) const {
+    m_pool->release(ptr);
+}
+
+aligned_buffer_pool::aligned_buffer_pool(std::size_t buffer_size, 
+                                         std::size_t alignment,
+                                         std::size_t max_cached_buffers) :
+    m_buffer_size(buffer_size),
+    m_alignment(alignment),
+    m_max_cached_buffers(max_cached_buffers) { }
+
+aligned_buffer_pool::~aligned_buffer_pool() {
+    for(auto ptr : m_free) {
+        ::free(ptr);
+    }
+}
+
+aligned_buffer_pool::buffer_ptr
+aligned_buffer_pool::acquire() {
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if(!m_free.empty()) {
+            char* ptr = m_free.back();
+            m_free.pop_back();
+            return buffer_ptr(ptr, deleter{this});
+        }
+    }
+
+    void* ptr = nullptr;
+
+    if(::posix_memalign(&ptr, m_alignment, m_buffer_size) != 0) {
+        throw std::bad_alloc();
+    }
+
+    return buffer_ptr(static_cast<char*>(ptr), deleter{this});
+}
+
+void
+aligned_buffer_pool::release(char* ptr) {
+
+    if(ptr == nullptr) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        if(m_free.size() < m_max_cached_buffers) {
+            m_free.push_back(ptr);
+            return;
+        }
+    }
+
+    ::free(ptr);
+}
+
+std::size_t
+aligned_buffer_pool::buffer_size() const {
+    return m_buffer_size;
+}
+
+std::size_t
+aligned_buffer_pool::alignment() const {
+    return m_alignment;
+}
+
+std::size_t
+aligned_buffer_pool::cached_buffers() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_free.size();
+}
+
+} // namespace utils
+} // namespace norns
@@ -0,0 +1,100 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#ifndef __UTILS_ALIGNED_BUFFER_POOL_HPP__
+#define __UTILS_ALIGNED_BUFFER_POOL_HPP__
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace norns {
+namespace utils {
+
+/*! A thread-safe pool of equally-sized buffers whose address is aligned 
+ * to 'alignment' bytes, as required by O_DIRECT I/O. Buffers are released 
+ * back to the pool when their owning buffer_ptr is destroyed, and the pool 
+ * keeps up to 'max_cached_buffers' of them to hand out again, so that 
+ * copies don't allocate (and fault in) fresh memory for every file. The 
+ * pool must outlive all the buffers obtained from it */
+class aligned_buffer_pool {
+
+public:
+    struct deleter {
+        void operator()(char* ptr) const;
+        aligned_buffer_pool* m_pool;
+    };
+
+    using buffer_ptr = std::unique_ptr<char, deleter>;
+
+    aligned_buffer_pool(std::size_t buffer_size, std::size_t alignment, 
+                        std::size_t max_cached_buffers);
+    ~aligned_buffer_pool();
+
+    aligned_buffer_pool(const aligned_buffer_pool& other) = delete;
+    aligned_buffer_pool& operator=(const aligned_buffer_pool& other) = delete;
+
+    /*! Return a buffer of buffer_size() bytes. Throws std::bad_alloc if 
+     * no cached buffer is available and a new one can't be allocated */
+    buffer_ptr
+    acquire();
+
+    std::size_t
+    buffer_size() const;
+
+    std::size_t
+    alignment() const;
+
+    /*! Number of buffers currently cached */
+    std::size_t
+    cached_buffers() const;
+
+private:
+    void
+    release(char* ptr);
+
+    const std::size_t m_buffer_size;
+    const std::size_t m_alignment;
+    const std::size_t m_max_cached_buffers;
+    mutable std::mutex m_mutex;
+    std::vector<char*> m_free;
+};
+
+} // namespace utils
+} // namespace norns
+
+#endif /* __UTILS_ALIGNED_BUFFER_POOL_HPP__ */
@@ -0,0 +1,136 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <algorithm>
+#include <new>
+#include "block-cache.hpp"
+
+namespace norns {
+namespace utils {
+
+block_cache::block_cache(std::size_t max_cached_blocks) :
+    m_max_cached_blocks(max_cached_blocks) { }
+
+block_cache::~block_cache() {
+    for(auto& sc : m_classes) {
+        while(sc.m_head != nullptr) {
+            free_block* blk = sc.m_head;
+            sc.m_head = blk->m_next;
+            ::operator delete(blk);
+        }
+    }
+}
+
+block_cache::size_class*
+block_cache::find_class(std::size_t size) {
+
+    for(auto& sc : m_classes) {
+        if(sc.m_size == size) {
+            return &sc;
+        }
+
+        // classes are assigned in order, so the first unused slot 
+        // means that this size has not been seen before
+        if(sc.m_size == 0) {
+            sc.m_size = size;
+            return &sc;
+        }
+    }
+
+    return nullptr;
+}
+
+void*
+block_cache::allocate(std::size_t size) {
+
+    size = std::max(size, sizeof(free_block));
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_class* sc = find_class(size);
+
+        if(sc != nullptr && sc->m_head != nullptr) {
+            free_block* blk = sc->m_head;
+            sc->m_head = blk->m_next;
+            --sc->m_count;
+            return blk;
+        }
+    }
+
+    return ::operator new(size);
+}
+
+void
+block_cache::deallocate(void* ptr, std::size_t size) {
+
+    if(ptr == nullptr) {
+        return;
+    }
+
+    size = std::max(size, sizeof(free_block));
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        size_class* sc = find_class(size);
+
+        if(sc != nullptr && sc->m_count < m_max_cached_blocks) {
+            free_block* blk = static_cast<free_block*>(ptr);
+            blk->m_next = sc->m_head;
+            sc->m_head = blk;
+            ++sc->m_count;
+            return;
+        }
+    }
+
+    ::operator delete(ptr);
+}
+
+std::size_t
+block_cache::cached_blocks() const {
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::size_t n = 0;
+
+    for(const auto& sc : m_classes) {
+        n += sc.m_count;
+    }
+
+    return n;
+}
+
+} // namespace utils
+} // namespace norns
@@ -0,0 +1,146 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#ifndef __UTILS_BLOCK_CACHE_HPP__
+#define __UTILS_BLOCK_CACHE_HPP__
+
+#include <array>
+#include <memory>
+#include <mutex>
+
+namespace norns {
+namespace utils {
+
+/*! A thread-safe cache of fixed-size memory blocks. Blocks returned to the
+ * cache are kept in a per-size free list (up to a maximum number of blocks 
+ * per size) and are handed out again by later requests of the same size, 
+ * so that objects created and destroyed at a steady rate (e.g. the 
+ * metadata of I/O tasks) do not hit the heap once the cache is warm */
+class block_cache {
+
+public:
+    explicit block_cache(std::size_t max_cached_blocks = 4096);
+    ~block_cache();
+
+    block_cache(const block_cache& other) = delete;
+    block_cache& operator=(const block_cache& other) = delete;
+
+    void*
+    allocate(std::size_t size);
+
+    void
+    deallocate(void* ptr, std::size_t size);
+
+    /*! Number of blocks currently cached (for all sizes) */
+    std::size_t
+    cached_blocks() const;
+
+private:
+    struct free_block {
+        free_block* m_next;
+    };
+
+    struct size_class {
+        std::size_t m_size = 0;
+        std::size_t m_count = 0;
+        free_block* m_head = nullptr;
+    };
+
+    // objects allocated through the cache only come in a handful of 
+    // different sizes, so a small array is enough. Requests for sizes 
+    // that do not fit go straight to the heap
+    constexpr static std::size_t max_size_classes = 4;
+
+    size_class*
+    find_class(std::size_t size);
+
+    const std::size_t m_max_cached_blocks;
+    mutable std::mutex m_mutex;
+    std::array<size_class, max_size_classes> m_classes;
+};
+
+/*! Allocator that obtains single objects from a shared block_cache. 
+ * Suitable for std::allocate_shared() and node-based containers: requests
+ * for arrays (e.g. hash table buckets) are forwarded to the heap */
+template <typename T>
+struct cached_allocator {
+
+    using value_type = T;
+
+    explicit cached_allocator(const std::shared_ptr<block_cache>& cache) noexcept :
+        m_cache(cache) { }
+
+    template <typename U>
+    cached_allocator(const cached_allocator<U>& other) noexcept :
+        m_cache(other.m_cache) { }
+
+    T*
+    allocate(std::size_t n) {
+        if(n == 1) {
+            return static_cast<T*>(m_cache->allocate(sizeof(T)));
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void
+    deallocate(T* ptr, std::size_t n) noexcept {
+        if(n == 1) {
+            m_cache->deallocate(ptr, sizeof(T));
+            return;
+        }
+        ::operator delete(ptr);
+    }
+
+    std::shared_ptr<block_cache> m_cache;
+};
+
+template <typename T, typename U>
+inline bool
+operator==(const cached_allocator<T>& lhs, const cached_allocator<U>& rhs) {
+    return lhs.m_cache == rhs.m_cache;
+}
+
+template <typename T, typename U>
+inline bool
+operator!=(const cached_allocator<T>& lhs, const cached_allocator<U>& rhs) {
+    return !(lhs == rhs);
+}
+
+} // namespace utils
+} // namespace norns
+
+#endif /* __UTILS_BLOCK_CACHE_HPP__ */
@@ -0,0 +1,170 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include "latency-histogram.hpp"
+
+namespace norns {
+namespace utils {
+
+latency_histogram::latency_histogram() :
+    m_count(0),
+    m_sum(0),
+    m_max(0) {
+
+    for(auto& b : m_buckets) {
+        b.store(0, std::memory_order_relaxed);
+    }
+}
+
+void
+latency_histogram::record(uint64_t usecs) {
+
+    m_buckets[bucket_for(usecs)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(usecs, std::memory_order_relaxed);
+
+    uint64_t current = m_max.load(std::memory_order_relaxed);
+
+    while(usecs > current && 
+          !m_max.compare_exchange_weak(current, usecs, 
+                                       std::memory_order_relaxed)) { }
+}
+
+uint64_t
+latency_histogram::count() const {
+    return m_count.load(std::memory_order_relaxed);
+}
+
+double
+latency_histogram::mean() const {
+
+    const uint64_t n = count();
+
+    if(n == 0) {
+        return 0.0;
+    }
+
+    return static_cast<double>(m_sum.load(std::memory_order_relaxed)) / n;
+}
+
+uint64_t
+latency_histogram::max() const {
+    return m_max.load(std::memory_order_relaxed);
+}
+
+uint64_t
+latency_histogram::percentile(double q) const {
+
+    // values may be recorded while we walk the buckets, so work on a 
+    // snapshot to get a consistent total
+    std::array<uint64_t, num_buckets> snapshot;
+    uint64_t total = 0;
+
+    for(std::size_t i = 0; i < num_buckets; ++i) {
+        snapshot[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += snapshot[i];
+    }
+
+    if(total == 0) {
+        return 0;
+    }
+
+    q = std::min(std::max(q, 0.0), 1.0);
+
+    const uint64_t rank = 
+        std::max<uint64_t>(static_cast<uint64_t>(std::ceil(q * total)), 1);
+
+    // the largest value is known exactly
+    if(rank >= total) {
+        return max();
+    }
+
+    uint64_t seen = 0;
+
+    for(std::size_t i = 0; i < num_buckets - 1; ++i) {
+        seen += snapshot[i];
+
+        if(seen >= rank) {
+            // a bucket's midpoint may exceed the largest value in it
+            return std::min(value_at(i), max());
+        }
+    }
+
+    // values in the last bucket are out of range
+    return max();
+}
+
+std::size_t
+latency_histogram::bucket_for(uint64_t value) {
+
+    if(value < sub_buckets) {
+        return value;
+    }
+
+    // position of the most significant bit
+    const unsigned msb = 63 - __builtin_clzll(value);
+
+    if(msb >= max_bits) {
+        return num_buckets - 1;
+    }
+
+    const unsigned shift = msb - sub_bucket_bits;
+
+    return (msb - sub_bucket_bits + 1) * sub_buckets + 
+           ((value >> shift) & (sub_buckets - 1));
+}
+
+uint64_t
+latency_histogram::value_at(std::size_t bucket) {
+
+    if(bucket < sub_buckets) {
+        return bucket;
+    }
+
+    const unsigned shift = bucket / sub_buckets - 1;
+    const uint64_t lower = 
+        (sub_buckets + bucket % sub_buckets) << shift;
+    const uint64_t width = uint64_t{1} << shift;
+
+    return lower + width / 2;
+}
+
+} // namespace utils
+} // namespace norns
@@ -0,0 +1,115 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#ifndef __UTILS_LATENCY_HISTOGRAM_HPP__
+#define __UTILS_LATENCY_HISTOGRAM_HPP__
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace norns {
+namespace utils {
+
+/*! A lock-free histogram of durations, kept in microseconds. Buckets are 
+ * laid out as in HDR histograms: each power of two is split into 16 
+ * linear sub-buckets, so that any value (up to ~12 days) is reported with 
+ * a relative error below 1/16 while the histogram has a fixed size. 
+ * Recording a value takes a few relaxed atomic operations, so histograms 
+ * can be updated from any number of threads and read at any time */
+class latency_histogram {
+
+public:
+    latency_histogram();
+
+    latency_histogram(const latency_histogram& other) = delete;
+    latency_histogram& operator=(const latency_histogram& other) = delete;
+
+    void
+    record(uint64_t usecs);
+
+    template <typename Rep, typename Period>
+    void
+    record(const std::chrono::duration<Rep, Period>& d) {
+        const auto usecs = 
+            std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+        record(usecs > 0 ? static_cast<uint64_t>(usecs) : 0);
+    }
+
+    /*! Number of values recorded */
+    uint64_t
+    count() const;
+
+    /*! Mean of the values recorded (0 if none) */
+    double
+    mean() const;
+
+    /*! Largest value recorded (0 if none) */
+    uint64_t
+    max() const;
+
+    /*! Value below which a fraction q (0 <= q <= 1) of the recorded values
+     * fall, within the resolution of the histogram (0 if none) */
+    uint64_t
+    percentile(double q) const;
+
+private:
+    constexpr static const unsigned sub_bucket_bits = 4;
+    constexpr static const uint64_t sub_buckets = 1u << sub_bucket_bits;
+    // values with more than max_bits bits end up in the last bucket
+    constexpr static const unsigned max_bits = 40;
+    constexpr static const std::size_t num_buckets = 
+        (max_bits - sub_bucket_bits + 1) * sub_buckets;
+
+    static std::size_t
+    bucket_for(uint64_t value);
+
+    // representative value (midpoint) of a bucket
+    static uint64_t
+    value_at(std::size_t bucket);
+
+    std::array<std::atomic<uint64_t>, num_buckets> m_buckets;
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_sum;
+    std::atomic<uint64_t> m_max;
+};
+
+} // namespace utils
+} // namespace norns
+
+#endif /* __UTILS_LATENCY_HISTOGRAM_HPP__ */
@@ -0,0 +1,278 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include "config.h"
+
+#include <sched.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#include <linux/mempolicy.h>
+#include <boost/filesystem/fstream.hpp>
+#include <climits>
+#include <string>
+
+#include "numa.hpp"
+
+namespace {
+
+const bfs::path sysfs_nodes{"/sys/devices/system/node"};
+const bfs::path sysfs_devices{"/sys/devices"};
+
+// the NUMA node the calling thread is currently bound to
+thread_local int32_t current_node = norns::utils::numa::no_node;
+
+bool
+read_integer(const bfs::path& filename, long& value) noexcept {
+
+    try {
+        bfs::ifstream ifs(filename);
+
+        if(!ifs || !(ifs >> value)) {
+            return false;
+        }
+
+        return true;
+    }
+    catch(...) {
+        return false;
+    }
+}
+
+// parse a sysfs cpulist (e.g. "0-7,16-23") into 'cpus'
+bool
+cpus_of(int32_t node, cpu_set_t& cpus) noexcept {
+
+    CPU_ZERO(&cpus);
+
+    try {
+        bfs::ifstream ifs(sysfs_nodes / 
+                          ("node" + std::to_string(node)) / "cpulist");
+        std::string cpulist;
+
+        if(!ifs || !std::getline(ifs, cpulist)) {
+            return false;
+        }
+
+        std::size_t count = 0;
+        std::size_t pos = 0;
+
+        while(pos < cpulist.size()) {
+            std::size_t end = cpulist.find(',', pos);
+
+            if(end == std::string::npos) {
+                end = cpulist.size();
+            }
+
+            const std::string range = cpulist.substr(pos, end - pos);
+            const std::size_t dash = range.find('-');
+
+            const unsigned long first = std::stoul(range.substr(0, dash));
+            const unsigned long last = (dash == std::string::npos) ? 
+                first : std::stoul(range.substr(dash + 1));
+
+            for(unsigned long cpu = first; 
+                cpu <= last && cpu < CPU_SETSIZE; ++cpu) {
+                CPU_SET(cpu, &cpus);
+                ++count;
+            }
+
+            pos = end + 1;
+        }
+
+        return count != 0;
+    }
+    catch(...) {
+        return false;
+    }
+}
+
+// the affinity mask that threads had before being bound to any node, 
+// captured the first time a thread is bound
+const cpu_set_t&
+original_affinity() noexcept {
+
+    static const cpu_set_t mask = [] {
+        cpu_set_t m;
+
+        if(::sched_getaffinity(0, sizeof(m), &m) != 0) {
+            CPU_ZERO(&m);
+
+            for(long cpu = 0; cpu < ::sysconf(_SC_NPROCESSORS_CONF) && 
+                              cpu < CPU_SETSIZE; ++cpu) {
+                CPU_SET(cpu, &m);
+            }
+        }
+        return m;
+    }();
+
+    return mask;
+}
+
+long
+set_mempolicy(int mode, const unsigned long* nodemask, 
+              unsigned long maxnode) noexcept {
+    return ::syscall(SYS_set_mempolicy, mode, nodemask, maxnode);
+}
+
+} // anonymous namespace
+
+namespace norns {
+namespace utils {
+namespace numa {
+
+int32_t
+node_of(const bfs::path& path) noexcept {
+
+    struct stat st;
+
+    if(::stat(path.c_str(), &st) != 0) {
+        return no_node;
+    }
+
+    // anonymous devices (tmpfs, NFS, ...) are not attached to any node
+    if(major(st.st_dev) == 0) {
+        return no_node;
+    }
+
+    const bfs::path devlink = bfs::path{"/sys/dev/block"} / 
+        (std::to_string(major(st.st_dev)) + ":" + 
+         std::to_string(minor(st.st_dev)));
+
+    boost::system::error_code ec;
+    bfs::path devpath = bfs::canonical(devlink, ec);
+
+    if(ec) {
+        return no_node;
+    }
+
+    // walk up the device hierarchy (partition -> disk -> controller -> 
+    // PCI device) until some level reports its node
+    for(; !devpath.empty() && devpath != sysfs_devices; 
+          devpath = devpath.parent_path()) {
+
+        long node;
+
+        if(read_integer(devpath / "numa_node", node)) {
+            return node < 0 ? no_node : static_cast<int32_t>(node);
+        }
+    }
+
+    return no_node;
+}
+
+bool
+is_valid_node(int32_t node) noexcept {
+
+    if(node < 0) {
+        return false;
+    }
+
+    cpu_set_t cpus;
+    return cpus_of(node, cpus);
+}
+
+std::error_code
+bind_current_thread(int32_t node) noexcept {
+
+    if(node == current_node) {
+        return {};
+    }
+
+    if(node == no_node) {
+        const cpu_set_t& mask = original_affinity();
+
+        // pthread_setaffinity_np() returns the error instead of setting 
+        // errno
+        const int rv = ::pthread_setaffinity_np(::pthread_self(), 
+                                                sizeof(mask), &mask);
+
+        if(rv != 0) {
+            return std::error_code(rv, std::system_category());
+        }
+
+        // failing to reset the memory policy is harmless: the kernel
+        // falls back to other nodes when the preferred one is exhausted
+        set_mempolicy(MPOL_DEFAULT, nullptr, 0);
+        current_node = no_node;
+        return {};
+    }
+
+    constexpr std::size_t bits_per_word = sizeof(unsigned long) * CHAR_BIT;
+
+    if(node >= static_cast<int32_t>(CPU_SETSIZE)) {
+        return std::error_code(EINVAL, std::generic_category());
+    }
+
+    cpu_set_t cpus;
+
+    if(!cpus_of(node, cpus)) {
+        return std::error_code(EINVAL, std::generic_category());
+    }
+
+    // make sure the original mask is captured before changing it
+    (void) original_affinity();
+
+    const int rv = ::pthread_setaffinity_np(::pthread_self(), 
+                                            sizeof(cpus), &cpus);
+
+    if(rv != 0) {
+        return std::error_code(rv, std::system_category());
+    }
+
+    unsigned long nodemask[CPU_SETSIZE / bits_per_word] = {};
+    nodemask[node / bits_per_word] |= 1UL << (node % bits_per_word);
+
+    if(set_mempolicy(MPOL_PREFERRED, nodemask, CPU_SETSIZE) != 0) {
+        const int saved_errno = errno;
+        // keep the thread consistent: either fully bound or not at all
+        ::pthread_setaffinity_np(::pthread_self(), 
+                                 sizeof(original_affinity()), 
+                                 &original_affinity());
+        set_mempolicy(MPOL_DEFAULT, nullptr, 0);
+        current_node = no_node;
+        return std::error_code(saved_errno, std::generic_category());
+    }
+
+    current_node = node;
+    return {};
+}
+
+} // namespace numa
+} // namespace utils
+} // namespace norns
@@ -0,0 +1,76 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#ifndef NORNS_UTILS_NUMA_HPP
+#define NORNS_UTILS_NUMA_HPP
+
+#include <cstdint>
+#include <system_error>
+#include <boost/filesystem.hpp>
+
+namespace bfs = boost::filesystem;
+
+namespace norns {
+namespace utils {
+namespace numa {
+
+// value used to denote "no particular NUMA node"
+constexpr int32_t no_node = -1;
+
+// return the NUMA node closest to the block device backing 'path', or 
+// no_node if it cannot be determined (e.g. virtual and network filesystems, 
+// or single-node systems whose devices do not report a node)
+int32_t
+node_of(const bfs::path& path) noexcept;
+
+// check whether 'node' is an online NUMA node with CPUs attached
+bool
+is_valid_node(int32_t node) noexcept;
+
+// pin the calling thread to the CPUs of 'node' and make it prefer memory 
+// from 'node' for its allocations (so that staging buffers and page cache 
+// pages end up close to the CPUs using them). If 'node' is no_node, the 
+// thread's original placement is restored. Calls with the node the thread 
+// is already bound to return immediately without issuing any syscalls.
+std::error_code
+bind_current_thread(int32_t node) noexcept;
+
+} // namespace numa
+} // namespace utils
+} // namespace norns
+
+#endif /* NORNS_UTILS_NUMA_HPP */
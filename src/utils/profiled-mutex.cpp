@@ -0,0 +1,182 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <algorithm>
+#include <list>
+
+#include "profiled-mutex.hpp"
+
+namespace {
+
+using norns::utils::lock_stats;
+
+uint64_t
+to_nsecs(lock_stats::clock::duration d) {
+    const auto nsecs = 
+        std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+    return nsecs > 0 ? static_cast<uint64_t>(nsecs) : 0;
+}
+
+void
+update_max(std::atomic<uint64_t>& max, uint64_t value) {
+    uint64_t current = max.load(std::memory_order_relaxed);
+    while(value > current && 
+          !max.compare_exchange_weak(current, value, 
+                                     std::memory_order_relaxed)) { }
+}
+
+// records are never destroyed, so that locks owned by static objects can 
+// still use them during process exit
+struct stats_list {
+    std::mutex m_mutex;
+    std::list<lock_stats> m_records;
+};
+
+stats_list&
+all_stats() {
+    static stats_list* const list = new stats_list();
+    return *list;
+}
+
+} // anonymous namespace
+
+namespace norns {
+namespace utils {
+
+namespace detail {
+std::atomic<bool> g_lock_profiling(false);
+} // namespace detail
+
+void
+enable_lock_profiling(bool enable) {
+    detail::g_lock_profiling.store(enable, std::memory_order_relaxed);
+}
+
+lock_stats&
+lock_stats::named(const std::string& name) {
+
+    auto& sl = ::all_stats();
+    std::lock_guard<std::mutex> lock(sl.m_mutex);
+
+    const auto it = std::find_if(sl.m_records.begin(), sl.m_records.end(),
+            [&](const lock_stats& ls) {
+                return ls.m_name == name;
+            });
+
+    if(it != sl.m_records.end()) {
+        return *it;
+    }
+
+    sl.m_records.emplace_back(name);
+    return sl.m_records.back();
+}
+
+std::vector<lock_stats_snapshot>
+lock_stats::collect() {
+
+    std::vector<lock_stats_snapshot> snapshots;
+
+    {
+        auto& sl = ::all_stats();
+        std::lock_guard<std::mutex> lock(sl.m_mutex);
+
+        for(const auto& ls : sl.m_records) {
+            snapshots.push_back(ls.snapshot());
+        }
+    }
+
+    std::sort(snapshots.begin(), snapshots.end(), 
+            [](const lock_stats_snapshot& lhs, const lock_stats_snapshot& rhs) {
+                return lhs.m_name < rhs.m_name;
+            });
+
+    return snapshots;
+}
+
+lock_stats::lock_stats(const std::string& name) :
+    m_name(name),
+    m_acquisitions(0),
+    m_shared_acquisitions(0),
+    m_contended(0),
+    m_wait_ns(0),
+    m_max_wait_ns(0),
+    m_hold_ns(0),
+    m_max_hold_ns(0) {}
+
+void
+lock_stats::record_acquisition(clock::duration wait, bool contended, 
+                               bool shared) {
+
+    (shared ? m_shared_acquisitions : m_acquisitions)
+        .fetch_add(1, std::memory_order_relaxed);
+
+    if(!contended) {
+        return;
+    }
+
+    const uint64_t nsecs = ::to_nsecs(wait);
+
+    m_contended.fetch_add(1, std::memory_order_relaxed);
+    m_wait_ns.fetch_add(nsecs, std::memory_order_relaxed);
+    ::update_max(m_max_wait_ns, nsecs);
+}
+
+void
+lock_stats::record_hold(clock::duration hold) {
+
+    const uint64_t nsecs = ::to_nsecs(hold);
+
+    m_hold_ns.fetch_add(nsecs, std::memory_order_relaxed);
+    ::update_max(m_max_hold_ns, nsecs);
+}
+
+lock_stats_snapshot
+lock_stats::snapshot() const {
+    return lock_stats_snapshot{
+        m_name,
+        m_acquisitions.load(std::memory_order_relaxed),
+        m_shared_acquisitions.load(std::memory_order_relaxed),
+        m_contended.load(std::memory_order_relaxed),
+        m_wait_ns.load(std::memory_order_relaxed),
+        m_max_wait_ns.load(std::memory_order_relaxed),
+        m_hold_ns.load(std::memory_order_relaxed),
+        m_max_hold_ns.load(std::memory_order_relaxed)
+    };
+}
+
+} // namespace utils
+} // namespace norns
@@ -0,0 +1,233 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#ifndef __UTILS_PROFILED_MUTEX_HPP__
+#define __UTILS_PROFILED_MUTEX_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <boost/thread/shared_mutex.hpp>
+
+namespace norns {
+namespace utils {
+
+/*! Contention profiling for the daemon's locks. Each class of locks (e.g. 
+ * all task_info locks) shares a named lock_stats record that accumulates 
+ * how many times its locks were acquired, how long threads waited for 
+ * them and how long they were held in exclusive mode. Records are created 
+ * once and live until the process exits.
+ *
+ * Profiling is disabled by default: profiled mutexes then cost a single 
+ * relaxed load on top of the wrapped mutex */
+
+namespace detail {
+extern std::atomic<bool> g_lock_profiling;
+} // namespace detail
+
+void
+enable_lock_profiling(bool enable);
+
+inline bool
+lock_profiling_enabled() {
+    return detail::g_lock_profiling.load(std::memory_order_relaxed);
+}
+
+/*! A copy of a lock_stats record at a point in time */
+struct lock_stats_snapshot {
+    std::string m_name;
+    uint64_t m_acquisitions;
+    uint64_t m_shared_acquisitions;
+    uint64_t m_contended;
+    uint64_t m_wait_ns;
+    uint64_t m_max_wait_ns;
+    uint64_t m_hold_ns;
+    uint64_t m_max_hold_ns;
+};
+
+struct lock_stats {
+
+    using clock = std::chrono::steady_clock;
+
+    /*! Return the record for 'name', creating it if needed. This takes a 
+     * global lock, so classes with many locks should look up their record 
+     * once and pass it to each of them */
+    static lock_stats&
+    named(const std::string& name);
+
+    /*! Snapshots of all records, sorted by name */
+    static std::vector<lock_stats_snapshot>
+    collect();
+
+    explicit lock_stats(const std::string& name);
+
+    lock_stats(const lock_stats& other) = delete;
+    lock_stats& operator=(const lock_stats& other) = delete;
+
+    void
+    record_acquisition(clock::duration wait, bool contended, bool shared);
+
+    void
+    record_hold(clock::duration hold);
+
+    lock_stats_snapshot
+    snapshot() const;
+
+    const std::string m_name;
+    std::atomic<uint64_t> m_acquisitions;
+    std::atomic<uint64_t> m_shared_acquisitions;
+    std::atomic<uint64_t> m_contended;
+    std::atomic<uint64_t> m_wait_ns;
+    std::atomic<uint64_t> m_max_wait_ns;
+    std::atomic<uint64_t> m_hold_ns;
+    std::atomic<uint64_t> m_max_hold_ns;
+};
+
+/*! A Lockable (and SharedLockable, if Mutex is) wrapper that accounts 
+ * for its acquisitions in a lock_stats record. Hold times are only 
+ * measured for exclusive acquisitions, since shared owners may release 
+ * the lock in any order */
+template <typename Mutex>
+class basic_profiled_mutex {
+
+    using clock = lock_stats::clock;
+
+public:
+    explicit basic_profiled_mutex(lock_stats& stats) :
+        m_stats(stats) {}
+
+    explicit basic_profiled_mutex(const std::string& name) :
+        m_stats(lock_stats::named(name)) {}
+
+    basic_profiled_mutex(const basic_profiled_mutex& other) = delete;
+    basic_profiled_mutex& operator=(const basic_profiled_mutex& other) = delete;
+
+    void
+    lock() {
+        if(!lock_profiling_enabled()) {
+            m_mutex.lock();
+            return;
+        }
+
+        const auto start = clock::now();
+        const bool contended = !m_mutex.try_lock();
+
+        if(contended) {
+            m_mutex.lock();
+        }
+
+        m_since = clock::now();
+        m_stats.record_acquisition(m_since - start, contended, false);
+    }
+
+    bool
+    try_lock() {
+        if(!m_mutex.try_lock()) {
+            return false;
+        }
+
+        if(lock_profiling_enabled()) {
+            m_since = clock::now();
+            m_stats.record_acquisition(clock::duration::zero(), false, false);
+        }
+
+        return true;
+    }
+
+    void
+    unlock() {
+        // m_since is only set if profiling was enabled when the lock was 
+        // acquired, and it is only accessed while holding it exclusively
+        if(m_since != clock::time_point()) {
+            m_stats.record_hold(clock::now() - m_since);
+            m_since = clock::time_point();
+        }
+
+        m_mutex.unlock();
+    }
+
+    void
+    lock_shared() {
+        if(!lock_profiling_enabled()) {
+            m_mutex.lock_shared();
+            return;
+        }
+
+        const auto start = clock::now();
+        const bool contended = !m_mutex.try_lock_shared();
+
+        if(contended) {
+            m_mutex.lock_shared();
+        }
+
+        m_stats.record_acquisition(clock::now() - start, contended, true);
+    }
+
+    bool
+    try_lock_shared() {
+        if(!m_mutex.try_lock_shared()) {
+            return false;
+        }
+
+        if(lock_profiling_enabled()) {
+            m_stats.record_acquisition(clock::duration::zero(), false, true);
+        }
+
+        return true;
+    }
+
+    void
+    unlock_shared() {
+        m_mutex.unlock_shared();
+    }
+
+private:
+    Mutex m_mutex;
+    lock_stats& m_stats;
+    clock::time_point m_since;
+};
+
+using profiled_mutex = basic_profiled_mutex<std::mutex>;
+using profiled_shared_mutex = basic_profiled_mutex<boost::shared_mutex>;
+
+} // namespace utils
+} // namespace norns
+
+#endif /* __UTILS_PROFILED_MUTEX_HPP__ */
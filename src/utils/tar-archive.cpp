@@ -51,6 +51,7 @@ using archive_ptr = std::unique_ptr<struct archive,
                                     decltype(&archive_write_free)>;
 using entry_ptr = std::unique_ptr<struct archive_entry, 
                                   decltype(&::archive_entry_free)>;
+using cancel_check = std::function<bool()>;
 
 // helper functions
 namespace {
@@ -70,7 +71,8 @@ xalign(std::size_t n, std::size_t block_size) {
 std::error_code
 append_file_data(struct archive* ar,
                  const bfs::path& name, 
-                 std::size_t size) {
+                 std::size_t size,
+                 const cancel_check& is_cancelled) {
 
     using norns::utils::file_handle;
     std::error_code ec;
@@ -86,6 +88,12 @@ append_file_data(struct archive* ar,
     off_t offset = 0;
 
 	while(offset < static_cast<off_t>(size)) {
+
+        if(is_cancelled && is_cancelled()) {
+            ec.assign(ECANCELED, std::generic_category());
+            return ec;
+        }
+
 		ssize_t n = ::pread(fh.native(), buffer.data(), buffer.size(), offset);
 
 		switch(n) {
@@ -125,7 +133,8 @@ std::error_code
 append_file(struct archive* arc,
             const bfs::path& source_path,
             const bfs::path& archive_path,
-            const entry_ptr& entry) {
+            const entry_ptr& entry,
+            const cancel_check& is_cancelled) {
 
     std::error_code ec;
 
@@ -147,7 +156,7 @@ append_file(struct archive* arc,
     }
 
     // append the actual file data to the archive
-    return ::append_file_data(arc, source_path, stbuf.st_size);
+    return ::append_file_data(arc, source_path, stbuf.st_size, is_cancelled);
 }
 
 std::error_code
@@ -286,6 +295,11 @@ tar::~tar() {
     this->release();
 }
 
+void
+tar::set_cancellation_check(const std::function<bool()>& is_cancelled) {
+    m_is_cancelled = is_cancelled;
+}
+
 void
 tar::add_file(const bfs::path& source_file, 
               const bfs::path& archive_file,
@@ -319,7 +333,8 @@ tar::add_file(const bfs::path& source_file,
         return;
     }
 
-    ec = ::append_file(m_archive, source_path, archive_file, entry);
+    ec = ::append_file(m_archive, source_path, archive_file, entry, 
+                       m_is_cancelled);
 }
 
 void
@@ -410,7 +425,8 @@ tar::add_directory(const bfs::path& source_dir,
         if(bfs::is_regular(*it)) {
 //            fmt::print(stderr, "    ::append_file({}, tp: {})\n", 
 //                       *it, transformed_path);
-            ec = ::append_file(m_archive, *it, transformed_path, entry);
+            ec = ::append_file(m_archive, *it, transformed_path, entry,
+                               m_is_cancelled);
 
             if(ec) {
                 return;
@@ -39,6 +39,7 @@
 #define NORNS_UTILS_TAR_ARCHIVE_HPP
 
 #include <boost/filesystem.hpp>
+#include <functional>
 #include <system_error>
 
 // forward declare 'struct archive'
@@ -64,6 +65,12 @@ struct tar {
 
     ~tar();
 
+    /*! Set a predicate that is checked before each block of file data is 
+     * appended to the archive. If it returns true, add_file() and 
+     * add_directory() stop and fail with ECANCELED */
+    void
+    set_cancellation_check(const std::function<bool()>& is_cancelled);
+
     void
     add_file(const bfs::path& real_name, 
              const bfs::path& archive_name,
@@ -92,6 +99,7 @@ struct tar {
     struct archive* m_archive = nullptr;
     bfs::path m_path;
     openmode m_openmode;
+    std::function<bool()> m_is_cancelled;
 };
 
 } // namespace utils
@@ -0,0 +1,366 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "trace.hpp"
+
+namespace {
+
+using norns::utils::trace::clock;
+
+// buffers of threads that have exited are kept so that their events can 
+// still be dumped, but only the most recent ones (runners come and go as 
+// the bulk lane is resized)
+constexpr const std::size_t max_exited_threads = 64;
+
+struct event {
+    const char* m_category;
+    const char* m_name;
+    uint64_t m_id;
+    int64_t m_ts;   // usecs
+    int64_t m_dur;  // usecs (< 0 for instant events)
+};
+
+struct thread_buffer {
+
+    thread_buffer(pid_t tid, std::size_t capacity) :
+        m_tid(tid),
+        m_events(capacity),
+        m_next(0),
+        m_count(0),
+        m_exited(false) {}
+
+    void
+    reset(std::size_t capacity) {
+        m_events.assign(capacity, event());
+        m_next = 0;
+        m_count = 0;
+    }
+
+    std::mutex m_mutex;
+    const pid_t m_tid;
+    std::string m_name;
+    std::vector<event> m_events;
+    std::size_t m_next;
+    std::size_t m_count;
+    bool m_exited;
+};
+
+struct buffer_registry {
+    std::mutex m_mutex;
+    std::size_t m_capacity = 0;
+    std::list<std::shared_ptr<thread_buffer>> m_buffers;
+};
+
+// never destroyed, since threads may record events while the process exits
+buffer_registry&
+registry() {
+    static auto* r = new buffer_registry;
+    return *r;
+}
+
+// drop the buffers of exited threads beyond max_exited_threads
+// (N.B. registry().m_mutex must be held)
+void
+prune_exited(buffer_registry& r) {
+
+    std::size_t nexited = 0;
+
+    for(const auto& buf : r.m_buffers) {
+        std::lock_guard<std::mutex> lock(buf->m_mutex);
+        nexited += buf->m_exited ? 1 : 0;
+    }
+
+    // buffers are registered in order, so the oldest ones come first
+    for(auto it = r.m_buffers.begin(); 
+        it != r.m_buffers.end() && nexited > max_exited_threads; ) {
+
+        bool exited;
+        {
+            std::lock_guard<std::mutex> lock((*it)->m_mutex);
+            exited = (*it)->m_exited;
+        }
+
+        if(exited) {
+            it = r.m_buffers.erase(it);
+            --nexited;
+            continue;
+        }
+
+        ++it;
+    }
+}
+
+// owns the calling thread's buffer and flags it when the thread exits
+struct thread_handle {
+
+    ~thread_handle() {
+        if(m_buffer) {
+            std::lock_guard<std::mutex> lock(m_buffer->m_mutex);
+            m_buffer->m_exited = true;
+        }
+    }
+
+    std::shared_ptr<thread_buffer> m_buffer;
+    bool m_named = false;
+};
+
+thread_local thread_handle t_handle;
+
+thread_buffer&
+current_buffer() {
+
+    if(!t_handle.m_buffer) {
+        auto& r = registry();
+        std::lock_guard<std::mutex> lock(r.m_mutex);
+
+        t_handle.m_buffer = std::make_shared<thread_buffer>(
+                static_cast<pid_t>(::syscall(SYS_gettid)), r.m_capacity);
+        r.m_buffers.push_back(t_handle.m_buffer);
+        prune_exited(r);
+    }
+
+    return *t_handle.m_buffer;
+}
+
+int64_t
+to_usecs(clock::time_point tp) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            tp.time_since_epoch()).count();
+}
+
+void
+record(const event& ev) {
+
+    auto& buf = current_buffer();
+    std::lock_guard<std::mutex> lock(buf.m_mutex);
+
+    if(buf.m_events.empty()) {
+        return;
+    }
+
+    buf.m_events[buf.m_next] = ev;
+    buf.m_next = (buf.m_next + 1) % buf.m_events.size();
+    buf.m_count = std::min(buf.m_count + 1, buf.m_events.size());
+}
+
+void
+write_escaped(std::ostream& os, const char* str) {
+
+    os << '"';
+
+    for(const char* p = str; *p != '\0'; ++p) {
+        switch(*p) {
+            case '"':
+                os << "\\\"";
+                break;
+            case '\\':
+                os << "\\\\";
+                break;
+            default:
+                if(static_cast<unsigned char>(*p) < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", *p);
+                    os << buffer;
+                }
+                else {
+                    os << *p;
+                }
+        }
+    }
+
+    os << '"';
+}
+
+} // anonymous namespace
+
+namespace norns {
+namespace utils {
+namespace trace {
+
+namespace detail {
+std::atomic<bool> g_enabled(false);
+} // namespace detail
+
+void
+configure(std::size_t capacity) {
+
+    auto& r = registry();
+    std::lock_guard<std::mutex> lock(r.m_mutex);
+
+    r.m_capacity = capacity;
+
+    for(auto it = r.m_buffers.begin(); it != r.m_buffers.end(); ) {
+
+        std::unique_lock<std::mutex> buf_lock((*it)->m_mutex);
+
+        if((*it)->m_exited) {
+            buf_lock.unlock();
+            it = r.m_buffers.erase(it);
+            continue;
+        }
+
+        (*it)->reset(capacity);
+        ++it;
+    }
+
+    detail::g_enabled.store(capacity != 0, std::memory_order_relaxed);
+}
+
+void
+set_thread_name(const char* name) {
+
+    if(!enabled() || t_handle.m_named) {
+        return;
+    }
+
+    auto& buf = current_buffer();
+    std::lock_guard<std::mutex> lock(buf.m_mutex);
+    buf.m_name = name;
+    t_handle.m_named = true;
+}
+
+void
+instant(const char* category, const char* name, uint64_t id) {
+
+    if(!enabled()) {
+        return;
+    }
+
+    record(event{category, name, id, to_usecs(clock::now()), -1});
+}
+
+void
+complete(const char* category, const char* name, uint64_t id, 
+         clock::time_point start, clock::time_point end) {
+
+    if(!enabled()) {
+        return;
+    }
+
+    record(event{category, name, id, to_usecs(start), 
+                 std::max<int64_t>(0, to_usecs(end) - to_usecs(start))});
+}
+
+void
+write_chrome_json(std::ostream& os) {
+
+    std::vector<std::shared_ptr<thread_buffer>> buffers;
+
+    {
+        auto& r = registry();
+        std::lock_guard<std::mutex> lock(r.m_mutex);
+        buffers.assign(r.m_buffers.begin(), r.m_buffers.end());
+    }
+
+    const pid_t pid = ::getpid();
+    bool first = true;
+
+    const auto begin_event = [&](const char* name, const char* phase, 
+                                 pid_t tid) {
+        os << (first ? "\n" : ",\n") << "{\"name\":";
+        write_escaped(os, name);
+        os << ",\"ph\":\"" << phase << "\",\"pid\":" << pid 
+           << ",\"tid\":" << tid;
+        first = false;
+    };
+
+    os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    std::vector<event> events;
+
+    for(const auto& buf : buffers) {
+
+        std::string name;
+
+        // copy the events so that the thread can keep recording while 
+        // we write them out
+        {
+            std::lock_guard<std::mutex> lock(buf->m_mutex);
+
+            const std::size_t size = buf->m_events.size();
+            const std::size_t start = 
+                size == 0 ? 0 : (buf->m_next + size - buf->m_count) % size;
+
+            events.clear();
+
+            for(std::size_t i = 0; i < buf->m_count; ++i) {
+                events.push_back(buf->m_events[(start + i) % size]);
+            }
+
+            name = buf->m_name;
+        }
+
+        if(!name.empty()) {
+            begin_event("thread_name", "M", buf->m_tid);
+            os << ",\"args\":{\"name\":";
+            write_escaped(os, name.c_str());
+            os << "}}";
+        }
+
+        for(const auto& ev : events) {
+            begin_event(ev.m_name, ev.m_dur < 0 ? "i" : "X", buf->m_tid);
+            os << ",\"cat\":";
+            write_escaped(os, ev.m_category);
+            os << ",\"ts\":" << ev.m_ts;
+
+            if(ev.m_dur < 0) {
+                os << ",\"s\":\"t\"";
+            }
+            else {
+                os << ",\"dur\":" << ev.m_dur;
+            }
+
+            os << ",\"args\":{\"id\":" << ev.m_id << "}}";
+        }
+    }
+
+    os << "\n]}\n";
+}
+
+} // namespace trace
+} // namespace utils
+} // namespace norns
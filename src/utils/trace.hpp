@@ -0,0 +1,128 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#ifndef __UTILS_TRACE_HPP__
+#define __UTILS_TRACE_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+namespace norns {
+namespace utils {
+namespace trace {
+
+/*! Lifecycle tracing for the daemon. Each thread records events into its 
+ * own ring buffer of fixed size, so that recording an event only takes an 
+ * uncontended lock and a few stores, and old events are overwritten once
+ * the buffer is full. The events of all threads can then be written out 
+ * in the Chrome trace format (chrome://tracing, ui.perfetto.dev).
+ *
+ * Names and categories are NOT copied: they must be string literals (or 
+ * otherwise outlive the tracing facility). Tracing is disabled until 
+ * configure() is called with a non-zero capacity, and all functions 
+ * return immediately while it is */
+
+using clock = std::chrono::steady_clock;
+
+namespace detail {
+extern std::atomic<bool> g_enabled;
+} // namespace detail
+
+/*! Keep up to 'capacity' events per thread (0 disables tracing). Events 
+ * recorded so far are discarded */
+void
+configure(std::size_t capacity);
+
+inline bool
+enabled() {
+    return detail::g_enabled.load(std::memory_order_relaxed);
+}
+
+/*! Name the calling thread in traces (e.g. "bulk"). Only the first name 
+ * given to a thread is kept, so this can be called from hot paths */
+void
+set_thread_name(const char* name);
+
+/*! Record something that happened at a point in time */
+void
+instant(const char* category, const char* name, uint64_t id = 0);
+
+/*! Record something that happened between 'start' and 'end' */
+void
+complete(const char* category, const char* name, uint64_t id, 
+         clock::time_point start, clock::time_point end);
+
+/*! Record the lifetime of the scope as a complete event */
+class scope {
+
+public:
+    scope(const char* category, const char* name, uint64_t id = 0) :
+        m_category(category),
+        m_name(name),
+        m_id(id),
+        m_enabled(enabled()),
+        m_start(m_enabled ? clock::now() : clock::time_point()) {}
+
+    scope(const scope& other) = delete;
+    scope& operator=(const scope& other) = delete;
+
+    ~scope() {
+        if(m_enabled) {
+            complete(m_category, m_name, m_id, m_start, clock::now());
+        }
+    }
+
+private:
+    const char* const m_category;
+    const char* const m_name;
+    const uint64_t m_id;
+    const bool m_enabled;
+    const clock::time_point m_start;
+};
+
+/*! Write the events currently recorded by all threads (including those 
+ * that already exited) as a Chrome trace JSON object */
+void
+write_chrome_json(std::ostream& os);
+
+} // namespace trace
+} // namespace utils
+} // namespace norns
+
+#endif /* __UTILS_TRACE_HPP__ */
@@ -61,11 +61,14 @@ SCENARIO("copy local POSIX file to local POSIX file",
         // define input names
         const bfs::path src_file_at_root = "/file0";
         const bfs::path src_file_at_subdir = "/a/b/c/d/file0";
+        const bfs::path src_large_file = "/large_file0"; // > copy_chunk_size
         const bfs::path src_invalid_file = "/a/b/c/d/does_not_exist_file0";
         const bfs::path src_invalid_dir = "/a/b/c/d/does_not_exist_dir0";
         const bfs::path src_subdir0 = "/input_dir0";
         const bfs::path src_subdir1 = "/input_dir0/a/b/c/input_dir1";
         const bfs::path src_empty_dir = "/empty_dir0";
+        const bfs::path src_mixed_dir = "/mixed_dir0"; // nested, mixed sizes
+        const bfs::path src_linked_dir = "/linked_dir0"; // has a symlinked subdir
 
         const bfs::path src_noperms_file0 = "/noperms_file0";
         const bfs::path src_noperms_file1 = "/noperms/a/b/c/d/noperms_file0"; // parents accessible
@@ -73,6 +76,7 @@ SCENARIO("copy local POSIX file to local POSIX file",
         const bfs::path src_noperms_subdir0 = "/noperms_subdir0"; // subdir non-accessible
         const bfs::path src_noperms_subdir1 = "/noperms/a/b/c/d/noperms_subdir1"; // child subdir non-accessible
         const bfs::path src_noperms_subdir2 = "/noperms/noperms_subdir2/a"; // parent subdir non-accessible
+        const bfs::path src_noperms_tree = "/noperms_tree0"; // non-accessible file mid-tree
 
         const bfs::path src_symlink_at_root0 = "/symlink0";
         const bfs::path src_symlink_at_root1 = "/symlink1";
@@ -90,10 +94,12 @@ SCENARIO("copy local POSIX file to local POSIX file",
         const bfs::path dst_file_at_subdir1 = "/a/b/c/d/file1"; // same parents, different basename
         const bfs::path dst_file_at_subdir2 = "/e/f/g/h/i/file0"; // different parents, same basename
         const bfs::path dst_file_at_subdir3 = "/e/f/g/h/i/file1"; // different fullname
+        const bfs::path dst_subdir2         = "/output_dir2";
 
         // create input data
         env.add_to_namespace(nsid0, src_file_at_root, 4096);
         env.add_to_namespace(nsid0, src_file_at_subdir, 8192);
+        env.add_to_namespace(nsid0, src_large_file, 5*1024*1024 + 1234);
         env.add_to_namespace(nsid0, src_subdir0);
         env.add_to_namespace(nsid0, src_subdir1);
         env.add_to_namespace(nsid0, src_empty_dir);
@@ -108,6 +114,22 @@ SCENARIO("copy local POSIX file to local POSIX file",
             env.add_to_namespace(nsid0, p, 4096+i*10);
         }
 
+        // a tree mixing empty, small and large files (> copy_chunk_size) 
+        // at different depths, and an empty subdir
+        env.add_to_namespace(nsid0, src_mixed_dir / "file0", 0);
+        env.add_to_namespace(nsid0, src_mixed_dir / "a/file1", 100);
+        env.add_to_namespace(nsid0, src_mixed_dir / "a/b/large_file0", 
+                             3*1024*1024 + 1234);
+        env.add_to_namespace(nsid0, src_mixed_dir / "a/b/c/file2", 4096);
+        env.add_to_namespace(nsid0, src_mixed_dir / "d/large_file1", 
+                             2*1024*1024);
+        env.add_to_namespace(nsid0, src_mixed_dir / "d/file3", 8193);
+        env.add_to_namespace(nsid0, src_mixed_dir / "a/e");
+
+        // a tree with a symlink to a directory
+        env.add_to_namespace(nsid0, src_linked_dir / "file0", 4096);
+        env.add_to_namespace(nsid0, src_subdir0, src_linked_dir / "symlink0");
+
         // create input data with special permissions
         auto p = env.add_to_namespace(nsid0, src_noperms_file0, 0);
         env.remove_access(p);
@@ -127,6 +149,12 @@ SCENARIO("copy local POSIX file to local POSIX file",
         p = env.add_to_namespace(nsid0, src_noperms_subdir2);
         env.remove_access(p.parent_path());
 
+        env.add_to_namespace(nsid0, src_noperms_tree / "file0", 4096);
+        env.add_to_namespace(nsid0, src_noperms_tree / "a/b/file1", 8192);
+        p = env.add_to_namespace(nsid0, src_noperms_tree / "a/noperms_file0", 
+                                 4096);
+        env.remove_access(p);
+
         // add symlinks to the namespace
         env.add_to_namespace(nsid0, src_file_at_root, src_symlink_at_root0);
         env.add_to_namespace(nsid0, src_subdir0, src_symlink_at_root1);
@@ -495,6 +523,55 @@ SCENARIO("copy local POSIX file to local POSIX file",
                 }
             }
         }
+
+        // - trying to copy a subdir containing a file without appropriate
+        // permissions to access it
+        WHEN("copying a NORNS_LOCAL_PATH subdir containing a file without "
+             "appropriate permissions to access it") {
+
+            norns_iotask_t task = 
+                NORNS_IOTASK(NORNS_IOTASK_COPY, 
+                             NORNS_LOCAL_PATH(nsid0, src_noperms_tree.c_str()), 
+                             NORNS_LOCAL_PATH(nsid1, dst_subdir2.c_str()));
+
+            norns_error_t rv = norns_submit(&task);
+
+            THEN("norns_submit() returns NORNS_SUCCESS") {
+                REQUIRE(rv == NORNS_SUCCESS);
+                REQUIRE(task.t_id != 0);
+
+                // wait until the task completes
+                rv = norns_wait(&task, NULL);
+
+                THEN("norns_wait() returns NORNS_SUCCESS") {
+                    REQUIRE(rv == NORNS_SUCCESS);
+
+                    THEN("norns_error() reports NORNS_ESYSTEMERROR and "
+                         "EACCES|EPERM") {
+                        norns_stat_t stats;
+                        rv = norns_error(&task, &stats);
+
+                        REQUIRE(rv == NORNS_SUCCESS);
+                        REQUIRE(stats.st_status == NORNS_EFINISHEDWERROR);
+                        REQUIRE(stats.st_task_error == NORNS_ESYSTEMERROR);
+                        REQUIRE(( (stats.st_sys_errno == EACCES) || 
+                                  (stats.st_sys_errno == EPERM ) ));
+                    }
+
+                    THEN("The accessible files are copied anyway") {
+                        bfs::path src = 
+                            env.get_from_namespace(nsid0, src_noperms_tree);
+                        bfs::path dst = 
+                            env.get_from_namespace(nsid1, dst_subdir2);
+
+                        REQUIRE(compare_files(src / "file0", 
+                                              dst / "file0") == true);
+                        REQUIRE(compare_files(src / "a/b/file1", 
+                                              dst / "a/b/file1") == true);
+                    }
+                }
+            }
+        }
 #endif
 
         // symlink leading out of namespace
@@ -569,6 +646,67 @@ SCENARIO("copy local POSIX file to local POSIX file",
 
                         REQUIRE(compare_files(src, dst) == true);
                     }
+
+                    THEN("norns_error() reports the copy engines used") {
+                        norns_stat_t stats;
+                        rv = norns_error(&task, &stats);
+
+                        REQUIRE(rv == NORNS_SUCCESS);
+                        REQUIRE(stats.st_status == NORNS_EFINISHED);
+                        REQUIRE(stats.st_copy_engines != 0);
+                        REQUIRE((stats.st_copy_engines &
+                                    ~(NORNS_COPY_REFLINK |
+                                      NORNS_COPY_FILE_RANGE |
+                                      NORNS_COPY_SENDFILE |
+                                      NORNS_COPY_READ_WRITE |
+                                      NORNS_COPY_IO_URING |
+                                      NORNS_COPY_DIRECT)) == 0);
+                    }
+                }
+            }
+        }
+
+        // cp -r ns0://large_file0 -> ns1://large_file0 = ns1://large_file0
+        WHEN("copying a NORNS_LOCAL_PATH file larger than the copy chunk "
+             "size (copied in parallel ranges)") {
+            
+            norns_iotask_t task = 
+                NORNS_IOTASK(NORNS_IOTASK_COPY, 
+                             NORNS_LOCAL_PATH(nsid0, src_large_file.c_str()), 
+                             NORNS_LOCAL_PATH(nsid1, src_large_file.c_str()));
+
+            norns_error_t rv = norns_submit(&task);
+
+            THEN("norns_submit() returns NORNS_SUCCESS") {
+                REQUIRE(rv == NORNS_SUCCESS);
+                REQUIRE(task.t_id != 0);
+
+                // wait until the task completes
+                rv = norns_wait(&task, NULL);
+
+                THEN("norns_wait() returns NORNS_SUCCESS") {
+                    REQUIRE(rv == NORNS_SUCCESS);
+
+                    THEN("norns_error() reports all data as transferred") {
+                        norns_stat_t stats;
+                        rv = norns_error(&task, &stats);
+
+                        REQUIRE(rv == NORNS_SUCCESS);
+                        REQUIRE(stats.st_status == NORNS_EFINISHED);
+                        REQUIRE(stats.st_task_error == NORNS_SUCCESS);
+                        REQUIRE(stats.st_pending == 0);
+                        REQUIRE(stats.st_total == 5*1024*1024 + 1234);
+                    }
+
+                    THEN("Files are equal") {
+
+                        bfs::path src = 
+                            env.get_from_namespace(nsid0, src_large_file);
+                        bfs::path dst = 
+                            env.get_from_namespace(nsid1, src_large_file);
+
+                        REQUIRE(compare_files(src, dst) == true);
+                    }
                 }
             }
         }
@@ -1113,6 +1251,49 @@ SCENARIO("copy local POSIX file to local POSIX file",
             }
         }
 
+        // cp -r /a/contents.* -> /b = /b/contents.*
+        // (contents is a tree of files of different sizes)
+        WHEN("copying a NORNS_LOCAL_PATH subdir with nested subdirs and "
+             "files of different sizes") {
+
+            norns_iotask_t task = 
+                NORNS_IOTASK(NORNS_IOTASK_COPY, 
+                             NORNS_LOCAL_PATH(nsid0, src_mixed_dir.c_str()), 
+                             NORNS_LOCAL_PATH(nsid1, dst_subdir2.c_str()));
+
+            norns_error_t rv = norns_submit(&task);
+
+            THEN("norns_submit() returns NORNS_SUCCESS") {
+                REQUIRE(rv == NORNS_SUCCESS);
+                REQUIRE(task.t_id != 0);
+
+                // wait until the task completes
+                rv = norns_wait(&task, NULL);
+
+                THEN("norns_wait() returns NORNS_SUCCESS") {
+                    REQUIRE(rv == NORNS_SUCCESS);
+
+                    norns_stat_t stats;
+                    rv = norns_error(&task, &stats);
+
+                    REQUIRE(rv == NORNS_SUCCESS);
+                    REQUIRE(stats.st_status == NORNS_EFINISHED);
+
+                    THEN("Copied files and subdirs are identical to "
+                         "original") {
+                        bfs::path src = 
+                            env.get_from_namespace(nsid0, src_mixed_dir);
+                        bfs::path dst = 
+                            env.get_from_namespace(nsid1, dst_subdir2);
+
+                        REQUIRE(compare_directories(src, dst) == true);
+                        REQUIRE(bfs::is_directory(dst / "a/e"));
+                        REQUIRE(bfs::is_empty(dst / "a/e"));
+                    }
+                }
+            }
+        }
+
         /**********************************************************************/
         /* tests for soft links                                               */
         /**********************************************************************/
@@ -1328,6 +1509,52 @@ SCENARIO("copy local POSIX file to local POSIX file",
             }
         }
 
+        WHEN("copying a NORNS_LOCAL_PATH subdir containing a symlink to "
+             "another subdir") {
+
+            norns_iotask_t task = 
+                NORNS_IOTASK(NORNS_IOTASK_COPY, 
+                             NORNS_LOCAL_PATH(nsid0, src_linked_dir.c_str()), 
+                             NORNS_LOCAL_PATH(nsid1, dst_subdir2.c_str()));
+
+            norns_error_t rv = norns_submit(&task);
+
+            THEN("norns_submit() returns NORNS_SUCCESS") {
+                REQUIRE(rv == NORNS_SUCCESS);
+                REQUIRE(task.t_id != 0);
+
+                // wait until the task completes
+                rv = norns_wait(&task, NULL);
+
+                THEN("norns_wait() returns NORNS_SUCCESS") {
+                    REQUIRE(rv == NORNS_SUCCESS);
+
+                    norns_stat_t stats;
+                    rv = norns_error(&task, &stats);
+
+                    REQUIRE(rv == NORNS_SUCCESS);
+                    REQUIRE(stats.st_status == NORNS_EFINISHED);
+
+                    THEN("Regular files are copied but the symlink is not "
+                         "followed") {
+                        bfs::path src = 
+                            env.get_from_namespace(nsid0, src_linked_dir);
+                        bfs::path dst = 
+                            env.get_from_namespace(nsid1, dst_subdir2);
+
+                        REQUIRE(compare_files(src / "file0", 
+                                              dst / "file0") == true);
+
+                        for(int i=0; i<10; ++i) {
+                            const bfs::path p{dst / "symlink0" / 
+                                              ("file" + std::to_string(i))};
+                            REQUIRE(!bfs::exists(p));
+                        }
+                    }
+                }
+            }
+        }
+
         env.notify_success();
     }
 
@@ -0,0 +1,188 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <cstring>
+#include <vector>
+#include "nornsctl.h"
+#include "test-env.hpp"
+#include "catch.hpp"
+
+namespace {
+
+const nornsctl_latency_t*
+find_entry(const std::vector<nornsctl_latency_t>& entries, 
+           nornsctl_latency_scope_t scope, const char* name, 
+           nornsctl_latency_phase_t phase) {
+
+    for(const auto& e : entries) {
+        if(e.l_scope == scope && e.l_phase == phase && 
+           std::strcmp(e.l_name, name) == 0) {
+            return &e;
+        }
+    }
+
+    return nullptr;
+}
+
+} // anonymous namespace
+
+SCENARIO("latency statistics", "[api::nornsctl_latency_stats]") {
+    GIVEN("a running urd instance") {
+
+        test_env env;
+
+        const char* nsid0 = "tmp0";
+        const char* nsid1 = "tmp1";
+        bfs::path src_mnt, dst_mnt;
+
+        // create namespaces
+        std::tie(std::ignore, src_mnt) = 
+            env.create_namespace(nsid0, "mnt/tmp0", 16384);
+        std::tie(std::ignore, dst_mnt) = 
+            env.create_namespace(nsid1, "mnt/tmp1", 16384);
+
+        // define input names
+        const bfs::path src_file = "/a/b/c/file";
+        const size_t src_file_size = 2*1024*1024;
+
+        // define output names
+        const bfs::path dst_file = "/b/c/d/file";
+
+        // create input data
+        env.add_to_namespace(nsid0, src_file, src_file_size);
+
+        WHEN("requesting latency statistics with invalid arguments") {
+
+            size_t nentries = 1;
+
+            THEN("NORNS_EBADARGS is returned") {
+                REQUIRE(nornsctl_latency_stats(NULL, NULL) == NORNS_EBADARGS);
+                REQUIRE(nornsctl_latency_stats(NULL, &nentries) == 
+                        NORNS_EBADARGS);
+            }
+        }
+
+        WHEN("requesting only the number of available entries") {
+
+            size_t nentries = 0;
+            norns_error_t rv = nornsctl_latency_stats(NULL, &nentries);
+
+            THEN("previously handled requests are accounted for") {
+                REQUIRE(rv == NORNS_SUCCESS);
+                // at least the namespace registrations have been timed
+                REQUIRE(nentries > 0);
+            }
+        }
+
+        WHEN("requesting latency statistics after a transfer completes") {
+
+            norns_iotask_t task = 
+                NORNSCTL_IOTASK(NORNS_IOTASK_COPY, 
+                                NORNS_LOCAL_PATH(nsid0, src_file.c_str()), 
+                                NORNS_LOCAL_PATH(nsid1, dst_file.c_str()));
+
+            norns_error_t rv = nornsctl_submit(&task);
+            REQUIRE(rv == NORNS_SUCCESS);
+
+            rv = nornsctl_wait(&task, NULL);
+            REQUIRE(rv == NORNS_SUCCESS);
+
+            size_t nentries = 0;
+            rv = nornsctl_latency_stats(NULL, &nentries);
+            REQUIRE(rv == NORNS_SUCCESS);
+            REQUIRE(nentries > 0);
+
+            // leave room for the entries added by the handler's own timing
+            std::vector<nornsctl_latency_t> entries(nentries + 8);
+            size_t capacity = entries.size();
+            rv = nornsctl_latency_stats(entries.data(), &capacity);
+            REQUIRE(rv == NORNS_SUCCESS);
+            REQUIRE(capacity <= entries.size());
+            entries.resize(capacity);
+
+            THEN("the task phases are reported for its type") {
+                for(const auto phase : { NORNSCTL_PHASE_QUEUED, 
+                                         NORNSCTL_PHASE_RESOLVE,
+                                         NORNSCTL_PHASE_SETUP,
+                                         NORNSCTL_PHASE_TRANSFER, 
+                                         NORNSCTL_PHASE_TOTAL }) {
+                    const auto e = find_entry(entries, 
+                            NORNSCTL_LATENCY_TASK_TYPE, "DATA_COPY", phase);
+
+                    REQUIRE(e != nullptr);
+                    REQUIRE(e->l_count == 1);
+                    REQUIRE(e->l_p50 <= e->l_p90);
+                    REQUIRE(e->l_p90 <= e->l_p99);
+                    REQUIRE(e->l_p99 <= e->l_max);
+                }
+            }
+
+            THEN("the task phases are reported for its namespace pair") {
+                const auto e = find_entry(entries, 
+                        NORNSCTL_LATENCY_NS_PAIR, "tmp0 => tmp1", 
+                        NORNSCTL_PHASE_TOTAL);
+
+                REQUIRE(e != nullptr);
+                REQUIRE(e->l_count == 1);
+            }
+
+            THEN("the submission handler latency is reported") {
+                const auto e = find_entry(entries, 
+                        NORNSCTL_LATENCY_REQUEST, "IOTASK_CREATE", 
+                        NORNSCTL_PHASE_HANDLER);
+
+                REQUIRE(e != nullptr);
+                REQUIRE(e->l_count >= 1);
+            }
+        }
+
+        env.notify_success();
+    }
+
+#ifndef USE_REAL_DAEMON
+    GIVEN("a non-running urd instance") {
+        WHEN("requesting latency statistics") {
+            size_t nentries = 0;
+            norns_error_t rv = nornsctl_latency_stats(NULL, &nentries);
+
+            THEN("NORNS_ECONNFAILED is returned") {
+                REQUIRE(rv == NORNS_ECONNFAILED);
+            }
+        }
+    }
+#endif
+}
@@ -0,0 +1,154 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <cstring>
+#include <vector>
+#include "nornsctl.h"
+#include "test-env.hpp"
+#include "catch.hpp"
+
+namespace {
+
+const nornsctl_lock_stat_t*
+find_entry(const std::vector<nornsctl_lock_stat_t>& entries, 
+           const char* name) {
+
+    for(const auto& e : entries) {
+        if(std::strcmp(e.lk_name, name) == 0) {
+            return &e;
+        }
+    }
+
+    return nullptr;
+}
+
+} // anonymous namespace
+
+SCENARIO("lock statistics", "[api::nornsctl_lock_stats]") {
+    GIVEN("a running urd instance with lock profiling enabled") {
+
+        test_env env;
+
+        const char* nsid0 = "tmp0";
+        const char* nsid1 = "tmp1";
+        bfs::path src_mnt, dst_mnt;
+
+        // create namespaces
+        std::tie(std::ignore, src_mnt) = 
+            env.create_namespace(nsid0, "mnt/tmp0", 16384);
+        std::tie(std::ignore, dst_mnt) = 
+            env.create_namespace(nsid1, "mnt/tmp1", 16384);
+
+        // define input names
+        const bfs::path src_file = "/a/b/c/file";
+        const size_t src_file_size = 2*1024*1024;
+
+        // define output names
+        const bfs::path dst_file = "/b/c/d/file";
+
+        // create input data
+        env.add_to_namespace(nsid0, src_file, src_file_size);
+
+        WHEN("requesting lock statistics with invalid arguments") {
+
+            size_t nentries = 1;
+
+            THEN("NORNS_EBADARGS is returned") {
+                REQUIRE(nornsctl_lock_stats(NULL, NULL) == NORNS_EBADARGS);
+                REQUIRE(nornsctl_lock_stats(NULL, &nentries) == 
+                        NORNS_EBADARGS);
+            }
+        }
+
+        WHEN("requesting lock statistics after a transfer completes") {
+
+            norns_iotask_t task = 
+                NORNSCTL_IOTASK(NORNS_IOTASK_COPY, 
+                                NORNS_LOCAL_PATH(nsid0, src_file.c_str()), 
+                                NORNS_LOCAL_PATH(nsid1, dst_file.c_str()));
+
+            norns_error_t rv = nornsctl_submit(&task);
+            REQUIRE(rv == NORNS_SUCCESS);
+
+            rv = nornsctl_wait(&task, NULL);
+            REQUIRE(rv == NORNS_SUCCESS);
+
+            size_t nentries = 0;
+            rv = nornsctl_lock_stats(NULL, &nentries);
+            REQUIRE(rv == NORNS_SUCCESS);
+            REQUIRE(nentries > 0);
+
+            std::vector<nornsctl_lock_stat_t> entries(nentries);
+            size_t capacity = entries.size();
+            rv = nornsctl_lock_stats(entries.data(), &capacity);
+            REQUIRE(rv == NORNS_SUCCESS);
+            REQUIRE(capacity == entries.size());
+
+            THEN("the locks used by the submission are accounted for") {
+                for(const auto name : { "task_info", 
+                                        "task_table.shard", 
+                                        "task_queue", 
+                                        "urd.namespace_manager" }) {
+                    const auto e = find_entry(entries, name);
+
+                    REQUIRE(e != nullptr);
+                    REQUIRE(e->lk_acquisitions + 
+                            e->lk_shared_acquisitions > 0);
+                    REQUIRE(e->lk_contended <= 
+                            e->lk_acquisitions + e->lk_shared_acquisitions);
+                    REQUIRE(e->lk_max_wait <= e->lk_wait);
+                    REQUIRE(e->lk_max_hold <= e->lk_hold);
+                }
+            }
+        }
+
+        env.notify_success();
+    }
+
+#ifndef USE_REAL_DAEMON
+    GIVEN("a non-running urd instance") {
+        WHEN("requesting lock statistics") {
+            size_t nentries = 0;
+            norns_error_t rv = nornsctl_lock_stats(NULL, &nentries);
+
+            THEN("NORNS_ECONNFAILED is returned") {
+                REQUIRE(rv == NORNS_ECONNFAILED);
+            }
+        }
+    }
+#endif
+}
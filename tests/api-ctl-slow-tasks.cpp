@@ -0,0 +1,151 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "nornsctl.h"
+#include "test-env.hpp"
+#include "catch.hpp"
+
+SCENARIO("slow task detection", "[api::nornsctl_slow_tasks]") {
+    GIVEN("a running urd instance with the watchdog enabled") {
+
+        // in dry run mode, tasks sleep for the given duration (in usecs) 
+        // before and after becoming running, without making any progress.
+        // The test daemon checks tasks every second and considers them 
+        // stalled after one second without progress
+        test_env env(fake_daemon_cfg(true, 4000000));
+
+        const char* nsid0 = "tmp0";
+        const char* nsid1 = "tmp1";
+        bfs::path src_mnt, dst_mnt;
+
+        // create namespaces
+        std::tie(std::ignore, src_mnt) = 
+            env.create_namespace(nsid0, "mnt/tmp0", 16384);
+        std::tie(std::ignore, dst_mnt) = 
+            env.create_namespace(nsid1, "mnt/tmp1", 16384);
+
+        // define input names
+        const bfs::path src_file = "/a/b/c/file";
+        const size_t src_file_size = 2*1024*1024;
+
+        // define output names
+        const bfs::path dst_file = "/b/c/d/file";
+
+        // create input data
+        env.add_to_namespace(nsid0, src_file, src_file_size);
+
+        WHEN("requesting slow tasks with invalid arguments") {
+
+            size_t nentries = 1;
+
+            THEN("NORNS_EBADARGS is returned") {
+                REQUIRE(nornsctl_slow_tasks(NULL, NULL) == NORNS_EBADARGS);
+                REQUIRE(nornsctl_slow_tasks(NULL, &nentries) == 
+                        NORNS_EBADARGS);
+            }
+        }
+
+        WHEN("no tasks are running") {
+
+            size_t nentries = 0;
+            norns_error_t rv = nornsctl_slow_tasks(NULL, &nentries);
+
+            THEN("no tasks are reported") {
+                REQUIRE(rv == NORNS_SUCCESS);
+                REQUIRE(nentries == 0);
+            }
+        }
+
+        WHEN("a running task makes no progress") {
+
+            norns_iotask_t task = 
+                NORNSCTL_IOTASK(NORNS_IOTASK_COPY, 
+                                NORNS_LOCAL_PATH(nsid0, src_file.c_str()), 
+                                NORNS_LOCAL_PATH(nsid1, dst_file.c_str()));
+
+            norns_error_t rv = nornsctl_submit(&task);
+            REQUIRE(rv == NORNS_SUCCESS);
+
+            norns_stat_t stats;
+
+            do {
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                rv = nornsctl_error(&task, &stats);
+                REQUIRE(rv == NORNS_SUCCESS);
+            } while(stats.st_status == NORNS_EPENDING);
+
+            REQUIRE(stats.st_status == NORNS_EINPROGRESS);
+
+            // leave time for at least one check after the stall timeout
+            std::this_thread::sleep_for(std::chrono::milliseconds(2500));
+
+            std::vector<nornsctl_slow_task_t> entries(4);
+            size_t nentries = entries.size();
+            rv = nornsctl_slow_tasks(entries.data(), &nentries);
+
+            THEN("the task is reported as stalled") {
+                REQUIRE(rv == NORNS_SUCCESS);
+                REQUIRE(nentries == 1);
+                REQUIRE(entries[0].sl_tid == task.t_id);
+                REQUIRE(entries[0].sl_reason == NORNSCTL_TASK_STALLED);
+                REQUIRE(entries[0].sl_sent_bytes == 0);
+                REQUIRE(entries[0].sl_idle >= 1.0);
+            }
+
+            rv = nornsctl_wait(&task, NULL);
+            REQUIRE(rv == NORNS_SUCCESS);
+        }
+
+        env.notify_success();
+    }
+
+#ifndef USE_REAL_DAEMON
+    GIVEN("a non-running urd instance") {
+        WHEN("requesting slow tasks") {
+            size_t nentries = 0;
+            norns_error_t rv = nornsctl_slow_tasks(NULL, &nentries);
+
+            THEN("NORNS_ECONNFAILED is returned") {
+                REQUIRE(rv == NORNS_ECONNFAILED);
+            }
+        }
+    }
+#endif
+}
@@ -0,0 +1,156 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <cmath>
+#include "nornsctl.h"
+#include "test-env.hpp"
+#include "catch.hpp"
+
+SCENARIO("estimate transfers", "[api::nornsctl_estimate_transfer]") {
+    GIVEN("a running urd instance") {
+
+        test_env env;
+
+        const char* nsid0 = "tmp0";
+        const char* nsid1 = "tmp1";
+        bfs::path src_mnt, dst_mnt;
+
+        // create namespaces
+        std::tie(std::ignore, src_mnt) = 
+            env.create_namespace(nsid0, "mnt/tmp0", 16384);
+        std::tie(std::ignore, dst_mnt) = 
+            env.create_namespace(nsid1, "mnt/tmp1", 16384);
+
+        // define input names
+        const bfs::path src_file = "/a/b/c/file";
+        const size_t src_file_size = 2*1024*1024;
+
+        // define output names
+        const bfs::path dst_file = "/b/c/d/file";
+
+        // create input data
+        env.add_to_namespace(nsid0, src_file, src_file_size);
+
+        WHEN("requesting an estimation with invalid arguments") {
+
+            nornsctl_estimate_t est;
+
+            THEN("NORNS_EBADARGS is returned") {
+                REQUIRE(nornsctl_estimate_transfer(NULL, nsid1, 1024, 1, 
+                                                   &est) == NORNS_EBADARGS);
+                REQUIRE(nornsctl_estimate_transfer(nsid0, NULL, 1024, 1, 
+                                                   &est) == NORNS_EBADARGS);
+                REQUIRE(nornsctl_estimate_transfer(nsid0, nsid1, 1024, 0, 
+                                                   &est) == NORNS_EBADARGS);
+                REQUIRE(nornsctl_estimate_transfer(nsid0, nsid1, 1024, 1, 
+                                                   NULL) == NORNS_EBADARGS);
+            }
+        }
+
+        WHEN("requesting an estimation before any transfer") {
+
+            nornsctl_estimate_t est;
+            norns_error_t rv = nornsctl_estimate_transfer(
+                    nsid0, nsid1, src_file_size, 1, &est);
+
+            THEN("no estimation is available") {
+                REQUIRE(rv == NORNS_SUCCESS);
+                REQUIRE(std::isnan(est.e_bandwidth));
+                REQUIRE(std::isnan(est.e_duration));
+                REQUIRE(est.e_backlog == 0.0);
+                REQUIRE(est.e_samples == 0);
+            }
+        }
+
+        WHEN("requesting an estimation after a transfer completes") {
+
+            norns_iotask_t task = 
+                NORNSCTL_IOTASK(NORNS_IOTASK_COPY, 
+                                NORNS_LOCAL_PATH(nsid0, src_file.c_str()), 
+                                NORNS_LOCAL_PATH(nsid1, dst_file.c_str()));
+
+            norns_error_t rv = nornsctl_submit(&task);
+            REQUIRE(rv == NORNS_SUCCESS);
+
+            rv = nornsctl_wait(&task, NULL);
+            REQUIRE(rv == NORNS_SUCCESS);
+
+            norns_stat_t stats;
+            rv = nornsctl_error(&task, &stats);
+            REQUIRE(rv == NORNS_SUCCESS);
+            REQUIRE(stats.st_status == NORNS_EFINISHED);
+
+            THEN("transfers of similar size are estimated from it") {
+                nornsctl_estimate_t est;
+                rv = nornsctl_estimate_transfer(nsid0, nsid1, 
+                                                src_file_size, 1, &est);
+
+                REQUIRE(rv == NORNS_SUCCESS);
+                REQUIRE(est.e_samples == 1);
+                REQUIRE(est.e_bandwidth > 0.0);
+                REQUIRE(est.e_duration > 0.0);
+                REQUIRE(est.e_backlog == 0.0);
+            }
+
+            THEN("transfers between other namespaces are not") {
+                nornsctl_estimate_t est;
+                rv = nornsctl_estimate_transfer(nsid1, nsid0, 
+                                                src_file_size, 1, &est);
+
+                REQUIRE(rv == NORNS_SUCCESS);
+                REQUIRE(std::isnan(est.e_duration));
+                REQUIRE(est.e_samples == 0);
+            }
+        }
+
+        env.notify_success();
+    }
+
+#ifndef USE_REAL_DAEMON
+    GIVEN("a non-running urd instance") {
+        WHEN("requesting an estimation") {
+            nornsctl_estimate_t est;
+            norns_error_t rv = 
+                nornsctl_estimate_transfer("tmp0", "tmp1", 1024, 1, &est);
+
+            THEN("NORNS_ECONNFAILED is returned") {
+                REQUIRE(rv == NORNS_ECONNFAILED);
+            }
+        }
+    }
+#endif
+}
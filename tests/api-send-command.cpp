@@ -37,6 +37,7 @@
 
 #include "norns.h"
 #include "nornsctl.h"
+#include <boost/filesystem/fstream.hpp>
 #include "test-env.hpp"
 #include "catch.hpp"
 
@@ -117,6 +118,47 @@ SCENARIO("send control commands to urd", "[api::nornsctl_send_command]") {
             }
         }
 
+        WHEN("a NORNSCTL_CMD_DUMP_TRACE command is sent") {
+
+            // submit a task so that there is something to trace
+            norns_iotask_t task = 
+                NORNS_IOTASK(NORNS_IOTASK_COPY, 
+                             NORNS_MEMORY_REGION((void*)0xdeadbeef, 42), 
+                             NORNS_LOCAL_PATH(nsid0, "foobar"));
+            REQUIRE(norns_submit(&task) == NORNS_SUCCESS);
+
+            const bfs::path trace_path = env.basedir() / "urd.trace.json";
+
+            norns_error_t rv = nornsctl_send_command(NORNSCTL_CMD_DUMP_TRACE, 
+                    const_cast<char*>(trace_path.c_str()));
+
+            THEN("nornsctl_send_command() returns NORNS_SUCCESS") {
+                REQUIRE(rv == NORNS_SUCCESS);
+
+                AND_THEN("the trace is written to the path provided") {
+                    bfs::ifstream in(trace_path);
+                    const std::string contents(
+                            (std::istreambuf_iterator<char>(in)), 
+                            std::istreambuf_iterator<char>());
+
+                    REQUIRE(contents.find("\"traceEvents\"") != 
+                            std::string::npos);
+                    REQUIRE(contents.find("\"enqueue\"") != 
+                            std::string::npos);
+                }
+            }
+        }
+
+        WHEN("a NORNSCTL_CMD_DUMP_TRACE command is sent without a path") {
+
+            norns_error_t rv = 
+                nornsctl_send_command(NORNSCTL_CMD_DUMP_TRACE, NULL);
+
+            THEN("nornsctl_send_command() returns NORNS_EBADARGS") {
+                REQUIRE(rv == NORNS_EBADARGS);
+            }
+        }
+
 #ifndef USE_REAL_DAEMON
         WHEN("a NORNSCTL_CMD_SHUTDOWN command is sent and there are no pending tasks") {
 
@@ -0,0 +1,211 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include "norns.h"
+#include "test-env.hpp"
+#include "catch.hpp"
+
+SCENARIO("cancel request", "[api::norns_cancel]") {
+    GIVEN("a running urd instance") {
+
+        test_env env(
+            fake_daemon_cfg {
+                true /* dry_run? */, 
+                500000 /* dry_run_duration (usecs) */
+            }
+        );
+
+        const char* nsid0 = "tmp0";
+        const char* nsid1 = "tmp1";
+        bfs::path src_mnt, dst_mnt;
+
+        // create namespaces
+        std::tie(std::ignore, src_mnt) = 
+            env.create_namespace(nsid0, "mnt/tmp0", 16384);
+        std::tie(std::ignore, dst_mnt) = 
+            env.create_namespace(nsid1, "mnt/tmp1", 16384);
+
+        // define input names
+        const bfs::path src_file = "/a/b/c/file";
+
+        // define output names
+        const bfs::path dst_file = "/b/c/d/file";
+
+        // create input data
+        env.add_to_namespace(nsid0, "/a/b/c/file", 4096);
+
+        /**********************************************************************/
+        /* tests for error conditions                                         */
+        /**********************************************************************/
+        WHEN("cancelling a NULL task") {
+
+            norns_error_t rv = norns_cancel(NULL);
+
+            THEN("NORNS_EBADARGS is returned") {
+                REQUIRE(rv == NORNS_EBADARGS);
+            }
+        }
+
+        WHEN("cancelling a task that has not been submitted") {
+
+            norns_iotask_t task = 
+                NORNS_IOTASK(NORNS_IOTASK_COPY, 
+                             NORNS_LOCAL_PATH(nsid0, src_file.c_str()), 
+                             NORNS_LOCAL_PATH(nsid1, dst_file.c_str()));
+
+            norns_error_t rv = norns_cancel(&task);
+
+            THEN("NORNS_EBADARGS is returned") {
+                REQUIRE(rv == NORNS_EBADARGS);
+            }
+        }
+
+        WHEN("cancelling a task that does not exist") {
+
+            norns_iotask_t task = 
+                NORNS_IOTASK(NORNS_IOTASK_COPY, 
+                             NORNS_LOCAL_PATH(nsid0, src_file.c_str()), 
+                             NORNS_LOCAL_PATH(nsid1, dst_file.c_str()));
+            task.t_id = 42;
+
+            norns_error_t rv = norns_cancel(&task);
+
+            THEN("NORNS_ENOSUCHTASK is returned") {
+                REQUIRE(rv == NORNS_ENOSUCHTASK);
+            }
+        }
+
+        /**********************************************************************/
+        /* tests for valid requests                                           */
+        /**********************************************************************/
+        WHEN("cancelling a pending task") {
+
+            // fill the runners with enough work so that the last task is 
+            // still waiting in the queue when we cancel it
+            const std::size_t ntasks = 4;
+            std::vector<norns_iotask_t> tasks;
+
+            for(std::size_t i = 0; i < ntasks; ++i) {
+                tasks.push_back(
+                    NORNS_IOTASK(NORNS_IOTASK_COPY, 
+                                 NORNS_LOCAL_PATH(nsid0, src_file.c_str()), 
+                                 NORNS_LOCAL_PATH(nsid1, dst_file.c_str())));
+
+                REQUIRE(norns_submit(&tasks.back()) == NORNS_SUCCESS);
+                REQUIRE(tasks.back().t_id != 0);
+            }
+
+            norns_iotask_t& task = tasks.back();
+            norns_error_t rv = norns_cancel(&task);
+
+            THEN("NORNS_SUCCESS is returned") {
+                REQUIRE(rv == NORNS_SUCCESS);
+
+                AND_THEN("the task finishes with NORNS_ETASKCANCELLED") {
+
+                    norns_stat_t stats;
+                    rv = norns_error(&task, &stats);
+
+                    REQUIRE(rv == NORNS_SUCCESS);
+                    REQUIRE(stats.st_status == NORNS_EFINISHEDWERROR);
+                    REQUIRE(stats.st_task_error == NORNS_ETASKCANCELLED);
+
+                    for(std::size_t i = 0; i < ntasks - 1; ++i) {
+                        REQUIRE(norns_wait(&tasks[i], NULL) == NORNS_SUCCESS);
+                    }
+                }
+            }
+        }
+
+        WHEN("cancelling a task that has already finished") {
+
+            norns_iotask_t task = 
+                NORNS_IOTASK(NORNS_IOTASK_COPY, 
+                             NORNS_LOCAL_PATH(nsid0, src_file.c_str()), 
+                             NORNS_LOCAL_PATH(nsid1, dst_file.c_str()));
+
+            REQUIRE(norns_submit(&task) == NORNS_SUCCESS);
+            REQUIRE(norns_wait(&task, NULL) == NORNS_SUCCESS);
+
+            norns_error_t rv = norns_cancel(&task);
+
+            THEN("NORNS_ETASKFINISHED is returned") {
+                // norns_wait() retrieved the final status of the task, 
+                // which allows the daemon to replace it with a tombstone
+                REQUIRE(rv == NORNS_ETASKFINISHED);
+            }
+        }
+
+        WHEN("cancelling a task that has already finished with an error") {
+
+            // as above, make sure that the last task is still pending when
+            // it's cancelled for the first time, so that it finishes with 
+            // NORNS_ETASKCANCELLED right away
+            const std::size_t ntasks = 4;
+            std::vector<norns_iotask_t> tasks;
+
+            for(std::size_t i = 0; i < ntasks; ++i) {
+                tasks.push_back(
+                    NORNS_IOTASK(NORNS_IOTASK_COPY, 
+                                 NORNS_LOCAL_PATH(nsid0, src_file.c_str()), 
+                                 NORNS_LOCAL_PATH(nsid1, dst_file.c_str())));
+
+                REQUIRE(norns_submit(&tasks.back()) == NORNS_SUCCESS);
+                REQUIRE(tasks.back().t_id != 0);
+            }
+
+            norns_iotask_t& task = tasks.back();
+            REQUIRE(norns_cancel(&task) == NORNS_SUCCESS);
+
+            norns_stat_t stats;
+            REQUIRE(norns_error(&task, &stats) == NORNS_SUCCESS);
+            REQUIRE(stats.st_status == NORNS_EFINISHEDWERROR);
+
+            norns_error_t rv = norns_cancel(&task);
+
+            THEN("NORNS_ETASKFINISHED is returned") {
+                REQUIRE(rv == NORNS_ETASKFINISHED);
+
+                for(std::size_t i = 0; i < ntasks - 1; ++i) {
+                    REQUIRE(norns_wait(&tasks[i], NULL) == NORNS_SUCCESS);
+                }
+            }
+        }
+
+        env.notify_success();
+    }
+}
@@ -0,0 +1,214 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include "norns.h"
+#include "test-env.hpp"
+#include "catch.hpp"
+
+SCENARIO("task dependencies", "[api::norns_submit]") {
+    GIVEN("a running urd instance") {
+
+        test_env env(
+            fake_daemon_cfg {
+                true /* dry_run? */, 
+                100000 /* dry_run_duration (usecs) */
+            }
+        );
+
+        const char* nsid0 = "tmp0";
+        const char* nsid1 = "tmp1";
+        bfs::path src_mnt, dst_mnt;
+
+        // create namespaces
+        std::tie(std::ignore, src_mnt) = 
+            env.create_namespace(nsid0, "mnt/tmp0", 16384);
+        std::tie(std::ignore, dst_mnt) = 
+            env.create_namespace(nsid1, "mnt/tmp1", 16384);
+
+        // define input names
+        const bfs::path src_file = "/a/b/c/file";
+
+        // define output names
+        const bfs::path dst_file = "/b/c/d/file";
+
+        // create input data
+        env.add_to_namespace(nsid0, "/a/b/c/file", 4096);
+
+        const auto make_task = [&]() {
+            return NORNS_IOTASK(NORNS_IOTASK_COPY, 
+                                NORNS_LOCAL_PATH(nsid0, src_file.c_str()), 
+                                NORNS_LOCAL_PATH(nsid1, dst_file.c_str()));
+        };
+
+        /**********************************************************************/
+        /* tests for error conditions                                         */
+        /**********************************************************************/
+        WHEN("submitting a task with parents but a NULL parent list") {
+
+            norns_iotask_t task = make_task();
+            task.t_nparents = 1;
+
+            norns_error_t rv = norns_submit(&task);
+
+            THEN("NORNS_EBADARGS is returned") {
+                REQUIRE(rv == NORNS_EBADARGS);
+            }
+        }
+
+        WHEN("submitting a task that depends on a non-existing task") {
+
+            const norns_tid_t parents[] = { 42 };
+
+            norns_iotask_t task = make_task();
+            task.t_parents = parents;
+            task.t_nparents = 1;
+
+            norns_error_t rv = norns_submit(&task);
+
+            THEN("NORNS_ENOSUCHTASK is returned") {
+                REQUIRE(rv == NORNS_ENOSUCHTASK);
+            }
+        }
+
+        /**********************************************************************/
+        /* tests for valid requests                                           */
+        /**********************************************************************/
+        WHEN("submitting a chain of dependent tasks") {
+
+            norns_iotask_t task0 = make_task();
+            REQUIRE(norns_submit(&task0) == NORNS_SUCCESS);
+
+            norns_iotask_t task1 = make_task();
+            task1.t_parents = &task0.t_id;
+            task1.t_nparents = 1;
+            REQUIRE(norns_submit(&task1) == NORNS_SUCCESS);
+
+            norns_iotask_t task2 = make_task();
+            task2.t_parents = &task1.t_id;
+            task2.t_nparents = 1;
+            REQUIRE(norns_submit(&task2) == NORNS_SUCCESS);
+
+            THEN("each task waits for its parent and all of them finish "
+                 "successfully") {
+
+                norns_stat_t stats;
+
+                REQUIRE(norns_error(&task2, &stats) == NORNS_SUCCESS);
+                REQUIRE(stats.st_status == NORNS_EPENDING);
+
+                REQUIRE(norns_wait(&task2, NULL) == NORNS_SUCCESS);
+                REQUIRE(norns_error(&task2, &stats) == NORNS_SUCCESS);
+                REQUIRE(stats.st_status == NORNS_EFINISHED);
+
+                // parents must have finished before task2 could start
+                for(norns_iotask_t* t : {&task0, &task1}) {
+                    REQUIRE(norns_error(t, &stats) == NORNS_SUCCESS);
+                    REQUIRE(stats.st_status == NORNS_EFINISHED);
+                }
+            }
+        }
+
+        WHEN("a task with dependents does not complete successfully") {
+
+            // keep the runner busy so that task0 is still pending when 
+            // we cancel it
+            norns_iotask_t busy = make_task();
+            REQUIRE(norns_submit(&busy) == NORNS_SUCCESS);
+
+            norns_iotask_t task0 = make_task();
+            REQUIRE(norns_submit(&task0) == NORNS_SUCCESS);
+
+            norns_iotask_t task1 = make_task();
+            task1.t_parents = &task0.t_id;
+            task1.t_nparents = 1;
+            REQUIRE(norns_submit(&task1) == NORNS_SUCCESS);
+
+            norns_iotask_t task2 = make_task();
+            const norns_tid_t parents[] = { busy.t_id, task1.t_id };
+            task2.t_parents = parents;
+            task2.t_nparents = 2;
+            REQUIRE(norns_submit(&task2) == NORNS_SUCCESS);
+
+            REQUIRE(norns_cancel(&task0) == NORNS_SUCCESS);
+
+            THEN("the failure propagates to all its dependents") {
+
+                norns_stat_t stats;
+
+                REQUIRE(norns_error(&task0, &stats) == NORNS_SUCCESS);
+                REQUIRE(stats.st_status == NORNS_EFINISHEDWERROR);
+                REQUIRE(stats.st_task_error == NORNS_ETASKCANCELLED);
+
+                for(norns_iotask_t* t : {&task1, &task2}) {
+                    REQUIRE(norns_error(t, &stats) == NORNS_SUCCESS);
+                    REQUIRE(stats.st_status == NORNS_EFINISHEDWERROR);
+                    REQUIRE(stats.st_task_error == NORNS_EDEPFAILED);
+                }
+
+                REQUIRE(norns_wait(&busy, NULL) == NORNS_SUCCESS);
+            }
+        }
+
+        WHEN("submitting a task whose parent has already failed") {
+
+            norns_iotask_t busy = make_task();
+            REQUIRE(norns_submit(&busy) == NORNS_SUCCESS);
+
+            norns_iotask_t task0 = make_task();
+            REQUIRE(norns_submit(&task0) == NORNS_SUCCESS);
+            REQUIRE(norns_cancel(&task0) == NORNS_SUCCESS);
+
+            norns_iotask_t task1 = make_task();
+            task1.t_parents = &task0.t_id;
+            task1.t_nparents = 1;
+            REQUIRE(norns_submit(&task1) == NORNS_SUCCESS);
+
+            THEN("the task fails without running") {
+
+                norns_stat_t stats;
+
+                REQUIRE(norns_error(&task1, &stats) == NORNS_SUCCESS);
+                REQUIRE(stats.st_status == NORNS_EFINISHEDWERROR);
+                REQUIRE(stats.st_task_error == NORNS_EDEPFAILED);
+
+                REQUIRE(norns_wait(&busy, NULL) == NORNS_SUCCESS);
+            }
+        }
+
+        env.notify_success();
+    }
+}
@@ -124,6 +124,11 @@ retry:
                             stats.st_status == NORNS_EFINISHED));
                 }
 
+                THEN("the task's byte counters are reported") {
+                    REQUIRE(stats.st_total == src_file_size);
+                    REQUIRE(stats.st_pending <= stats.st_total);
+                }
+
                 if(stats.st_status != NORNS_EFINISHED)
                     goto retry;
             }
@@ -0,0 +1,268 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+/* 
+ * Benchmark for the coalescing of small tasks in the urd task manager.
+ *
+ * Creates NUM_FILES files of FILE_SIZE bytes in a POSIX namespace and
+ * copies each one of them to another namespace with an individual copy 
+ * task, measuring the throughput (tasks/sec) achieved by the task manager 
+ * when:
+ *   - tasks are routed to the bulk lane, which runs them one by one 
+ *     (individual)
+ *   - tasks are routed to the small lane, which coalesces tasks between 
+ *     the same pair of namespaces (coalesced)
+ * Both lanes are configured with the same number of runners, and each 
+ * configuration is run three times, reporting the best result. As in urd,
+ * tasks log their progress to a file.
+ *
+ * Usage: bench_task_coalescing [NUM_FILES] [FILE_SIZE] [RUNNERS] [DIR]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+#include "backends/posix-fs.hpp"
+#include "resources/local_posix_path/local-path.hpp"
+#include "io/transferors/local-path-to-local-path.hpp"
+#include "io/task-manager.hpp"
+#include "io/task-info.hpp"
+#include "io/task-stats.hpp"
+#include "context.hpp"
+#include "logger.hpp"
+
+namespace {
+
+namespace bfs = boost::filesystem;
+using clock_type = std::chrono::steady_clock;
+
+std::string
+filename(std::size_t i) {
+    return "/file" + std::to_string(i);
+}
+
+void
+create_files(const bfs::path& dir, std::size_t nfiles, std::size_t size) {
+
+    const std::string data(size, 'x');
+
+    bfs::create_directories(dir);
+
+    for(std::size_t i = 0; i < nfiles; ++i) {
+        std::ofstream ofs((dir.string() + filename(i)).c_str(), 
+                          std::ios::binary);
+        ofs.write(data.data(), data.size());
+    }
+}
+
+double 
+run(const bfs::path& src_dir, const bfs::path& dst_dir, 
+    std::size_t nfiles, uint32_t nrunners, bool coalesce) {
+
+    using norns::iotask_id;
+    using norns::iotask_type;
+    using norns::io::task_status;
+
+    bfs::remove_all(dst_dir);
+    bfs::create_directories(dst_dir);
+
+    // tasks are routed to the small lane only if their size is below the 
+    // small task threshold
+    auto task_mgr = std::make_shared<norns::io::task_manager>(
+            nrunners, nrunners, nrunners, /* bulk runners */
+            nrunners, /* small runners */
+            coalesce ? std::numeric_limits<uint64_t>::max() : 0, 
+            128, /* bandwidth backlog */
+            0, 0, /* don't reap finished tasks */
+            false, 0 /* dry run, duration */);
+
+    const norns::context ctx(dst_dir, nullptr);
+
+    task_mgr->register_transfer_plugin(
+            norns::data::resource_type::local_posix_path,
+            norns::data::resource_type::local_posix_path,
+            std::make_shared<norns::io::local_path_to_local_path_transferor>(
+                ctx));
+
+    const std::vector<std::shared_ptr<norns::storage::backend>> backend_ptrs{
+        std::make_shared<norns::storage::posix_filesystem>(
+                "src://", false, src_dir, 0),
+        std::make_shared<norns::storage::posix_filesystem>(
+                "dst://", false, dst_dir, 0)
+    };
+
+    const norns::auth::credentials creds;
+
+    std::vector<std::vector<std::shared_ptr<norns::data::resource_info>>> 
+        rinfo_ptrs;
+    rinfo_ptrs.reserve(nfiles);
+
+    for(std::size_t i = 0; i < nfiles; ++i) {
+        rinfo_ptrs.push_back({
+            std::make_shared<norns::data::local_path_info>(
+                    "src://", filename(i)),
+            std::make_shared<norns::data::local_path_info>(
+                    "dst://", filename(i))
+        });
+    }
+
+    std::vector<iotask_id> tids;
+    tids.reserve(nfiles);
+
+    norns::urd_error rv;
+    boost::optional<norns::io::generic_task> tsk;
+
+    const auto t0 = clock_type::now();
+
+    for(std::size_t i = 0; i < nfiles; ++i) {
+
+        std::tie(rv, tsk) = task_mgr->create_local_initiated_task(
+                iotask_type::copy, creds, backend_ptrs, rinfo_ptrs[i]);
+
+        if(rv != norns::urd_error::success) {
+            std::fprintf(stderr, "Failed to create task: %s\n", 
+                         norns::utils::to_string(rv).c_str());
+            std::exit(EXIT_FAILURE);
+        }
+
+        tids.push_back(tsk->id());
+        task_mgr->enqueue_task(std::move(*tsk));
+        tsk = boost::none;
+    }
+
+    std::size_t nerrors = 0;
+
+    for(const auto tid : tids) {
+        for(;;) {
+            const auto tinfo = task_mgr->find(tid);
+
+            if(tinfo->status() == task_status::finished) {
+                break;
+            }
+
+            if(tinfo->status() == task_status::finished_with_error) {
+                ++nerrors;
+                break;
+            }
+
+            std::this_thread::yield();
+        }
+    }
+
+    const double elapsed = 
+        std::chrono::duration<double>(clock_type::now() - t0).count();
+
+    task_mgr->stop_all_tasks();
+
+    if(nerrors != 0) {
+        std::fprintf(stderr, "%zu tasks failed\n", nerrors);
+        std::exit(EXIT_FAILURE);
+    }
+
+    return nfiles / elapsed;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+
+    std::size_t nfiles = 100000;
+    std::size_t size = 4096;
+    uint32_t nrunners = 4;
+    bfs::path dir = bfs::temp_directory_path() / 
+                    bfs::unique_path("bench-task-coalescing-%%%%-%%%%");
+
+    if(argc > 1) {
+        nfiles = std::strtoul(argv[1], nullptr, 10);
+    }
+
+    if(argc > 2) {
+        size = std::strtoul(argv[2], nullptr, 10);
+    }
+
+    if(argc > 3) {
+        nrunners = std::strtoul(argv[3], nullptr, 10);
+    }
+
+    if(argc > 4) {
+        dir = argv[4];
+    }
+
+    if(nfiles == 0 || nrunners == 0) {
+        std::fprintf(stderr, 
+                "Usage: %s [NUM_FILES] [FILE_SIZE] [RUNNERS] [DIR]\n", 
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    create_files(dir / "src", nfiles, size);
+
+    // log to a file as urd does when configured with a log file, since 
+    // logging is part of the per-task cost
+    logger::create_global_logger("bench", "file", dir / "bench.log");
+
+    // both modes are run alternately and the best result of each is kept
+    // to reduce the noise introduced by the file system
+    double individual = 0.0;
+    double coalesced = 0.0;
+
+    for(int i = 0; i < 3; ++i) {
+        individual = std::max(individual,
+                run(dir / "src", dir / "dst", nfiles, nrunners, false));
+        coalesced = std::max(coalesced,
+                run(dir / "src", dir / "dst", nfiles, nrunners, true));
+    }
+
+    logger::destroy_global_logger();
+    bfs::remove_all(dir);
+
+    std::printf("files: %zu, size: %zu bytes, runners: %u\n", 
+                nfiles, size, nrunners);
+    std::printf("individual: %.0f tasks/sec\n", individual);
+    std::printf("coalesced:  %.0f tasks/sec (%.2fx)\n", 
+                coalesced, coalesced / individual);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,238 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+/* 
+ * Micro-benchmark for the task submission path of the urd task manager.
+ *
+ * Creates and enqueues a large number of tasks from a single thread (as the 
+ * API listener does) using a task_manager in dry-run mode, so that tasks 
+ * complete immediately, and measures for the submitting thread:
+ *   - heap allocations per submitted task, both while the task manager is 
+ *     warming up and once it has reached a steady state
+ *   - latency of create_local_initiated_task() + enqueue_task() 
+ *     (p50 / p99 / max)
+ *
+ * Completed tasks are erased once the submitter is WINDOW tasks ahead of 
+ * them (as urd does when a client retrieves their final status), so that 
+ * their memory can be recycled.
+ *
+ * Usage: bench_task_submission [NUM_TASKS] [WINDOW]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "backends/process-memory.hpp"
+#include "resources/memory_buffer/memory-buffer.hpp"
+#include "io/task-manager.hpp"
+#include "io/task-info.hpp"
+#include "io/task-stats.hpp"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+// allocations performed by the current thread while counting is enabled
+thread_local bool tl_counting = false;
+thread_local std::size_t tl_allocations = 0;
+
+} // anonymous namespace
+
+void* operator new(std::size_t size) {
+
+    if(tl_counting) {
+        ++tl_allocations;
+    }
+
+    if(void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+// N.B: operator delete must not be inlined, otherwise GCC complains about
+// free() being called on memory obtained from operator new
+__attribute__((noinline)) void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+__attribute__((noinline)) void operator delete(void* ptr, 
+                                               std::size_t /*size*/) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+
+struct result {
+    double m_warmup_allocs_per_task;
+    double m_steady_allocs_per_task;
+    double m_p50_usecs;
+    double m_p99_usecs;
+    double m_max_usecs;
+};
+
+result run(std::size_t ntasks, std::size_t window) {
+
+    using norns::iotask_id;
+    using norns::iotask_type;
+    using norns::io::task_status;
+
+    auto task_mgr = std::make_shared<norns::io::task_manager>(
+            2, 2, 2, /* bulk runners */
+            2, 16*1024*1024, /* small runners and threshold */
+            128, /* bandwidth backlog */
+            0, 0, /* don't reap finished tasks */
+            true, 0 /* dry run, duration */);
+
+    int buffer[1024];
+    const std::vector<std::shared_ptr<norns::storage::backend>> backend_ptrs{
+        std::make_shared<norns::storage::detail::process_memory>("mem://")
+    };
+    const std::vector<std::shared_ptr<norns::data::resource_info>> rinfo_ptrs{
+        std::make_shared<norns::data::memory_region_info>(
+                reinterpret_cast<uint64_t>(buffer), sizeof(buffer))
+    };
+    const norns::auth::credentials creds;
+
+    std::vector<iotask_id> tids(ntasks);
+    std::vector<std::size_t> allocations(ntasks);
+    std::vector<double> latencies(ntasks);
+
+    norns::urd_error rv;
+    boost::optional<norns::io::generic_task> tsk;
+
+    for(std::size_t i = 0; i < ntasks; ++i) {
+
+        const auto t0 = clock_type::now();
+
+        tl_allocations = 0;
+        tl_counting = true;
+
+        std::tie(rv, tsk) = task_mgr->create_local_initiated_task(
+                iotask_type::remove, creds, backend_ptrs, rinfo_ptrs);
+
+        if(rv != norns::urd_error::success) {
+            tl_counting = false;
+            std::fprintf(stderr, "Failed to create task: %s\n", 
+                         norns::utils::to_string(rv).c_str());
+            std::exit(EXIT_FAILURE);
+        }
+
+        tids[i] = tsk->id();
+        task_mgr->enqueue_task(std::move(*tsk));
+        tsk = boost::none;
+
+        tl_counting = false;
+
+        latencies[i] = std::chrono::duration<double, std::micro>(
+                clock_type::now() - t0).count();
+        allocations[i] = tl_allocations;
+
+        // retire old tasks so that their resources can be reused
+        if(i >= window) {
+            const iotask_id old_tid = tids[i - window];
+
+            for(;;) {
+                const auto tinfo = task_mgr->find(old_tid);
+
+                if(tinfo->status() == task_status::finished ||
+                   tinfo->status() == task_status::finished_with_error) {
+                    break;
+                }
+
+                std::this_thread::yield();
+            }
+
+            task_mgr->erase(old_tid);
+        }
+    }
+
+    task_mgr->stop_all_tasks();
+
+    const std::size_t nwarmup = std::min(window, ntasks);
+    const std::size_t warmup_allocs = std::accumulate(
+            allocations.begin(), allocations.begin() + nwarmup, 0ul);
+    const std::size_t steady_allocs = std::accumulate(
+            allocations.begin() + nwarmup, allocations.end(), 0ul);
+
+    std::sort(latencies.begin(), latencies.end());
+
+    return { static_cast<double>(warmup_allocs) / nwarmup,
+             ntasks > nwarmup ? 
+                static_cast<double>(steady_allocs) / (ntasks - nwarmup) : 0.0,
+             latencies[ntasks / 2],
+             latencies[std::min(ntasks - 1, (ntasks * 99) / 100)],
+             latencies.back() };
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+
+    std::size_t ntasks = 200000;
+    std::size_t window = 1024;
+
+    if(argc > 1) {
+        ntasks = std::strtoul(argv[1], nullptr, 10);
+    }
+
+    if(argc > 2) {
+        window = std::strtoul(argv[2], nullptr, 10);
+    }
+
+    if(ntasks == 0 || window == 0) {
+        std::fprintf(stderr, "Usage: %s [NUM_TASKS] [WINDOW]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const result r = run(ntasks, window);
+
+    std::printf("tasks: %zu, window: %zu\n", ntasks, window);
+    std::printf("allocations per task: %.2f (warm-up), %.2f (steady state)\n",
+                r.m_warmup_allocs_per_task, r.m_steady_allocs_per_task);
+    std::printf("submission latency (usec): p50 %.2f, p99 %.2f, max %.2f\n",
+                r.m_p50_usecs, r.m_p99_usecs, r.m_max_usecs);
+
+    return EXIT_SUCCESS;
+}
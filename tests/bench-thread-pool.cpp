@@ -0,0 +1,210 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+/* 
+ * Micro-benchmark for the urd worker pool.
+ *
+ * Compares the work-stealing pool in io/thread-pool/thread-pool.hpp against
+ * the previous design (a single queue protected by a mutex and a condition 
+ * variable, reproduced below as 'single_queue_pool') by submitting a large
+ * number of tiny tasks from a thread outside the pool (as the API listener 
+ * does) and measuring:
+ *   - throughput: tasks completed per second
+ *   - submit-to-start latency: time elapsed between a task being submitted
+ *     and a worker starting to execute it (p50 / p99 / max)
+ *
+ * Usage: bench_thread_pool [NUM_TASKS] [MAX_WORKERS]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "io/thread-pool/thread-pool.hpp"
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+/* the pool as it was before introducing work stealing */
+class single_queue_pool {
+
+    template <typename Callable>
+    struct task : public detail::task {
+        explicit task(Callable&& func) : m_func(std::move(func)) {}
+        void execute() override { m_func(); }
+        Callable m_func;
+    };
+
+public:
+    explicit single_queue_pool(const uint32_t num_threads)
+        : m_done(false) {
+        for(uint32_t i = 0; i < num_threads; ++i) {
+            m_threads.emplace_back(&single_queue_pool::worker, this);
+        }
+    }
+
+    ~single_queue_pool() {
+        m_done = true;
+        m_work_queue.invalidate();
+
+        for(auto& th : m_threads) {
+            th.join();
+        }
+    }
+
+    template <typename Callable>
+    void submit_and_forget(Callable&& func) {
+        m_work_queue.push(
+            std::make_unique<task<Callable>>(std::forward<Callable>(func)));
+    }
+
+private:
+    void worker() {
+        while(!m_done) {
+            std::unique_ptr<detail::task> task_ptr;
+
+            if(m_work_queue.wait_pop(task_ptr)) {
+                task_ptr->execute();
+            }
+        }
+    }
+
+    std::atomic<bool> m_done;
+    queue<std::unique_ptr<detail::task>> m_work_queue;
+    std::vector<std::thread> m_threads;
+};
+
+struct result {
+    double m_tasks_per_sec;
+    double m_p50_usecs;
+    double m_p99_usecs;
+    double m_max_usecs;
+};
+
+template <typename Pool>
+result run(uint32_t nworkers, std::size_t ntasks) {
+
+    std::vector<clock_type::time_point> submitted(ntasks);
+    std::vector<clock_type::time_point> started(ntasks);
+    std::atomic<std::size_t> completed{0};
+
+    clock_type::time_point t0, t1;
+
+    {
+        Pool runners(nworkers);
+
+        // let workers reach their idle state
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+        t0 = clock_type::now();
+
+        for(std::size_t i = 0; i < ntasks; ++i) {
+            submitted[i] = clock_type::now();
+
+            runners.submit_and_forget([i, &started, &completed]() {
+                started[i] = clock_type::now();
+                ++completed;
+            });
+        }
+
+        while(completed.load() < ntasks) {
+            std::this_thread::yield();
+        }
+
+        t1 = clock_type::now();
+    }
+
+    std::vector<double> latencies(ntasks);
+
+    for(std::size_t i = 0; i < ntasks; ++i) {
+        latencies[i] = std::chrono::duration<double, std::micro>(
+                started[i] - submitted[i]).count();
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+
+    const double elapsed = std::chrono::duration<double>(t1 - t0).count();
+
+    return { ntasks / elapsed,
+             latencies[ntasks / 2],
+             latencies[std::min(ntasks - 1, (ntasks * 99) / 100)],
+             latencies.back() };
+}
+
+void print(const char* name, uint32_t nworkers, const result& r) {
+    std::printf("%-14s %8u %14.0f %12.2f %12.2f %12.2f\n",
+                name, nworkers, r.m_tasks_per_sec, 
+                r.m_p50_usecs, r.m_p99_usecs, r.m_max_usecs);
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+
+    std::size_t ntasks = 200000;
+    uint32_t max_workers = 64;
+
+    if(argc > 1) {
+        ntasks = std::strtoul(argv[1], nullptr, 10);
+    }
+
+    if(argc > 2) {
+        max_workers = std::strtoul(argv[2], nullptr, 10);
+    }
+
+    if(ntasks == 0 || max_workers == 0) {
+        std::fprintf(stderr, "Usage: %s [NUM_TASKS] [MAX_WORKERS]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::printf("%-14s %8s %14s %12s %12s %12s\n", 
+                "pool", "workers", "tasks/sec", 
+                "p50 (usec)", "p99 (usec)", "max (usec)");
+
+    for(uint32_t nworkers = 1; nworkers <= max_workers; nworkers *= 2) {
+        print("single-queue", nworkers, 
+              run<single_queue_pool>(nworkers, ntasks));
+        print("work-stealing", nworkers, run<pool>(nworkers, ntasks));
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,253 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+/* 
+ * Benchmark for the io_uring path of local directory copies.
+ *
+ * Creates NUM_FILES files of FILE_SIZE bytes in a directory of a POSIX 
+ * namespace and copies the whole directory to another namespace with a 
+ * single copy task, measuring the throughput (files/sec) achieved when:
+ *   - each file is copied with blocking syscalls (synchronous)
+ *   - the files are copied in batches that keep QUEUE_DEPTH of them in 
+ *     flight through io_uring (io_uring)
+ * Both configurations use the same copy fanout, and each one is run three 
+ * times, reporting the best result. If io_uring is not available (e.g. 
+ * norns was built without liburing) only the synchronous path is measured.
+ *
+ * Usage: bench_uring_copy [NUM_FILES] [FILE_SIZE] [QUEUE_DEPTH] [DIR]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+#include "backends/posix-fs.hpp"
+#include "resources/local_posix_path/local-path.hpp"
+#include "io/transferors/local-path-to-local-path.hpp"
+#include "io/uring-copier.hpp"
+#include "io/task-manager.hpp"
+#include "io/task-info.hpp"
+#include "io/task-stats.hpp"
+#include "context.hpp"
+#include "logger.hpp"
+
+namespace {
+
+namespace bfs = boost::filesystem;
+using clock_type = std::chrono::steady_clock;
+
+// same as the daemon's defaults
+constexpr uint64_t copy_chunk_size = 256*1024*1024;
+constexpr uint32_t copy_fanout = 4;
+
+void
+create_files(const bfs::path& dir, std::size_t nfiles, std::size_t size) {
+
+    const std::string data(size, 'x');
+
+    bfs::create_directories(dir);
+
+    for(std::size_t i = 0; i < nfiles; ++i) {
+        std::ofstream ofs((dir / ("file" + std::to_string(i))).c_str(), 
+                          std::ios::binary);
+        ofs.write(data.data(), data.size());
+    }
+}
+
+double 
+run(const bfs::path& src_dir, const bfs::path& dst_dir, 
+    std::size_t nfiles, uint32_t queue_depth) {
+
+    using norns::iotask_type;
+    using norns::io::task_status;
+
+    bfs::remove_all(dst_dir);
+    bfs::create_directories(dst_dir);
+
+    auto task_mgr = std::make_shared<norns::io::task_manager>(
+            1, 1, 1, /* bulk runners */
+            1, /* small runners */
+            0, /* no small tasks */
+            128, /* bandwidth backlog */
+            0, 0, /* don't reap finished tasks */
+            false, 0 /* dry run, duration */);
+
+    const norns::context ctx(dst_dir, nullptr, nullptr, copy_chunk_size, 
+                             copy_fanout, queue_depth);
+
+    task_mgr->register_transfer_plugin(
+            norns::data::resource_type::local_posix_path,
+            norns::data::resource_type::local_posix_path,
+            std::make_shared<norns::io::local_path_to_local_path_transferor>(
+                ctx));
+
+    const std::vector<std::shared_ptr<norns::storage::backend>> backend_ptrs{
+        std::make_shared<norns::storage::posix_filesystem>(
+                "src://", false, src_dir.parent_path(), 0),
+        std::make_shared<norns::storage::posix_filesystem>(
+                "dst://", false, dst_dir, 0)
+    };
+
+    const norns::auth::credentials creds;
+
+    const std::vector<std::shared_ptr<norns::data::resource_info>> rinfo_ptrs{
+        std::make_shared<norns::data::local_path_info>(
+                "src://", "/" + src_dir.filename().string()),
+        std::make_shared<norns::data::local_path_info>(
+                "dst://", "/")
+    };
+
+    norns::urd_error rv;
+    boost::optional<norns::io::generic_task> tsk;
+
+    const auto t0 = clock_type::now();
+
+    std::tie(rv, tsk) = task_mgr->create_local_initiated_task(
+            iotask_type::copy, creds, backend_ptrs, rinfo_ptrs);
+
+    if(rv != norns::urd_error::success) {
+        std::fprintf(stderr, "Failed to create task: %s\n", 
+                     norns::utils::to_string(rv).c_str());
+        std::exit(EXIT_FAILURE);
+    }
+
+    const auto tid = tsk->id();
+    task_mgr->enqueue_task(std::move(*tsk));
+
+    task_status status;
+
+    for(;;) {
+        status = task_mgr->find(tid)->status();
+
+        if(status == task_status::finished || 
+           status == task_status::finished_with_error) {
+            break;
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+
+    const double elapsed = 
+        std::chrono::duration<double>(clock_type::now() - t0).count();
+
+    task_mgr->stop_all_tasks();
+
+    if(status == task_status::finished_with_error) {
+        std::fprintf(stderr, "Copy task failed\n");
+        std::exit(EXIT_FAILURE);
+    }
+
+    return nfiles / elapsed;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[]) {
+
+    std::size_t nfiles = 20000;
+    std::size_t size = 4096;
+    uint32_t queue_depth = 64;
+    bfs::path dir = bfs::temp_directory_path() / 
+                    bfs::unique_path("bench-uring-copy-%%%%-%%%%");
+
+    if(argc > 1) {
+        nfiles = std::strtoul(argv[1], nullptr, 10);
+    }
+
+    if(argc > 2) {
+        size = std::strtoul(argv[2], nullptr, 10);
+    }
+
+    if(argc > 3) {
+        queue_depth = std::strtoul(argv[3], nullptr, 10);
+    }
+
+    if(argc > 4) {
+        dir = argv[4];
+    }
+
+    if(nfiles == 0 || queue_depth == 0) {
+        std::fprintf(stderr, 
+                "Usage: %s [NUM_FILES] [FILE_SIZE] [QUEUE_DEPTH] [DIR]\n", 
+                argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    create_files(dir / "src", nfiles, size);
+
+    logger::create_global_logger("bench", "file", dir / "bench.log");
+
+    const bool have_uring = norns::io::uring_copier::available();
+
+    // both modes are run alternately and the best result of each is kept
+    // to reduce the noise introduced by the file system
+    double synchronous = 0.0;
+    double uring = 0.0;
+
+    for(int i = 0; i < 3; ++i) {
+        synchronous = std::max(synchronous,
+                run(dir / "src", dir / "dst", nfiles, 0));
+
+        if(have_uring) {
+            uring = std::max(uring,
+                    run(dir / "src", dir / "dst", nfiles, queue_depth));
+        }
+    }
+
+    logger::destroy_global_logger();
+    bfs::remove_all(dir);
+
+    std::printf("files: %zu, size: %zu bytes, queue depth: %u\n", 
+                nfiles, size, queue_depth);
+    std::printf("synchronous: %.0f files/sec\n", synchronous);
+
+    if(have_uring) {
+        std::printf("io_uring:    %.0f files/sec (%.2fx)\n", 
+                    uring, uring / synchronous);
+    }
+    else {
+        std::printf("io_uring:    not available\n");
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,175 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <string>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <config.h>
+
+#ifdef HAVE_WORKING_STD_REGEX
+
+#include <regex>
+namespace RE = std;
+
+#else // !HAVE_WORKING_STD_REGEX
+
+#include <boost/regex.hpp>
+namespace RE = boost;
+
+#endif // HAVE_WORKING_STD_REGEX
+
+#include "config/settings.hpp"
+#include "config-template.hpp"
+#include "catch.hpp"
+
+namespace bfs = boost::filesystem;
+
+namespace {
+
+using replacement_list = 
+    std::vector<
+        std::pair<std::string, std::string>>;
+
+// write a configuration file generated from the default one, where the 
+// value of each global setting in 'reps' has been replaced
+bfs::path
+write_config_file(const replacement_list& reps = replacement_list()) {
+
+    std::string contents = config_file::cftemplate;
+
+    for(const auto& r : reps) {
+        contents = RE::regex_replace(contents, 
+                        RE::regex("(\\n\\s*" + r.first + ":)[^,\\n]*"), 
+                        "$1 " + r.second);
+    }
+
+    const bfs::path filename = 
+        bfs::temp_directory_path() / bfs::unique_path("test-%%%%%%%%.conf");
+
+    bfs::ofstream outf(filename);
+    outf << contents;
+    outf.close();
+
+    return filename;
+}
+
+} // anonymous namespace
+
+SCENARIO("configuration file parsing", "[config::settings]") {
+
+    GIVEN("the default configuration file") {
+
+        const bfs::path filename = write_config_file();
+
+        WHEN("it is loaded") {
+
+            norns::config::settings cfg;
+
+            THEN("it is accepted") {
+                REQUIRE_NOTHROW(cfg.load_from_file(filename));
+                REQUIRE(cfg.small_task_workers() == 2);
+                REQUIRE(cfg.io_uring_queue_depth() == 0);
+            }
+        }
+
+        bfs::remove(filename);
+    }
+
+    GIVEN("a configuration file with 'small_task_workers: 0'") {
+
+        const bfs::path filename = 
+            write_config_file({{"small_task_workers", "0"}});
+
+        WHEN("it is loaded") {
+
+            norns::config::settings cfg;
+
+            THEN("std::invalid_argument is thrown") {
+                REQUIRE_THROWS_AS(cfg.load_from_file(filename), 
+                                  std::invalid_argument);
+            }
+        }
+
+        bfs::remove(filename);
+    }
+
+    GIVEN("a configuration file with 'small_task_workers: 3'") {
+
+        const bfs::path filename = 
+            write_config_file({{"small_task_workers", "3"}});
+
+        WHEN("it is loaded") {
+
+            norns::config::settings cfg;
+            cfg.load_from_file(filename);
+
+            THEN("the value is used") {
+                REQUIRE(cfg.small_task_workers() == 3);
+            }
+        }
+
+        bfs::remove(filename);
+    }
+
+    GIVEN("a configuration file with options that are disabled with 0") {
+
+        const bfs::path filename = 
+            write_config_file({{"finished_task_ttl", "0"}, 
+                               {"max_finished_tasks", "0"},
+                               {"trace_buffer_size", "0"},
+                               {"watchdog_interval", "0"}});
+
+        WHEN("it is loaded") {
+
+            norns::config::settings cfg;
+
+            THEN("it is accepted") {
+                REQUIRE_NOTHROW(cfg.load_from_file(filename));
+                REQUIRE(cfg.finished_task_ttl() == 0);
+                REQUIRE(cfg.max_finished_tasks() == 0);
+                REQUIRE(cfg.trace_buffer_size() == 0);
+                REQUIRE(cfg.watchdog_interval() == 0);
+            }
+        }
+
+        bfs::remove(filename);
+    }
+}
@@ -58,8 +58,26 @@ const norns::config::settings fake_daemon::default_cfg(
     42002, /* remote port */
     "./test_urd.pid", /* daemon_pidfile */
     2, /* api workers */
+    2, /* min api workers */
+    2, /* max api workers */
+    1, /* small task workers */
+    16*1024*1024, /* small task threshold */
     "./tmp/", /* staging directory */
     128,
+    {}, /* bandwidth model (not persisted) */
+    600, /* finished task ttl */
+    100000, /* max finished tasks */
+    {}, /* metrics socket (disabled) */
+    {}, /* metrics textfile (disabled) */
+    15, /* metrics interval */
+    8192, /* trace buffer size */
+    true, /* lock profiling */
+    1, /* watchdog interval */
+    1, /* stall timeout */
+    10, /* slow task threshold */
+    1024*1024, /* copy chunk size */
+    4, /* copy fanout */
+    32, /* io_uring queue depth */
     "./",
     {}
 );
@@ -0,0 +1,120 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <cmath>
+#include "io/concurrency-controller.hpp"
+#include "catch.hpp"
+
+using norns::io::concurrency_controller;
+
+namespace {
+
+// synthetic aggregate throughput that peaks at 'best' workers
+double 
+throughput_model(uint32_t level, uint32_t best) {
+    const double d = static_cast<double>(level) - best;
+    return 1000.0 / (1.0 + 0.1 * d * d);
+}
+
+} // anonymous namespace
+
+SCENARIO("concurrency controller", "[io::concurrency_controller]") {
+
+    GIVEN("a controller with equal bounds") {
+
+        concurrency_controller ctl(4, 4, 4);
+
+        THEN("it never changes the concurrency level") {
+            REQUIRE(!ctl.enabled());
+
+            for(int i = 0; i < 100; ++i) {
+                REQUIRE(ctl.update(100.0 * i) == 4);
+            }
+        }
+    }
+
+    GIVEN("a controller with bounds [1, 32] starting at 2") {
+
+        concurrency_controller ctl(1, 32, 2);
+
+        REQUIRE(ctl.enabled());
+        REQUIRE(ctl.level() == 2);
+
+        WHEN("the best throughput is achieved with 12 workers") {
+
+            for(int i = 0; i < 200; ++i) {
+                ctl.update(throughput_model(ctl.level(), 12));
+            }
+
+            THEN("the controller stays around 12 workers") {
+                // it keeps probing its neighbours from time to time
+                REQUIRE(ctl.level() >= 11);
+                REQUIRE(ctl.level() <= 13);
+            }
+        }
+
+        WHEN("the workload changes and the optimum moves to 4 workers") {
+
+            for(int i = 0; i < 200; ++i) {
+                ctl.update(throughput_model(ctl.level(), 12));
+            }
+
+            for(int i = 0; i < 500; ++i) {
+                ctl.update(throughput_model(ctl.level(), 4));
+            }
+
+            THEN("the controller follows the new optimum") {
+                REQUIRE(ctl.level() >= 3);
+                REQUIRE(ctl.level() <= 5);
+            }
+        }
+    }
+
+    GIVEN("a controller whose throughput always increases") {
+
+        concurrency_controller ctl(2, 8, 2);
+
+        for(int i = 0; i < 100; ++i) {
+            ctl.update(100.0 * ctl.level());
+        }
+
+        THEN("it never exceeds the upper bound") {
+            REQUIRE(ctl.level() >= 7);
+            REQUIRE(ctl.level() <= 8);
+        }
+    }
+}
@@ -0,0 +1,234 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+#include "backends/posix-fs.hpp"
+#include "resources/local_posix_path/local-path.hpp"
+#include "io/transferors/local-path-to-local-path.hpp"
+#include "io/task-manager.hpp"
+#include "io/task-info.hpp"
+#include "io/task-stats.hpp"
+#include "context.hpp"
+#include "catch.hpp"
+
+namespace bfs = boost::filesystem;
+
+using norns::io::task_status;
+
+namespace {
+
+std::vector<char>
+make_contents(std::size_t size) {
+
+    // not a repeating block, so that misplaced blocks are detected
+    std::vector<char> data(size);
+
+    for(std::size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<char>((i * 31 + i / 4096) % 251);
+    }
+
+    return data;
+}
+
+void
+write_file(const bfs::path& name, const std::vector<char>& data) {
+    std::ofstream ofs(name.c_str(), std::ios::binary);
+    ofs.write(data.data(), data.size());
+}
+
+std::vector<char>
+read_file(const bfs::path& name) {
+    std::ifstream ifs(name.c_str(), std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(ifs), 
+                             std::istreambuf_iterator<char>());
+}
+
+// copy 'src_dir/name' to 'dst_dir/name' with a task whose destination 
+// namespace is configured for direct I/O, returning the task's final 
+// status
+task_status
+direct_copy(const bfs::path& src_dir, const bfs::path& dst_dir, 
+            const std::string& name, uint64_t copy_chunk_size, 
+            uint32_t copy_fanout) {
+
+    auto task_mgr = std::make_shared<norns::io::task_manager>(
+            1, 1, 1, /* bulk runners */
+            1, /* small runners */
+            0, /* no small tasks */
+            128, /* bandwidth backlog */
+            0, 0, /* don't reap finished tasks */
+            false, 0 /* dry run, duration */);
+
+    task_mgr->add_direct_io("dst://");
+
+    const norns::context ctx(dst_dir, nullptr, nullptr, copy_chunk_size, 
+                             copy_fanout);
+
+    task_mgr->register_transfer_plugin(
+            norns::data::resource_type::local_posix_path,
+            norns::data::resource_type::local_posix_path,
+            std::make_shared<norns::io::local_path_to_local_path_transferor>(
+                ctx));
+
+    const std::vector<std::shared_ptr<norns::storage::backend>> backend_ptrs{
+        std::make_shared<norns::storage::posix_filesystem>(
+                "src://", false, src_dir, 0),
+        std::make_shared<norns::storage::posix_filesystem>(
+                "dst://", false, dst_dir, 0)
+    };
+
+    const std::vector<std::shared_ptr<norns::data::resource_info>> rinfo_ptrs{
+        std::make_shared<norns::data::local_path_info>("src://", "/" + name),
+        std::make_shared<norns::data::local_path_info>("dst://", "/" + name)
+    };
+
+    norns::urd_error rv;
+    boost::optional<norns::io::generic_task> tsk;
+
+    std::tie(rv, tsk) = task_mgr->create_local_initiated_task(
+            norns::iotask_type::copy, norns::auth::credentials(), 
+            backend_ptrs, rinfo_ptrs);
+
+    REQUIRE(rv == norns::urd_error::success);
+
+    const auto task_info_ptr = tsk->info();
+    REQUIRE(task_info_ptr->direct_io());
+
+    task_mgr->enqueue_task(std::move(*tsk));
+
+    task_status status;
+
+    for(;;) {
+        status = task_info_ptr->status();
+
+        if(status == task_status::finished || 
+           status == task_status::finished_with_error) {
+            break;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    task_mgr->stop_all_tasks();
+
+    return status;
+}
+
+} // anonymous namespace
+
+SCENARIO("copies that bypass the page cache", "[io::direct_io]") {
+
+    GIVEN("a file whose size is not a multiple of the block size") {
+
+        // not on the temporary directory, which may be a tmpfs that 
+        // doesn't support O_DIRECT
+        const bfs::path base_dir = bfs::absolute(
+                bfs::unique_path("io-direct-copy-%%%%-%%%%"));
+        const bfs::path src_dir = base_dir / "src";
+        const bfs::path dst_dir = base_dir / "dst";
+
+        bfs::create_directories(src_dir);
+        bfs::create_directories(dst_dir);
+
+        // several O_DIRECT buffers (4 MiB), plus a partial block
+        const std::size_t size = 9*1024*1024 + 12345;
+        const auto contents = make_contents(size);
+        write_file(src_dir / "file0", contents);
+
+        // a single, partial, block
+        const std::size_t small_size = 1000;
+        const auto small_contents = make_contents(small_size);
+        write_file(src_dir / "file1", small_contents);
+
+        WHEN("it is copied sequentially") {
+
+            const auto status = 
+                direct_copy(src_dir, dst_dir, "file0", 0, 1);
+
+            THEN("the copy has the same size and contents") {
+                REQUIRE(status == task_status::finished);
+                REQUIRE(bfs::file_size(dst_dir / "file0") == size);
+                REQUIRE(read_file(dst_dir / "file0") == contents);
+            }
+        }
+
+        WHEN("it is copied with idle helper threads") {
+
+            const auto status = 
+                direct_copy(src_dir, dst_dir, "file0", 0, 4);
+
+            THEN("the copy has the same size and contents") {
+                REQUIRE(status == task_status::finished);
+                REQUIRE(bfs::file_size(dst_dir / "file0") == size);
+                REQUIRE(read_file(dst_dir / "file0") == contents);
+            }
+        }
+
+        WHEN("it is copied in parallel ranges") {
+
+            const auto status = 
+                direct_copy(src_dir, dst_dir, "file0", 2*1024*1024, 4);
+
+            THEN("the copy has the same size and contents") {
+                REQUIRE(status == task_status::finished);
+                REQUIRE(bfs::file_size(dst_dir / "file0") == size);
+                REQUIRE(read_file(dst_dir / "file0") == contents);
+            }
+        }
+
+        WHEN("a file smaller than a block is copied") {
+
+            const auto status = 
+                direct_copy(src_dir, dst_dir, "file1", 0, 4);
+
+            THEN("the copy has the same size and contents") {
+                REQUIRE(status == task_status::finished);
+                REQUIRE(bfs::file_size(dst_dir / "file1") == small_size);
+                REQUIRE(read_file(dst_dir / "file1") == small_contents);
+            }
+        }
+
+        bfs::remove_all(base_dir);
+    }
+}
@@ -0,0 +1,187 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "io/rate-limiter.hpp"
+#include "catch.hpp"
+
+using norns::io::token_bucket;
+using norns::io::rate_limiter;
+using norns::io::rate_limit_registry;
+
+namespace {
+
+double 
+elapsed_secs(const std::chrono::steady_clock::time_point& start) {
+    return std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+}
+
+} // anonymous namespace
+
+SCENARIO("token bucket", "[io::token_bucket]") {
+
+    GIVEN("a token bucket with a rate of 1MiB/s and a burst of 1MiB") {
+
+        const uint64_t rate = 1024*1024;
+        token_bucket bucket(rate, rate);
+
+        WHEN("a request smaller than the burst is made") {
+
+            const auto start = std::chrono::steady_clock::now();
+            bucket.consume(rate / 2);
+
+            THEN("it is served immediately") {
+                REQUIRE(elapsed_secs(start) < 0.1);
+            }
+        }
+
+        WHEN("requests exceeding the burst are made") {
+
+            const auto start = std::chrono::steady_clock::now();
+
+            // 1MiB served from the burst + 0.5MiB at 1MiB/s
+            for(int i = 0; i < 6; ++i) {
+                bucket.consume(rate / 4);
+            }
+
+            THEN("the caller is blocked until enough tokens are available") {
+                const auto secs = elapsed_secs(start);
+                REQUIRE(secs >= 0.45);
+                REQUIRE(secs < 1.5);
+            }
+        }
+    }
+
+    GIVEN("a token bucket without a rate") {
+
+        token_bucket bucket(0, 0);
+
+        WHEN("a large request is made") {
+
+            const auto start = std::chrono::steady_clock::now();
+            bucket.consume(1ul << 40);
+
+            THEN("it is served immediately") {
+                REQUIRE(elapsed_secs(start) < 0.1);
+            }
+        }
+    }
+}
+
+SCENARIO("rate limit registry", "[io::rate_limit_registry]") {
+
+    GIVEN("a registry without limits") {
+
+        rate_limit_registry registry;
+
+        WHEN("a rate_limiter is requested") {
+
+            const auto limiter = registry.get("tmp0", "lustre0");
+
+            THEN("it is disabled") {
+                REQUIRE(!limiter.enabled());
+                REQUIRE(limiter.chunk_size() == 0);
+            }
+        }
+    }
+
+    GIVEN("a registry with namespace and pair limits") {
+
+        rate_limit_registry registry;
+        registry.add("lustre0", 100*1024*1024);
+        registry.add("tmp0", "lustre0", 10*1024*1024);
+
+        WHEN("a rate_limiter for an unrelated pair is requested") {
+
+            const auto limiter = registry.get("tmp0", "tmp1");
+
+            THEN("it is disabled") {
+                REQUIRE(!limiter.enabled());
+            }
+        }
+
+        WHEN("a rate_limiter for a transfer involving a limited namespace "
+             "is requested") {
+
+            const auto limiter = registry.get("tmp1", "lustre0");
+
+            THEN("it is enabled") {
+                REQUIRE(limiter.enabled());
+                REQUIRE(limiter.chunk_size() > 0);
+            }
+        }
+
+        WHEN("a rate_limiter for a limited pair is requested") {
+
+            const auto pair_limiter = registry.get("tmp0", "lustre0");
+            const auto ns_limiter = registry.get("tmp1", "lustre0");
+
+            THEN("chunks are sized according to the most restrictive "
+                 "limit") {
+                REQUIRE(pair_limiter.enabled());
+                REQUIRE(pair_limiter.chunk_size() < ns_limiter.chunk_size());
+            }
+        }
+
+        WHEN("several threads share a limited pair") {
+
+            const auto start = std::chrono::steady_clock::now();
+            std::vector<std::thread> threads;
+
+            // 10MiB served from the burst + 5MiB at 10MiB/s
+            for(int i = 0; i < 3; ++i) {
+                threads.emplace_back([&]() {
+                    const auto limiter = registry.get("tmp0", "lustre0");
+                    for(int j = 0; j < 5; ++j) {
+                        limiter.consume(1024*1024);
+                    }
+                });
+            }
+
+            for(auto& t : threads) {
+                t.join();
+            }
+
+            THEN("the aggregated bandwidth is limited") {
+                REQUIRE(elapsed_secs(start) >= 0.45);
+            }
+        }
+    }
+}
@@ -0,0 +1,564 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <cmath>
+#include <boost/filesystem.hpp>
+#include <algorithm>
+#include <boost/filesystem/fstream.hpp>
+#include "io/task-info.hpp"
+#include "io/task-stats.hpp"
+#include "io/stats-registry.hpp"
+#include "backends/posix-fs.hpp"
+#include "resources/local_posix_path/local-path.hpp"
+#include "catch.hpp"
+
+namespace bfs = boost::filesystem;
+
+using norns::io::stats_registry;
+using norns::io::pair_stats;
+using norns::io::task_info;
+using norns::io::task_status;
+
+namespace {
+
+constexpr std::size_t MiB = 1024*1024;
+
+std::shared_ptr<task_info>
+make_task_info(norns::iotask_id tid, 
+               const std::shared_ptr<stats_registry>& registry,
+               const boost::optional<norns::iotask_deadline>& deadline = 
+                    boost::none) {
+    return std::make_shared<task_info>(
+            tid, norns::iotask_type::noop, false, norns::auth::credentials(),
+            nullptr, nullptr, nullptr, nullptr, boost::any(), 
+            norns::iotask_priority::normal, deadline, 
+            norns::io::rate_limiter(), std::vector<norns::iotask_id>(), 
+            norns::utils::numa::no_node, false, registry);
+}
+
+// task copying between two (non-existing) namespaces "src0" and "dst0"
+std::shared_ptr<task_info>
+make_copy_task_info(norns::iotask_id tid, 
+                    const std::shared_ptr<stats_registry>& registry) {
+
+    const auto src_backend = 
+        std::make_shared<norns::storage::posix_filesystem>(
+            "src0", false, "/non/existing/src0", 0);
+    const auto dst_backend = 
+        std::make_shared<norns::storage::posix_filesystem>(
+            "dst0", false, "/non/existing/dst0", 0);
+
+    return std::make_shared<task_info>(
+            tid, norns::iotask_type::copy, false, norns::auth::credentials(),
+            src_backend, 
+            std::make_shared<norns::data::local_path_info>("src0", "/file"),
+            dst_backend,
+            std::make_shared<norns::data::local_path_info>("dst0", "/file"),
+            boost::any(), norns::iotask_priority::normal, boost::none, 
+            norns::io::rate_limiter(), std::vector<norns::iotask_id>(), 
+            norns::utils::numa::no_node, false, registry);
+}
+
+uint64_t
+running_bytes(const pair_stats& ps) {
+    uint64_t bytes = 0;
+    for(const auto& b : ps.m_running_bytes) {
+        bytes += b.load();
+    }
+    return bytes;
+}
+
+uint64_t
+queued_bytes(const pair_stats& ps) {
+    uint64_t bytes = 0;
+    for(const auto& b : ps.m_queued_bytes) {
+        bytes += b.load();
+    }
+    return bytes;
+}
+
+} // anonymous namespace
+
+SCENARIO("size classes", "[io::size_class]") {
+
+    using norns::io::size_class;
+
+    REQUIRE(size_class(0) == 0);
+    REQUIRE(size_class(64*1024 - 1) == 0);
+    REQUIRE(size_class(64*1024) == 1);
+    REQUIRE(size_class(MiB - 1) == 1);
+    REQUIRE(size_class(MiB) == 2);
+    REQUIRE(size_class(16*MiB) == 3);
+    REQUIRE(size_class(256*MiB) == 4);
+    REQUIRE(size_class(std::size_t(64)*1024*MiB) == 4);
+}
+
+SCENARIO("namespace pair stats", "[io::pair_stats]") {
+
+    GIVEN("pair stats with a backlog of 4 samples") {
+
+        pair_stats ps(4);
+
+        THEN("no estimation is available") {
+            REQUIRE(std::isnan(ps.predict(MiB)));
+            REQUIRE(std::isnan(ps.bandwidth(2)));
+            REQUIRE(ps.backlog() == 0.0);
+        }
+
+        WHEN("a few large transfers are recorded") {
+            ps.record_transfer(1024*MiB, 1024.0 / 100.0);
+            ps.record_transfer(1024*MiB, 1024.0 / 200.0);
+
+            THEN("the average of the samples is returned") {
+                REQUIRE(ps.bandwidth(4) == Approx(150.0));
+                REQUIRE(ps.model().m_samples[4] == 2);
+            }
+
+            AND_WHEN("more samples are recorded") {
+                ps.record_transfer(1024*MiB, 1024.0 / 300.0);
+
+                THEN("they are averaged with exponentially decaying "
+                     "weights") {
+                    REQUIRE(ps.bandwidth(4) == Approx(150.0 + 0.4 * 150.0));
+                }
+            }
+
+            THEN("estimations for other sizes use the nearest class") {
+                REQUIRE(ps.bandwidth(2) == Approx(150.0));
+                REQUIRE(ps.predict(300*MiB) == Approx(2.0));
+                REQUIRE(ps.predict(32*MiB) == Approx(32.0 / 150.0));
+            }
+        }
+
+        WHEN("both small and large transfers are recorded") {
+
+            ps.record_transfer(512*MiB, 2.0);
+
+            for(int i = 0; i < 10; ++i) {
+                ps.record_transfer(4096, 0.01);
+                ps.record_transfer(2*MiB, 0.01 + 2.0 / 64.0);
+            }
+
+            THEN("small transfers don't affect the bandwidth of large ones") {
+                REQUIRE(ps.bandwidth(4) == Approx(256.0));
+                REQUIRE(ps.predict(512*MiB) == Approx(0.01 + 2.0).epsilon(0.01));
+            }
+
+            THEN("the per-task overhead is estimated") {
+                REQUIRE(ps.model().m_overhead == Approx(0.01).epsilon(0.01));
+                REQUIRE(ps.bandwidth(2) == Approx(64.0).epsilon(0.01));
+            }
+
+            THEN("the overhead is accounted once per task") {
+                REQUIRE(ps.predict(100*4096, 100) == 
+                        Approx(100 * 0.01).epsilon(0.01));
+                REQUIRE(ps.predict(10*2*MiB, 10) == 
+                        Approx(10 * (0.01 + 2.0 / 64.0)).epsilon(0.01));
+            }
+        }
+    }
+
+    GIVEN("pair stats with a backlog of 0 samples") {
+
+        pair_stats ps(0);
+
+        WHEN("transfers are recorded") {
+            ps.record_transfer(512*MiB, 2.0);
+
+            THEN("they are ignored") {
+                REQUIRE(std::isnan(ps.predict(512*MiB)));
+            }
+        }
+    }
+}
+
+SCENARIO("bandwidth model persistence", "[io::stats_registry]") {
+
+    GIVEN("a stats registry with some bandwidth models") {
+
+        const auto registry = std::make_shared<stats_registry>(16);
+        const bfs::path path = 
+            bfs::temp_directory_path() / bfs::unique_path();
+
+        registry->get("src0", "dst0")->record_transfer(512*MiB, 2.0);
+        registry->get("src0", "dst0")->record_transfer(4096, 0.01);
+        registry->get("src0", "dst1")->record_transfer(32*MiB, 0.25);
+
+        WHEN("the models are saved and loaded into another registry") {
+
+            REQUIRE(!registry->save_models(path.string()));
+
+            const auto other = std::make_shared<stats_registry>(16);
+            REQUIRE(!other->load_models(path.string()));
+
+            THEN("the models are the same") {
+                for(const auto& dst : {"dst0", "dst1"}) {
+                    const auto m1 = registry->get("src0", dst)->model();
+                    const auto m2 = other->find("src0", dst)->model();
+
+                    REQUIRE(m1.m_overhead_samples == m2.m_overhead_samples);
+                    REQUIRE(m1.m_samples == m2.m_samples);
+
+                    if(m1.m_overhead_samples != 0) {
+                        REQUIRE(m1.m_overhead == m2.m_overhead);
+                    }
+
+                    for(std::size_t sc = 0; 
+                        sc < norns::io::num_size_classes; ++sc) {
+                        if(m1.m_samples[sc] != 0) {
+                            REQUIRE(m1.m_bandwidth[sc] == m2.m_bandwidth[sc]);
+                        }
+                    }
+                }
+
+                REQUIRE(other->get("src0", "dst0")->predict(512*MiB) == 
+                        Approx(registry->get("src0", "dst0")->predict(512*MiB)));
+            }
+
+            bfs::remove(path);
+        }
+
+        WHEN("models for nsids with special characters are saved and "
+             "loaded into another registry") {
+
+            const std::string src_nsid = "#src 0";
+            const std::string dst_nsid = "dst\t1\\ \n";
+
+            registry->get(src_nsid, dst_nsid)->record_transfer(32*MiB, 0.25);
+
+            REQUIRE(!registry->save_models(path.string()));
+
+            const auto other = std::make_shared<stats_registry>(16);
+            REQUIRE(!other->load_models(path.string()));
+
+            THEN("the nsids are preserved") {
+                REQUIRE(other->find(src_nsid, dst_nsid) != nullptr);
+                REQUIRE(other->find("src0", "dst0") != nullptr);
+                REQUIRE(other->find("src0", "dst1") != nullptr);
+
+                REQUIRE(other->get(src_nsid, dst_nsid)->predict(32*MiB) ==
+                        Approx(registry->get(src_nsid, dst_nsid)
+                                    ->predict(32*MiB)));
+            }
+
+            bfs::remove(path);
+        }
+
+        WHEN("a corrupted file is loaded") {
+
+            bfs::ofstream out(path);
+            out << "src0 dst0 0.01 1 nan 0\n";
+            out.close();
+
+            const auto other = std::make_shared<stats_registry>(16);
+            const auto ec = other->load_models(path.string());
+
+            THEN("an error is returned and nothing is loaded") {
+                REQUIRE(ec == std::errc::invalid_argument);
+                REQUIRE(other->find("src0", "dst0") == nullptr);
+            }
+
+            bfs::remove(path);
+        }
+
+        WHEN("a non-existing file is loaded") {
+
+            const auto ec = registry->load_models(path.string());
+
+            THEN("ENOENT is returned") {
+                REQUIRE(ec == std::errc::no_such_file_or_directory);
+            }
+        }
+    }
+}
+
+SCENARIO("task stats registry", "[io::stats_registry]") {
+
+    GIVEN("a stats registry") {
+
+        const auto registry = std::make_shared<stats_registry>(16);
+
+        WHEN("tasks are created") {
+
+            auto t1 = make_task_info(1, registry);
+            auto t2 = make_task_info(2, registry);
+            auto t3 = make_task_info(3, registry, 
+                    std::chrono::system_clock::now() + 
+                    std::chrono::seconds(60));
+
+            THEN("they are accounted as pending") {
+                REQUIRE(registry->pending_tasks() == 3);
+                REQUIRE(registry->running_tasks() == 0);
+                REQUIRE(registry->tasks_with_deadline() == 1);
+                REQUIRE(registry->eta() == 0.0);
+            }
+
+            AND_WHEN("they change their status") {
+
+                t1->update_status(task_status::running);
+                t3->update_status(task_status::running);
+
+                THEN("the counters reflect it") {
+                    REQUIRE(registry->pending_tasks() == 1);
+                    REQUIRE(registry->running_tasks() == 2);
+                }
+
+                t3->update_status(task_status::finished_with_error, 
+                                  norns::urd_error::system_error, 
+                                  std::error_code());
+
+                THEN("finished tasks are no longer accounted as active") {
+                    REQUIRE(registry->pending_tasks() == 1);
+                    REQUIRE(registry->running_tasks() == 1);
+                    REQUIRE(registry->finished_tasks() == 1);
+                    REQUIRE(registry->tasks_with_deadline() == 0);
+                }
+
+                AND_WHEN("finished tasks are destroyed") {
+
+                    t3.reset();
+
+                    THEN("they are no longer accounted") {
+                        REQUIRE(registry->pending_tasks() == 1);
+                        REQUIRE(registry->running_tasks() == 1);
+                        REQUIRE(registry->finished_tasks() == 0);
+                        REQUIRE(registry->tasks_with_deadline() == 0);
+                    }
+                }
+            }
+
+            AND_WHEN("unfinished tasks are destroyed") {
+
+                t1->update_status(task_status::running);
+                t1.reset();
+                t2.reset();
+
+                THEN("they are no longer accounted") {
+                    REQUIRE(registry->pending_tasks() == 1);
+                    REQUIRE(registry->running_tasks() == 0);
+                    REQUIRE(registry->finished_tasks() == 0);
+                }
+            }
+        }
+
+        WHEN("a task between two namespaces is running") {
+
+            auto t = make_copy_task_info(1, registry);
+            const auto ps = registry->get("src0", "dst0");
+
+            REQUIRE(t->pair_stats() == ps);
+
+            t->set_total_bytes(100*MiB);
+            t->update_status(task_status::running);
+
+            THEN("its bytes are pending for the pair") {
+                REQUIRE(ps->m_running_tasks == 1);
+                REQUIRE(running_bytes(*ps) == 100*MiB);
+                REQUIRE(queued_bytes(*ps) == 0);
+            }
+
+            THEN("the ETA can't be estimated until bandwidth is known") {
+                REQUIRE(std::isnan(registry->eta()));
+            }
+
+            AND_WHEN("bandwidth samples are available") {
+
+                ps->record_transfer(100*MiB, 1.0);
+
+                THEN("the ETA is estimated from them") {
+                    REQUIRE(registry->eta() == Approx(1.0));
+                }
+
+                AND_WHEN("the task makes progress") {
+
+                    t->record_progress(50*MiB);
+
+                    THEN("the ETA is updated") {
+                        REQUIRE(running_bytes(*ps) == 50*MiB);
+                        REQUIRE(registry->eta() == Approx(0.5));
+                    }
+                }
+
+                AND_WHEN("other tasks are pending") {
+
+                    auto t2 = make_copy_task_info(2, registry);
+                    t2->set_total_bytes(100*MiB);
+
+                    // tasks stay in the size class they were queued in
+                    THEN("they are included in the ETA") {
+                        REQUIRE(ps->m_queued_tasks[0] == 1);
+                        REQUIRE(queued_bytes(*ps) == 100*MiB);
+                        REQUIRE(registry->eta() == Approx(2.0));
+                    }
+                }
+            }
+
+            AND_WHEN("its total size changes while running") {
+
+                t->record_progress(10*MiB);
+                t->set_total_bytes(200*MiB);
+
+                THEN("the pending bytes are updated") {
+                    REQUIRE(running_bytes(*ps) == 190*MiB);
+                }
+            }
+
+            AND_WHEN("the task transfers more than expected and finishes") {
+
+                t->record_progress(150*MiB);
+                REQUIRE(running_bytes(*ps) == 0);
+
+                t->update_status(task_status::finished);
+                t->record_progress(10*MiB);
+
+                THEN("the pair has no pending bytes") {
+                    REQUIRE(ps->m_running_tasks == 0);
+                    REQUIRE(running_bytes(*ps) == 0);
+                    REQUIRE(registry->eta() == 0.0);
+                }
+            }
+
+            AND_WHEN("the task finishes before transferring everything") {
+
+                t->record_progress(30*MiB);
+                t->update_status(task_status::finished_with_error, 
+                                 norns::urd_error::system_error, 
+                                 std::error_code());
+
+                THEN("the pair has no pending bytes") {
+                    REQUIRE(ps->m_running_tasks == 0);
+                    REQUIRE(running_bytes(*ps) == 0);
+                }
+            }
+        }
+    }
+}
+
+SCENARIO("task latency statistics", "[io::stats_registry]") {
+
+    using norns::io::latency_phase;
+    using norns::io::latency_stats;
+    using norns::io::task_phase;
+
+    const auto find = [](const std::vector<latency_stats>& lstats, 
+                         latency_stats::scope sc, const std::string& name,
+                         latency_phase phase) {
+        return std::find_if(lstats.begin(), lstats.end(), 
+                [&](const latency_stats& ls) {
+                    return ls.get_scope() == sc && ls.name() == name && 
+                           ls.phase() == phase;
+                });
+    };
+
+    GIVEN("a stats registry") {
+
+        const auto registry = std::make_shared<stats_registry>(16);
+
+        WHEN("no tasks have finished") {
+
+            auto t = make_copy_task_info(1, registry);
+            t->mark(task_phase::dequeued);
+            t->update_status(task_status::running);
+
+            THEN("no latencies are reported") {
+                REQUIRE(registry->latencies().empty());
+            }
+        }
+
+        WHEN("a task finishes after going through all its phases") {
+
+            auto t = make_copy_task_info(1, registry);
+            t->mark(task_phase::dequeued);
+            t->update_status(task_status::running);
+            t->mark(task_phase::resolved);
+            t->mark(task_phase::started);
+            t->update_status(task_status::finished);
+
+            const auto lstats = registry->latencies();
+
+            THEN("all phases are reported for its type and its pair") {
+                for(const auto phase : { latency_phase::queued, 
+                                         latency_phase::resolve, 
+                                         latency_phase::setup, 
+                                         latency_phase::transfer, 
+                                         latency_phase::total }) {
+
+                    auto it = find(lstats, latency_stats::scope::task_type, 
+                                   "DATA_COPY", phase);
+                    REQUIRE(it != lstats.end());
+                    REQUIRE(it->count() == 1);
+                    REQUIRE(it->p50() <= it->max());
+
+                    it = find(lstats, latency_stats::scope::ns_pair, 
+                              "src0 => dst0", phase);
+                    REQUIRE(it != lstats.end());
+                    REQUIRE(it->count() == 1);
+                }
+            }
+
+            THEN("the total latency spans all other phases") {
+                const auto total = find(lstats, 
+                        latency_stats::scope::task_type, "DATA_COPY", 
+                        latency_phase::total);
+                const auto transfer = find(lstats, 
+                        latency_stats::scope::task_type, "DATA_COPY", 
+                        latency_phase::transfer);
+
+                REQUIRE(total->max() >= transfer->max());
+            }
+        }
+
+        WHEN("a task finishes without being dequeued") {
+
+            auto t = make_task_info(1, registry);
+            t->update_status(task_status::finished_with_error, 
+                             norns::urd_error::system_error, 
+                             std::error_code());
+
+            const auto lstats = registry->latencies();
+
+            THEN("only its total latency is reported") {
+                REQUIRE(lstats.size() == 1);
+                REQUIRE(lstats[0].get_scope() == 
+                        latency_stats::scope::task_type);
+                REQUIRE(lstats[0].name() == "NOOP");
+                REQUIRE(lstats[0].phase() == latency_phase::total);
+                REQUIRE(lstats[0].count() == 1);
+            }
+        }
+    }
+}
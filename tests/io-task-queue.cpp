@@ -0,0 +1,228 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <chrono>
+#include <vector>
+#include "io/task-info.hpp"
+#include "io/task-queue.hpp"
+#include "io/task.hpp"
+#include "catch.hpp"
+
+namespace {
+
+norns::io::generic_task
+make_task(norns::iotask_id tid, 
+          norns::iotask_priority priority,
+          const boost::optional<norns::iotask_deadline>& deadline = 
+            boost::none) {
+
+    using norns::io::task_info;
+    using norns::iotask_type;
+
+    auto info = std::make_shared<task_info>(
+            tid, iotask_type::noop, false, norns::auth::credentials(), 
+            nullptr, nullptr, nullptr, nullptr, boost::any(), 
+            priority, deadline);
+
+    return norns::io::generic_task(iotask_type::noop, 
+            norns::io::task<iotask_type::noop>(std::move(info), 0));
+}
+
+} // anonymous namespace
+
+SCENARIO("task queue ordering", "[io::task_queue]") {
+
+    using norns::iotask_priority;
+    using clock = std::chrono::system_clock;
+
+    GIVEN("an empty task queue") {
+
+        norns::io::task_queue queue;
+
+        REQUIRE(queue.empty());
+        REQUIRE(!queue.pop());
+
+        WHEN("tasks with different priorities are pushed") {
+
+            queue.push(make_task(1, iotask_priority::low));
+            queue.push(make_task(2, iotask_priority::urgent));
+            queue.push(make_task(3, iotask_priority::normal));
+            queue.push(make_task(4, iotask_priority::high));
+
+            THEN("they are popped in decreasing priority order") {
+                REQUIRE(queue.size() == 4);
+                REQUIRE(queue.pop()->id() == 2);
+                REQUIRE(queue.pop()->id() == 4);
+                REQUIRE(queue.pop()->id() == 3);
+                REQUIRE(queue.pop()->id() == 1);
+                REQUIRE(queue.empty());
+            }
+        }
+
+        WHEN("tasks with the same priority and different deadlines are "
+             "pushed") {
+
+            const auto now = clock::now();
+
+            queue.push(make_task(1, iotask_priority::normal));
+            queue.push(make_task(2, iotask_priority::normal, 
+                                 now + std::chrono::seconds(30)));
+            queue.push(make_task(3, iotask_priority::normal, 
+                                 now + std::chrono::seconds(10)));
+            queue.push(make_task(4, iotask_priority::normal));
+
+            THEN("the earliest deadline goes first and tasks without a "
+                 "deadline keep their FIFO order") {
+
+                const auto snapshot = queue.snapshot();
+                REQUIRE(snapshot.size() == 4);
+                REQUIRE(snapshot[0]->id() == 3);
+                REQUIRE(snapshot[1]->id() == 2);
+                REQUIRE(snapshot[2]->id() == 1);
+                REQUIRE(snapshot[3]->id() == 4);
+
+                REQUIRE(queue.pop()->id() == 3);
+                REQUIRE(queue.pop()->id() == 2);
+                REQUIRE(queue.pop()->id() == 1);
+                REQUIRE(queue.pop()->id() == 4);
+            }
+        }
+
+        WHEN("a high priority task without deadline and a low priority task "
+             "with a deadline are pushed") {
+
+            queue.push(make_task(1, iotask_priority::low, clock::now()));
+            queue.push(make_task(2, iotask_priority::high));
+
+            THEN("priority takes precedence over the deadline") {
+                REQUIRE(queue.pop()->id() == 2);
+                REQUIRE(queue.pop()->id() == 1);
+            }
+        }
+
+        WHEN("a batch of tasks is popped") {
+
+            const auto now = clock::now();
+
+            REQUIRE(queue.push(make_task(1, iotask_priority::normal)));
+            REQUIRE(queue.push(make_task(2, iotask_priority::normal)));
+            REQUIRE(queue.push(make_task(3, iotask_priority::high)));
+            REQUIRE(queue.push(make_task(4, iotask_priority::normal)));
+            REQUIRE(queue.push(make_task(5, iotask_priority::normal,
+                                         now + std::chrono::seconds(10))));
+            REQUIRE(queue.push(make_task(6, iotask_priority::normal)));
+            REQUIRE(queue.push(make_task(7, iotask_priority::normal)));
+            REQUIRE(queue.push(make_task(8, iotask_priority::normal)));
+
+            // scheduling order is 3, 5, 1, 2, 4, 6, 7, 8: task 6 can't be
+            // coalesced with the tasks before it
+            const auto can_coalesce = 
+                [](const norns::io::generic_task& /*head*/, 
+                   const norns::io::generic_task& other) {
+                    return other.id() != 6;
+                };
+
+            std::vector<norns::io::generic_task> batch;
+
+            THEN("tasks that follow the head in scheduling order are "
+                 "coalesced, up to the limit") {
+
+                // task 5 has a deadline and is therefore scheduled alone
+                REQUIRE(queue.pop_batch(batch, 8, can_coalesce) == 1);
+                REQUIRE(batch.size() == 1);
+                REQUIRE(batch[0].id() == 3);
+                REQUIRE(queue.pop_batch(batch, 8, can_coalesce) == 1);
+                REQUIRE(batch.size() == 2);
+                REQUIRE(batch[1].id() == 5);
+
+                batch.clear();
+
+                REQUIRE(queue.pop_batch(batch, 2, can_coalesce) == 2);
+                REQUIRE(batch[0].id() == 1);
+                REQUIRE(batch[1].id() == 2);
+
+                batch.clear();
+
+                // the batch stops before task 6
+                REQUIRE(queue.pop_batch(batch, 8, can_coalesce) == 1);
+                REQUIRE(batch[0].id() == 4);
+
+                REQUIRE(queue.size() == 3);
+                REQUIRE(queue.pop()->id() == 6);
+                REQUIRE(queue.pop()->id() == 7);
+                REQUIRE(queue.pop()->id() == 8);
+            }
+
+            THEN("runner notifications left without work are reused") {
+
+                REQUIRE(queue.pop_batch(batch, 8, can_coalesce) == 1);
+                REQUIRE(queue.pop_batch(batch, 8, can_coalesce) == 1);
+                REQUIRE(queue.pop_batch(batch, 8, can_coalesce) == 3);
+                REQUIRE(queue.pop_batch(batch, 8, can_coalesce) == 3);
+                REQUIRE(queue.empty());
+
+                // four notifications are now pending without a task: the 
+                // first one consumes its credit finding nothing, and the 
+                // other three are reused by newly pushed tasks
+                REQUIRE(!queue.pop());
+                REQUIRE(!queue.push(make_task(9, iotask_priority::normal)));
+                REQUIRE(!queue.push(make_task(10, iotask_priority::normal)));
+                REQUIRE(!queue.push(make_task(11, iotask_priority::normal)));
+                REQUIRE(queue.push(make_task(12, iotask_priority::normal)));
+            }
+        }
+
+        WHEN("a queued task is removed") {
+
+            queue.push(make_task(1, iotask_priority::normal));
+            queue.push(make_task(2, iotask_priority::high));
+            queue.push(make_task(3, iotask_priority::low));
+
+            REQUIRE(queue.remove(2));
+
+            THEN("it is no longer popped and the remaining tasks keep "
+                 "their order") {
+                REQUIRE(queue.size() == 2);
+                REQUIRE(!queue.remove(2));
+                REQUIRE(!queue.remove(42));
+                REQUIRE(queue.pop()->id() == 1);
+                REQUIRE(queue.pop()->id() == 3);
+                REQUIRE(queue.empty());
+            }
+        }
+    }
+}
@@ -0,0 +1,264 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "io/task-info.hpp"
+#include "io/task-stats.hpp"
+#include "io/task-table.hpp"
+#include "catch.hpp"
+
+using norns::io::task_table;
+using norns::io::task_info;
+using norns::io::task_status;
+
+namespace {
+
+std::shared_ptr<task_info>
+make_task_info(norns::iotask_id tid) {
+    return std::make_shared<task_info>(
+            tid, norns::iotask_type::noop, false, norns::auth::credentials(),
+            nullptr, nullptr, nullptr, nullptr);
+}
+
+} // anonymous namespace
+
+SCENARIO("task table", "[io::task_table]") {
+
+    GIVEN("an empty task table") {
+
+        task_table table(std::make_shared<norns::utils::block_cache>());
+
+        THEN("it has no tasks") {
+            REQUIRE(table.size() == 0);
+            REQUIRE(table.find(42) == nullptr);
+            REQUIRE(!table.erase(42));
+        }
+
+        WHEN("tasks are inserted") {
+
+            for(norns::iotask_id tid = 1; tid <= 200; ++tid) {
+                REQUIRE(table.insert(tid, make_task_info(tid)));
+            }
+
+            THEN("they can be found") {
+                REQUIRE(table.size() == 200);
+
+                for(norns::iotask_id tid = 1; tid <= 200; ++tid) {
+                    const auto tinfo = table.find(tid);
+                    REQUIRE(tinfo != nullptr);
+                    REQUIRE(tinfo->id() == tid);
+                }
+            }
+
+            THEN("existing ids can't be reused") {
+                REQUIRE(!table.insert(42, make_task_info(42)));
+                REQUIRE(table.size() == 200);
+            }
+
+            THEN("for_each() and count_if() visit all of them") {
+                std::size_t visited = 0;
+                table.for_each([&](const std::shared_ptr<task_info>&) {
+                    ++visited;
+                });
+                REQUIRE(visited == 200);
+
+                REQUIRE(table.count_if(
+                    [](const std::shared_ptr<task_info>& tinfo) {
+                        return tinfo->id() % 2 == 0;
+                    }) == 100);
+            }
+
+            AND_WHEN("some of them are erased") {
+
+                for(norns::iotask_id tid = 1; tid <= 200; tid += 2) {
+                    REQUIRE(table.erase(tid));
+                }
+
+                THEN("only the remaining ones can be found") {
+                    REQUIRE(table.size() == 100);
+
+                    for(norns::iotask_id tid = 1; tid <= 200; ++tid) {
+                        REQUIRE((table.find(tid) == nullptr) == (tid % 2 == 1));
+                    }
+                }
+            }
+
+            AND_WHEN("some of them finish and are buried") {
+
+                table.find(1)->update_status(task_status::finished);
+                table.find(2)->update_status(task_status::finished_with_error,
+                        norns::urd_error::system_error, 
+                        std::make_error_code(std::errc::no_space_on_device));
+
+                REQUIRE(table.bury(1));
+                REQUIRE(table.bury(2));
+                REQUIRE(!table.bury(201));
+
+                THEN("they are replaced by tombstones") {
+                    REQUIRE(table.size() == 198);
+                    REQUIRE(table.tombstones() == 2);
+                    REQUIRE(table.find(1) == nullptr);
+                    REQUIRE(table.find(2) == nullptr);
+                    REQUIRE(!static_cast<bool>(table.find_tombstone(3)));
+                }
+
+                THEN("their tombstones keep their final status") {
+                    const auto ts1 = table.find_tombstone(1);
+                    REQUIRE(static_cast<bool>(ts1));
+                    REQUIRE(!ts1->is_remote());
+                    REQUIRE(ts1->stats().status() == task_status::finished);
+
+                    const auto ts2 = table.find_tombstone(2);
+                    REQUIRE(static_cast<bool>(ts2));
+                    REQUIRE(ts2->stats().status() == 
+                            task_status::finished_with_error);
+                    REQUIRE(ts2->stats().error() == 
+                            norns::urd_error::system_error);
+                    REQUIRE(ts2->stats().sys_error().value() == ENOSPC);
+                }
+            }
+        }
+    }
+
+    GIVEN("a task table with a limited number of tombstones") {
+
+        // tombstones are limited per shard, so a few tasks per shard 
+        // are enough to exceed the limit
+        const std::size_t max_tombstones = task_table::num_shards * 2;
+        const norns::iotask_id ntasks = max_tombstones * 4;
+
+        task_table table(std::make_shared<norns::utils::block_cache>(),
+                         max_tombstones);
+
+        WHEN("more tasks than that are buried") {
+
+            for(norns::iotask_id tid = 1; tid <= ntasks; ++tid) {
+                REQUIRE(table.insert(tid, make_task_info(tid)));
+                REQUIRE(table.bury(tid));
+            }
+
+            THEN("only the most recent tombstones are kept") {
+                REQUIRE(table.size() == 0);
+                REQUIRE(table.tombstones() <= max_tombstones);
+                REQUIRE(table.tombstones() > 0);
+                REQUIRE(static_cast<bool>(table.find_tombstone(ntasks)));
+                REQUIRE(!static_cast<bool>(table.find_tombstone(1)));
+            }
+        }
+
+        WHEN("a reused id is buried again") {
+
+            // ids that fall on the same shard as 'tid'
+            const norns::iotask_id tid = 1;
+            const norns::iotask_id other = tid + task_table::num_shards;
+
+            REQUIRE(table.insert(tid, make_task_info(tid)));
+            REQUIRE(table.bury(tid));
+
+            const auto tinfo = make_task_info(tid);
+            tinfo->update_status(task_status::finished_with_error,
+                    norns::urd_error::system_error,
+                    std::make_error_code(std::errc::no_space_on_device));
+
+            REQUIRE(table.insert(tid, tinfo));
+            REQUIRE(table.bury(tid));
+
+            REQUIRE(table.insert(other, make_task_info(other)));
+            REQUIRE(table.bury(other));
+
+            THEN("its tombstone is refreshed and not evicted early") {
+                REQUIRE(table.tombstones() == 2);
+                REQUIRE(static_cast<bool>(table.find_tombstone(other)));
+
+                const auto ts = table.find_tombstone(tid);
+                REQUIRE(static_cast<bool>(ts));
+                REQUIRE(ts->stats().status() ==
+                        task_status::finished_with_error);
+            }
+        }
+    }
+
+    GIVEN("a task table accessed concurrently") {
+
+        task_table table(std::make_shared<norns::utils::block_cache>());
+
+        const unsigned nthreads = 4;
+        const norns::iotask_id per_thread = 2000;
+        std::atomic<norns::iotask_id> next_id{0};
+        std::atomic<std::size_t> failures{0};
+        std::vector<std::thread> threads;
+
+        // each thread inserts tasks and queries and erases them, along 
+        // with tasks inserted by the other threads
+        for(unsigned i = 0; i < nthreads; ++i) {
+            threads.emplace_back([&] {
+                for(norns::iotask_id n = 0; n < per_thread; ++n) {
+                    const auto tid = ++next_id;
+
+                    if(!table.insert(tid, make_task_info(tid))) {
+                        ++failures;
+                    }
+
+                    const auto tinfo = table.find(tid);
+
+                    if(!tinfo || tinfo->id() != tid) {
+                        ++failures;
+                    }
+
+                    // look up a task that may have been inserted by 
+                    // another thread
+                    table.find(tid - 1);
+
+                    if(n % 2 == 0 && !table.erase(tid)) {
+                        ++failures;
+                    }
+                }
+            });
+        }
+
+        for(auto& t : threads) {
+            t.join();
+        }
+
+        THEN("all operations succeed") {
+            REQUIRE(failures == 0);
+            REQUIRE(table.size() == nthreads * per_thread / 2);
+        }
+    }
+}
@@ -0,0 +1,316 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "io/thread-pool/thread-pool.hpp"
+#include "catch.hpp"
+
+namespace {
+
+void wait_for(const std::atomic<int>& counter, int expected) {
+    while(counter.load() < expected) {
+        std::this_thread::yield();
+    }
+}
+
+// like wait_for(), but give up after 'timeout'. Returns whether the 
+// counter reached 'expected'
+bool wait_for(const std::atomic<int>& counter, int expected, 
+              std::chrono::milliseconds timeout) {
+
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+    while(counter.load() < expected) {
+        if(std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::yield();
+    }
+
+    return true;
+}
+
+} // anonymous namespace
+
+SCENARIO("work-stealing deque", "[io::work_stealing_deque]") {
+
+    GIVEN("an empty deque") {
+
+        work_stealing_deque<int*> deque(4);
+        int values[16];
+
+        WHEN("the owner pushes more elements than its initial capacity") {
+
+            for(auto& v : values) {
+                deque.push(&v);
+            }
+
+            THEN("pop() returns them in LIFO order") {
+                REQUIRE(deque.size() == 16);
+
+                for(int i = 15; i >= 0; --i) {
+                    int* out = nullptr;
+                    REQUIRE(deque.pop(out));
+                    REQUIRE(out == &values[i]);
+                }
+
+                int* out = nullptr;
+                REQUIRE(!deque.pop(out));
+                REQUIRE(deque.empty());
+            }
+
+            THEN("steal() returns them in FIFO order") {
+                for(int i = 0; i < 16; ++i) {
+                    int* out = nullptr;
+                    REQUIRE(deque.steal(out));
+                    REQUIRE(out == &values[i]);
+                }
+
+                int* out = nullptr;
+                REQUIRE(!deque.steal(out));
+            }
+        }
+    }
+}
+
+SCENARIO("bounded MPMC queue", "[io::mpmc_queue]") {
+
+    GIVEN("a queue with capacity 8") {
+
+        mpmc_queue<int*> queue(8);
+        int values[9];
+
+        WHEN("9 elements are pushed") {
+
+            for(int i = 0; i < 8; ++i) {
+                REQUIRE(queue.try_push(&values[i]));
+            }
+
+            THEN("the 9th push fails") {
+                REQUIRE(!queue.try_push(&values[8]));
+            }
+
+            THEN("elements are popped in FIFO order") {
+                for(int i = 0; i < 8; ++i) {
+                    int* out = nullptr;
+                    REQUIRE(queue.try_pop(out));
+                    REQUIRE(out == &values[i]);
+                }
+
+                int* out = nullptr;
+                REQUIRE(!queue.try_pop(out));
+                REQUIRE(queue.empty());
+            }
+        }
+    }
+}
+
+SCENARIO("work-stealing thread pool", "[io::pool]") {
+
+    GIVEN("a pool with 4 workers") {
+
+        pool runners(4);
+
+        WHEN("many tasks are submitted with submit_and_forget()") {
+
+            const int ntasks = 100000;
+            std::atomic<int> counter{0};
+
+            for(int i = 0; i < ntasks; ++i) {
+                runners.submit_and_forget([&counter]() { ++counter; });
+            }
+
+            THEN("all of them are executed") {
+                wait_for(counter, ntasks);
+                REQUIRE(counter == ntasks);
+            }
+        }
+
+        WHEN("tasks are submitted with submit_with_epilog_and_forget()") {
+
+            const int ntasks = 1000;
+            std::atomic<int> counter{0};
+            std::atomic<int> errors{0};
+
+            for(int i = 0; i < ntasks; ++i) {
+
+                auto flag = std::make_shared<bool>(false);
+
+                runners.submit_with_epilog_and_forget(
+                    [flag]() { *flag = true; },
+                    [flag, &counter, &errors]() { 
+                        if(!*flag) {
+                            ++errors;
+                        }
+                        ++counter;
+                    });
+            }
+
+            THEN("each epilog runs after its task") {
+                wait_for(counter, ntasks);
+                REQUIRE(errors == 0);
+            }
+        }
+
+        WHEN("workers submit new tasks from within a task") {
+
+            const int nparents = 100;
+            const int nchildren = 100;
+            std::atomic<int> counter{0};
+
+            for(int i = 0; i < nparents; ++i) {
+                runners.submit_and_forget([&runners, &counter]() {
+                    for(int j = 0; j < nchildren; ++j) {
+                        runners.submit_and_forget([&counter]() { ++counter; });
+                    }
+                });
+            }
+
+            THEN("all nested tasks are executed") {
+                wait_for(counter, nparents * nchildren);
+                REQUIRE(counter == nparents * nchildren);
+            }
+        }
+
+        WHEN("a task is submitted with submit_and_track()") {
+
+            auto future = runners.submit_and_track([](int a, int b) {
+                    return a + b;
+                }, 40, 2);
+
+            THEN("its result can be retrieved") {
+                REQUIRE(future.get() == 42);
+            }
+        }
+    }
+}
+
+SCENARIO("resizable thread pool", "[io::pool]") {
+
+    GIVEN("a pool with 2 active workers and room for 8") {
+
+        pool runners(2, 8);
+
+        REQUIRE(runners.size() == 2);
+        REQUIRE(runners.capacity() == 8);
+
+        WHEN("the pool is grown") {
+
+            runners.resize(8);
+
+            THEN("tasks can run concurrently on all workers") {
+
+                std::atomic<int> running{0};
+                std::atomic<int> done{0};
+
+                for(int i = 0; i < 8; ++i) {
+                    runners.submit_and_forget([&running, &done]() {
+                        ++running;
+                        // wait until all 8 tasks are running at once
+                        while(running.load() < 8) {
+                            std::this_thread::yield();
+                        }
+                        ++done;
+                    });
+                }
+
+                wait_for(done, 8);
+                REQUIRE(runners.size() == 8);
+            }
+        }
+
+        WHEN("the pool is resized beyond its capacity") {
+
+            runners.resize(100);
+
+            THEN("it is clamped to its capacity") {
+                REQUIRE(runners.size() == 8);
+            }
+        }
+
+        WHEN("the pool is shrunk while tasks are queued") {
+
+            const int ntasks = 10000;
+            std::atomic<int> counter{0};
+
+            runners.resize(8);
+
+            for(int i = 0; i < ntasks; ++i) {
+                runners.submit_and_forget([&counter]() { ++counter; });
+
+                if(i == ntasks / 2) {
+                    runners.resize(1);
+                }
+            }
+
+            THEN("all tasks are still executed") {
+                wait_for(counter, ntasks);
+                REQUIRE(counter == ntasks);
+                REQUIRE(runners.size() == 1);
+            }
+        }
+    }
+
+    GIVEN("an idle pool with 4 active workers") {
+
+        WHEN("it is shrunk and a task is submitted") {
+
+            THEN("the task is executed") {
+
+                // the task used to be stranded if enqueue() woke up one 
+                // of the deactivated workers, so try several times
+                for(int round = 0; round < 20; ++round) {
+
+                    pool runners(4, 4);
+                    std::atomic<int> counter{0};
+
+                    // let all workers go to sleep
+                    std::this_thread::sleep_for(
+                            std::chrono::milliseconds(10));
+
+                    runners.resize(1);
+                    runners.submit_and_forget([&counter]() { ++counter; });
+
+                    REQUIRE(wait_for(counter, 1, 
+                                     std::chrono::milliseconds(5000)));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,254 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include "metrics/metrics-registry.hpp"
+#include "metrics/metrics-exporter.hpp"
+#include "catch.hpp"
+
+namespace bfs = boost::filesystem;
+
+using norns::metrics::registry;
+using norns::metrics::exporter;
+using norns::metrics::metric_type;
+using norns::metrics::sample;
+
+namespace {
+
+bool
+contains(const std::string& str, const std::string& substr) {
+    return str.find(substr) != std::string::npos;
+}
+
+// send an HTTP request through a UNIX socket and return the full response
+std::string
+query(const bfs::path& socket_path) {
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    REQUIRE(fd != -1);
+
+    struct sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socket_path.c_str(), 
+                 sizeof(addr.sun_path) - 1);
+
+    REQUIRE(::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), 
+                      sizeof(addr)) == 0);
+
+    const std::string request = "GET /metrics HTTP/1.0\r\n\r\n";
+    REQUIRE(::write(fd, request.data(), request.size()) == 
+            static_cast<ssize_t>(request.size()));
+
+    std::string response;
+    char buffer[1024];
+    ssize_t n;
+
+    while((n = ::read(fd, buffer, sizeof(buffer))) > 0) {
+        response.append(buffer, n);
+    }
+
+    ::close(fd);
+    return response;
+}
+
+} // anonymous namespace
+
+SCENARIO("metrics registry", "[metrics::registry]") {
+
+    GIVEN("an empty registry") {
+
+        registry reg;
+
+        THEN("nothing is exported") {
+            REQUIRE(reg.to_prometheus().empty());
+        }
+
+        WHEN("counters and gauges are registered and updated") {
+
+            auto c1 = reg.make_counter("norns_test_total", "A test counter", 
+                                       {{"pair", "a"}});
+            auto c2 = reg.make_counter("norns_test_total", "A test counter", 
+                                       {{"pair", "b"}});
+            auto g = reg.make_gauge("norns_test_gauge", "A test gauge");
+
+            c1->inc();
+            c1->inc(41);
+            c2->inc(7);
+            g->set(10);
+            g->sub(3);
+
+            const auto text = reg.to_prometheus();
+
+            THEN("they are exported in the Prometheus text format") {
+                REQUIRE(contains(text, "# HELP norns_test_total "
+                                       "A test counter\n"));
+                REQUIRE(contains(text, "# TYPE norns_test_total counter\n"));
+                REQUIRE(contains(text, "norns_test_total{pair=\"a\"} 42\n"));
+                REQUIRE(contains(text, "norns_test_total{pair=\"b\"} 7\n"));
+                REQUIRE(contains(text, "# TYPE norns_test_gauge gauge\n"));
+                REQUIRE(contains(text, "norns_test_gauge 7\n"));
+            }
+
+            THEN("registering them again returns the same instances") {
+                REQUIRE(reg.make_counter("norns_test_total", "", 
+                                         {{"pair", "a"}}) == c1);
+                REQUIRE(reg.make_gauge("norns_test_gauge", "") == g);
+            }
+
+            THEN("reusing their names with another type fails") {
+                REQUIRE_THROWS_AS(reg.make_gauge("norns_test_total", ""), 
+                                  std::invalid_argument);
+                REQUIRE_THROWS_AS(reg.add_collector("norns_test_gauge", "", 
+                                    metric_type::counter, 
+                                    [](std::vector<sample>&) { }), 
+                                  std::invalid_argument);
+            }
+        }
+
+        WHEN("invalid names are used") {
+            THEN("registration fails") {
+                REQUIRE_THROWS_AS(reg.make_counter("0abc", ""), 
+                                  std::invalid_argument);
+                REQUIRE_THROWS_AS(reg.make_counter("a-b", ""), 
+                                  std::invalid_argument);
+                REQUIRE_THROWS_AS(reg.make_counter("ok", "", {{"a:b", "x"}}), 
+                                  std::invalid_argument);
+            }
+        }
+
+        WHEN("collectors are registered") {
+
+            int ncalls = 0;
+
+            reg.add_collector("norns_collected", "Computed \\ on demand\n", 
+                    metric_type::gauge, [&](std::vector<sample>& samples) {
+                        ++ncalls;
+                        samples.emplace_back(
+                            norns::metrics::labels{{"path", "a\"b\\c\nd"}}, 
+                            0.5);
+                    });
+
+            reg.add_collector("norns_empty", "No samples", metric_type::gauge,
+                    [](std::vector<sample>&) { });
+
+            const auto text = reg.to_prometheus();
+
+            THEN("they are invoked and their samples escaped") {
+                REQUIRE(ncalls == 1);
+                REQUIRE(contains(text, "# HELP norns_collected "
+                                       "Computed \\\\ on demand\\n\n"));
+                REQUIRE(contains(text, "norns_collected"
+                                       "{path=\"a\\\"b\\\\c\\nd\"} 0.5\n"));
+            }
+
+            THEN("metrics without samples are omitted") {
+                REQUIRE(!contains(text, "norns_empty"));
+            }
+        }
+    }
+}
+
+SCENARIO("metrics exporter", "[metrics::exporter]") {
+
+    GIVEN("a registry with some metrics") {
+
+        const auto reg = std::make_shared<registry>();
+        reg->make_counter("norns_test_total", "A test counter")->inc(3);
+
+        const bfs::path tmpdir = bfs::temp_directory_path() / 
+                                 bfs::unique_path("metrics-%%%%-%%%%");
+        bfs::create_directories(tmpdir);
+
+        WHEN("metrics are exported through a UNIX socket") {
+
+            exporter exp(reg, tmpdir / "metrics.socket", {}, 
+                         std::chrono::seconds(1));
+            REQUIRE(!exp.start());
+
+            const auto response = query(tmpdir / "metrics.socket");
+
+            THEN("requests are answered with the current metrics") {
+                REQUIRE(response.compare(0, 15, "HTTP/1.0 200 OK") == 0);
+                REQUIRE(contains(response, "\r\n\r\n# HELP norns_test_total"));
+                REQUIRE(contains(response, "norns_test_total 3\n"));
+            }
+
+            AND_WHEN("the exporter is stopped") {
+
+                exp.stop();
+
+                THEN("the socket is removed") {
+                    REQUIRE(!bfs::exists(tmpdir / "metrics.socket"));
+                }
+            }
+        }
+
+        WHEN("metrics are exported to a textfile") {
+
+            const bfs::path textfile = tmpdir / "urd.prom";
+            exporter exp(reg, {}, textfile, std::chrono::seconds(1));
+            REQUIRE(!exp.start());
+
+            // the file is written as soon as the exporter starts
+            for(int i = 0; i < 100 && !bfs::exists(textfile); ++i) {
+                usleep(10000);
+            }
+
+            exp.stop();
+
+            THEN("the file contains the current metrics") {
+                bfs::ifstream in(textfile);
+                const std::string contents(
+                        (std::istreambuf_iterator<char>(in)), 
+                        std::istreambuf_iterator<char>());
+
+                REQUIRE(contains(contents, "norns_test_total 3\n"));
+                REQUIRE(!bfs::exists(textfile.string() + ".tmp"));
+            }
+        }
+
+        bfs::remove_all(tmpdir);
+    }
+}
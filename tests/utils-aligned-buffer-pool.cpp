@@ -0,0 +1,127 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "utils/aligned-buffer-pool.hpp"
+#include "catch.hpp"
+
+using norns::utils::aligned_buffer_pool;
+
+SCENARIO("aligned buffer pool", "[utils::aligned_buffer_pool]") {
+
+    GIVEN("a pool of 64 KiB buffers aligned to 4 KiB") {
+
+        aligned_buffer_pool pool(64*1024, 4096, 2);
+
+        REQUIRE(pool.buffer_size() == 64*1024);
+        REQUIRE(pool.alignment() == 4096);
+        REQUIRE(pool.cached_buffers() == 0);
+
+        WHEN("buffers are acquired") {
+
+            auto b1 = pool.acquire();
+            auto b2 = pool.acquire();
+
+            THEN("they are distinct, aligned and writable") {
+                REQUIRE(b1.get() != b2.get());
+                REQUIRE(reinterpret_cast<uintptr_t>(b1.get()) % 4096 == 0);
+                REQUIRE(reinterpret_cast<uintptr_t>(b2.get()) % 4096 == 0);
+
+                b1.get()[0] = 'a';
+                b1.get()[pool.buffer_size() - 1] = 'z';
+                REQUIRE(b1.get()[0] == 'a');
+                REQUIRE(b1.get()[pool.buffer_size() - 1] == 'z');
+            }
+        }
+
+        WHEN("buffers are released") {
+
+            char* ptr;
+
+            {
+                auto b = pool.acquire();
+                ptr = b.get();
+            }
+
+            THEN("they are cached and handed out again") {
+                REQUIRE(pool.cached_buffers() == 1);
+
+                auto b = pool.acquire();
+                REQUIRE(b.get() == ptr);
+                REQUIRE(pool.cached_buffers() == 0);
+            }
+        }
+
+        WHEN("more buffers than the limit are released") {
+
+            {
+                auto b1 = pool.acquire();
+                auto b2 = pool.acquire();
+                auto b3 = pool.acquire();
+            }
+
+            THEN("only up to the limit are cached") {
+                REQUIRE(pool.cached_buffers() == 2);
+            }
+        }
+    }
+
+    GIVEN("a pool shared by several threads") {
+
+        aligned_buffer_pool pool(4096, 4096, 8);
+        std::vector<std::thread> threads;
+
+        for(int i = 0; i < 4; ++i) {
+            threads.emplace_back([&pool, i]() {
+                for(int j = 0; j < 1000; ++j) {
+                    auto b = pool.acquire();
+                    b.get()[0] = static_cast<char>(i);
+                }
+            });
+        }
+
+        for(auto& t : threads) {
+            t.join();
+        }
+
+        THEN("no more buffers than threads are cached") {
+            REQUIRE(pool.cached_buffers() <= 4);
+        }
+    }
+}
@@ -0,0 +1,158 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "utils/latency-histogram.hpp"
+#include "catch.hpp"
+
+using norns::utils::latency_histogram;
+
+SCENARIO("latency histogram", "[utils::latency_histogram]") {
+
+    GIVEN("an empty histogram") {
+
+        latency_histogram h;
+
+        THEN("it reports no values") {
+            REQUIRE(h.count() == 0);
+            REQUIRE(h.mean() == 0.0);
+            REQUIRE(h.max() == 0);
+            REQUIRE(h.percentile(0.5) == 0);
+        }
+    }
+
+    GIVEN("a histogram with small values") {
+
+        latency_histogram h;
+
+        for(uint64_t v = 1; v <= 10; ++v) {
+            h.record(v);
+        }
+
+        THEN("they are reported exactly") {
+            REQUIRE(h.count() == 10);
+            REQUIRE(h.mean() == Approx(5.5));
+            REQUIRE(h.max() == 10);
+            REQUIRE(h.percentile(0.0) == 1);
+            REQUIRE(h.percentile(0.5) == 5);
+            REQUIRE(h.percentile(0.9) == 9);
+            REQUIRE(h.percentile(1.0) == 10);
+        }
+    }
+
+    GIVEN("a histogram with values spanning several orders of magnitude") {
+
+        latency_histogram h;
+
+        // 1us .. 100s
+        for(uint64_t v = 1; v <= 100000000; v *= 10) {
+            for(int i = 0; i < 10; ++i) {
+                h.record(v);
+            }
+        }
+
+        THEN("percentiles are within the resolution of the histogram") {
+            REQUIRE(h.count() == 90);
+            REQUIRE(h.max() == 100000000);
+
+            for(auto q : {0.1, 0.3, 0.5, 0.7, 0.9}) {
+                // q falls on the last value of a decade
+                uint64_t expected = 1;
+                for(int i = 1; i < q * 10; ++i) {
+                    expected *= 10;
+                }
+
+                const double err = 
+                    std::abs(static_cast<double>(h.percentile(q)) - expected) / 
+                    expected;
+                REQUIRE(err <= 1.0 / 16);
+            }
+
+            REQUIRE(h.percentile(1.0) == 100000000);
+        }
+    }
+
+    GIVEN("durations") {
+
+        latency_histogram h;
+
+        h.record(std::chrono::milliseconds(3));
+        h.record(std::chrono::nanoseconds(-5));
+
+        THEN("they are recorded in microseconds") {
+            REQUIRE(h.count() == 2);
+            REQUIRE(h.max() == 3000);
+            REQUIRE(h.percentile(0.0) == 0);
+        }
+    }
+
+    GIVEN("values larger than the range of the histogram") {
+
+        latency_histogram h;
+        h.record(uint64_t{1} << 50);
+
+        THEN("they are reported as the recorded maximum") {
+            REQUIRE(h.count() == 1);
+            REQUIRE(h.percentile(0.5) == uint64_t{1} << 50);
+        }
+    }
+
+    GIVEN("a histogram updated concurrently") {
+
+        latency_histogram h;
+        std::vector<std::thread> threads;
+
+        for(int t = 0; t < 4; ++t) {
+            threads.emplace_back([&h, t] {
+                for(uint64_t v = 0; v < 10000; ++v) {
+                    h.record(v * (t + 1));
+                }
+            });
+        }
+
+        for(auto& t : threads) {
+            t.join();
+        }
+
+        THEN("no values are lost") {
+            REQUIRE(h.count() == 40000);
+            REQUIRE(h.max() == 9999 * 4);
+        }
+    }
+}
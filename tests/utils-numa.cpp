@@ -0,0 +1,124 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <sched.h>
+#include <thread>
+#include "utils/numa.hpp"
+#include "catch.hpp"
+
+namespace numa = norns::utils::numa;
+
+namespace {
+
+cpu_set_t
+current_affinity() {
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    ::sched_getaffinity(0, sizeof(mask), &mask);
+    return mask;
+}
+
+} // anonymous namespace
+
+SCENARIO("NUMA node detection", "[utils::numa]") {
+
+    GIVEN("paths not backed by a block device") {
+        THEN("node_of() returns no_node") {
+            REQUIRE(numa::node_of("/proc") == numa::no_node);
+            REQUIRE(numa::node_of("/non/existing/path") == numa::no_node);
+        }
+    }
+
+    GIVEN("non-existing nodes") {
+        THEN("is_valid_node() returns false") {
+            REQUIRE(!numa::is_valid_node(numa::no_node));
+            REQUIRE(!numa::is_valid_node(1 << 20));
+        }
+    }
+}
+
+SCENARIO("NUMA thread binding", "[utils::numa]") {
+
+    // run in a separate thread so that the test runner is not affected
+    GIVEN("a thread that binds itself to an invalid node") {
+        std::error_code ec;
+        bool unchanged = false;
+
+        std::thread([&] {
+            const auto before = current_affinity();
+            ec = numa::bind_current_thread(1 << 20);
+            const auto after = current_affinity();
+            unchanged = CPU_EQUAL(&before, &after);
+        }).join();
+
+        THEN("an error is returned and its affinity is not modified") {
+            REQUIRE(ec);
+            REQUIRE(unchanged);
+        }
+    }
+
+    GIVEN("a thread that binds itself to node 0 and then unbinds itself") {
+
+        if(!numa::is_valid_node(0)) {
+            WARN("NUMA node 0 not available, skipping");
+            return;
+        }
+
+        std::error_code ec_bind, ec_unbind;
+        bool restricted = false;
+        bool restored = false;
+
+        std::thread([&] {
+            const auto before = current_affinity();
+
+            ec_bind = numa::bind_current_thread(0);
+            const auto bound = current_affinity();
+            restricted = CPU_COUNT(&bound) <= CPU_COUNT(&before);
+
+            ec_unbind = numa::bind_current_thread(numa::no_node);
+            const auto after = current_affinity();
+            restored = CPU_EQUAL(&before, &after);
+        }).join();
+
+        THEN("its affinity is restricted and later restored") {
+            REQUIRE(!ec_bind);
+            REQUIRE(restricted);
+            REQUIRE(!ec_unbind);
+            REQUIRE(restored);
+        }
+    }
+}
@@ -0,0 +1,188 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <chrono>
+#include <thread>
+#include <boost/thread/locks.hpp>
+#include "utils/profiled-mutex.hpp"
+#include "catch.hpp"
+
+using norns::utils::lock_stats;
+using norns::utils::lock_stats_snapshot;
+using norns::utils::profiled_mutex;
+using norns::utils::profiled_shared_mutex;
+
+namespace {
+
+lock_stats_snapshot
+find(const std::string& name) {
+    for(const auto& s : lock_stats::collect()) {
+        if(s.m_name == name) {
+            return s;
+        }
+    }
+
+    FAIL("lock stats for '" << name << "' not found");
+    return lock_stats_snapshot();
+}
+
+} // anonymous namespace
+
+SCENARIO("lock contention profiling", "[utils::profiled_mutex]") {
+
+    GIVEN("lock stats records") {
+
+        THEN("records are shared by name") {
+            auto& ls0 = lock_stats::named("test.shared_by_name");
+            auto& ls1 = lock_stats::named("test.shared_by_name");
+            REQUIRE(&ls0 == &ls1);
+        }
+
+        THEN("records are reported in name order") {
+            lock_stats::named("test.order.b");
+            lock_stats::named("test.order.a");
+
+            const auto snapshots = lock_stats::collect();
+
+            for(std::size_t i = 1; i < snapshots.size(); ++i) {
+                REQUIRE(snapshots[i-1].m_name <= snapshots[i].m_name);
+            }
+        }
+    }
+
+    GIVEN("a profiled mutex and profiling disabled") {
+
+        norns::utils::enable_lock_profiling(false);
+        profiled_mutex m("test.disabled");
+
+        WHEN("the mutex is acquired") {
+            {
+                std::lock_guard<profiled_mutex> lock(m);
+            }
+
+            REQUIRE(m.try_lock());
+            m.unlock();
+
+            THEN("nothing is recorded") {
+                const auto s = find("test.disabled");
+                REQUIRE(s.m_acquisitions == 0);
+                REQUIRE(s.m_hold_ns == 0);
+            }
+        }
+    }
+
+    GIVEN("a profiled mutex and profiling enabled") {
+
+        norns::utils::enable_lock_profiling(true);
+
+        // records outlive the mutexes, so each case uses its own
+        WHEN("the mutex is acquired without contention") {
+            profiled_mutex m("test.uncontended");
+
+            for(int i = 0; i < 10; ++i) {
+                std::lock_guard<profiled_mutex> lock(m);
+            }
+
+            THEN("acquisitions are counted but no waits are") {
+                const auto s = find("test.uncontended");
+                REQUIRE(s.m_acquisitions == 10);
+                REQUIRE(s.m_shared_acquisitions == 0);
+                REQUIRE(s.m_contended == 0);
+                REQUIRE(s.m_wait_ns == 0);
+                REQUIRE(s.m_max_hold_ns <= s.m_hold_ns);
+            }
+        }
+
+        WHEN("another thread holds the mutex") {
+
+            profiled_mutex m("test.contended");
+            const auto hold_time = std::chrono::milliseconds(50);
+
+            std::unique_lock<profiled_mutex> lock(m);
+
+            std::thread t([&]() {
+                std::lock_guard<profiled_mutex> lock(m);
+            });
+
+            std::this_thread::sleep_for(hold_time);
+            lock.unlock();
+            t.join();
+
+            THEN("the wait and hold times are recorded") {
+                const auto s = find("test.contended");
+                REQUIRE(s.m_acquisitions == 2);
+                REQUIRE(s.m_contended == 1);
+                REQUIRE(s.m_wait_ns > 0);
+                REQUIRE(s.m_max_wait_ns == s.m_wait_ns);
+                REQUIRE(s.m_max_hold_ns >= 
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        hold_time).count());
+            }
+        }
+
+        norns::utils::enable_lock_profiling(false);
+    }
+
+    GIVEN("a profiled shared mutex and profiling enabled") {
+
+        norns::utils::enable_lock_profiling(true);
+        profiled_shared_mutex m("test.shared");
+
+        WHEN("the mutex is acquired in shared and exclusive mode") {
+            {
+                boost::shared_lock<profiled_shared_mutex> lock0(m);
+                boost::shared_lock<profiled_shared_mutex> lock1(m);
+                REQUIRE(m.try_lock_shared());
+                m.unlock_shared();
+                REQUIRE(!m.try_lock());
+            }
+
+            {
+                boost::unique_lock<profiled_shared_mutex> lock(m);
+            }
+
+            THEN("each mode is accounted for separately") {
+                const auto s = find("test.shared");
+                REQUIRE(s.m_shared_acquisitions == 3);
+                REQUIRE(s.m_acquisitions == 1);
+                REQUIRE(s.m_contended == 0);
+            }
+        }
+
+        norns::utils::enable_lock_profiling(false);
+    }
+}
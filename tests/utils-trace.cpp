@@ -0,0 +1,173 @@
+/************************************************************************* 
+ * Copyright (C) 2017-2019 Barcelona Supercomputing Center               *
+ *                         Centro Nacional de Supercomputacion           *
+ * All rights reserved.                                                  *
+ *                                                                       *
+ * This file is part of NORNS, a service that allows other programs to   *
+ * start, track and manage asynchronous transfers of data resources      *
+ * between different storage backends.                                   *
+ *                                                                       *
+ * See AUTHORS file in the top level directory for information regarding *
+ * developers and contributors.                                          *
+ *                                                                       *
+ * This software was developed as part of the EC H2020 funded project    *
+ * NEXTGenIO (Project ID: 671951).                                       *
+ *     www.nextgenio.eu                                                  *
+ *                                                                       *
+ * Permission is hereby granted, free of charge, to any person obtaining *
+ * a copy of this software and associated documentation files (the       *
+ * "Software"), to deal in the Software without restriction, including   *
+ * without limitation the rights to use, copy, modify, merge, publish,   *
+ * distribute, sublicense, and/or sell copies of the Software, and to    *
+ * permit persons to whom the Software is furnished to do so, subject to *
+ * the following conditions:                                             *
+ *                                                                       *
+ * The above copyright notice and this permission notice shall be        *
+ * included in all copies or substantial portions of the Software.       *
+ *                                                                       *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       *
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    *
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND                 *
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS   *
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN    *
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN     *
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE      *
+ * SOFTWARE.                                                             *
+ *************************************************************************/
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include "utils/trace.hpp"
+#include "catch.hpp"
+
+namespace trace = norns::utils::trace;
+namespace bpt = boost::property_tree;
+
+namespace {
+
+// parse the current trace, checking that it is valid JSON
+bpt::ptree
+dump() {
+    std::stringstream ss;
+    trace::write_chrome_json(ss);
+
+    bpt::ptree pt;
+    REQUIRE_NOTHROW(bpt::read_json(ss, pt));
+    return pt;
+}
+
+// events with category 'cat' in the trace
+std::vector<bpt::ptree>
+events_of(const bpt::ptree& pt, const std::string& cat) {
+
+    std::vector<bpt::ptree> events;
+
+    for(const auto& kv : pt.get_child("traceEvents")) {
+        if(kv.second.get<std::string>("cat", "") == cat) {
+            events.push_back(kv.second);
+        }
+    }
+
+    return events;
+}
+
+} // anonymous namespace
+
+SCENARIO("lifecycle tracing", "[utils::trace]") {
+
+    GIVEN("tracing is disabled") {
+
+        trace::configure(0);
+
+        WHEN("events are recorded") {
+
+            trace::instant("test", "ignored", 1);
+            { trace::scope s("test", "ignored", 2); }
+
+            THEN("nothing is traced") {
+                REQUIRE(!trace::enabled());
+                REQUIRE(events_of(dump(), "test").empty());
+            }
+        }
+    }
+
+    GIVEN("tracing is enabled") {
+
+        trace::configure(8);
+
+        WHEN("events are recorded") {
+
+            trace::set_thread_name("main \"thread\"");
+            trace::instant("test", "submitted", 42);
+            { trace::scope s("test", "executed", 42); }
+
+            const auto events = events_of(dump(), "test");
+
+            THEN("they are exported in the Chrome trace format") {
+                REQUIRE(events.size() == 2);
+
+                REQUIRE(events[0].get<std::string>("name") == "submitted");
+                REQUIRE(events[0].get<std::string>("ph") == "i");
+                REQUIRE(events[0].get<uint64_t>("args.id") == 42);
+
+                REQUIRE(events[1].get<std::string>("name") == "executed");
+                REQUIRE(events[1].get<std::string>("ph") == "X");
+                REQUIRE(events[1].get<int64_t>("dur") >= 0);
+                REQUIRE(events[1].get<int64_t>("ts") >= 
+                        events[0].get<int64_t>("ts"));
+            }
+
+            THEN("the thread is named") {
+                const auto pt = dump();
+                bool found = false;
+
+                for(const auto& kv : pt.get_child("traceEvents")) {
+                    if(kv.second.get<std::string>("ph") == "M" &&
+                       kv.second.get<std::string>("args.name") == 
+                            "main \"thread\"") {
+                        found = true;
+                    }
+                }
+
+                REQUIRE(found);
+            }
+        }
+
+        WHEN("more events than the buffer can hold are recorded") {
+
+            for(uint64_t i = 0; i < 20; ++i) {
+                trace::instant("test", "event", i);
+            }
+
+            const auto events = events_of(dump(), "test");
+
+            THEN("only the most recent ones are kept, in order") {
+                REQUIRE(events.size() == 8);
+
+                for(uint64_t i = 0; i < 8; ++i) {
+                    REQUIRE(events[i].get<uint64_t>("args.id") == 12 + i);
+                }
+            }
+        }
+
+        WHEN("events are recorded by a thread that exits") {
+
+            std::thread t([] {
+                trace::set_thread_name("worker");
+                trace::instant("test-thread", "event", 7);
+            });
+            t.join();
+
+            THEN("its events are still exported") {
+                const auto events = events_of(dump(), "test-thread");
+                REQUIRE(events.size() == 1);
+                REQUIRE(events[0].get<uint64_t>("args.id") == 7);
+            }
+        }
+
+        trace::configure(0);
+    }
+}